@@ -0,0 +1,438 @@
+#include "Node.h"
+#include "SensorDataJsonReader.h"
+#include "SensorDataJsonWriter.h"
+#include "SensorDataStore.h"
+#include "SensorTreeModel.h"
+#include "SyntheticLoad.h"
+
+#include <nlohmann/json.hpp>
+#include <wx/app.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Headless data-path benchmarks: microbenchmarks of the tree model, node
+// history, JSON writer, JSON reader and filter, and seeded synthetic workloads
+// applied through the store's packed ingest. Every case times a number of
+// repetitions of a batch of operations and reports per-operation percentiles
+// as JSON, so runs can be compared across commits.
+//
+// Usage: SensorTreeBenchmarks [--sizes=1000,10000,100000] [--repetitions=20]
+//                             [--batch=1000] [--cases=model,node,writer,reader,filter,workload]
+//                             [--workloads=workloads.json] [--output=results.json]
+//
+// Without --workloads, one workload per profile is run at the largest size.
+// Results go to stdout unless --output is given.
+
+namespace {
+
+using json = nlohmann::json;
+
+struct BenchmarkOptions
+{
+   std::vector<size_t> sizes = {1000, 10000, 100000};
+   size_t repetitions        = 20;
+   size_t batch              = 1000;
+   std::vector<std::string> cases;
+   std::string workloadFile;
+   std::string outputFile;
+};
+
+struct CaseResult
+{
+   std::string name;
+   json parameters;
+   size_t operations = 0;
+   // Nanoseconds per operation, one entry per timed repetition.
+   std::vector<double> samples;
+};
+
+std::vector<size_t> ParseList(const std::string &text)
+{
+   std::vector<size_t> values;
+   std::istringstream stream(text);
+   std::string item;
+   while (std::getline(stream, item, ',')) {
+      if (!item.empty())
+         values.push_back(static_cast<size_t>(std::stoull(item)));
+   }
+   return values;
+}
+
+std::vector<std::string> ParseNames(const std::string &text)
+{
+   std::vector<std::string> names;
+   std::istringstream stream(text);
+   std::string item;
+   while (std::getline(stream, item, ',')) {
+      if (!item.empty())
+         names.push_back(item);
+   }
+   return names;
+}
+
+bool ParseOptions(const std::vector<std::string> &args, BenchmarkOptions &options, std::string &errorMessage)
+{
+   for (const std::string &arg : args) {
+      const size_t equals = arg.find('=');
+      if (arg.rfind("--", 0) != 0 || equals == std::string::npos) {
+         errorMessage = "Unrecognised argument: " + arg;
+         return false;
+      }
+
+      const std::string key   = arg.substr(2, equals - 2);
+      const std::string value = arg.substr(equals + 1);
+      try {
+         if (key == "sizes")
+            options.sizes = ParseList(value);
+         else if (key == "repetitions")
+            options.repetitions = static_cast<size_t>(std::stoull(value));
+         else if (key == "batch")
+            options.batch = static_cast<size_t>(std::stoull(value));
+         else if (key == "cases")
+            options.cases = ParseNames(value);
+         else if (key == "workloads")
+            options.workloadFile = value;
+         else if (key == "output")
+            options.outputFile = value;
+         else {
+            errorMessage = "Unknown option: --" + key;
+            return false;
+         }
+      } catch (const std::exception &) {
+         errorMessage = "Invalid value for --" + key + ": " + value;
+         return false;
+      }
+   }
+
+   const bool hasZeroSize = std::find(options.sizes.begin(), options.sizes.end(), 0) != options.sizes.end();
+   if (options.sizes.empty() || hasZeroSize || options.repetitions == 0 || options.batch == 0) {
+      errorMessage = "Sizes, repetitions and batch must all be non-empty and positive.";
+      return false;
+   }
+
+   return true;
+}
+
+bool IsCaseSelected(const BenchmarkOptions &options, const std::string &group)
+{
+   return options.cases.empty() || std::find(options.cases.begin(), options.cases.end(), group) != options.cases.end();
+}
+
+// Nearest-rank percentile of sorted samples.
+double GetPercentile(const std::vector<double> &sorted, double percentile)
+{
+   const size_t rank = static_cast<size_t>(std::ceil(percentile / 100.0 * static_cast<double>(sorted.size())));
+   return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+// Runs the batch once untimed, then `repetitions` timed times.
+template <typename Batch>
+CaseResult Measure(std::string name, json parameters, size_t operations, size_t repetitions, Batch &&runBatch)
+{
+   CaseResult result;
+   result.name       = std::move(name);
+   result.parameters = std::move(parameters);
+   result.operations = operations;
+
+   runBatch();
+   for (size_t repetition = 0; repetition < repetitions; ++repetition) {
+      const auto start = std::chrono::steady_clock::now();
+      runBatch();
+      const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+      result.samples.push_back(elapsed.count() / static_cast<double>(operations));
+   }
+
+   std::vector<double> sorted = result.samples;
+   std::sort(sorted.begin(), sorted.end());
+   std::fprintf(stderr, "%-22s %-44s %12.1f ns/op\n", result.name.c_str(), result.parameters.dump().c_str(),
+       GetPercentile(sorted, 50.0));
+   return result;
+}
+
+json DescribeResult(const CaseResult &result)
+{
+   std::vector<double> sorted = result.samples;
+   std::sort(sorted.begin(), sorted.end());
+
+   double total = 0.0;
+   for (double sample : sorted)
+      total += sample;
+
+   const double median = GetPercentile(sorted, 50.0);
+   return {
+       {"name", result.name},
+       {"parameters", result.parameters},
+       {"operations_per_repetition", result.operations},
+       {"repetitions", sorted.size()},
+       {"ns_per_op",
+           {{"min", sorted.front()}, {"p50", median}, {"p90", GetPercentile(sorted, 90.0)}, {"p99", GetPercentile(sorted, 99.0)},
+               {"max", sorted.back()}, {"mean", total / static_cast<double>(sorted.size())}}},
+       {"ops_per_second", median > 0.0 ? 1e9 / median : 0.0},
+   };
+}
+
+std::vector<SyntheticLoadGenerator::SensorDefinition> MakeSensors(size_t count)
+{
+   SyntheticLoadConfig config;
+   config.sensorCount = count;
+   config.depth       = 2;
+   config.fanOut      = 10;
+   return SyntheticLoadGenerator(config).GetSensors();
+}
+
+DataValue MakeValue(DataValue::e_Type type, size_t step)
+{
+   switch (type) {
+      case DataValue::DOUBLE:
+         return DataValue(50.0 + static_cast<double>(step % 20));
+      case DataValue::INTEGER:
+         return DataValue(static_cast<std::int64_t>(500 + step % 200));
+      case DataValue::STRING:
+         return DataValue(std::string(step % 2 == 0 ? "OK" : "Warning"));
+      case DataValue::BOOLEAN:
+         return DataValue(step % 2 == 0);
+   }
+
+   return DataValue(0.0);
+}
+
+// Gives every sensor its first sample, so timed samples update existing rows.
+void PopulateModel(SensorTreeModel &model, const std::vector<SyntheticLoadGenerator::SensorDefinition> &sensors,
+    std::chrono::steady_clock::time_point timestamp)
+{
+   std::vector<SensorSample> samples;
+   for (const auto &sensor : sensors) {
+      samples.push_back({sensor.path, MakeValue(sensor.type, 0), sensor.thresholds, SensorAlarmState::Ok, timestamp});
+      if (samples.size() == 10000) {
+         model.AddDataSamples(samples);
+         samples.clear();
+      }
+   }
+   model.AddDataSamples(samples);
+}
+
+void RunModelCases(const BenchmarkOptions &options, std::vector<CaseResult> &results)
+{
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(1));
+   for (size_t size : options.sizes) {
+      const auto sensors = MakeSensors(size);
+      for (const char *filter : {"none", "text", "alarmed"}) {
+         SensorTreeModel model;
+         model.SetLiveDataMode(false);
+         PopulateModel(model, sensors, baseTime);
+         if (std::string(filter) == "text")
+            model.SetFilter("Sensor1");
+         else if (std::string(filter) == "alarmed")
+            model.SetShowAlarmedOnly(true);
+
+         size_t step = 0;
+         results.push_back(Measure("model.add_sample", {{"sensors", size}, {"filter", filter}}, options.batch, options.repetitions, [&] {
+            for (size_t count = 0; count < options.batch; ++count, ++step) {
+               const auto &sensor = sensors[step % sensors.size()];
+               // Every hundredth sample raises an alarm, so the alarmed-only
+               // view has rows coming and going.
+               const SensorAlarmState state = step % 100 == 0 ? SensorAlarmState::Failed : SensorAlarmState::Ok;
+               model.AddDataSample(sensor.path, MakeValue(sensor.type, step), sensor.thresholds, state,
+                   baseTime + std::chrono::milliseconds(step + 1));
+            }
+         }));
+      }
+   }
+}
+
+void RunNodeCases(const BenchmarkOptions &options, std::vector<CaseResult> &results)
+{
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(1));
+   for (size_t limit : {size_t{1024}, size_t{16384}}) {
+      Node node("bench");
+      node.SetHistoryLimit(limit);
+
+      // Fills the history first, so every timed sample also evicts one.
+      size_t step = 0;
+      for (; step < limit; ++step)
+         node.SetValue(DataValue(static_cast<double>(step % 100)), {}, SensorAlarmState::Ok, baseTime + std::chrono::milliseconds(step));
+
+      results.push_back(Measure("node.set_value", {{"history_limit", limit}}, options.batch, options.repetitions, [&] {
+         for (size_t count = 0; count < options.batch; ++count, ++step)
+            node.SetValue(DataValue(static_cast<double>(step % 100)), {}, SensorAlarmState::Ok, baseTime + std::chrono::milliseconds(step));
+      }));
+   }
+}
+
+void RunWriterCases(const BenchmarkOptions &options, std::vector<CaseResult> &results)
+{
+   const std::filesystem::path path = std::filesystem::temp_directory_path() / "sensor_tree_benchmark_writer.json";
+   const auto sensors               = MakeSensors(options.sizes.front());
+   {
+      SensorDataJsonWriter writer(path.string());
+      size_t step = 0;
+      results.push_back(Measure("writer.record_sample", {{"sensors", sensors.size()}}, options.batch, options.repetitions, [&] {
+         for (size_t count = 0; count < options.batch; ++count, ++step) {
+            const auto &sensor = sensors[step % sensors.size()];
+            writer.RecordSample(sensor.path, MakeValue(sensor.type, step), sensor.thresholds, SensorAlarmState::Ok);
+         }
+      }));
+   }
+   std::filesystem::remove(path);
+}
+
+void RunReaderCases(const BenchmarkOptions &options, std::vector<CaseResult> &results)
+{
+   const std::filesystem::path path = std::filesystem::temp_directory_path() / "sensor_tree_benchmark_reader.json";
+   for (size_t size : options.sizes) {
+      const auto sensors = MakeSensors(std::min<size_t>(size, 1000));
+      {
+         SensorDataJsonWriter writer(path.string());
+         for (size_t step = 0; step < size; ++step) {
+            const auto &sensor = sensors[step % sensors.size()];
+            writer.RecordSample(sensor.path, MakeValue(sensor.type, step), sensor.thresholds,
+                step % 50 == 0 ? SensorAlarmState::Warn : SensorAlarmState::Ok);
+         }
+      }
+
+      results.push_back(Measure("reader.load_file", {{"samples", size}}, size, options.repetitions, [&] {
+         SensorDataJsonReader::LoadResult loaded;
+         std::string errorMessage;
+         if (!SensorDataJsonReader::LoadFromFile(path.string(), loaded, errorMessage) || loaded.samples.size() != size)
+            std::fprintf(stderr, "Loading the generated recording failed: %s\n", errorMessage.c_str());
+      }));
+   }
+   std::filesystem::remove(path);
+}
+
+void RunFilterCases(const BenchmarkOptions &options, std::vector<CaseResult> &results)
+{
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(1));
+   for (size_t size : options.sizes) {
+      SensorTreeModel model;
+      model.SetLiveDataMode(false);
+      PopulateModel(model, MakeSensors(size), baseTime);
+
+      // Alternating between two texts re-evaluates every node each time.
+      bool toggle = false;
+      results.push_back(Measure("model.set_filter", {{"sensors", size}}, size, options.repetitions, [&] {
+         toggle = !toggle;
+         model.SetFilter(toggle ? "Sensor1" : "Sensor2");
+      }));
+   }
+}
+
+void RunWorkloadCases(const BenchmarkOptions &options, const std::vector<SyntheticWorkload> &workloads, std::vector<CaseResult> &results)
+{
+   for (const SyntheticWorkload &workload : workloads) {
+      // One stream, so the samples and their order replay exactly.
+      SyntheticLoadConfig config = workload.config;
+      config.threadCount         = 1;
+      SyntheticLoadGenerator generator(config);
+
+      SensorDataStore store;
+      std::vector<std::uint32_t> ids;
+      for (const auto &sensor : generator.GetSensors())
+         ids.push_back(store.RegisterSensor(sensor.path, sensor.thresholds));
+
+      // Batches are generated up front so only the store is timed.
+      SyntheticLoadGenerator::Stream stream(generator, ids, 0, config.seed);
+      std::vector<PackedSampleBatch> batches(options.repetitions + 1);
+      const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(1));
+      for (size_t index = 0; index < batches.size(); ++index)
+         stream.Fill(batches[index], options.batch, baseTime + std::chrono::milliseconds(index));
+
+      size_t next = 0;
+      const json parameters = {{"workload", workload.name}, {"profile", ToString(config.profile)}, {"seed", config.seed},
+          {"sensors", config.sensorCount}};
+      results.push_back(Measure("store.workload", parameters, options.batch, options.repetitions, [&] {
+         const PackedSampleBatch &batch = batches[next++];
+         store.AddPackedSamples(batch.GetRecords(), batch.Size(), batch.GetText());
+      }));
+   }
+}
+
+int RunBenchmarks(const BenchmarkOptions &options)
+{
+   std::vector<SyntheticWorkload> workloads;
+   if (!options.workloadFile.empty()) {
+      std::string errorMessage;
+      if (!LoadSyntheticWorkloads(options.workloadFile, workloads, errorMessage)) {
+         std::fprintf(stderr, "%s\n", errorMessage.c_str());
+         return 2;
+      }
+   } else {
+      for (WorkloadProfile profile : {WorkloadProfile::Uniform, WorkloadProfile::HotSensors, WorkloadProfile::AlarmStorm,
+               WorkloadProfile::TreeGrowth, WorkloadProfile::Categorical}) {
+         SyntheticWorkload workload{ToString(profile), MakeWorkloadConfig(profile)};
+         workload.config.sensorCount = *std::max_element(options.sizes.begin(), options.sizes.end());
+         workloads.push_back(std::move(workload));
+      }
+   }
+
+   std::vector<CaseResult> results;
+   if (IsCaseSelected(options, "model"))
+      RunModelCases(options, results);
+   if (IsCaseSelected(options, "node"))
+      RunNodeCases(options, results);
+   if (IsCaseSelected(options, "writer"))
+      RunWriterCases(options, results);
+   if (IsCaseSelected(options, "reader"))
+      RunReaderCases(options, results);
+   if (IsCaseSelected(options, "filter"))
+      RunFilterCases(options, results);
+   if (IsCaseSelected(options, "workload"))
+      RunWorkloadCases(options, workloads, results);
+
+   json report = {{"benchmark", "SensorTreeBenchmarks"}, {"repetitions", options.repetitions}, {"batch", options.batch},
+       {"results", json::array()}};
+   for (const CaseResult &result : results)
+      report["results"].push_back(DescribeResult(result));
+
+   if (options.outputFile.empty()) {
+      std::cout << report.dump(2) << std::endl;
+      return 0;
+   }
+
+   std::ofstream output(options.outputFile);
+   output << report.dump(2) << std::endl;
+   if (!output) {
+      std::fprintf(stderr, "Unable to write %s\n", options.outputFile.c_str());
+      return 1;
+   }
+   return 0;
+}
+
+} // namespace
+
+class DataPathBenchmarkApp : public wxApp
+{
+ public:
+   // Options are parsed in OnRun; skip wxApp's own command-line handling.
+   bool OnInit() override { return true; }
+   int OnRun() override;
+};
+
+wxIMPLEMENT_APP_CONSOLE(DataPathBenchmarkApp);
+
+int DataPathBenchmarkApp::OnRun()
+{
+   std::vector<std::string> args;
+   for (int idx = 1; idx < argc; ++idx)
+      args.push_back(argv[idx].ToStdString());
+
+   BenchmarkOptions options;
+   std::string errorMessage;
+   if (!ParseOptions(args, options, errorMessage)) {
+      std::fprintf(stderr, "%s\n", errorMessage.c_str());
+      return 2;
+   }
+
+   return RunBenchmarks(options);
+}
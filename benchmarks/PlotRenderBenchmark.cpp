@@ -0,0 +1,180 @@
+#include "PlotRenderer.h"
+#include "SensorTreeModel.h"
+
+#include <wx/app.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Offscreen plot rendering benchmark: renders synthetic plots for every
+// combination of series count, history depth and plot width and reports the
+// mean time per frame.
+//
+// Usage: SensorTreePlotBenchmark [--series=1,8,32] [--depth=1000,10000,100000]
+//                                [--width=640,1920] [--height=480] [--frames=20]
+
+namespace {
+
+struct BenchmarkOptions
+{
+   std::vector<size_t> seriesCounts = {1, 8, 32};
+   std::vector<size_t> depths       = {1000, 10000, 100000};
+   std::vector<size_t> widths       = {640, 1920};
+   int height                       = 480;
+   int frames                       = 20;
+};
+
+std::vector<size_t> ParseList(const std::string &text)
+{
+   std::vector<size_t> values;
+   std::istringstream stream(text);
+   std::string item;
+   while (std::getline(stream, item, ',')) {
+      if (!item.empty())
+         values.push_back(static_cast<size_t>(std::stoull(item)));
+   }
+   return values;
+}
+
+bool ParseOptions(const std::vector<std::string> &args, BenchmarkOptions &options, std::string &errorMessage)
+{
+   for (const std::string &arg : args) {
+      const size_t equals = arg.find('=');
+      if (arg.rfind("--", 0) != 0 || equals == std::string::npos) {
+         errorMessage = "Unrecognised argument: " + arg;
+         return false;
+      }
+
+      const std::string key   = arg.substr(2, equals - 2);
+      const std::string value = arg.substr(equals + 1);
+      try {
+         if (key == "series")
+            options.seriesCounts = ParseList(value);
+         else if (key == "depth")
+            options.depths = ParseList(value);
+         else if (key == "width")
+            options.widths = ParseList(value);
+         else if (key == "height")
+            options.height = std::stoi(value);
+         else if (key == "frames")
+            options.frames = std::stoi(value);
+         else {
+            errorMessage = "Unknown option: --" + key;
+            return false;
+         }
+      } catch (const std::exception &) {
+         errorMessage = "Invalid value for --" + key + ": " + value;
+         return false;
+      }
+   }
+
+   if (options.seriesCounts.empty() || options.depths.empty() || options.widths.empty() || options.height <= 0 || options.frames <= 0) {
+      errorMessage = "Series, depth, width, height and frames must all be non-empty and positive.";
+      return false;
+   }
+
+   return true;
+}
+
+// Populates the model with seriesCount offline sensors holding depth samples each.
+std::vector<PlotSeries> PopulateModel(SensorTreeModel &model, size_t seriesCount, size_t depth)
+{
+   static const wxColour kPalette[] = {
+       wxColour(57, 106, 177),
+       wxColour(218, 124, 48),
+       wxColour(62, 150, 81),
+       wxColour(204, 37, 41)};
+
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(1));
+
+   std::vector<PlotSeries> series;
+   series.reserve(seriesCount);
+   for (size_t seriesIdx = 0; seriesIdx < seriesCount; ++seriesIdx) {
+      const std::vector<std::string> path = {"bench", "sensor" + std::to_string(seriesIdx)};
+      model.AddDataSample(path, DataValue(0.0), {}, SensorAlarmState::Ok, baseTime);
+
+      Node *node = model.FindNodeByPath(path);
+      node->SetHistoryLimit(depth);
+      for (size_t sampleIdx = 1; sampleIdx < depth; ++sampleIdx) {
+         const double value = 100.0 * std::sin(0.01 * static_cast<double>(sampleIdx) + static_cast<double>(seriesIdx));
+         node->SetValue(DataValue(value), {}, SensorAlarmState::Ok, baseTime + std::chrono::milliseconds(10 * sampleIdx));
+      }
+
+      PlotSeries entry;
+      entry.pathSegments = path;
+      entry.displayPath  = node->GetFullPath();
+      entry.colour       = kPalette[seriesIdx % (sizeof(kPalette) / sizeof(kPalette[0]))];
+      entry.pen          = wxPen(entry.colour, 2);
+      entry.brush        = wxBrush(entry.colour);
+      series.push_back(std::move(entry));
+   }
+
+   return series;
+}
+
+int RunBenchmark(const BenchmarkOptions &options)
+{
+   std::printf("%8s %10s %8s %12s\n", "series", "depth", "width", "ms/frame");
+
+   for (size_t seriesCount : options.seriesCounts) {
+      for (size_t depth : options.depths) {
+         SensorTreeModel model;
+         model.SetLiveDataMode(false);
+         const std::vector<PlotSeries> series = PopulateModel(model, seriesCount, depth);
+
+         PlotRenderRequest request;
+         request.series               = &series;
+         request.model                = &model;
+         request.viewport.presetRange = TimeRange::All;
+
+         for (size_t width : options.widths) {
+            const wxSize size(static_cast<int>(width), options.height);
+
+            // Warm up caches and the graphics backend before timing.
+            PlotRenderer::RenderToImage(request, size);
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int frame = 0; frame < options.frames; ++frame)
+               PlotRenderer::RenderToImage(request, size);
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+            std::printf("%8zu %10zu %8zu %12.3f\n", seriesCount, depth, width, elapsed.count() / options.frames);
+            std::fflush(stdout);
+         }
+      }
+   }
+
+   return 0;
+}
+
+} // namespace
+
+class PlotRenderBenchmarkApp : public wxApp
+{
+ public:
+   // Options are parsed in OnRun; skip wxApp's own command-line handling.
+   bool OnInit() override { return true; }
+   int OnRun() override;
+};
+
+wxIMPLEMENT_APP(PlotRenderBenchmarkApp);
+
+int PlotRenderBenchmarkApp::OnRun()
+{
+   std::vector<std::string> args;
+   for (int idx = 1; idx < argc; ++idx)
+      args.push_back(argv[idx].ToStdString());
+
+   BenchmarkOptions options;
+   std::string errorMessage;
+   if (!ParseOptions(args, options, errorMessage)) {
+      std::fprintf(stderr, "%s\n", errorMessage.c_str());
+      return 2;
+   }
+
+   return RunBenchmark(options);
+}
@@ -0,0 +1,263 @@
+#include "SensorWireProtocol.h"
+
+#include <wx/app.h>
+#include <wx/socket.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams synthetic samples to a running SensorTreeApp over the SensorWire
+// protocol and reports the achieved send rate, for throughput tests of the
+// network ingest path.
+//
+// Usage: SensorLoopbackSender [--transport=tcp|udp] [--host=127.0.0.1]
+//                             [--port=5555] [--sensors=1000] [--rate=0]
+//                             [--seconds=10] [--batch=500]
+//
+// A rate of 0 sends as fast as the socket accepts data.
+
+namespace {
+
+// Keeps every UDP datagram comfortably below the 64 KiB limit.
+constexpr size_t MAX_DATAGRAM_DEFINITIONS = 256;
+constexpr size_t MAX_DATAGRAM_BATCH       = 2000;
+
+struct SenderOptions
+{
+   bool udp         = false;
+   std::string host = "127.0.0.1";
+   unsigned port    = SensorWire::DEFAULT_PORT;
+   size_t sensors   = 1000;
+   double rate      = 0.0;
+   double seconds   = 10.0;
+   size_t batch     = 500;
+};
+
+bool ParseOptions(const std::vector<std::string> &args, SenderOptions &options, std::string &errorMessage)
+{
+   for (const std::string &arg : args) {
+      const size_t equals = arg.find('=');
+      if (arg.rfind("--", 0) != 0 || equals == std::string::npos) {
+         errorMessage = "Unrecognised argument: " + arg;
+         return false;
+      }
+
+      const std::string key   = arg.substr(2, equals - 2);
+      const std::string value = arg.substr(equals + 1);
+      try {
+         if (key == "transport") {
+            if (value != "tcp" && value != "udp") {
+               errorMessage = "Transport must be tcp or udp.";
+               return false;
+            }
+            options.udp = value == "udp";
+         } else if (key == "host")
+            options.host = value;
+         else if (key == "port")
+            options.port = static_cast<unsigned>(std::stoul(value));
+         else if (key == "sensors")
+            options.sensors = static_cast<size_t>(std::stoull(value));
+         else if (key == "rate")
+            options.rate = std::stod(value);
+         else if (key == "seconds")
+            options.seconds = std::stod(value);
+         else if (key == "batch")
+            options.batch = static_cast<size_t>(std::stoull(value));
+         else {
+            errorMessage = "Unknown option: --" + key;
+            return false;
+         }
+      } catch (const std::exception &) {
+         errorMessage = "Invalid value for --" + key + ": " + value;
+         return false;
+      }
+   }
+
+   if (options.udp && options.batch > MAX_DATAGRAM_BATCH)
+      options.batch = MAX_DATAGRAM_BATCH;
+
+   if (options.sensors == 0 || options.batch == 0 || options.seconds <= 0.0 || options.rate < 0.0 || options.port > 65535) {
+      errorMessage = "Sensors, batch and seconds must be positive, rate non-negative and port below 65536.";
+      return false;
+   }
+
+   return true;
+}
+
+std::vector<std::string> SensorPath(size_t index)
+{
+   return {"Loopback", "Group" + std::to_string(index / 100), "Sensor" + std::to_string(index)};
+}
+
+class Transport
+{
+ public:
+   Transport(const SenderOptions &options) :
+       m_udp(options.udp),
+       m_stream(),
+       m_datagram(),
+       m_remote()
+   {
+      m_remote.Hostname(options.host);
+      m_remote.Service(static_cast<unsigned short>(options.port));
+   }
+
+   ~Transport()
+   {
+      if (m_stream)
+         m_stream->Destroy();
+      if (m_datagram)
+         m_datagram->Destroy();
+   }
+
+   bool Open()
+   {
+      if (m_udp) {
+         wxIPV4address local;
+         local.AnyAddress();
+         local.Service(0);
+         m_datagram = new wxDatagramSocket(local, wxSOCKET_BLOCK);
+         return m_datagram->IsOk();
+      }
+
+      m_stream = new wxSocketClient(wxSOCKET_BLOCK | wxSOCKET_WAITALL);
+      return m_stream->Connect(m_remote, true);
+   }
+
+   bool Send(const std::vector<std::uint8_t> &bytes)
+   {
+      if (bytes.empty())
+         return true;
+
+      wxSocketBase *socket = m_udp ? static_cast<wxSocketBase *>(m_datagram) : m_stream;
+      if (m_udp)
+         m_datagram->SendTo(m_remote, bytes.data(), static_cast<wxUint32>(bytes.size()));
+      else
+         m_stream->Write(bytes.data(), static_cast<wxUint32>(bytes.size()));
+      return !socket->Error() && socket->LastCount() == bytes.size();
+   }
+
+ private:
+   bool m_udp;
+   wxSocketClient *m_stream;
+   wxDatagramSocket *m_datagram;
+   wxIPV4address m_remote;
+};
+
+// Path ids are per connection; UDP has none, so the definitions are repeated
+// periodically for receivers that started late or dropped a datagram.
+bool SendDefinitions(Transport &transport, const SenderOptions &options)
+{
+   SensorWireEncoder encoder;
+   SensorThresholds thresholds;
+   thresholds.upperNonCritical = DataValue(90.0);
+   thresholds.upperCritical    = DataValue(95.0);
+
+   for (size_t index = 0; index < options.sensors; ++index) {
+      encoder.DefinePath(static_cast<std::uint32_t>(index), SensorPath(index), thresholds);
+      if (options.udp && (index + 1) % MAX_DATAGRAM_DEFINITIONS == 0 && !transport.Send(encoder.TakeBuffer()))
+         return false;
+   }
+   return transport.Send(encoder.TakeBuffer());
+}
+
+int RunSender(const SenderOptions &options)
+{
+   Transport transport(options);
+   if (!transport.Open()) {
+      std::fprintf(stderr, "Cannot reach %s:%u over %s.\n", options.host.c_str(), options.port, options.udp ? "udp" : "tcp");
+      return 1;
+   }
+   if (!SendDefinitions(transport, options)) {
+      std::fprintf(stderr, "Sending path definitions failed.\n");
+      return 1;
+   }
+
+   using Clock = std::chrono::steady_clock;
+
+   const auto start        = Clock::now();
+   const auto deadline     = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.seconds));
+   auto lastDefinitions    = start;
+   auto lastReport         = start;
+   size_t sent             = 0;
+   size_t sentAtLastReport = 0;
+   std::uint64_t bytes     = 0;
+   size_t nextSensor       = 0;
+
+   SensorWireEncoder encoder;
+   while (Clock::now() < deadline) {
+      if (options.rate > 0.0) {
+         // Pace against the schedule rather than sleeping a fixed amount, so
+         // slow sends do not accumulate into a lower rate.
+         const auto due = start + std::chrono::duration_cast<Clock::duration>(
+                                      std::chrono::duration<double>(static_cast<double>(sent) / options.rate));
+         if (due > Clock::now())
+            std::this_thread::sleep_until(due);
+      }
+
+      for (size_t i = 0; i < options.batch; ++i) {
+         const double phase = 0.001 * static_cast<double>(sent + i) + static_cast<double>(nextSensor);
+         encoder.AppendSample(static_cast<std::uint32_t>(nextSensor), DataValue(50.0 + 45.0 * std::sin(phase)));
+         nextSensor = (nextSensor + 1) % options.sensors;
+      }
+
+      const std::vector<std::uint8_t> buffer = encoder.TakeBuffer();
+      if (!transport.Send(buffer)) {
+         std::fprintf(stderr, "Send failed after %zu samples.\n", sent);
+         return 1;
+      }
+      sent += options.batch;
+      bytes += buffer.size();
+
+      const auto now = Clock::now();
+      if (options.udp && now - lastDefinitions >= std::chrono::seconds(1)) {
+         SendDefinitions(transport, options);
+         lastDefinitions = now;
+      }
+      if (now - lastReport >= std::chrono::seconds(1)) {
+         const std::chrono::duration<double> interval = now - lastReport;
+         std::printf("%10.0f samples/s\n", static_cast<double>(sent - sentAtLastReport) / interval.count());
+         std::fflush(stdout);
+         lastReport       = now;
+         sentAtLastReport = sent;
+      }
+   }
+
+   const std::chrono::duration<double> elapsed = Clock::now() - start;
+   std::printf("sent %zu samples in %.2f s: %.0f samples/s, %.1f bytes/sample\n",
+       sent, elapsed.count(), static_cast<double>(sent) / elapsed.count(),
+       sent ? static_cast<double>(bytes) / static_cast<double>(sent) : 0.0);
+   return 0;
+}
+
+} // namespace
+
+class SensorLoopbackSenderApp : public wxAppConsole
+{
+ public:
+   // Options are parsed in OnRun; skip wxApp's own command-line handling.
+   bool OnInit() override { return wxSocketBase::Initialize(); }
+   int OnRun() override;
+};
+
+wxIMPLEMENT_APP_CONSOLE(SensorLoopbackSenderApp);
+
+int SensorLoopbackSenderApp::OnRun()
+{
+   std::vector<std::string> args;
+   for (int idx = 1; idx < argc; ++idx)
+      args.push_back(argv[idx].ToStdString());
+
+   SenderOptions options;
+   std::string errorMessage;
+   if (!ParseOptions(args, options, errorMessage)) {
+      std::fprintf(stderr, "%s\n", errorMessage.c_str());
+      return 2;
+   }
+
+   return RunSender(options);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "SensorData.h"
+
+#include <chrono>
+#include <cstddef>
+
+// Plain threshold classification. A positive margin moves every threshold
+// towards the normal range, so the value must sit that far inside a limit to
+// be classified below it.
+SensorAlarmState ClassifyNumericAlarm(double numeric, const SensorThresholds &thresholds, double margin = 0.0);
+
+// Tuning shared by every sensor's evaluator.
+struct AlarmPolicy
+{
+   bool enabled = true;
+   // Clearing or downgrading an alarm requires moving back inside the limit
+   // by this fraction of the sensor's threshold span.
+   double hysteresisFraction = 0.02;
+   // A new state must persist this long before it is committed.
+   std::chrono::milliseconds minimumDwell{1000};
+   // Token bucket bounding how often one sensor may change state.
+   size_t transitionBurst = 4;
+   std::chrono::seconds transitionRefill{15};
+};
+
+// Per-sensor alarm state machine between the producer and the tree. Numeric
+// samples with thresholds are classified in-app; everything else uses the
+// producer's reported state. Either way a candidate state must survive the
+// dwell time and find a transition token before it replaces the current one,
+// so flapping sensors settle instead of repainting and re-filtering the tree
+// on every sample.
+class AlarmEvaluator
+{
+ public:
+   using TimePoint = std::chrono::steady_clock::time_point;
+
+   AlarmEvaluator();
+
+   SensorAlarmState Evaluate(const DataValue &value,
+       const SensorThresholds &thresholds,
+       SensorAlarmState reported,
+       TimePoint timestamp,
+       const AlarmPolicy &policy);
+
+   // Commits a pending state whose dwell time has passed by `now`, for
+   // sensors that go quiet before a later sample could commit it. Returns
+   // whether the state changed.
+   bool CommitPending(TimePoint now, const AlarmPolicy &policy);
+   // When CommitPending() could next succeed: once the pending state has
+   // dwelt long enough and a transition token has refilled. False when
+   // nothing is pending or the policy allows no transitions.
+   bool GetPendingDeadline(const AlarmPolicy &policy, TimePoint &deadline) const;
+   bool HasPending() const { return m_hasPending; }
+
+   SensorAlarmState GetState() const { return m_state; }
+   size_t GetTransitionCount() const { return m_transitionCount; }
+   // Candidate changes that reverted before they could be committed.
+   size_t GetSuppressedCount() const { return m_suppressedCount; }
+
+ private:
+   static double HysteresisMargin(const SensorThresholds &thresholds, const AlarmPolicy &policy);
+   void RefillTokens(TimePoint timestamp, const AlarmPolicy &policy);
+   bool TryCommit(TimePoint timestamp, const AlarmPolicy &policy);
+
+   bool m_initialized;
+   SensorAlarmState m_state;
+   bool m_hasPending;
+   SensorAlarmState m_pending;
+   TimePoint m_pendingSince;
+   double m_tokens;
+   TimePoint m_lastRefill;
+   size_t m_transitionCount;
+   size_t m_suppressedCount;
+};
@@ -0,0 +1,104 @@
+#pragma once
+#include "SensorData.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class AlarmEventKind : std::uint8_t
+{
+   StateChanged,
+   WentStale,
+   Recovered
+};
+
+// Append-only history of alarm transitions. Entries are never modified, so
+// indices handed out stay valid. Two indexes avoid scanning the log:
+// fixed-size blocks carry their time span for range queries, and each sensor
+// keeps the positions of its own entries in time order. Sensor paths are kept
+// sorted so a subtree prefix resolves to its sensors with one range lookup.
+class AlarmJournal
+{
+ public:
+   using TimePoint = std::chrono::steady_clock::time_point;
+
+   static constexpr size_t BLOCK_SIZE     = 1024;
+   static constexpr std::uint32_t NO_TEXT = UINT32_MAX;
+
+   struct Entry
+   {
+      TimePoint timestamp;
+      // Numeric sample value; non-numeric values are stored as text.
+      double value;
+      std::uint32_t textId;
+      std::uint32_t sensorId;
+      AlarmEventKind kind;
+      SensorAlarmState previous;
+      SensorAlarmState state;
+   };
+
+   struct Query
+   {
+      // Path segments of the subtree to search; empty matches every sensor.
+      std::vector<std::string> pathPrefix;
+      std::optional<TimePoint> from;
+      std::optional<TimePoint> to;
+      // Restricts state changes to those entering this state.
+      std::optional<SensorAlarmState> state;
+      // Restricts results to one kind of event.
+      std::optional<AlarmEventKind> kind;
+      // Newest matches are kept when the limit is reached.
+      size_t limit = SIZE_MAX;
+   };
+
+   AlarmJournal();
+
+   size_t Append(const std::vector<std::string> &path,
+       AlarmEventKind kind,
+       SensorAlarmState previous,
+       SensorAlarmState state,
+       const DataValue &value,
+       TimePoint timestamp);
+   void Clear();
+
+   size_t Size() const { return m_entries.size(); }
+   bool Empty() const { return m_entries.empty(); }
+   const Entry &GetEntry(size_t index) const { return m_entries[index]; }
+   const std::string &GetSensorPath(std::uint32_t sensorId) const { return m_sensorPaths[sensorId]; }
+   std::string GetValueText(const Entry &entry) const;
+   size_t GetSensorCount() const { return m_sensorPaths.size(); }
+
+   // Indices of matching entries, oldest first.
+   std::vector<size_t> Run(const Query &query) const;
+
+ private:
+   struct Block
+   {
+      TimePoint minTime;
+      TimePoint maxTime;
+   };
+
+   std::uint32_t InternSensor(const std::string &path);
+   std::uint32_t InternText(const std::string &text);
+   bool Matches(const Entry &entry, const Query &query) const;
+   std::vector<std::uint32_t> ResolveSensors(const std::vector<std::string> &pathPrefix) const;
+   std::vector<size_t> RunBySensor(const std::vector<std::uint32_t> &sensors, const Query &query) const;
+   std::vector<size_t> RunByTime(const Query &query) const;
+
+   std::deque<Entry> m_entries;
+   std::vector<Block> m_blocks;
+   // Running maximum of block end times; non-decreasing even when samples
+   // arrive out of order, so the first block of a range is a binary search.
+   std::vector<TimePoint> m_blockMaxPrefix;
+   std::vector<std::string> m_sensorPaths;
+   std::map<std::string, std::uint32_t> m_sensorsByPath;
+   std::vector<std::vector<size_t>> m_entriesBySensor;
+   std::vector<std::string> m_texts;
+   std::unordered_map<std::string, std::uint32_t> m_textIds;
+};
@@ -0,0 +1,72 @@
+#pragma once
+#include "AlarmJournal.h"
+
+#include <wx/listctrl.h>
+#include <wx/wx.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+class SensorTreeModel;
+
+// Lists journal entries newest first. The list is virtual, so only the rows
+// on screen are ever formatted; without a filter rows map straight onto
+// journal positions and no query runs at all.
+class AlarmJournalPanel : public wxPanel
+{
+ public:
+   AlarmJournalPanel(wxWindow *parent, const AlarmJournal &journal, const SensorTreeModel *model);
+
+   // Picks up entries appended since the last call; cheap when nothing changed.
+   void SyncWithJournal();
+   // Drops cached results after the journal was cleared.
+   void Reset();
+
+   static constexpr size_t MAX_QUERY_RESULTS = 100000;
+   static constexpr std::chrono::seconds WINDOW_REFRESH_INTERVAL{1};
+
+ private:
+   class EventList : public wxListCtrl
+   {
+    public:
+      explicit EventList(AlarmJournalPanel *owner);
+
+    protected:
+      wxString OnGetItemText(long item, long column) const override;
+
+    private:
+      AlarmJournalPanel *m_owner;
+   };
+
+   enum Column : long
+   {
+      COL_AGE,
+      COL_SENSOR,
+      COL_TRANSITION,
+      COL_VALUE
+   };
+
+   bool HasFilter() const;
+   AlarmJournal::Query BuildQuery() const;
+   void RunQuery();
+   void UpdateRowCount();
+   size_t GetRowCount() const;
+   size_t EntryForRow(long row) const;
+   wxString FormatCell(long row, long column) const;
+   void OnFilterChanged(wxCommandEvent &event);
+
+   const AlarmJournal &m_journal;
+   const SensorTreeModel *m_model;
+   EventList *m_list;
+   wxTextCtrl *m_prefixCtrl;
+   wxChoice *m_eventChoice;
+   wxChoice *m_rangeChoice;
+   wxStaticText *m_countLabel;
+   // Set when the filter controls were last applied; typing alone does not
+   // change the list until Enter is pressed.
+   bool m_filtered;
+   std::vector<size_t> m_results;
+   size_t m_syncedSize;
+   std::chrono::steady_clock::time_point m_referenceTime;
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include "SensorData.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Arithmetic over other sensors, compiled once into stack bytecode. Sensor
+// paths are written in braces so '/' stays available for division:
+//
+//    {Rack1/PSU/Voltage} * {Rack1/PSU/Current}
+//    abs({Fan/A/Speed} - {Fan/B/Speed})
+//
+// Supports + - * /, unary minus, parentheses, numeric literals and the
+// functions abs, sqrt, min and max. Constant subexpressions are folded.
+class DerivedExpression
+{
+ public:
+   static constexpr size_t MAX_STACK_DEPTH = 64;
+
+   DerivedExpression();
+
+   static bool Compile(const std::string &text, DerivedExpression &expression, std::string &errorMessage);
+
+   const std::string &GetText() const { return m_text; }
+   // Distinct input paths in slot order; Evaluate reads one value per slot.
+   const std::vector<std::vector<std::string>> &GetInputs() const { return m_inputs; }
+   size_t GetInstructionCount() const { return m_code.size(); }
+
+   double Evaluate(const double *inputs) const;
+
+ private:
+   enum class OpCode : std::uint8_t
+   {
+      PushConstant,
+      PushInput,
+      Add,
+      Subtract,
+      Multiply,
+      Divide,
+      Negate,
+      Abs,
+      Sqrt,
+      Min,
+      Max
+   };
+
+   struct Instruction
+   {
+      OpCode op;
+      std::uint32_t input;
+      double constant;
+   };
+
+   class Parser;
+
+   static double Apply(OpCode op, double a, double b);
+
+   std::string m_text;
+   std::vector<Instruction> m_code;
+   std::vector<std::vector<std::string>> m_inputs;
+};
+
+// The set of virtual sensors a tree evaluates. Each definition keeps the
+// newest numeric value of each of its inputs, so a sample re-evaluates only
+// the definitions that read its path, and each of those costs one bytecode
+// run.
+class DerivedSensorSet
+{
+ public:
+   struct Definition
+   {
+      std::vector<std::string> outputPath;
+      DerivedExpression expression;
+      SensorThresholds thresholds;
+   };
+
+   struct Output
+   {
+      size_t definition;
+      double value;
+   };
+
+   DerivedSensorSet();
+
+   // Fails on syntax errors, a duplicate output path, or a definition that
+   // would feed its own inputs.
+   bool Add(const std::vector<std::string> &outputPath,
+       const std::string &expressionText,
+       SensorThresholds thresholds,
+       std::string &errorMessage);
+
+   bool Empty() const { return m_definitions.empty(); }
+   size_t Size() const { return m_definitions.size(); }
+   const Definition &GetDefinition(size_t index) const { return m_definitions[index]; }
+
+   // Records a sample for every definition reading this path and appends the
+   // definitions that now have all inputs and a finite result.
+   void OnInput(const std::vector<std::string> &path, const DataValue &value, std::vector<Output> &outputs);
+   // Forgets input values, e.g. after the tree was cleared.
+   void ResetInputs();
+
+ private:
+   struct Binding
+   {
+      size_t definition;
+      size_t slot;
+   };
+
+   struct InputState
+   {
+      std::vector<double> values;
+      std::vector<bool> present;
+      size_t missing = 0;
+   };
+
+   static std::string JoinKey(const std::vector<std::string> &path);
+   bool FeedsAny(const std::string &outputKey, const std::vector<std::string> &inputKeys) const;
+
+   std::vector<Definition> m_definitions;
+   std::vector<std::string> m_outputKeys;
+   std::vector<InputState> m_inputStates;
+   std::unordered_map<std::string, std::vector<Binding>> m_bindingsByInput;
+   std::string m_keyBuffer;
+};
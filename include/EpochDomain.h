@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Epoch-based reclamation for data that writers publish to lock-free readers.
+// A reader pins the current epoch while it dereferences anything published;
+// a writer that unpublishes an object retires it at the epoch returned by
+// Advance() and frees it once IsReclaimable() says every reader that could
+// still see it has unpinned. Pins nest and belong to the thread that took
+// them; a thread must not block on a writer while pinned.
+class EpochDomain
+{
+ public:
+   // Pins the calling thread for the guard's lifetime.
+   class Guard
+   {
+    public:
+      Guard();
+      ~Guard();
+
+      Guard(Guard &&other) noexcept;
+      Guard(const Guard &)            = delete;
+      Guard &operator=(const Guard &) = delete;
+      Guard &operator=(Guard &&)      = delete;
+
+    private:
+      bool m_pinned;
+   };
+
+   // Threads pinned at the same time beyond this wait for a free slot.
+   static constexpr size_t MAX_PINNED_THREADS = 64;
+
+   // Closes the current epoch and returns it. Anything unpublished before the
+   // call may be freed once that epoch is reclaimable.
+   static std::uint64_t Advance();
+   // Whether no thread has been pinned since `epoch` or earlier.
+   static bool IsReclaimable(std::uint64_t epoch);
+   // Waits until IsReclaimable(epoch), ignoring the calling thread's own pin.
+   static void WaitUntilReclaimable(std::uint64_t epoch);
+};
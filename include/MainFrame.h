@@ -1,24 +1,26 @@
 #pragma once
 #include "PlotManager.h"
 #include "SensorTreeModel.h"
+#include "SourceManager.h"
 
 #include "SensorDataJsonWriter.h"
+#include "SensorModelThread.h"
 
 #include <wx/dataview.h>
 #include <wx/event.h>
+#include <wx/splitter.h>
 #include <wx/timer.h>
 #include <wx/wx.h>
 
 #include <atomic>
 #include <chrono>
-#include <deque>
 #include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
-class SensorDataGenerator;
-class SensorDataEvent;
+class AlarmJournalPanel;
 class SensorDataTestGenerator;
 
 enum
@@ -30,24 +32,36 @@ enum
    ID_ExpandAll,
    ID_CollapseAll,
    ID_ToggleDataGen,
+   ID_ConfigureDataGen,
+   ID_LoadDataGenWorkload,
 
    // Connection
-   ID_ConnectYes,
-   ID_ConnectNo,
-   ID_NewMessage,
 
    // Context menu entries
    ID_ExpandAllHere,
    ID_CollapseChildrenHere,
    ID_SendToNewPlot,
+   // One entry per AggregateKind, in enum order
+   ID_AggregateNone,
+   ID_AggregateSum,
+   ID_AggregateMean,
+   ID_AggregateMin,
+   ID_AggregateMax,
 
    // Controls
    ID_RotateLog,
    ID_ClearTree,
+   ID_PlotFrameRate,
+   ID_ShowStatistics,
+   ID_AlarmPolicy,
+   ID_ShowAlarmJournal,
+   ID_AddDerivedSensor,
 
    ID_SavePlotConfig,
    ID_LoadPlotConfig,
    ID_OpenSensorData,
+   ID_ReplaySensorData,
+   ID_ExportPlotsPng,
 
    // Command helpers
    ID_FocusFilter
@@ -59,42 +73,46 @@ class MainFrame : public wxFrame
    MainFrame();
 
  private:
-   struct PendingSample
-   {
-      std::vector<std::string> path;
-      DataValue value;
-      SensorThresholds thresholds;
-      SensorAlarmState alarmState                     = SensorAlarmState::Ok;
-      std::chrono::steady_clock::time_point timestamp = std::chrono::steady_clock::now();
-   };
-
    void OnExit(wxCommandEvent &event);
    void OnAbout(wxCommandEvent &event);
    void OnToggleDataGenerator(wxCommandEvent &event);
+   void OnConfigureDataGenerator(wxCommandEvent &event);
+   void OnLoadDataGeneratorWorkload(wxCommandEvent &event);
    void OnFilterTextChanged(wxCommandEvent &event);
    void OnShowAlarmedOnly(wxCommandEvent &event);
 
    void CreateMenuBar();
    void SetupStatusBar();
    void CreateSensorTreeView();
-   void UpdateNetworkIndicator(const wxColour &colour, const wxString &tooltip);
+   void UpdateSourceIndicators();
 
    // UI components
+   wxSplitterWindow *m_splitter;
    wxDataViewCtrl *m_treeCtrl;
+   // Docked below the tree when shown from the View menu
+   AlarmJournalPanel *m_journalPanel;
    wxTextCtrl *m_filterCtrl;
-   wxPanel *m_networkIndicator;
+   // One coloured square per running source, in start order
+   wxBoxSizer *m_sourceIndicatorSizer;
+   std::vector<wxPanel *> m_sourceIndicators;
    wxCheckBox *m_showAlarmedOnlyCheck;
    wxButton *m_rotateLogButton;
    wxButton *m_clearTreeButton;
+   // Running-statistics columns, hidden until enabled from the View menu
+   std::vector<wxDataViewColumn *> m_statisticsColumns;
    SensorTreeModel *m_treeModel;
+   AlarmJournal m_alarmJournal;
    wxTimer m_ageTimer;
    std::atomic<bool> m_generationActive;
-   SensorDataGenerator *m_dataThread;
-   SensorDataTestGenerator *m_testDataThread;
-   uint64_t m_messagesReceived;
-   std::unique_ptr<SensorDataJsonWriter> m_dataRecorder;
+   SourceManager m_sourceManager;
+   // Owned by m_sourceManager; kept for its configuration and prompt stop.
+   SensorDataTestGenerator *m_testGenerator;
+   // Applies drained samples to the tree's store; started after the sources.
+   std::unique_ptr<SensorModelThread> m_modelThread;
+   // Drained-sample count at the last reset of the message counter
+   uint64_t m_messageCountBaseline;
    std::string m_currentLogFile;
-   bool m_isNetworkConnected;
+   size_t m_connectedSources;
    // Track the item for which a context menu is opened
    wxDataViewItem m_contextItem;
 
@@ -102,17 +120,13 @@ class MainFrame : public wxFrame
    void BindEvents();
    void OnClose(wxCloseEvent &event);
    void OnAgeTimer(wxTimerEvent &event);
-   void ApplySample(const PendingSample &sample, bool recordSample);
-   void DrainPendingSamples();
    void RefreshVisibleTreeState();
-   void OnSensorData(wxCommandEvent &event);
-   void OnConnectionStatus(wxThreadEvent &event);
-   void OnNewMessage(wxThreadEvent &event);
    void OnExpandAll(wxCommandEvent &event);
    void OnItemActivated(wxDataViewEvent &event);
    void OnItemContextMenu(wxDataViewEvent &event);
    void OnExpandAllHere(wxCommandEvent &event);
    void OnCollapseChildrenHere(wxCommandEvent &event);
+   void OnSetAggregate(wxCommandEvent &event);
    void OnSendToNewPlot(wxCommandEvent &event);
    void OnSendToExistingPlot(wxCommandEvent &event);
    void OnCollapseAll(wxCommandEvent &event);
@@ -120,9 +134,16 @@ class MainFrame : public wxFrame
    void OnItemCollapsed(wxDataViewEvent &event);
    void OnRotateLog(wxCommandEvent &event);
    void OnClearTree(wxCommandEvent &event);
+   void OnPlotFrameRate(wxCommandEvent &event);
+   void OnShowStatistics(wxCommandEvent &event);
+   void OnAlarmPolicy(wxCommandEvent &event);
+   void OnShowAlarmJournal(wxCommandEvent &event);
+   void OnAddDerivedSensor(wxCommandEvent &event);
    void OnSavePlotConfig(wxCommandEvent &event);
    void OnLoadPlotConfig(wxCommandEvent &event);
    void OnOpenSensorData(wxCommandEvent &event);
+   void OnReplaySensorData(wxCommandEvent &event);
+   void OnExportPlotsPng(wxCommandEvent &event);
    void OnFocusFilter(wxCommandEvent &event);
    void OnFilterEnter(wxCommandEvent &event);
    void StartDataTestGeneration();
@@ -130,6 +151,7 @@ class MainFrame : public wxFrame
    void RestoreExpansionState();
    void PruneExpansionSubtree(Node *node, bool includeRoot);
    void PopulatePlotMenu(wxMenu &menu);
+   void PopulateAggregateMenu(wxMenu &menu);
    void ClearDynamicPlotMenuItems();
    std::vector<Node *> CollectPlotEligibleNodes(wxString &messageOut) const;
    void RotateLogFile(const wxString &reason = wxString());
@@ -139,5 +161,4 @@ class MainFrame : public wxFrame
    std::unordered_set<std::string> m_expandedNodes;
    std::unique_ptr<PlotManager> m_plotManager;
    std::unordered_map<int, wxString> m_plotMenuIdToName;
-   std::deque<PendingSample> m_pendingSamples;
 };
\ No newline at end of file
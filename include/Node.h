@@ -1,8 +1,11 @@
 #pragma once
+#include "AlarmEvaluator.h"
+#include "SampleHistory.h"
 #include "SensorData.h"
+#include "SensorStatistics.h"
+#include "SubtreeAggregate.h"
 
 #include <chrono>
-#include <deque>
 #include <memory>
 #include <optional>
 #include <string>
@@ -42,8 +45,32 @@ class Node
        SensorThresholds thresholds,
        SensorAlarmState alarmState,
        std::chrono::steady_clock::time_point timestamp);
+   // SetValue for a sensor whose thresholds are already set; the value is
+   // moved straight into the history.
+   void AppendSample(DataValue &&value, SensorAlarmState alarmState, std::chrono::steady_clock::time_point timestamp);
+   // Changes the alarm state without a new sample, for transitions the
+   // evaluator commits once a quiet sensor's dwell time has passed.
+   void SetAlarmState(SensorAlarmState alarmState);
    double GetSecondsSinceUpdate() const;
    double GetSecondsSinceUpdate(std::chrono::steady_clock::time_point referenceTime) const;
+   std::chrono::steady_clock::time_point GetLastUpdateTime() const { return m_lastUpdate; }
+
+   // Staleness is decided by the tree model; any new sample clears it.
+   bool IsStale() const { return m_stale; }
+   void SetStale(bool stale);
+   // Whether the model holds a pending staleness deadline for this node.
+   bool IsStalenessArmed() const { return m_stalenessArmed; }
+   void SetStalenessArmed(bool armed) { m_stalenessArmed = armed; }
+   // Whether the model holds a deadline for the evaluator's pending state.
+   bool IsAlarmDwellArmed() const { return m_alarmDwellArmed; }
+   void SetAlarmDwellArmed(bool armed) { m_alarmDwellArmed = armed; }
+   // Whether the store already lists this node in its pending change set.
+   bool IsChangePending() const { return m_changePending; }
+   void SetChangePending(bool pending) { m_changePending = pending; }
+   // Whether the tree view has been told this row exists. Only the UI thread
+   // reads or writes it.
+   bool IsShownInView() const { return m_shownInView; }
+   void SetShownInView(bool shown) { m_shownInView = shown; }
 
    // Tree utilities
    std::vector<std::string> GetPath() const;
@@ -56,18 +83,30 @@ class Node
    std::vector<Node *> GetAllDescendants() const;
    std::vector<Node *> GetLeafNodes() const;
 
-   struct TimedSample
-   {
-      std::chrono::steady_clock::time_point timestamp;
-      DataValue value;
-      SensorAlarmState alarmState;
-   };
+   using TimedSample = ::TimedSample;
+   using HistoryView = SampleHistory::View;
 
-   const std::deque<TimedSample> &GetHistory() const { return m_history; }
-   bool HasHistory() const { return !m_history.empty(); }
-   size_t GetHistoryLimit() const { return m_historyLimit; }
+   // Unlike the rest of the node, the history may be read without the
+   // store's lock: a view is a consistent snapshot of the samples, their
+   // columns and the newest value, even while samples keep arriving.
+   HistoryView GetHistory() const { return m_history.Snapshot(); }
+   bool HasHistory() const { return !m_history.Empty(); }
+   size_t GetHistoryLimit() const { return m_history.GetLimit(); }
+   void SetHistoryLimit(size_t limit);
    void ClearHistory();
    size_t GetUpdateCount() const { return m_updateCount; }
+   // Running statistics maintained by SetValue, independent of the history limit.
+   const SensorStatistics &GetStatistics() const { return m_statistics; }
+   // Debounced alarm state machine the tree model feeds before SetValue.
+   AlarmEvaluator &GetAlarmEvaluator() { return m_alarmEvaluator; }
+   const AlarmEvaluator &GetAlarmEvaluator() const { return m_alarmEvaluator; }
+
+   // Totals over this node and its descendants, updated along the ancestor
+   // chain whenever a value, alarm state or staleness changes.
+   const SubtreeAggregate &GetAggregate() const { return m_aggregate; }
+   // Which aggregate the tree shows for this node.
+   AggregateKind GetAggregateKind() const { return m_aggregateKind; }
+   void SetAggregateKind(AggregateKind kind) { m_aggregateKind = kind; }
 
  private:
    std::string m_name;
@@ -79,9 +118,24 @@ class Node
    SensorThresholds m_thresholds;
    SensorAlarmState m_alarmState;
    std::chrono::steady_clock::time_point m_lastUpdate;
-   std::deque<TimedSample> m_history;
-   size_t m_historyLimit;
+   SampleHistory m_history;
    size_t m_updateCount;
+   SensorStatistics m_statistics;
+   AlarmEvaluator m_alarmEvaluator;
+   bool m_stale;
+   bool m_stalenessArmed;
+   bool m_alarmDwellArmed;
+   bool m_changePending;
+   bool m_shownInView;
+   SubtreeAggregate m_aggregate;
+   AggregateKind m_aggregateKind;
+
+   AggregateContribution GetContribution() const;
+   // Replaces this node's own contribution in its aggregate and every
+   // ancestor's. Extremes are only rescanned where the old value was the
+   // extreme and the new one does not reach it.
+   void PropagateContribution(const AggregateContribution &before, const AggregateContribution &after);
+   void RescanExtremes();
 
    void GetAllDescendantsRecursive(std::vector<Node *> &nodes) const;
    void GetLeafNodesRecursive(std::vector<Node *> &leaves) const;
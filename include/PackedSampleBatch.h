@@ -0,0 +1,125 @@
+#pragma once
+#include "SensorData.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One sample in a packed batch: 24 bytes, no heap storage. The sensor id comes
+// from SensorDataStore::RegisterSensor, the timestamp is a steady_clock tick
+// count, and the payload holds the raw bits of an integer, double or boolean,
+// or the offset and length of a string in the batch's text arena.
+struct PackedSampleRecord
+{
+   std::uint32_t sensorId;
+   std::uint8_t type;
+   std::uint8_t alarmState;
+   std::uint16_t reserved;
+   std::int64_t timestampTicks;
+   std::uint64_t payload;
+
+   DataValue::e_Type GetType() const { return static_cast<DataValue::e_Type>(type); }
+   SensorAlarmState GetAlarmState() const { return static_cast<SensorAlarmState>(alarmState); }
+   std::chrono::steady_clock::time_point GetTimestamp() const
+   {
+      return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(timestampTicks));
+   }
+
+   std::int64_t GetInteger() const { return static_cast<std::int64_t>(payload); }
+   bool GetBoolean() const { return payload != 0; }
+   double GetDouble() const
+   {
+      double value = 0.0;
+      std::memcpy(&value, &payload, sizeof(value));
+      return value;
+   }
+   std::string_view GetString(std::string_view text) const
+   {
+      return text.substr(static_cast<size_t>(payload >> 32), static_cast<size_t>(payload & 0xffffffffu));
+   }
+};
+
+static_assert(sizeof(PackedSampleRecord) == 24, "Packed records are meant to stay at 24 bytes");
+
+// The record's value; empty for an unknown type or a string outside the text.
+inline std::optional<DataValue> DecodePackedValue(const PackedSampleRecord &record, std::string_view text)
+{
+   switch (record.GetType()) {
+      case DataValue::INTEGER:
+         return DataValue(record.GetInteger());
+      case DataValue::DOUBLE:
+         return DataValue(record.GetDouble());
+      case DataValue::BOOLEAN:
+         return DataValue(record.GetBoolean());
+      case DataValue::STRING:
+         break;
+      default:
+         return std::nullopt;
+   }
+
+   const size_t offset = static_cast<size_t>(record.payload >> 32);
+   const size_t length = static_cast<size_t>(record.payload & 0xffffffffu);
+   if (offset > text.size() || length > text.size() - offset)
+      return std::nullopt;
+   return DataValue(std::string(record.GetString(text)));
+}
+
+// Producer-side builder for SensorDataStore::AddPackedSamples. Clear() keeps
+// the capacity, so a decoder reusing one batch allocates nothing once warm.
+class PackedSampleBatch
+{
+ public:
+   void AppendInteger(std::uint32_t sensorId, std::chrono::steady_clock::time_point timestamp, std::int64_t value,
+       SensorAlarmState alarmState = SensorAlarmState::Ok)
+   {
+      Append(sensorId, DataValue::INTEGER, timestamp, static_cast<std::uint64_t>(value), alarmState);
+   }
+
+   void AppendDouble(std::uint32_t sensorId, std::chrono::steady_clock::time_point timestamp, double value,
+       SensorAlarmState alarmState = SensorAlarmState::Ok)
+   {
+      std::uint64_t bits = 0;
+      std::memcpy(&bits, &value, sizeof(bits));
+      Append(sensorId, DataValue::DOUBLE, timestamp, bits, alarmState);
+   }
+
+   void AppendBoolean(std::uint32_t sensorId, std::chrono::steady_clock::time_point timestamp, bool value,
+       SensorAlarmState alarmState = SensorAlarmState::Ok)
+   {
+      Append(sensorId, DataValue::BOOLEAN, timestamp, value ? 1 : 0, alarmState);
+   }
+
+   void AppendString(std::uint32_t sensorId, std::chrono::steady_clock::time_point timestamp, std::string_view value,
+       SensorAlarmState alarmState = SensorAlarmState::Ok)
+   {
+      const std::uint64_t offset = m_text.size();
+      m_text.append(value.data(), value.size());
+      Append(sensorId, DataValue::STRING, timestamp, (offset << 32) | static_cast<std::uint32_t>(value.size()), alarmState);
+   }
+
+   void Clear()
+   {
+      m_records.clear();
+      m_text.clear();
+   }
+
+   bool Empty() const { return m_records.empty(); }
+   size_t Size() const { return m_records.size(); }
+   const PackedSampleRecord *GetRecords() const { return m_records.data(); }
+   std::string_view GetText() const { return m_text; }
+
+ private:
+   void Append(std::uint32_t sensorId, DataValue::e_Type type, std::chrono::steady_clock::time_point timestamp,
+       std::uint64_t payload, SensorAlarmState alarmState)
+   {
+      m_records.push_back({sensorId, static_cast<std::uint8_t>(type), static_cast<std::uint8_t>(alarmState), 0,
+          static_cast<std::int64_t>(timestamp.time_since_epoch().count()), payload});
+   }
+
+   std::vector<PackedSampleRecord> m_records;
+   std::string m_text;
+};
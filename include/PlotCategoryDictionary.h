@@ -0,0 +1,49 @@
+#pragma once
+#include "Node.h"
+
+#include <wx/string.h>
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Per-plot mapping of categorical samples (strings and booleans) to integer
+// lanes. Lanes are assigned on first appearance and never move, so labels are
+// converted once and reused by every frame. Each node also keeps a lane column
+// aligned with its history that is extended only by samples that arrived
+// since the previous frame.
+class PlotCategoryDictionary
+{
+ public:
+   // Lane of a categorical value, assigning one if it is new; NaN otherwise.
+   double LaneFor(const DataValue &value);
+
+   // Lanes aligned index-for-index with a view of node's history;
+   // non-categorical samples hold NaN.
+   const std::deque<double> &GetNodeLanes(const Node &node, const Node::HistoryView &history);
+
+   // Drops cached node columns when the model's nodes may have been replaced.
+   void SyncStructure(std::uint64_t structureVersion);
+
+   size_t GetLaneCount() const { return m_labels.size(); }
+   const wxString &GetLabel(size_t lane) const { return m_labels[lane]; }
+   void Clear();
+
+ private:
+   struct NodeLanes
+   {
+      // History sequences the lanes cover, [firstSequence, endSequence).
+      std::uint64_t firstSequence = 0;
+      std::uint64_t endSequence   = 0;
+      std::deque<double> lanes;
+   };
+
+   size_t Intern(const std::string &text);
+
+   std::unordered_map<std::string, size_t> m_lanes;
+   std::vector<wxString> m_labels;
+   std::unordered_map<const Node *, NodeLanes> m_nodeLanes;
+   std::uint64_t m_structureVersion = 0;
+};
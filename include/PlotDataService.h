@@ -0,0 +1,100 @@
+#pragma once
+#include "PlotCategoryDictionary.h"
+#include "SampleHistory.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+class Node;
+
+// Shares per-sensor plot data between plot windows. A snapshot covers one
+// sensor over one time window at one pixel width and is immutable once built,
+// so every plot showing the same sensor with the same window reuses it until
+// the sensor receives a new sample. The render scheduler opens a tick before
+// painting, which fixes the clock every plot renders against and drops
+// snapshots nobody asked for during the previous tick.
+class PlotDataService
+{
+ public:
+   using TimePoint = std::chrono::steady_clock::time_point;
+
+   struct SnapshotKey
+   {
+      const Node *node = nullptr;
+      // Without a window the whole history is used and the bounds only
+      // define the pixel columns for decimation.
+      bool hasWindow      = false;
+      TimePoint viewStart = TimePoint::min();
+      TimePoint viewEnd   = TimePoint::min();
+      int pixelWidth      = 1;
+
+      bool operator==(const SnapshotKey &other) const
+      {
+         return node == other.node && hasWindow == other.hasWindow && viewStart == other.viewStart &&
+                viewEnd == other.viewEnd && pixelWidth == other.pixelWidth;
+      }
+   };
+
+   struct Sample
+   {
+      TimePoint timestamp;
+      // Numeric value, or the category lane when categorical is set.
+      double value;
+      bool categorical;
+   };
+
+   struct Snapshot
+   {
+      // M4-decimated window samples plus one neighbour either side of a
+      // windowed range so polylines reach the plot edges.
+      std::vector<Sample> samples;
+      NumericExtents numericExtents;
+      // Sorted lanes of every categorical sample inside the window.
+      std::vector<size_t> visibleLanes;
+      bool hasData = false;
+   };
+
+   static constexpr size_t MAX_CACHED_SNAPSHOTS = 4096;
+
+   PlotDataService();
+
+   void BeginTick(TimePoint now);
+   // Clock shared by every plot rendered in the current tick.
+   TimePoint GetFrameTime() const { return m_frameTime; }
+
+   // history is a view of key.node's history; a cached snapshot is reused
+   // while the view holds the same samples.
+   std::shared_ptr<const Snapshot> Acquire(const SnapshotKey &key, std::uint64_t structureVersion, const SampleHistory::View &history);
+   const PlotCategoryDictionary &GetCategories() const { return m_categories; }
+   size_t GetCachedCount() const { return m_snapshots.size(); }
+   void Clear();
+
+   // Uncached build for renders without a service.
+   static Snapshot BuildSnapshot(const SnapshotKey &key, const SampleHistory::View &history, PlotCategoryDictionary &categories);
+
+ private:
+   struct KeyHash
+   {
+      size_t operator()(const SnapshotKey &key) const;
+   };
+
+   struct CacheEntry
+   {
+      std::shared_ptr<const Snapshot> snapshot;
+      std::uint64_t firstSequence = 0;
+      std::uint64_t endSequence   = 0;
+      std::uint64_t usedTick      = 0;
+   };
+
+   // Drops snapshots not acquired since the start of the previous tick.
+   void SweepUnused();
+
+   std::unordered_map<SnapshotKey, CacheEntry, KeyHash> m_snapshots;
+   PlotCategoryDictionary m_categories;
+   std::uint64_t m_structureVersion;
+   std::uint64_t m_tick;
+   TimePoint m_frameTime;
+};
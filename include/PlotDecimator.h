@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+struct PlotPoint
+{
+   double x;
+   double y;
+};
+
+// M4 decimation: keeps at most the first, minimum, maximum and last point of
+// every horizontal pixel column, in their original order. Rasterising the
+// reduced polyline produces the same pixels as the full one, while path
+// construction is bounded by the plot width instead of the sample count.
+// Input points must be ordered by x.
+void DecimateM4(const std::vector<PlotPoint> &points, std::vector<PlotPoint> &output);
+
+// Index form of DecimateM4 for samples that are not stored as PlotPoints,
+// over the indices [first, last). columnOf(i) gives the pixel column of sample
+// i (non-decreasing), valueOf(i) its value, and keep(i) is called for every
+// retained index in order. Samples whose value is NaN are skipped. valueOf is
+// called exactly once per index, in order, so it may also record what it sees.
+template <typename ColumnOf, typename ValueOf, typename Keep>
+void SelectM4(size_t first, size_t last, ColumnOf columnOf, ValueOf valueOf, Keep keep)
+{
+   size_t index = first;
+   double value = 0.0;
+   auto seekValue = [&]() {
+      for (; index < last; ++index) {
+         value = valueOf(index);
+         if (!std::isnan(value))
+            return;
+      }
+   };
+
+   seekValue();
+   if (index >= last)
+      return;
+
+   auto column = columnOf(index);
+   while (index < last) {
+      std::array<size_t, 4> leading = {};
+      size_t runCount               = 0;
+      size_t minIndex               = index;
+      size_t maxIndex               = index;
+      size_t lastIndex              = index;
+      double minValue               = value;
+      double maxValue               = value;
+
+      const auto runColumn = column;
+      while (index < last && column == runColumn) {
+         if (runCount < leading.size())
+            leading[runCount] = index;
+         ++runCount;
+         if (value < minValue) {
+            minValue = value;
+            minIndex = index;
+         }
+         if (value > maxValue) {
+            maxValue = value;
+            maxIndex = index;
+         }
+         lastIndex = index;
+
+         ++index;
+         seekValue();
+         if (index < last)
+            column = columnOf(index);
+      }
+
+      if (runCount <= leading.size()) {
+         for (size_t idx = 0; idx < runCount; ++idx)
+            keep(leading[idx]);
+      } else {
+         std::array<size_t, 4> selected = {leading[0], minIndex, maxIndex, lastIndex};
+         std::sort(selected.begin(), selected.end());
+         const auto uniqueEnd = std::unique(selected.begin(), selected.end());
+         for (auto it = selected.begin(); it != uniqueEnd; ++it)
+            keep(*it);
+      }
+   }
+}
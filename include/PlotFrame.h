@@ -1,6 +1,5 @@
 #pragma once
 #include <wx/tglbtn.h>
-#include <wx/timer.h>
 #include <wx/wx.h>
 
 #include <chrono>
@@ -10,7 +9,9 @@
 #include <vector>
 
 class Node;
+class PlotDataService;
 class SensorTreeModel;
+struct PlotRenderRequest;
 
 struct PlotSeries
 {
@@ -58,24 +59,48 @@ class PlotFrame : public wxFrame
    void SetOnClosed(std::function<void()> callback);
    std::optional<std::chrono::seconds> GetTimeRangeDuration() const;
 
+   // Request a redraw after a plotted sensor changed. The frame only records
+   // the request and asks the render scheduler for a tick, so repeated
+   // requests between ticks cost nothing.
+   void MarkDirty();
+   bool IsDirty() const { return m_dirty; }
+   void SetOnRenderRequested(std::function<void()> callback);
+   // Minimised or hidden frames are skipped by the scheduler until restored.
+   bool IsRenderable() const;
+   // Paints pending changes synchronously; called once per scheduler tick.
+   void RenderTick(std::chrono::steady_clock::time_point now);
+   // When a live view next scrolls by a pixel, so the scheduler can wake for
+   // it; empty for views that do not follow the clock.
+   std::optional<std::chrono::steady_clock::time_point> GetNextClockMove() const;
+
+   // Shared per-sensor snapshots, owned by the PlotManager.
+   void SetDataService(PlotDataService *service) { m_dataService = service; }
+
+   PlotRenderRequest BuildRenderRequest() const;
+   // Draws the current view offscreen at an arbitrary size.
+   wxImage RenderToImage(const wxSize &size) const;
+
  private:
    class PlotCanvas;
 
    void ApplyViewportState(const PlotViewportState &viewport, bool notify);
    void ApplyLockAllPlotsState(bool locked, bool notify);
-   void OnTimer(wxTimerEvent &event);
+   void OnIconize(wxIconizeEvent &event);
    void OnClose(wxCloseEvent &event);
    bool AppendSeries(Node *node);
    wxColour PickColour();
    void OnLockAllPlotsButton(wxCommandEvent &event);
    void OnTimeRangeButton(wxCommandEvent &event);
+   void OnStatisticsButton(wxCommandEvent &event);
    void SetTimeRange(TimeRange range);
    void UpdateTimeRangeButtons();
 
    wxString m_title;
    SensorTreeModel *m_model;
    PlotCanvas *m_canvas;
-   wxTimer m_timer;
+   bool m_dirty;
+   std::function<void()> m_onRenderRequested;
+   PlotDataService *m_dataService;
    std::vector<PlotSeries> m_series;
    std::function<void()> m_onClosed;
    size_t m_nextColourIndex;
@@ -86,6 +111,8 @@ class PlotFrame : public wxFrame
       wxToggleButton *button;
    };
    std::vector<TimeButtonEntry> m_timeButtons;
+   wxToggleButton *m_statisticsButton;
+   bool m_showStatistics;
    wxToggleButton *m_lockAllButton;
    bool m_lockAllPlots;
    PlotViewportState m_viewport;
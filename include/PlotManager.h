@@ -1,15 +1,23 @@
 #pragma once
+#include "PlotDataService.h"
+#include "PlotFrame.h"
+
+#include <wx/gdicmn.h>
 #include <wx/string.h>
 
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 class wxWindow;
 class Node;
-class PlotFrame;
 class SensorTreeModel;
-struct PlotViewportState;
+
+constexpr double DEFAULT_PLOT_MAX_FRAME_RATE = 10.0;
 
 class PlotManager
 {
@@ -31,11 +39,27 @@ class PlotManager
    std::vector<PlotConfiguration> GetPlotConfigurations() const;
    size_t RestorePlotConfigurations(const std::vector<PlotConfiguration> &configs, std::vector<wxString> &warnings);
    void CloseAllPlots();
+   void SetMaxFrameRate(double framesPerSecond);
+   double GetMaxFrameRate() const { return m_maxFrameRate; }
+   // Renders every open plot offscreen and writes one PNG per plot into directory.
+   size_t ExportPlotsToPng(const wxString &directory, const wxSize &size, std::vector<wxString> &warnings) const;
 
  private:
    static std::string NormalizeName(const wxString &name);
+   class RenderTimer;
+
+   // One timer paces every plot window: ticks are spaced by the frame
+   // interval from the previous tick and only run while a frame is dirty or
+   // a live view is due to scroll. An earlier due time reschedules the timer.
+   void ScheduleRenderTick();
+   void ScheduleRenderTick(std::chrono::steady_clock::time_point due);
+   void RenderTick();
+   void FlushViewportSync();
    void HandleViewportChanged(PlotFrame *source, const PlotViewportState &viewport);
    void HandlePlotClosed(const std::string &name);
+   void HandleSensorUpdated(const Node *node);
+   void RebuildSubscriptions();
+   void InvalidateSubscriptions() { m_subscriptionsValid = false; }
 
    struct PlotEntry
    {
@@ -46,5 +70,20 @@ class PlotManager
    wxWindow *m_parent;
    SensorTreeModel *m_model;
    bool m_lockAllPlots;
+   double m_maxFrameRate;
    std::unordered_map<std::string, PlotEntry> m_plots;
+   // Snapshots shared by every open plot.
+   PlotDataService m_dataService;
+   std::unique_ptr<RenderTimer> m_renderTimer;
+   std::chrono::steady_clock::time_point m_lastRenderTick;
+   std::chrono::steady_clock::time_point m_renderTickDue;
+   // Latest locked viewport change, applied to the other plots on the next
+   // tick so a drag produces one update per frame rather than per mouse event.
+   std::optional<PlotViewportState> m_pendingViewport;
+   PlotFrame *m_pendingViewportSource;
+   // Plots interested in each resolved sensor node, rebuilt lazily whenever the
+   // plot set or the model structure changes.
+   std::unordered_map<const Node *, std::vector<PlotFrame *>> m_subscriptions;
+   bool m_subscriptionsValid;
+   std::uint64_t m_subscribedStructureVersion;
 };
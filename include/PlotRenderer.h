@@ -0,0 +1,168 @@
+#pragma once
+#include "Node.h"
+#include "PlotFrame.h"
+
+#include <wx/bitmap.h>
+#include <wx/dc.h>
+#include <wx/dcgraph.h>
+#include <wx/image.h>
+
+#include <chrono>
+#include <map>
+#include <optional>
+#include <vector>
+
+class PlotDataService;
+class SensorTreeModel;
+class wxGraphicsContext;
+
+// Everything the renderer needs to know about one plot, independent of any window.
+struct PlotRenderRequest
+{
+   const std::vector<PlotSeries> *series = nullptr;
+   const SensorTreeModel *model          = nullptr;
+   PlotViewportState viewport;
+   std::optional<std::chrono::seconds> windowDuration;
+   std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+   // Shared snapshot cache; series are scanned per render when null.
+   PlotDataService *dataService = nullptr;
+   // Overlay each sensor's running mean and +/- one standard deviation.
+   bool showStatistics = false;
+};
+
+// Draws plots into arbitrary device contexts so the on-screen canvas, offscreen
+// bitmaps, PNG export and the render benchmark share one pipeline.
+class PlotRenderer
+{
+ public:
+   using TimePoint = std::chrono::steady_clock::time_point;
+   using Duration  = std::chrono::steady_clock::duration;
+
+   static constexpr int LEFT_MARGIN    = 55;
+   static constexpr int RIGHT_MARGIN   = 22;
+   static constexpr int TOP_MARGIN     = 10;
+   static constexpr int BOTTOM_MARGIN  = 30;
+   static constexpr int LEGEND_PADDING = 4;
+
+   // Plots with at least this many series are summarised as a statistical
+   // envelope instead of drawing one line per sensor.
+   static constexpr size_t DENSE_SERIES_THRESHOLD = 32;
+
+   struct PreparedSample
+   {
+      TimePoint timestamp;
+      double mappedValue;
+   };
+
+   // Distribution of every series' values within one pixel column.
+   struct EnvelopeColumn
+   {
+      bool valid    = false;
+      double min    = 0.0;
+      double p10    = 0.0;
+      double p25    = 0.0;
+      double median = 0.0;
+      double p75    = 0.0;
+      double p90    = 0.0;
+      double max    = 0.0;
+   };
+
+   // A value outside the column's 1.5 x IQR fences.
+   struct EnvelopeOutlier
+   {
+      int column;
+      double value;
+   };
+
+   // A series' running mean and standard deviation when the frame was prepared.
+   struct SeriesStatistics
+   {
+      bool hasNumeric = false;
+      double mean     = 0.0;
+      double stdDev   = 0.0;
+   };
+
+   // Everything needed to draw one frame, resolved once per render.
+   struct FrameLayout
+   {
+      wxString statusMessage;
+      bool showStatusLegend = false;
+      wxPoint legendOrigin;
+      std::vector<const Node *> resolvedNodes;
+      // Captured with the nodes, so drawing reads no node state afterwards.
+      std::vector<size_t> updateCounts;
+      std::vector<SeriesStatistics> statistics;
+      wxRect plotRect;
+      TimePoint plotStart;
+      TimePoint plotEnd;
+      double timeRange           = 1.0;
+      double minValue            = -1.0;
+      double maxValue            = 1.0;
+      double valueRange          = 2.0;
+      bool usingCategoricalAxis  = false;
+      bool hasCategoricalSamples = false;
+      std::map<double, wxString> categoricalLabels;
+      std::vector<std::vector<PreparedSample>> prepared;
+      // Follow-latest windows are snapped to whole pixels so a cached series
+      // layer can be scrolled by an integer offset as time advances.
+      bool followsLatest     = false;
+      bool tracksClock       = false;
+      Duration pixelDuration = Duration::zero();
+      // Dense plots carry numeric samples only and draw the envelope.
+      bool denseMode = false;
+      std::vector<EnvelopeColumn> envelope;
+      std::vector<EnvelopeOutlier> outliers;
+      // Never set for dense or purely categorical plots.
+      bool showStatistics = false;
+   };
+
+   struct LegendEntry
+   {
+      wxString label;
+      wxColour colour;
+      bool missing;
+
+      bool operator==(const LegendEntry &other) const
+      {
+         return label == other.label && colour == other.colour && missing == other.missing;
+      }
+   };
+
+   static wxColour BackgroundColour() { return wxColour(18, 22, 30); }
+   static wxColour TextColour() { return wxColour(235, 238, 245); }
+   static wxColour GridColour() { return wxColour(70, 78, 92); }
+   static wxColour MissingTextColour() { return wxColour(160, 165, 180); }
+   static wxColour EnvelopeColour() { return wxColour(95, 170, 255); }
+   static wxColour OutlierColour() { return wxColour(255, 120, 90); }
+
+   // Needs the store's lock held.
+   static std::vector<const Node *> ResolveNodes(const PlotRenderRequest &request);
+   // Holds the store's lock only while resolving nodes and taking views of
+   // their history; the rest of the frame is built from the views.
+   static void PrepareFrame(const PlotRenderRequest &request, const wxSize &size, FrameLayout &layout);
+   static std::vector<LegendEntry> BuildLegendEntries(const PlotRenderRequest &request, const std::vector<const Node *> &resolvedNodes);
+   // Per-column min/max/percentiles across all series of a dense plot.
+   static void BuildEnvelope(FrameLayout &layout);
+
+   // Individual layers; the canvas caches these separately.
+   static void DrawStatus(wxDC &dc, const FrameLayout &layout, const std::vector<LegendEntry> &legend);
+   static void DrawChrome(wxDC &dc, const FrameLayout &layout);
+   static void DrawGrid(wxDC &dc, const FrameLayout &layout);
+   static wxSize MeasureLegend(wxDC &dc, const std::vector<LegendEntry> &entries);
+   static wxPoint GetLegendBoxOrigin(const FrameLayout &layout);
+   static void DrawLegendBox(wxDC &dc, const wxPoint &boxOrigin, const std::vector<LegendEntry> &entries);
+   // Mean and one-sigma lines from each series' captured statistics.
+   static void DrawStatisticsOverlay(wxDC &dc, const FrameLayout &layout, const std::vector<PlotSeries> &series);
+   // Strokes every series, or only samples newer than drawnUntil when given.
+   // Dense plots always draw the whole envelope.
+   static void DrawSeries(wxGraphicsContext &gc,
+       const FrameLayout &layout,
+       const std::vector<PlotSeries> &series,
+       const std::vector<TimePoint> *drawnUntil);
+
+   // Complete, uncached frame into a graphics-backed DC using its current font.
+   static FrameLayout Render(wxGCDC &dc, const PlotRenderRequest &request, const wxSize &size);
+   static wxBitmap RenderToBitmap(const PlotRenderRequest &request, const wxSize &size);
+   // Renders without touching a native window or screen-compatible bitmap.
+   static wxImage RenderToImage(const PlotRenderRequest &request, const wxSize &size);
+};
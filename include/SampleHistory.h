@@ -0,0 +1,151 @@
+#pragma once
+#include "EpochDomain.h"
+#include "SensorData.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Running numeric range; an empty range has min > max.
+struct NumericExtents
+{
+   double min = std::numeric_limits<double>::infinity();
+   double max = -std::numeric_limits<double>::infinity();
+
+   bool IsValid() const { return min <= max; }
+
+   void Include(double value)
+   {
+      // NaN compares false both ways, so non-numeric placeholders are skipped.
+      if (value < min)
+         min = value;
+      if (value > max)
+         max = value;
+   }
+
+   void Merge(const NumericExtents &other)
+   {
+      if (other.min < min)
+         min = other.min;
+      if (other.max > max)
+         max = other.max;
+   }
+};
+
+struct TimedSample
+{
+   std::chrono::steady_clock::time_point timestamp;
+   DataValue value;
+   SensorAlarmState alarmState;
+};
+
+// A sensor's most recent samples, with contiguous timestamp and numeric
+// columns at the same indices for vectorised plot scans. Non-numeric samples
+// are stored as NaN so numeric scans can skip them without branching, and
+// per-block extents let range queries scan only the partial blocks at either
+// edge of a window.
+//
+// One writer appends while any number of readers take Views without a lock.
+// Samples live in a fixed-capacity generation that is only ever appended to;
+// a full generation is copied forward without its evicted samples and the
+// old one is retired through EpochDomain, so a View never sees a sample
+// change or move under it.
+class SampleHistory
+{
+   struct Generation;
+
+ public:
+   using TimePoint = std::chrono::steady_clock::time_point;
+
+   static constexpr size_t kBlockSize = 64;
+
+   // Consistent snapshot of the history when it was taken. Pins the calling
+   // thread's epoch, so keep it briefly and on the thread that took it.
+   class View
+   {
+    public:
+      size_t size() const { return m_size; }
+      bool empty() const { return m_size == 0; }
+      const TimedSample &operator[](size_t index) const { return m_rows[m_head + index]; }
+      const TimedSample &front() const { return (*this)[0]; }
+      const TimedSample &back() const { return (*this)[m_size - 1]; }
+      const TimedSample *begin() const { return m_rows + m_head; }
+      const TimedSample *end() const { return begin() + m_size; }
+
+      TimePoint GetTimestamp(size_t index) const { return m_timestamps[m_head + index]; }
+      double GetNumeric(size_t index) const { return m_numeric[m_head + index]; }
+      const TimePoint *GetTimestampData() const { return m_timestamps + m_head; }
+      const double *GetNumericData() const { return m_numeric + m_head; }
+
+      // Samples are numbered in the order they were appended; index 0 is
+      // sample GetFirstSequence(). Sequences are never reused, so comparing
+      // them tells whether two views of one history differ.
+      std::uint64_t GetFirstSequence() const { return m_firstSequence; }
+      std::uint64_t GetEndSequence() const { return m_firstSequence + m_size; }
+
+      // Half-open index range [first, last) of samples with start <= timestamp <= end.
+      std::pair<size_t, size_t> FindWindow(TimePoint start, TimePoint end) const;
+      // Numeric extents over the half-open index range [first, last).
+      NumericExtents ComputeExtents(size_t first, size_t last) const;
+
+    private:
+      friend class SampleHistory;
+
+      View(EpochDomain::Guard &&guard, const Generation &generation);
+
+      EpochDomain::Guard m_guard;
+      const TimedSample *m_rows;
+      const TimePoint *m_timestamps;
+      const double *m_numeric;
+      const NumericExtents *m_blocks;
+      // Position of index 0 within the generation, which fixes block alignment.
+      size_t m_head;
+      size_t m_size;
+      std::uint64_t m_firstSequence;
+   };
+
+   explicit SampleHistory(size_t limit = 1024);
+   // Frees the history at once. An owner shared with readers on other threads
+   // waits for EpochDomain::IsReclaimable() first, as SensorDataStore does.
+   ~SampleHistory();
+
+   SampleHistory(const SampleHistory &)            = delete;
+   SampleHistory &operator=(const SampleHistory &) = delete;
+
+   // Writer side; calls must not overlap. Timestamps are expected to be
+   // non-decreasing.
+   void Append(TimedSample &&sample, double numeric);
+   void Clear();
+   void SetLimit(size_t limit);
+   size_t GetLimit() const { return m_limit; }
+
+   View Snapshot() const;
+   bool Empty() const;
+
+   // Vectorised min/max over a raw buffer; NaN entries are ignored.
+   static NumericExtents ScanExtents(const double *values, size_t count);
+
+ private:
+   struct RetiredGeneration
+   {
+      Generation *generation;
+      std::uint64_t epoch;
+   };
+
+   // Publishes a generation of `capacity` holding the newest `keep` samples
+   // and retires the current one.
+   void Reallocate(size_t capacity, size_t keep);
+   void ReclaimRetired();
+   // Room for the limit plus half as many evicted samples, so a full history
+   // is copied forward once every limit / 2 appends.
+   size_t GetMaximumCapacity() const;
+
+   std::atomic<Generation *> m_current;
+   size_t m_limit;
+   std::vector<RetiredGeneration> m_retired;
+};
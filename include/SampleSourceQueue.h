@@ -0,0 +1,73 @@
+#pragma once
+#include "SensorData.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+struct SampleSourceStats
+{
+   std::uint64_t received  = 0;
+   std::uint64_t dropped   = 0;
+   std::uint64_t delivered = 0;
+   size_t depth            = 0;
+   size_t highWater        = 0;
+   std::chrono::steady_clock::time_point lastReceived;
+};
+
+// Bounded hand-off between one producer thread and the SensorModelThread that
+// drains it. A producer that cannot afford to wait (a socket reader) passes a
+// zero wait and loses whatever does not fit; one that can (a file replay)
+// waits for room, which slows it to the rate the store consumes.
+class SampleSourceQueue
+{
+ public:
+   static constexpr size_t DEFAULT_CAPACITY = 50000;
+   // Waits until every sample fits or the queue is closed.
+   static constexpr std::chrono::milliseconds WAIT_UNTIL_CLOSED{-1};
+
+   explicit SampleSourceQueue(size_t capacity = DEFAULT_CAPACITY);
+
+   // Returns how many samples were accepted; the rest are counted as dropped.
+   size_t Push(std::vector<SensorSample> &&samples, std::chrono::milliseconds maxWait = std::chrono::milliseconds(0));
+   // Moves up to maxCount of the oldest samples to the end of `out`.
+   size_t PopInto(size_t maxCount, std::vector<SensorSample> &out);
+   // Discards queued samples without counting them as dropped.
+   void Clear();
+   // Wakes a waiting producer for good; later pushes are dropped.
+   void Close();
+   // Counts samples a producer applied to the store itself, bypassing the
+   // queue, as received and delivered.
+   void RecordDelivered(size_t count);
+
+   size_t GetCapacity() const { return m_capacity; }
+   size_t GetDepth() const;
+   SampleSourceStats GetStats() const;
+
+ private:
+   const size_t m_capacity;
+   mutable std::mutex m_mutex;
+   std::condition_variable m_spaceAvailable;
+   std::deque<SensorSample> m_samples;
+   SampleSourceStats m_stats;
+   bool m_closed;
+};
+
+// Shares a drain budget between queues so a chatty source cannot starve quiet
+// ones. Each non-empty queue gets an equal slice per round; whatever a queue
+// does not use is offered to the others in further rounds, and the queue that
+// starts the next drain rotates so rounding never favours the same source.
+class FairSampleMerger
+{
+ public:
+   FairSampleMerger();
+
+   size_t Drain(const std::vector<SampleSourceQueue *> &queues, size_t budget, std::vector<SensorSample> &out);
+
+ private:
+   size_t m_nextStart;
+};
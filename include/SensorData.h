@@ -1,4 +1,5 @@
 #pragma once
+#include <chrono>
 #include <cstdint>
 #include <optional>
 #include <string>
@@ -127,6 +128,16 @@ struct SensorThresholds
    }
 };
 
+// One sample as it travels from a producer to the tree.
+struct SensorSample
+{
+   std::vector<std::string> path;
+   DataValue value;
+   SensorThresholds thresholds;
+   SensorAlarmState alarmState                     = SensorAlarmState::Ok;
+   std::chrono::steady_clock::time_point timestamp = std::chrono::steady_clock::now();
+};
+
 // Individual data sample with hierarchical path
 class SensorData
 {
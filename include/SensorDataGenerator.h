@@ -1,21 +1,63 @@
 #pragma once
+#include "SensorData.h"
+#include "SensorWireProtocol.h"
+#include "SourceManager.h"
 
-#include <wx/thread.h>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
-class wxEvtHandler;
+class wxDatagramSocket;
+class wxSocketBase;
+class wxSocketServer;
 
-class SensorDataGenerator : public wxThread
+// Receives sensor samples from the network on its own thread. Sensors either
+// keep a TCP connection open or send UDP datagrams to the same port; both
+// carry the SensorWire protocol. Everything decoded in one poll iteration is
+// published as one batch; a full queue drops rather than stalling the sockets.
+class SensorDataGenerator : public SampleSource
 {
  public:
-   SensorDataGenerator(wxEvtHandler *target);
-   virtual ~SensorDataGenerator() = default;
+   explicit SensorDataGenerator(std::uint16_t port = SensorWire::DEFAULT_PORT);
+   virtual ~SensorDataGenerator();
+
+   static constexpr int POLL_INTERVAL_MS             = 10;
+   static constexpr size_t READ_BUFFER_SIZE          = 64 * 1024;
+   static constexpr std::chrono::seconds UDP_TIMEOUT = std::chrono::seconds(5);
 
  protected:
    virtual ExitCode Entry() override;
 
  private:
-   void QueueConnectionEvent(bool connected);
-   void QueueNewMessageEvent();
+   struct StreamSource
+   {
+      std::unique_ptr<wxSocketBase> socket;
+      SensorWireDecoder decoder;
+   };
+
+   struct DatagramSource
+   {
+      SensorWireDecoder decoder;
+      std::chrono::steady_clock::time_point lastSeen;
+   };
+
+   bool OpenSockets();
+   void CloseSockets();
+   void AcceptClients();
+   void ReadStreams(std::vector<SensorSample> &batch);
+   void ReadDatagrams(std::vector<SensorSample> &batch);
+   void ExpireDatagramSources(std::chrono::steady_clock::time_point now);
+   bool HasSources() const;
 
-   wxEvtHandler *m_target;
+   std::uint16_t m_port;
+   std::unique_ptr<wxSocketServer> m_server;
+   std::unique_ptr<wxDatagramSocket> m_datagramSocket;
+   std::vector<StreamSource> m_streams;
+   // Keyed by "address:port" of the sender.
+   std::unordered_map<std::string, DatagramSource> m_datagramSources;
+   std::vector<std::uint8_t> m_readBuffer;
+   std::string m_errorMessage;
 };
@@ -0,0 +1,22 @@
+#pragma once
+#include "SourceManager.h"
+
+#include <string>
+
+// Replays a saved recording as a live source, keeping the recorded spacing
+// between samples (scaled by `speed`). Samples are stamped when published.
+// Waits for queue space rather than dropping, so a replay never loses data.
+class SensorDataReplaySource : public SampleSource
+{
+ public:
+   SensorDataReplaySource(std::string filePath, double speed = 1.0);
+
+   static constexpr int MAX_SLEEP_MS = 50;
+
+ protected:
+   virtual ExitCode Entry() override;
+
+ private:
+   std::string m_filePath;
+   double m_speed;
+};
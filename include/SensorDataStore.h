@@ -0,0 +1,259 @@
+#pragma once
+#include "AlarmJournal.h"
+#include "DerivedSensors.h"
+#include "Node.h"
+#include "PackedSampleBatch.h"
+#include "StalenessWheel.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// An alarm transition as it happened; the node may have moved on by the time
+// the change set carrying it is consumed.
+struct SensorAlarmTransition
+{
+   const Node *node;
+   AlarmEventKind kind;
+   SensorAlarmState previous;
+   SensorAlarmState state;
+   DataValue value;
+   std::chrono::steady_clock::time_point timestamp;
+};
+
+// Everything that changed in the store since the consumer last took changes.
+struct SensorChangeSet
+{
+   // Parents come before their children.
+   std::vector<Node *> createdNodes;
+   // Each node once, whether it received samples, changed alarm or staleness
+   // state or had its aggregate kind changed.
+   std::vector<Node *> updatedNodes;
+   std::vector<SensorAlarmTransition> transitions;
+   std::uint64_t structureVersion = 0;
+   std::uint64_t alarmVersion     = 0;
+
+   bool Empty() const { return createdNodes.empty() && updatedNodes.empty() && transitions.empty(); }
+   void Clear();
+};
+
+// Whole-tree counts, kept per shard and summed when read.
+struct SensorStoreTotals
+{
+   size_t sensorCount        = 0;
+   std::uint64_t sampleCount = 0;
+   size_t warningCount       = 0;
+   size_t failedCount        = 0;
+   size_t staleCount         = 0;
+};
+
+// Owns the sensor tree and every mutation of it, with no knowledge of the UI.
+// Top-level subtrees are spread over shards by the hash of their name; each
+// shard has its own lock, staleness wheel and change set, so samples for
+// different shards are applied in parallel. Mutations may come from any
+// thread and lock the shards they touch; anyone dereferencing nodes from
+// another thread holds LockSubtree() for one subtree or Lock() for the whole
+// tree meanwhile. Shard locks are recursive, so readers can nest them freely.
+// Nodes are only destroyed by Clear().
+class SensorDataStore
+{
+ public:
+   using SensorId = std::uint32_t;
+
+   // Holds every shard's lock, acquired in shard order.
+   class ReadLock
+   {
+    public:
+      explicit ReadLock(const SensorDataStore &store);
+
+    private:
+      std::vector<std::unique_lock<std::recursive_mutex>> m_locks;
+   };
+
+   explicit SensorDataStore(size_t shardCount = 1);
+   ~SensorDataStore();
+
+   SensorDataStore(const SensorDataStore &)            = delete;
+   SensorDataStore &operator=(const SensorDataStore &) = delete;
+
+   // One shard per core, for stores fed by StartWorkers().
+   static size_t GetDefaultShardCount();
+   size_t GetShardCount() const { return m_shards.size(); }
+
+   ReadLock Lock() const { return ReadLock(*this); }
+   // Locks only the shard holding node's subtree; enough for reading the node
+   // and its descendants. Empty for nullptr.
+   std::unique_lock<std::recursive_mutex> LockSubtree(const Node *node) const;
+
+   // Gives each shard a worker thread applying what SubmitSamples() routes to
+   // it. Until then, and after StopWorkers(), samples are applied on the
+   // submitting thread.
+   void StartWorkers();
+   // Applies whatever is still queued, then joins the workers.
+   void StopWorkers();
+   // Consumes the samples, leaving the vector empty. With workers running the
+   // samples are queued to their shards and applied asynchronously; the call
+   // blocks while a shard's queue is full.
+   void SubmitSamples(std::vector<SensorSample> &samples);
+
+   void AddDataSample(const std::vector<std::string> &path, const DataValue &value,
+       SensorThresholds thresholds,
+       SensorAlarmState alarmState,
+       std::chrono::steady_clock::time_point timestamp);
+   // Applies each shard's share of the batch under one acquisition of its lock.
+   void AddDataSamples(const std::vector<SensorSample> &samples);
+   // AddDataSamples for samples whose alarm states were already decided, such
+   // as a loaded recording; their states are taken as-is.
+   void AddRecordedSamples(const std::vector<SensorSample> &samples);
+
+   // Batch ingest for producers that resolve paths once. A sample that keeps
+   // its sensor's alarm state is appended straight into the node; a sensor's
+   // first sample, alarm transitions and stale sensors reporting again go
+   // through AddDataSample's bookkeeping. Registering a known path returns
+   // its id and replaces its thresholds.
+   SensorId RegisterSensor(const std::vector<std::string> &path, SensorThresholds thresholds = {});
+   // Records with an unknown id, type or alarm state are skipped; returns how
+   // many were applied. Producers on several threads may call it at once;
+   // each batch takes every shard it touches once. Not to be called while
+   // holding Lock().
+   size_t AddPackedSamples(const PackedSampleRecord *records, size_t count, std::string_view text);
+
+   // Virtual sensors computed from other sensors. Their samples are added like
+   // any other, so they get history, thresholds, alarms and plotting; the
+   // first one appears once every input has reported after the definition.
+   // Outputs are applied after the batch that produced them, which may be on
+   // another shard's worker.
+   bool AddDerivedSensor(const std::vector<std::string> &path,
+       const std::string &expression,
+       SensorThresholds thresholds,
+       std::string &errorMessage);
+
+   // Applied to every incoming sample; disabling it trusts producer states as-is.
+   void SetAlarmPolicy(const AlarmPolicy &policy);
+   AlarmPolicy GetAlarmPolicy() const;
+   // Chooses the aggregate shown for a container and every container below it.
+   void SetAggregateKind(Node *node, AggregateKind kind);
+
+   void SetLiveDataMode(bool isLiveData);
+   bool IsLiveDataMode() const;
+   // Time elapsed columns are measured against: now when live, otherwise the
+   // newest sample of the loaded recording.
+   std::chrono::steady_clock::time_point GetReferenceTime() const;
+
+   // Fires due staleness deadlines against the reference time. A sensor goes
+   // stale after missing STALE_PERIOD_MULTIPLIER of its expected update
+   // periods and recovers with its next sample; stale sensors count as alarms.
+   // Also commits alarm states still pending once their dwell time is up.
+   void AdvanceStaleness();
+   // Destroys every node and drops changes nobody has taken yet.
+   void Clear();
+
+   Node *FindNodeByPath(const std::vector<std::string> &path) const;
+   // In the order they were created. Only valid while holding Lock().
+   const std::vector<Node *> &GetRootNodes() const { return m_rootOrder; }
+
+   // Moves every shard's pending changes into `changes` and starts new sets.
+   void TakeChanges(SensorChangeSet &changes);
+
+   SensorStoreTotals GetTotals() const;
+   std::uint64_t GetStructureVersion() const { return m_structureVersion.load(); }
+   std::uint64_t GetAlarmVersion() const { return m_alarmVersion.load(); }
+
+   static constexpr double STALE_PERIOD_MULTIPLIER = 3.0;
+   static constexpr std::chrono::seconds STALE_MINIMUM_TIMEOUT{1};
+   // SubmitSamples() blocks while a shard has this many samples queued.
+   static constexpr size_t SHARD_QUEUE_CAPACITY = 50000;
+
+ private:
+   struct Shard
+   {
+      mutable std::recursive_mutex mutex;
+      std::vector<std::unique_ptr<Node>> rootNodes;
+      StalenessWheel staleness;
+      // Dwell deadlines of the alarm states evaluators hold pending.
+      StalenessWheel alarmDwell;
+      std::vector<Node *> expired;
+      SensorChangeSet changes;
+      // A copy per shard, so applying samples never reads shared state.
+      AlarmPolicy alarmPolicy;
+      SensorStoreTotals totals;
+      // Derived sensor samples produced while applying, routed once the
+      // shard's lock is released.
+      std::vector<SensorSample> derivedSamples;
+
+      std::mutex queueMutex;
+      std::condition_variable queueReady;
+      std::condition_variable queueSpace;
+      std::vector<SensorSample> queue;
+      bool stopping = false;
+      std::thread worker;
+   };
+
+   struct RegisteredSensor
+   {
+      std::vector<std::string> path;
+      SensorThresholds thresholds;
+      size_t shard;
+      // Resolved by the sensor's first sample; only valid while
+      // clearGeneration matches the store's.
+      Node *node;
+      std::uint64_t clearGeneration;
+   };
+
+   size_t GetShardIndex(const std::string &rootName) const;
+   size_t GetShardIndex(const std::vector<std::string> &path) const { return path.empty() ? 0 : GetShardIndex(path[0]); }
+   size_t GetShardIndex(const Node *node) const;
+   void AddSamplesByShard(const std::vector<SensorSample> &samples, bool evaluateAlarms);
+   void ApplyBatch(Shard &shard, const std::vector<const SensorSample *> &samples, bool evaluateAlarms);
+   void RouteDerivedSamples(std::vector<SensorSample> &samples);
+   void EnqueueByShard(std::vector<SensorSample> &samples, bool waitForSpace);
+   bool ApplyPackedRecord(Shard &shard, const PackedSampleRecord &record, std::string_view text);
+   void EnqueueSamples(size_t shardIndex, std::vector<SensorSample> &samples, bool waitForSpace);
+   void RunWorker(Shard &shard);
+   Node *ApplySample(Shard &shard, const std::vector<std::string> &path, const DataValue &value,
+       SensorThresholds thresholds,
+       SensorAlarmState alarmState,
+       std::chrono::steady_clock::time_point timestamp,
+       bool evaluateAlarm);
+   void FeedDerivedSensors(Shard &shard, const std::vector<std::string> &path, const DataValue &value, std::chrono::steady_clock::time_point timestamp);
+   Node *FindOrCreatePath(Shard &shard, const std::vector<std::string> &path);
+   void SetAggregateKind(Shard &shard, Node *node, AggregateKind kind);
+   static void MarkUpdated(Shard &shard, Node *node);
+   static void CountAlarmState(SensorStoreTotals &totals, SensorAlarmState state, int delta);
+   void UpdateReferenceTime(std::chrono::steady_clock::time_point timestamp);
+   static void ArmStaleness(Shard &shard, Node *node);
+   static void ArmAlarmDwell(Shard &shard, Node *node);
+   static std::chrono::steady_clock::duration GetStaleTimeout(const Node *node);
+
+   std::vector<std::unique_ptr<Shard>> m_shards;
+   std::atomic<bool> m_workersRunning;
+   // Appended to under the creating shard's lock and this mutex.
+   std::mutex m_rootOrderMutex;
+   std::vector<Node *> m_rootOrder;
+   std::atomic<bool> m_isLiveDataMode;
+   mutable std::mutex m_referenceTimeMutex;
+   std::optional<std::chrono::steady_clock::time_point> m_elapsedReferenceTime;
+   std::atomic<std::uint64_t> m_structureVersion;
+   std::atomic<std::uint64_t> m_alarmVersion;
+   std::atomic<std::uint64_t> m_clearGeneration;
+   // Taken after a shard lock when samples feed derived sensors, and held
+   // while their outputs are queued.
+   std::mutex m_derivedMutex;
+   std::atomic<bool> m_hasDerivedSensors;
+   DerivedSensorSet m_derivedSensors;
+   // Exclusive for registration, shared by packed ingest; taken before any
+   // shard lock.
+   std::shared_mutex m_registryMutex;
+   std::vector<RegisteredSensor> m_registeredSensors;
+   std::unordered_map<std::string, SensorId> m_sensorIdsByPath;
+};
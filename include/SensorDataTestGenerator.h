@@ -1,27 +1,46 @@
 #pragma once
-
-#include <wx/thread.h>
+#include "SensorDataStore.h"
+#include "SensorModelThread.h"
+#include "SourceManager.h"
+#include "SyntheticLoad.h"
 
 #include <atomic>
-#include <random>
-
-class wxEvtHandler;
+#include <cstdint>
+#include <memory>
+#include <mutex>
 
-class SensorDataTestGenerator : public wxThread
+// Synthetic source: runs a SyntheticLoadGenerator into the store while the
+// shared flag is set; reported as connected only while generating. Its
+// samples go straight to the store rather than through the queue, so each
+// batch is reported to the model thread, when there is one, to be counted
+// and written to the current log.
+class SensorDataTestGenerator : public SampleSource
 {
  public:
-   SensorDataTestGenerator(std::atomic<bool> &activeFlag, wxEvtHandler *target);
+   SensorDataTestGenerator(std::atomic<bool> &activeFlag, SensorDataStore &store, SensorModelThread *modelThread);
    virtual ~SensorDataTestGenerator() = default;
 
+   // Restarts a running generator with the new shape and pace.
+   void SetConfig(const SyntheticLoadConfig &config);
+   SyntheticLoadConfig GetConfig() const;
+   // Joins the generator's workers, so nothing reaches the store once this
+   // returns; call after clearing the flag.
+   void StopGenerating();
+
  protected:
    virtual ExitCode Entry() override;
 
  private:
-   void QueueRandomDataSample();
-   void QueueConnectionEvent(bool connected);
-   void QueueNewMessageEvent();
+   void StopLocked();
+   void ReportGenerated();
 
    std::atomic<bool> &m_activeFlag;
-   wxEvtHandler *m_target;
-   std::mt19937 m_rng;
+   SensorDataStore &m_store;
+   SensorModelThread *m_modelThread;
+   // Guards the config and the generator, which Entry() and StopGenerating()
+   // both start and stop.
+   mutable std::mutex m_mutex;
+   SyntheticLoadConfig m_config;
+   std::unique_ptr<SyntheticLoadGenerator> m_generator;
+   std::uint64_t m_reportedCount;
 };
@@ -0,0 +1,55 @@
+#pragma once
+#include "SensorDataJsonWriter.h"
+#include "SensorDataStore.h"
+#include "SourceManager.h"
+
+#include <wx/thread.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+// Feeds the live tree: drains the sources, records what it drained and
+// submits it to the store, whose shard workers apply it when started, then
+// advances staleness. The UI thread never applies live samples itself; it
+// publishes the store's change sets on its own timer, so ingest no longer
+// waits for painting or input.
+class SensorModelThread : public wxThread
+{
+ public:
+   SensorModelThread(SensorDataStore &store, SourceManager &sources);
+
+   // Samples are submitted in batches of at most this many; each shard
+   // applies its share under one acquisition of its lock.
+   static constexpr size_t MAX_SAMPLES_PER_BATCH = 2000;
+   static constexpr unsigned long IDLE_SLEEP_MS  = 5;
+
+   // Swaps the log drained samples are written to and returns the previous
+   // one, so the caller closes it outside the ingest path. nullptr stops
+   // recording.
+   std::unique_ptr<SensorDataJsonWriter> ReplaceRecorder(std::unique_ptr<SensorDataJsonWriter> recorder);
+   std::uint64_t GetDrainedCount() const { return m_drained.load(); }
+
+   // Producers that apply samples to the store themselves, such as the
+   // synthetic generator, report them here so they are still counted with
+   // the drained samples and written to the current log. Any thread.
+   void CountApplied(size_t count) { m_drained += count; }
+   // Whether RecordApplied() has a log to write to, so callers only build the
+   // samples while someone keeps them.
+   bool IsRecording() const { return m_isRecording.load(); }
+   void RecordApplied(const std::vector<SensorSample> &samples);
+
+ protected:
+   ExitCode Entry() override;
+
+ private:
+   SensorDataStore &m_store;
+   SourceManager &m_sources;
+   std::mutex m_recorderMutex;
+   std::unique_ptr<SensorDataJsonWriter> m_recorder;
+   std::atomic<bool> m_isRecording;
+   std::atomic<std::uint64_t> m_drained;
+   std::vector<SensorSample> m_batch;
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include "SensorData.h"
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+
+// O(1) running statistics for one sensor, updated as each sample arrives so
+// columns and plot overlays never rescan history. Numeric samples feed the
+// mean/variance, EWMA and sliding-window extremes; every sample feeds the
+// update rate and the time spent in each alarm state.
+class SensorStatistics
+{
+ public:
+   using TimePoint = std::chrono::steady_clock::time_point;
+   using Duration  = std::chrono::steady_clock::duration;
+
+   static constexpr double EWMA_ALPHA = 0.1;
+   static constexpr std::chrono::seconds EXTREMES_WINDOW{60};
+   static constexpr double EXPECTED_INTERVAL_MAX_STEP = 2.0;
+
+   SensorStatistics();
+
+   void Update(double numeric, SensorAlarmState alarmState, TimePoint timestamp);
+   void Reset();
+
+   size_t GetNumericCount() const { return m_numericCount; }
+   bool HasNumeric() const { return m_numericCount > 0; }
+   // Welford mean and sample variance over every numeric sample.
+   double GetMean() const { return m_mean; }
+   double GetVariance() const;
+   double GetStdDev() const;
+   double GetEwma() const { return m_ewma; }
+   // Extremes over numeric samples from the EXTREMES_WINDOW ending at now;
+   // NaN when none falls inside it, e.g. once a sensor has gone quiet.
+   double GetWindowMin(TimePoint now) const;
+   double GetWindowMax(TimePoint now) const;
+
+   // Samples per second, smoothed over recent inter-arrival intervals.
+   double GetUpdateRate() const;
+   // Typical gap between samples, used to detect silent sensors. Unlike the
+   // update rate, each interval's pull is capped so a single outage does not
+   // teach the sensor that long silences are normal. Zero until two samples.
+   Duration GetExpectedInterval() const;
+   // Includes the still-open interval since the last sample up to now.
+   Duration GetTimeInState(SensorAlarmState state, TimePoint now) const;
+
+ private:
+   struct WindowSample
+   {
+      TimePoint timestamp;
+      double value;
+   };
+
+   void EvictWindow(TimePoint now);
+   static double GetWindowFront(const std::deque<WindowSample> &window, TimePoint now);
+
+   size_t m_numericCount;
+   double m_mean;
+   double m_m2;
+   double m_ewma;
+   // Monotonic deques: values increase from front in m_windowMin and
+   // decrease in m_windowMax, so each front is the window's extreme.
+   std::deque<WindowSample> m_windowMin;
+   std::deque<WindowSample> m_windowMax;
+
+   size_t m_sampleCount;
+   TimePoint m_lastSample;
+   double m_meanIntervalSeconds;
+   double m_expectedIntervalSeconds;
+   SensorAlarmState m_lastState;
+   Duration m_timeInWarn;
+   Duration m_timeInFailed;
+};
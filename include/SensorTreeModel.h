@@ -1,25 +1,62 @@
 #pragma once
-#include "Node.h"
+#include "SensorDataStore.h"
 
 #include <wx/dataview.h>
 
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
 #include <vector>
 
-// Custom data model for the hierarchical sensor tree
+// wxDataViewModel adapter over a SensorDataStore. The store may be fed from
+// another thread; the view only learns about it through PublishChanges(),
+// which runs on the UI thread and turns the store's change set into row
+// notifications for the rows the view actually shows.
 class SensorTreeModel : public wxDataViewModel
 {
  public:
-   SensorTreeModel();
+   // More than one shard lets the store apply samples on several cores once
+   // its workers are started.
+   explicit SensorTreeModel(size_t shardCount = 1);
    ~SensorTreeModel() override;
 
+   SensorDataStore &GetStore() { return m_store; }
+   const SensorDataStore &GetStore() const { return m_store; }
+   // Held by UI code that dereferences nodes outside the model's callbacks.
+   SensorDataStore::ReadLock LockStore() const { return m_store.Lock(); }
+
+   // Adds and removes rows whose visibility changed, refreshes changed rows
+   // and fires the update and alarm callbacks for everything the store changed
+   // since the last call. Returns whether there was anything to publish.
+   bool PublishChanges();
+
+   // Mutations for the UI thread; each one publishes its changes right away.
    void AddDataSample(const std::vector<std::string> &path, const DataValue &value,
        SensorThresholds thresholds,
        SensorAlarmState alarmState,
        std::chrono::steady_clock::time_point timestamp);
+   void AddDataSamples(const std::vector<SensorSample> &samples);
+   // Keeps the recorded alarm states instead of re-evaluating them.
+   void AddRecordedSamples(const std::vector<SensorSample> &samples);
+   using SensorId = SensorDataStore::SensorId;
+   SensorId RegisterSensor(const std::vector<std::string> &path, SensorThresholds thresholds = {});
+   size_t AddPackedSamples(const PackedSampleRecord *records, size_t count, std::string_view text);
+   size_t AddPackedSamples(const PackedSampleBatch &batch) { return AddPackedSamples(batch.GetRecords(), batch.Size(), batch.GetText()); }
+   bool AddDerivedSensor(const std::vector<std::string> &path,
+       const std::string &expression,
+       SensorThresholds thresholds,
+       std::string &errorMessage);
+   // Chooses the aggregate shown for a container and every container below it.
+   void SetAggregateKind(Node *node, AggregateKind kind);
    void SetLiveDataMode(bool isLiveData);
-   bool IsLiveDataMode() const { return m_isLiveDataMode; }
+   bool IsLiveDataMode() const { return m_store.IsLiveDataMode(); }
+   void SetAlarmPolicy(const AlarmPolicy &policy) { m_store.SetAlarmPolicy(policy); }
+   AlarmPolicy GetAlarmPolicy() const { return m_store.GetAlarmPolicy(); }
+   void AdvanceStaleness();
+   void Clear();
 
    void SetFilter(const wxString &filterText);
    const wxString &GetFilter() const { return m_filter; }
@@ -28,6 +65,21 @@ class SensorTreeModel : public wxDataViewModel
    bool IsNodeVisible(const Node *node) const;
    void SetExpansionQuery(std::function<bool(const Node *)> query);
 
+   // Invoked once per published change set for every sensor that changed;
+   // node is nullptr when the whole tree was cleared.
+   void SetOnSensorUpdated(std::function<void(const Node *)> callback);
+   // Invoked for every committed alarm transition, a sensor going stale and
+   // a stale sensor reporting again.
+   using AlarmTransitionCallback = std::function<void(const SensorAlarmTransition &)>;
+   void SetOnAlarmTransition(AlarmTransitionCallback callback);
+   // Incremented whenever a sensor's displayed alarm or staleness state
+   // changes, so views can skip re-filtering when nothing moved.
+   std::uint64_t GetAlarmVersion() const { return m_alarmVersion; }
+
+   // Incremented whenever nodes are created or the tree is cleared, so cached
+   // path-to-node resolutions can be validated cheaply.
+   std::uint64_t GetStructureVersion() const { return m_structureVersion; }
+
    unsigned int GetColumnCount() const override;
    wxString GetColumnType(unsigned int col) const override;
 
@@ -40,10 +92,15 @@ class SensorTreeModel : public wxDataViewModel
    bool HasContainerColumns(const wxDataViewItem &item) const override;
    unsigned int GetChildren(const wxDataViewItem &parent, wxDataViewItemArray &array) const override;
 
+   // Time elapsed columns are measured against: now when live, otherwise the
+   // newest sample of the loaded recording.
+   std::chrono::steady_clock::time_point GetReferenceTime() const { return m_store.GetReferenceTime(); }
    void RefreshElapsedTimes();
-   void Clear();
 
-   Node *FindNodeByPath(const std::vector<std::string> &path) const;
+   // Elapsed times are shown to 0.1 s, so rows are not refreshed faster.
+   static constexpr std::chrono::milliseconds ELAPSED_REFRESH_INTERVAL{100};
+
+   Node *FindNodeByPath(const std::vector<std::string> &path) const { return m_store.FindNodeByPath(path); }
 
    enum Column
    {
@@ -55,6 +112,17 @@ class SensorTreeModel : public wxDataViewModel
       COL_UPPER_CRITICAL_THRESHOLD,
       COL_ELAPSED,
       COL_UPDATE_COUNT,
+      // Configured per container node from the tree's context menu.
+      COL_AGGREGATE,
+      // Optional running statistics, hidden unless enabled in the view.
+      COL_MEAN,
+      COL_STDDEV,
+      COL_EWMA,
+      COL_WINDOW_MIN,
+      COL_WINDOW_MAX,
+      COL_UPDATE_RATE,
+      COL_TIME_IN_WARN,
+      COL_TIME_IN_FAILED,
       COL_COUNT
    };
 
@@ -62,31 +130,37 @@ class SensorTreeModel : public wxDataViewModel
    {
       size_t warningCount = 0;
       size_t failureCount = 0;
-   };
+      size_t staleCount   = 0;
 
- private:
-   struct CreatedEdge
-   {
-      Node *parent;
-      Node *child;
-      bool parentWasLeaf;
+      bool Any() const { return warningCount > 0 || failureCount > 0 || staleCount > 0; }
    };
 
+ private:
    struct VisibleSubtreeState
    {
       bool isVisible = false;
       AlarmSummary alarmSummary;
    };
 
-   Node *FindOrCreatePath(const std::vector<std::string> &path, bool &structureChanged, std::vector<CreatedEdge> &createdEdges);
-   std::vector<Node *> BuildPath(Node *node) const;
-
-   std::vector<std::unique_ptr<Node>> m_rootNodes;
+   // Brings the rows along one root-to-node path in line with the current
+   // filters. Returns whether the node stayed in the view throughout, in
+   // which case only its contents may need refreshing.
+   bool SyncRowPath(Node *node);
+   void ShowSubtree(Node *node);
+   void HideSubtree(Node *node);
+   // Re-decides every row after the filters changed; the caller resets the view.
+   void RebuildShownRows();
+
+   SensorDataStore m_store;
+   // Reused between publishes so taking changes does not allocate.
+   SensorChangeSet m_changes;
+   std::vector<Node *> m_pathScratch;
+   std::vector<Node *> m_changedRows;
    wxString m_filter;
    wxString m_filterLower;
    bool m_showAlarmedOnly = false;
-   bool m_isLiveDataMode  = true;
-   std::optional<std::chrono::steady_clock::time_point> m_elapsedReferenceTime;
+   std::optional<std::chrono::steady_clock::time_point> m_lastElapsedRefresh;
+   bool m_rowsChanged = false;
 
    Node *GetNodeFromItem(const wxDataViewItem &item) const;
    wxDataViewItem CreateItemFromNode(Node *node) const;
@@ -94,8 +168,12 @@ class SensorTreeModel : public wxDataViewModel
    bool NodeNameMatchesFilter(const Node *node) const;
    bool NodeMatchesAlarmFilter(const Node *node) const;
    VisibleSubtreeState EvaluateVisibleSubtree(const Node *node) const;
-   bool HasVisibleChildren(const Node *node) const;
+   bool HasShownChildren(const Node *node) const;
    AlarmSummary CountAlarmedDescendants(const Node *node) const;
 
    std::function<bool(const Node *)> m_isNodeExpanded;
+   std::function<void(const Node *)> m_onSensorUpdated;
+   AlarmTransitionCallback m_onAlarmTransition;
+   std::uint64_t m_structureVersion = 0;
+   std::uint64_t m_alarmVersion     = 0;
 };
\ No newline at end of file
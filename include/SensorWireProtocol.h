@@ -0,0 +1,105 @@
+#pragma once
+#include "SensorData.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Compact binary framing for sensors reporting over TCP or UDP. All integers
+// are little endian. Every frame starts with a 4-byte payload length followed
+// by a 1-byte frame type:
+//
+//    DefinePath: u32 id, u16 segment count, (u16 length, bytes) per segment,
+//                u8 threshold mask, one value per set mask bit
+//    Samples:    u32 count, then per sample u32 id, u32 age in microseconds,
+//                u8 alarm state, value
+//
+// A value is a u8 DataValue type followed by i64, f64, u8 or (u16 length,
+// bytes). A path is spelled out once per connection; samples only carry its
+// id, so a steady stream costs a few bytes per reading.
+namespace SensorWire {
+
+constexpr std::uint16_t DEFAULT_PORT   = 5555;
+constexpr std::uint32_t MAX_FRAME_SIZE = 16u * 1024u * 1024u;
+constexpr size_t FRAME_HEADER_SIZE     = 5;
+
+enum class FrameType : std::uint8_t
+{
+   DefinePath = 1,
+   Samples    = 2
+};
+
+} // namespace SensorWire
+
+class SensorWireEncoder
+{
+ public:
+   SensorWireEncoder();
+
+   void DefinePath(std::uint32_t id, const std::vector<std::string> &path, const SensorThresholds &thresholds = {});
+   // Samples accumulate into one Samples frame until Flush or TakeBuffer.
+   void AppendSample(std::uint32_t id, const DataValue &value,
+       SensorAlarmState alarmState = SensorAlarmState::Ok,
+       std::chrono::microseconds age = std::chrono::microseconds(0));
+   void Flush();
+
+   size_t GetPendingSampleCount() const { return m_sampleCount; }
+   const std::vector<std::uint8_t> &GetBuffer() const { return m_buffer; }
+   // Flushes and hands over everything encoded so far.
+   std::vector<std::uint8_t> TakeBuffer();
+   void Clear();
+
+ private:
+   size_t BeginFrame(SensorWire::FrameType type);
+   void EndFrame(size_t frameStart);
+
+   std::vector<std::uint8_t> m_buffer;
+   size_t m_samplesFrameStart;
+   std::uint32_t m_sampleCount;
+};
+
+// Per-connection decoding state. Bytes may arrive in arbitrary fragments; a
+// frame is decoded once it is complete.
+class SensorWireDecoder
+{
+ public:
+   struct Stats
+   {
+      std::uint64_t bytes        = 0;
+      std::uint64_t frames       = 0;
+      std::uint64_t samples      = 0;
+      std::uint64_t unknownPaths = 0;
+   };
+
+   SensorWireDecoder();
+
+   // Appends decoded samples to `samples`. Returns false on a malformed frame;
+   // the stream cannot be resynchronised after that and should be dropped.
+   bool Feed(const void *data, size_t size,
+       std::chrono::steady_clock::time_point receivedAt,
+       std::vector<SensorSample> &samples,
+       std::string &errorMessage);
+   void Reset();
+
+   const Stats &GetStats() const { return m_stats; }
+   size_t GetDefinedPathCount() const { return m_paths.size(); }
+
+ private:
+   struct PathDefinition
+   {
+      std::vector<std::string> path;
+      SensorThresholds thresholds;
+   };
+
+   bool DecodeFrame(const std::uint8_t *payload, size_t size,
+       std::chrono::steady_clock::time_point receivedAt,
+       std::vector<SensorSample> &samples,
+       std::string &errorMessage);
+
+   std::vector<std::uint8_t> m_pending;
+   std::unordered_map<std::uint32_t, PathDefinition> m_paths;
+   Stats m_stats;
+};
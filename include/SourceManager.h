@@ -0,0 +1,111 @@
+#pragma once
+#include "SampleSourceQueue.h"
+
+#include <wx/thread.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+enum class SampleSourceKind
+{
+   Network,
+   Replay,
+   Synthetic
+};
+
+enum class SampleSourceState
+{
+   Idle,
+   Connected,
+   Finished,
+   Failed
+};
+
+inline const char *ToString(SampleSourceKind kind)
+{
+   switch (kind) {
+      case SampleSourceKind::Network:
+         return "network";
+      case SampleSourceKind::Replay:
+         return "replay";
+      case SampleSourceKind::Synthetic:
+         return "synthetic";
+   }
+
+   return "network";
+}
+
+inline const char *ToString(SampleSourceState state)
+{
+   switch (state) {
+      case SampleSourceState::Idle:
+         return "idle";
+      case SampleSourceState::Connected:
+         return "connected";
+      case SampleSourceState::Finished:
+         return "finished";
+      case SampleSourceState::Failed:
+         return "failed";
+   }
+
+   return "idle";
+}
+
+// A producer running on its own joinable thread. Subclasses implement Entry()
+// and hand samples over through Publish(); they never touch the UI.
+class SampleSource : public wxThread
+{
+ public:
+   SampleSource(std::string name, SampleSourceKind kind, size_t queueCapacity = SampleSourceQueue::DEFAULT_CAPACITY);
+   virtual ~SampleSource() = default;
+
+   const std::string &GetName() const { return m_name; }
+   SampleSourceKind GetKind() const { return m_kind; }
+   SampleSourceState GetState() const { return m_state.load(); }
+   SampleSourceQueue &GetQueue() { return m_queue; }
+   const SampleSourceQueue &GetQueue() const { return m_queue; }
+
+ protected:
+   size_t Publish(std::vector<SensorSample> &&samples, std::chrono::milliseconds maxWait = std::chrono::milliseconds(0));
+   void SetState(SampleSourceState state) { m_state = state; }
+
+ private:
+   const std::string m_name;
+   const SampleSourceKind m_kind;
+   std::atomic<SampleSourceState> m_state;
+   SampleSourceQueue m_queue;
+};
+
+// Owns every running producer and merges their queues fairly for the model
+// thread. Sources are started and stopped from the UI thread, which is also
+// the only one reading the source list; draining may happen on any thread.
+class SourceManager
+{
+ public:
+   SourceManager();
+   ~SourceManager();
+
+   SourceManager(const SourceManager &)            = delete;
+   SourceManager &operator=(const SourceManager &) = delete;
+
+   // Starts the thread and takes ownership; returns false if it cannot run.
+   bool Start(std::unique_ptr<SampleSource> source);
+   void StopAll();
+
+   size_t Drain(size_t budget, std::vector<SensorSample> &out);
+   void ClearQueues();
+
+   size_t GetSourceCount() const { return m_sources.size(); }
+   const SampleSource &GetSource(size_t index) const { return *m_sources[index]; }
+   size_t GetConnectedCount() const;
+
+ private:
+   std::vector<std::unique_ptr<SampleSource>> m_sources;
+   // Guards the queue list and the merger against a concurrent Drain.
+   std::mutex m_drainMutex;
+   std::vector<SampleSourceQueue *> m_queues;
+   FairSampleMerger m_merger;
+};
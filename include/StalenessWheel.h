@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Node;
+
+// Hierarchical timer wheel holding one staleness deadline per armed sensor.
+// Scheduling is O(1) and each entry is cascaded at most once per level, so
+// firing is O(1) amortised however many sensors are tracked. Deadlines are
+// rounded up to whole ticks and never fire early. Rescheduling is left to the
+// caller: a sensor that keeps reporting keeps its original deadline, and when
+// that fires the caller re-arms it from the newest sample instead of touching
+// the wheel on every update.
+class StalenessWheel
+{
+ public:
+   using TimePoint = std::chrono::steady_clock::time_point;
+   using Duration  = std::chrono::steady_clock::duration;
+
+   static constexpr std::chrono::milliseconds TICK{100};
+   static constexpr size_t SLOT_BITS   = 6;
+   static constexpr size_t SLOT_COUNT  = size_t(1) << SLOT_BITS;
+   static constexpr size_t LEVEL_COUNT = 4;
+
+   StalenessWheel();
+
+   // Deadlines at or before the current tick fire on the next Advance.
+   // Entries scheduled before the first Advance wait until it fixes the
+   // wheel's starting time.
+   void Schedule(Node *node, TimePoint deadline);
+   // Moves the wheel to now and appends every node whose deadline passed.
+   // Time never runs backwards; earlier values are ignored.
+   void Advance(TimePoint now, std::vector<Node *> &expired);
+   void Clear();
+
+   size_t Size() const { return m_size; }
+   bool Empty() const { return m_size == 0; }
+
+ private:
+   struct Entry
+   {
+      Node *node;
+      std::uint64_t tick;
+   };
+
+   using Level = std::array<std::vector<Entry>, SLOT_COUNT>;
+
+   static std::uint64_t TickOf(TimePoint time, bool roundUp);
+   void Insert(const Entry &entry);
+   void ProcessTick(std::vector<Node *> &expired);
+
+   bool m_started;
+   std::vector<Entry> m_pending;
+   std::uint64_t m_currentTick;
+   size_t m_size;
+   std::array<Level, LEVEL_COUNT> m_levels;
+   std::array<size_t, LEVEL_COUNT> m_levelSizes;
+   std::vector<Entry> m_cascade;
+};
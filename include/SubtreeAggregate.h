@@ -0,0 +1,79 @@
+#pragma once
+#include "SensorData.h"
+
+#include <cstddef>
+#include <limits>
+
+enum class AggregateKind
+{
+   None,
+   Sum,
+   Mean,
+   Min,
+   Max
+};
+
+inline const char *ToString(AggregateKind kind)
+{
+   switch (kind) {
+      case AggregateKind::None:
+         return "none";
+      case AggregateKind::Sum:
+         return "sum";
+      case AggregateKind::Mean:
+         return "mean";
+      case AggregateKind::Min:
+         return "min";
+      case AggregateKind::Max:
+         return "max";
+   }
+
+   return "none";
+}
+
+// What one node's own sample adds to the aggregates of itself and every
+// ancestor.
+struct AggregateContribution
+{
+   bool hasValue          = false;
+   bool numeric           = false;
+   double value           = 0.0;
+   SensorAlarmState state = SensorAlarmState::Ok;
+   bool stale             = false;
+};
+
+// Totals over a node and all of its descendants that have values. Nodes keep
+// these up to date as samples arrive, so reading one never walks the subtree.
+struct SubtreeAggregate
+{
+   size_t numericCount = 0;
+   double sum          = 0.0;
+   double min          = std::numeric_limits<double>::infinity();
+   double max          = -std::numeric_limits<double>::infinity();
+   size_t warningCount = 0;
+   size_t failureCount = 0;
+   size_t staleCount   = 0;
+
+   bool HasNumeric() const { return numericCount > 0; }
+
+   // NaN when no numeric sensor contributes.
+   double Get(AggregateKind kind) const
+   {
+      if (!HasNumeric())
+         return std::numeric_limits<double>::quiet_NaN();
+
+      switch (kind) {
+         case AggregateKind::Sum:
+            return sum;
+         case AggregateKind::Mean:
+            return sum / static_cast<double>(numericCount);
+         case AggregateKind::Min:
+            return min;
+         case AggregateKind::Max:
+            return max;
+         case AggregateKind::None:
+            break;
+      }
+      return std::numeric_limits<double>::quiet_NaN();
+   }
+};
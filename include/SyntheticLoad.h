@@ -0,0 +1,198 @@
+#pragma once
+#include "PackedSampleBatch.h"
+#include "SensorData.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class SensorDataStore;
+
+// How a worker picks sensors and values.
+enum class WorkloadProfile
+{
+   // Every sensor in turn.
+   Uniform,
+   // Sensors drawn from a Zipf distribution, so a few carry most samples.
+   HotSensors,
+   // Every tenth round of the sensors turns into two rounds of mostly alarms.
+   AlarmStorm,
+   // Sensors start reporting a sixteenth at a time, each burst of new paths
+   // following a few rounds of the ones already present.
+   TreeGrowth,
+   // String sensors report one of many category labels instead of a status.
+   Categorical
+};
+
+inline const char *ToString(WorkloadProfile profile)
+{
+   switch (profile) {
+      case WorkloadProfile::Uniform:
+         return "uniform";
+      case WorkloadProfile::HotSensors:
+         return "hot-sensors";
+      case WorkloadProfile::AlarmStorm:
+         return "alarm-storm";
+      case WorkloadProfile::TreeGrowth:
+         return "tree-growth";
+      case WorkloadProfile::Categorical:
+         return "categorical";
+   }
+
+   return "uniform";
+}
+
+inline bool TryParseWorkloadProfile(std::string_view text, WorkloadProfile &profile)
+{
+   for (WorkloadProfile candidate : {WorkloadProfile::Uniform, WorkloadProfile::HotSensors, WorkloadProfile::AlarmStorm,
+            WorkloadProfile::TreeGrowth, WorkloadProfile::Categorical}) {
+      if (text == ToString(candidate)) {
+         profile = candidate;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+// Shape and pace of a synthetic workload. The shares are relative weights of
+// each value type. A worker's records, apart from their timestamps, depend
+// only on the config, so a seed replays the same samples on every run.
+struct SyntheticLoadConfig
+{
+   WorkloadProfile profile = WorkloadProfile::Uniform;
+   std::uint64_t seed      = 1;
+   size_t sensorCount      = 1000;
+   // Group levels above the sensors, each splitting into fanOut branches.
+   size_t depth        = 2;
+   size_t fanOut       = 10;
+   double doubleShare  = 1.0;
+   double integerShare = 1.0;
+   double stringShare  = 1.0;
+   double booleanShare = 1.0;
+   // Average over all threads; zero generates as fast as the store applies.
+   double samplesPerSecond = 1000.0;
+   // Peak rate as a multiple of the average. Each burst period opens at the
+   // peak rate and idles once its share is sent, keeping the average.
+   double burstFactor = 1.0;
+   std::chrono::milliseconds burstPeriod{1000};
+   // Fraction of samples outside their sensor's normal range.
+   double alarmRate = 0.05;
+   // Skew of WorkloadProfile::HotSensors; larger is hotter.
+   double zipfExponent = 1.1;
+   size_t threadCount  = 1;
+   size_t batchSize    = 1000;
+};
+
+// The defaults for a profile: the string-heavy mix for Categorical and a
+// quiet baseline between AlarmStorm's storms.
+SyntheticLoadConfig MakeWorkloadConfig(WorkloadProfile profile);
+
+struct SyntheticWorkload
+{
+   std::string name;
+   SyntheticLoadConfig config;
+};
+
+// Reads named workloads from a JSON object mapping each name to its settings,
+// e.g. {"hot-10k": {"profile": "hot-sensors", "seed": 7, "sensors": 10000}}.
+// Settings left out keep MakeWorkloadConfig()'s value for the profile.
+// Workloads are returned sorted by name.
+bool LoadSyntheticWorkloads(const std::string &filePath, std::vector<SyntheticWorkload> &workloads, std::string &errorMessage);
+
+// Feeds SensorDataStore::AddPackedSamples from its own worker threads. Each
+// worker owns an interleaved slice of the sensors and refills one reused
+// packed batch, so no queue, wx event or per-sample allocation sits between
+// the generator and the tree.
+class SyntheticLoadGenerator
+{
+ public:
+   struct SensorDefinition
+   {
+      std::vector<std::string> path;
+      DataValue::e_Type type;
+      SensorThresholds thresholds;
+   };
+
+   // One worker's sensors and random state; the samples depend only on the
+   // seed.
+   class Stream
+   {
+    public:
+      // `sensorIds` maps definition indices to the ids the records carry.
+      Stream(const SyntheticLoadGenerator &generator, const std::vector<std::uint32_t> &sensorIds, size_t worker, std::uint64_t seed);
+
+      // Appends the next `count` samples of the profile, stamped `timestamp`.
+      void Fill(PackedSampleBatch &batch, size_t count, std::chrono::steady_clock::time_point timestamp);
+      size_t GetSensorCount() const { return m_sensors.size(); }
+
+    private:
+      size_t NextSlot();
+      bool IsInStorm() const;
+      std::uint64_t NextRandom();
+      double NextUnit();
+
+      const SyntheticLoadGenerator &m_generator;
+      const std::vector<std::uint32_t> &m_sensorIds;
+      std::vector<size_t> m_sensors;
+      // Cumulative Zipf weights by slot, for HotSensors.
+      std::vector<double> m_hotWeights;
+      size_t m_cursor;
+      // Slots reporting so far, and when the next TreeGrowth burst is due.
+      size_t m_activeCount;
+      std::uint64_t m_nextGrowth;
+      std::uint64_t m_filled;
+      std::uint64_t m_state;
+   };
+
+   // Called on a worker's thread once each of its batches reached the store,
+   // for whoever still records or counts samples the source queues never see.
+   using BatchObserver = std::function<void(const SyntheticLoadGenerator &generator, const PackedSampleBatch &batch)>;
+
+   explicit SyntheticLoadGenerator(const SyntheticLoadConfig &config);
+   ~SyntheticLoadGenerator();
+
+   SyntheticLoadGenerator(const SyntheticLoadGenerator &)            = delete;
+   SyntheticLoadGenerator &operator=(const SyntheticLoadGenerator &) = delete;
+
+   const SyntheticLoadConfig &GetConfig() const { return m_config; }
+   const std::vector<SensorDefinition> &GetSensors() const { return m_sensors; }
+   // The configured count, limited to one thread per sensor.
+   size_t GetThreadCount() const { return m_threadCount; }
+
+   // The definition behind a record's sensor id, or nullptr for an id this
+   // generator did not register. Valid from Start() on.
+   const SensorDefinition *FindSensor(std::uint32_t sensorId) const;
+
+   // Set before Start().
+   void SetBatchObserver(BatchObserver observer) { m_batchObserver = std::move(observer); }
+   // Registers the sensors with the store and starts the workers. The store
+   // must outlive Stop().
+   void Start(SensorDataStore &store);
+   void Stop();
+   bool IsRunning() const { return !m_threads.empty(); }
+   std::uint64_t GetGeneratedCount() const { return m_generatedCount.load(); }
+
+   // When a worker's sampleIndex-th sample is due, measured from its start.
+   std::chrono::duration<double> GetDueOffset(std::uint64_t sampleIndex) const;
+
+ private:
+   void Run(size_t worker, SensorDataStore &store, std::uint64_t seed);
+
+   const SyntheticLoadConfig m_config;
+   const std::vector<SensorDefinition> m_sensors;
+   const size_t m_threadCount;
+   std::vector<std::uint32_t> m_sensorIds;
+   std::unordered_map<std::uint32_t, size_t> m_sensorsById;
+   BatchObserver m_batchObserver;
+   std::vector<std::thread> m_threads;
+   std::atomic<bool> m_stopRequested;
+   std::atomic<std::uint64_t> m_generatedCount;
+};
@@ -0,0 +1,162 @@
+#include "AlarmEvaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+int Severity(SensorAlarmState state)
+{
+   return static_cast<int>(state);
+}
+
+bool IsNumericThreshold(const std::optional<DataValue> &threshold)
+{
+   return threshold.has_value() && threshold->IsNumeric();
+}
+
+} // namespace
+
+SensorAlarmState ClassifyNumericAlarm(double numeric, const SensorThresholds &thresholds, double margin)
+{
+   if (IsNumericThreshold(thresholds.lowerCritical) && numeric < thresholds.lowerCritical->GetNumeric() + margin)
+      return SensorAlarmState::Failed;
+   if (IsNumericThreshold(thresholds.upperCritical) && numeric > thresholds.upperCritical->GetNumeric() - margin)
+      return SensorAlarmState::Failed;
+   if (IsNumericThreshold(thresholds.lowerNonCritical) && numeric < thresholds.lowerNonCritical->GetNumeric() + margin)
+      return SensorAlarmState::Warn;
+   if (IsNumericThreshold(thresholds.upperNonCritical) && numeric > thresholds.upperNonCritical->GetNumeric() - margin)
+      return SensorAlarmState::Warn;
+   return SensorAlarmState::Ok;
+}
+
+AlarmEvaluator::AlarmEvaluator() :
+    m_initialized(false),
+    m_state(SensorAlarmState::Ok),
+    m_hasPending(false),
+    m_pending(SensorAlarmState::Ok),
+    m_pendingSince(),
+    m_tokens(0.0),
+    m_lastRefill(),
+    m_transitionCount(0),
+    m_suppressedCount(0)
+{
+}
+
+SensorAlarmState AlarmEvaluator::Evaluate(const DataValue &value,
+    const SensorThresholds &thresholds,
+    SensorAlarmState reported,
+    TimePoint timestamp,
+    const AlarmPolicy &policy)
+{
+   SensorAlarmState target = reported;
+
+   const bool hasNumericThresholds = IsNumericThreshold(thresholds.lowerCritical) || IsNumericThreshold(thresholds.lowerNonCritical) ||
+                                     IsNumericThreshold(thresholds.upperNonCritical) || IsNumericThreshold(thresholds.upperCritical);
+   if (value.IsNumeric() && hasNumericThresholds) {
+      const double numeric = value.GetNumeric();
+      target               = ClassifyNumericAlarm(numeric, thresholds);
+      if (m_initialized && Severity(target) < Severity(m_state)) {
+         const SensorAlarmState relaxed = ClassifyNumericAlarm(numeric, thresholds, HysteresisMargin(thresholds, policy));
+         target                         = Severity(relaxed) < Severity(m_state) ? relaxed : m_state;
+      }
+   }
+
+   if (!m_initialized) {
+      m_initialized = true;
+      m_state       = target;
+      m_tokens      = static_cast<double>(policy.transitionBurst);
+      m_lastRefill  = timestamp;
+      return m_state;
+   }
+
+   RefillTokens(timestamp, policy);
+
+   if (target == m_state) {
+      if (m_hasPending)
+         ++m_suppressedCount;
+      m_hasPending = false;
+      return m_state;
+   }
+
+   // Escalating from Warn to Failed while a Warn was pending keeps the
+   // original dwell start; reversing direction restarts it.
+   const bool sameDirection = m_hasPending && (Severity(m_pending) > Severity(m_state)) == (Severity(target) > Severity(m_state));
+   if (!sameDirection)
+      m_pendingSince = timestamp;
+   m_hasPending = true;
+   m_pending    = target;
+
+   TryCommit(timestamp, policy);
+   return m_state;
+}
+
+bool AlarmEvaluator::CommitPending(TimePoint now, const AlarmPolicy &policy)
+{
+   if (!m_hasPending)
+      return false;
+
+   RefillTokens(now, policy);
+   return TryCommit(now, policy);
+}
+
+bool AlarmEvaluator::GetPendingDeadline(const AlarmPolicy &policy, TimePoint &deadline) const
+{
+   if (!m_hasPending || policy.transitionBurst == 0)
+      return false;
+
+   deadline = m_pendingSince + policy.minimumDwell;
+
+   const double refill = std::chrono::duration<double>(policy.transitionRefill).count();
+   if (m_tokens < 1.0 && refill > 0.0) {
+      const auto tokenDue = m_lastRefill + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                               std::chrono::duration<double>((1.0 - m_tokens) * refill));
+      deadline = std::max(deadline, tokenDue);
+   }
+   return true;
+}
+
+bool AlarmEvaluator::TryCommit(TimePoint timestamp, const AlarmPolicy &policy)
+{
+   if (timestamp - m_pendingSince < policy.minimumDwell || m_tokens < 1.0)
+      return false;
+
+   m_tokens -= 1.0;
+
+   m_state      = m_pending;
+   m_hasPending = false;
+   ++m_transitionCount;
+   return true;
+}
+
+double AlarmEvaluator::HysteresisMargin(const SensorThresholds &thresholds, const AlarmPolicy &policy)
+{
+   double lowest  = std::numeric_limits<double>::infinity();
+   double highest = -std::numeric_limits<double>::infinity();
+   size_t count   = 0;
+   for (const std::optional<DataValue> *threshold :
+       {&thresholds.lowerCritical, &thresholds.lowerNonCritical, &thresholds.upperNonCritical, &thresholds.upperCritical}) {
+      if (!IsNumericThreshold(*threshold))
+         continue;
+      lowest  = std::min(lowest, (*threshold)->GetNumeric());
+      highest = std::max(highest, (*threshold)->GetNumeric());
+      ++count;
+   }
+
+   // A lone limit has no span, so its own magnitude sets the scale.
+   const double span = count > 1 ? highest - lowest : std::abs(highest);
+   return policy.hysteresisFraction * span;
+}
+
+void AlarmEvaluator::RefillTokens(TimePoint timestamp, const AlarmPolicy &policy)
+{
+   if (timestamp <= m_lastRefill)
+      return;
+
+   const double capacity = static_cast<double>(policy.transitionBurst);
+   const double refill   = std::chrono::duration<double>(policy.transitionRefill).count();
+   const double elapsed  = std::chrono::duration<double>(timestamp - m_lastRefill).count();
+   m_tokens              = refill > 0.0 ? std::min(capacity, m_tokens + elapsed / refill) : capacity;
+   m_lastRefill          = timestamp;
+}
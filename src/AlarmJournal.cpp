@@ -0,0 +1,219 @@
+#include "AlarmJournal.h"
+
+#include "PathUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+AlarmJournal::AlarmJournal() :
+    m_entries(),
+    m_blocks(),
+    m_blockMaxPrefix(),
+    m_sensorPaths(),
+    m_sensorsByPath(),
+    m_entriesBySensor(),
+    m_texts(),
+    m_textIds()
+{
+}
+
+size_t AlarmJournal::Append(const std::vector<std::string> &path,
+    AlarmEventKind kind,
+    SensorAlarmState previous,
+    SensorAlarmState state,
+    const DataValue &value,
+    TimePoint timestamp)
+{
+   Entry entry;
+   entry.timestamp = timestamp;
+   entry.value     = value.IsNumeric() ? value.GetNumeric() : std::numeric_limits<double>::quiet_NaN();
+   entry.textId    = value.IsNumeric() ? NO_TEXT : InternText(value.GetDisplayString());
+   entry.sensorId  = InternSensor(PathUtils::JoinPath(path));
+   entry.kind      = kind;
+   entry.previous  = previous;
+   entry.state     = state;
+
+   const size_t index = m_entries.size();
+   m_entries.push_back(entry);
+
+   // Stale events are stamped with the store's clock and state changes with
+   // sample times, so a sensor's events can arrive slightly out of order.
+   std::vector<size_t> &positions = m_entriesBySensor[entry.sensorId];
+   if (positions.empty() || m_entries[positions.back()].timestamp <= timestamp) {
+      positions.push_back(index);
+   } else {
+      positions.insert(std::upper_bound(positions.begin(), positions.end(), timestamp,
+                           [this](const TimePoint &time, size_t position) { return time < m_entries[position].timestamp; }),
+          index);
+   }
+
+   if (index % BLOCK_SIZE == 0) {
+      m_blocks.push_back({timestamp, timestamp});
+      m_blockMaxPrefix.push_back(m_blockMaxPrefix.empty() ? timestamp : std::max(m_blockMaxPrefix.back(), timestamp));
+   } else {
+      Block &block  = m_blocks.back();
+      block.minTime = std::min(block.minTime, timestamp);
+      block.maxTime = std::max(block.maxTime, timestamp);
+      m_blockMaxPrefix.back() = std::max(m_blockMaxPrefix.back(), timestamp);
+   }
+
+   return index;
+}
+
+void AlarmJournal::Clear()
+{
+   m_entries.clear();
+   m_blocks.clear();
+   m_blockMaxPrefix.clear();
+   m_sensorPaths.clear();
+   m_sensorsByPath.clear();
+   m_entriesBySensor.clear();
+   m_texts.clear();
+   m_textIds.clear();
+}
+
+std::string AlarmJournal::GetValueText(const Entry &entry) const
+{
+   if (entry.textId != NO_TEXT)
+      return m_texts[entry.textId];
+   return DataValue(entry.value).GetDisplayString();
+}
+
+std::vector<size_t> AlarmJournal::Run(const Query &query) const
+{
+   if (query.limit == 0)
+      return {};
+
+   if (query.pathPrefix.empty())
+      return RunByTime(query);
+   return RunBySensor(ResolveSensors(query.pathPrefix), query);
+}
+
+std::uint32_t AlarmJournal::InternSensor(const std::string &path)
+{
+   auto it = m_sensorsByPath.find(path);
+   if (it != m_sensorsByPath.end())
+      return it->second;
+
+   const std::uint32_t id = static_cast<std::uint32_t>(m_sensorPaths.size());
+   m_sensorPaths.push_back(path);
+   m_sensorsByPath.emplace(path, id);
+   m_entriesBySensor.emplace_back();
+   return id;
+}
+
+std::uint32_t AlarmJournal::InternText(const std::string &text)
+{
+   auto it = m_textIds.find(text);
+   if (it != m_textIds.end())
+      return it->second;
+
+   const std::uint32_t id = static_cast<std::uint32_t>(m_texts.size());
+   m_texts.push_back(text);
+   m_textIds.emplace(text, id);
+   return id;
+}
+
+bool AlarmJournal::Matches(const Entry &entry, const Query &query) const
+{
+   if (query.from && entry.timestamp < *query.from)
+      return false;
+   if (query.to && entry.timestamp > *query.to)
+      return false;
+   if (query.kind && entry.kind != *query.kind)
+      return false;
+   if (query.state && (entry.kind != AlarmEventKind::StateChanged || entry.state != *query.state))
+      return false;
+   return true;
+}
+
+std::vector<std::uint32_t> AlarmJournal::ResolveSensors(const std::vector<std::string> &pathPrefix) const
+{
+   // Every path starting with "prefix/" sorts into one contiguous run of the
+   // map, so a subtree is one range lookup. Keys such as "Category3 b" may
+   // sort between "Category3" and that run, but never inside it.
+   const std::string prefix = PathUtils::JoinPath(pathPrefix);
+   const std::string under  = prefix + "/";
+
+   std::vector<std::uint32_t> sensors;
+   auto exact = m_sensorsByPath.find(prefix);
+   if (exact != m_sensorsByPath.end())
+      sensors.push_back(exact->second);
+
+   for (auto it = m_sensorsByPath.lower_bound(under); it != m_sensorsByPath.end(); ++it) {
+      if (it->first.compare(0, under.size(), under) != 0)
+         break;
+      sensors.push_back(it->second);
+   }
+   return sensors;
+}
+
+std::vector<size_t> AlarmJournal::RunBySensor(const std::vector<std::uint32_t> &sensors, const Query &query) const
+{
+   std::vector<size_t> matches;
+   for (std::uint32_t sensor : sensors) {
+      const std::vector<size_t> &positions = m_entriesBySensor[sensor];
+
+      // Each sensor's positions are kept in time order, so both ends of the
+      // window are binary searches. Only the newest `limit` of each sensor
+      // can survive the final cut.
+      auto begin = positions.begin();
+      auto end   = positions.end();
+      if (query.from) {
+         begin = std::lower_bound(positions.begin(), positions.end(), *query.from,
+             [this](size_t index, const TimePoint &time) { return m_entries[index].timestamp < time; });
+      }
+      if (query.to) {
+         end = std::upper_bound(begin, positions.end(), *query.to,
+             [this](const TimePoint &time, size_t index) { return time < m_entries[index].timestamp; });
+      }
+
+      size_t kept = 0;
+      for (auto it = end; it != begin && kept < query.limit;) {
+         --it;
+         const Entry &entry = m_entries[*it];
+         if (!Matches(entry, query))
+            continue;
+         matches.push_back(*it);
+         ++kept;
+      }
+   }
+
+   std::sort(matches.begin(), matches.end());
+   if (matches.size() > query.limit)
+      matches.erase(matches.begin(), matches.end() - static_cast<std::ptrdiff_t>(query.limit));
+   return matches;
+}
+
+std::vector<size_t> AlarmJournal::RunByTime(const Query &query) const
+{
+   std::vector<size_t> matches;
+   if (m_entries.empty())
+      return matches;
+
+   // Blocks before this one end before the window starts.
+   size_t firstBlock = 0;
+   if (query.from) {
+      firstBlock = static_cast<size_t>(std::lower_bound(m_blockMaxPrefix.begin(), m_blockMaxPrefix.end(), *query.from) -
+                                       m_blockMaxPrefix.begin());
+   }
+
+   // Walk newest to oldest so a limit stops the search early.
+   for (size_t block = m_blocks.size(); block-- > firstBlock && matches.size() < query.limit;) {
+      if (query.from && m_blocks[block].maxTime < *query.from)
+         continue;
+      if (query.to && m_blocks[block].minTime > *query.to)
+         continue;
+
+      const size_t begin = block * BLOCK_SIZE;
+      const size_t end   = std::min(m_entries.size(), begin + BLOCK_SIZE);
+      for (size_t index = end; index-- > begin && matches.size() < query.limit;) {
+         if (Matches(m_entries[index], query))
+            matches.push_back(index);
+      }
+   }
+
+   std::reverse(matches.begin(), matches.end());
+   return matches;
+}
@@ -0,0 +1,229 @@
+#include "AlarmJournalPanel.h"
+
+#include "PathUtils.h"
+#include "SensorTreeModel.h"
+
+#include <iterator>
+#include <optional>
+
+namespace {
+
+struct EventFilter
+{
+   const char *label;
+   std::optional<AlarmEventKind> kind;
+   std::optional<SensorAlarmState> state;
+};
+
+const EventFilter EVENT_FILTERS[] = {
+    {"All events", std::nullopt, std::nullopt},
+    {"Entered failed", AlarmEventKind::StateChanged, SensorAlarmState::Failed},
+    {"Entered warn", AlarmEventKind::StateChanged, SensorAlarmState::Warn},
+    {"Returned to ok", AlarmEventKind::StateChanged, SensorAlarmState::Ok},
+    {"Went stale", AlarmEventKind::WentStale, std::nullopt},
+    {"Recovered", AlarmEventKind::Recovered, std::nullopt},
+};
+
+struct RangeFilter
+{
+   const char *label;
+   std::optional<std::chrono::seconds> span;
+};
+
+const RangeFilter RANGE_FILTERS[] = {
+    {"Last 5 minutes", std::chrono::minutes(5)},
+    {"Last hour", std::chrono::hours(1)},
+    {"Last 24 hours", std::chrono::hours(24)},
+    {"All time", std::nullopt},
+};
+
+wxString DescribeTransition(const AlarmJournal::Entry &entry)
+{
+   switch (entry.kind) {
+      case AlarmEventKind::StateChanged:
+         return wxString::Format("%s -> %s", ToString(entry.previous), ToString(entry.state));
+      case AlarmEventKind::WentStale:
+         return wxString::Format("stale (%s)", ToString(entry.state));
+      case AlarmEventKind::Recovered:
+         return "recovered";
+   }
+
+   return wxString();
+}
+
+} // namespace
+
+AlarmJournalPanel::EventList::EventList(AlarmJournalPanel *owner) :
+    wxListCtrl(owner, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxLC_REPORT | wxLC_VIRTUAL | wxLC_HRULES),
+    m_owner(owner)
+{
+   AppendColumn("Age (s)", wxLIST_FORMAT_RIGHT, 80);
+   AppendColumn("Sensor", wxLIST_FORMAT_LEFT, 320);
+   AppendColumn("Transition", wxLIST_FORMAT_LEFT, 120);
+   AppendColumn("Value", wxLIST_FORMAT_RIGHT, 100);
+}
+
+wxString AlarmJournalPanel::EventList::OnGetItemText(long item, long column) const
+{
+   return m_owner->FormatCell(item, column);
+}
+
+AlarmJournalPanel::AlarmJournalPanel(wxWindow *parent, const AlarmJournal &journal, const SensorTreeModel *model) :
+    wxPanel(parent, wxID_ANY),
+    m_journal(journal),
+    m_model(model),
+    m_list(nullptr),
+    m_prefixCtrl(nullptr),
+    m_eventChoice(nullptr),
+    m_rangeChoice(nullptr),
+    m_countLabel(nullptr),
+    m_filtered(false),
+    m_results(),
+    m_syncedSize(0),
+    m_referenceTime()
+{
+   m_prefixCtrl = new wxTextCtrl(this, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxTE_PROCESS_ENTER);
+   m_prefixCtrl->SetHint("Subtree, e.g. Category3/Rack1");
+
+   m_eventChoice = new wxChoice(this, wxID_ANY);
+   for (const EventFilter &filter : EVENT_FILTERS)
+      m_eventChoice->Append(filter.label);
+   m_eventChoice->SetSelection(0);
+
+   m_rangeChoice = new wxChoice(this, wxID_ANY);
+   for (const RangeFilter &filter : RANGE_FILTERS)
+      m_rangeChoice->Append(filter.label);
+   m_rangeChoice->SetSelection(static_cast<int>(std::size(RANGE_FILTERS)) - 1);
+
+   m_countLabel = new wxStaticText(this, wxID_ANY, wxEmptyString);
+   m_list       = new EventList(this);
+
+   wxBoxSizer *filterSizer = new wxBoxSizer(wxHORIZONTAL);
+   filterSizer->Add(m_prefixCtrl, 1, wxEXPAND);
+   filterSizer->Add(m_eventChoice, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, 8);
+   filterSizer->Add(m_rangeChoice, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, 8);
+   filterSizer->Add(m_countLabel, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, 8);
+
+   wxBoxSizer *sizer = new wxBoxSizer(wxVERTICAL);
+   sizer->Add(filterSizer, 0, wxEXPAND | wxALL, 5);
+   sizer->Add(m_list, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 5);
+   SetSizer(sizer);
+
+   m_prefixCtrl->Bind(wxEVT_TEXT_ENTER, &AlarmJournalPanel::OnFilterChanged, this);
+   m_eventChoice->Bind(wxEVT_CHOICE, &AlarmJournalPanel::OnFilterChanged, this);
+   m_rangeChoice->Bind(wxEVT_CHOICE, &AlarmJournalPanel::OnFilterChanged, this);
+
+   UpdateRowCount();
+}
+
+void AlarmJournalPanel::SyncWithJournal()
+{
+   const auto referenceTime = m_model ? m_model->GetReferenceTime() : std::chrono::steady_clock::now();
+
+   // Ages and time windows move even when nothing new arrives.
+   const bool grew = m_journal.Size() != m_syncedSize;
+   const bool aged = referenceTime - m_referenceTime >= WINDOW_REFRESH_INTERVAL;
+   if (!grew && !aged)
+      return;
+
+   m_referenceTime = referenceTime;
+   if (m_filtered)
+      RunQuery();
+   UpdateRowCount();
+}
+
+void AlarmJournalPanel::Reset()
+{
+   m_results.clear();
+   m_syncedSize = 0;
+   UpdateRowCount();
+}
+
+bool AlarmJournalPanel::HasFilter() const
+{
+   const AlarmJournal::Query query = BuildQuery();
+   return !query.pathPrefix.empty() || query.from || query.kind || query.state;
+}
+
+AlarmJournal::Query AlarmJournalPanel::BuildQuery() const
+{
+   AlarmJournal::Query query;
+   query.pathPrefix = PathUtils::SplitPath(PathUtils::ToUtf8(m_prefixCtrl->GetValue()));
+   query.limit      = MAX_QUERY_RESULTS;
+
+   const int event = m_eventChoice->GetSelection();
+   if (event != wxNOT_FOUND) {
+      query.kind  = EVENT_FILTERS[event].kind;
+      query.state = EVENT_FILTERS[event].state;
+   }
+
+   const int range = m_rangeChoice->GetSelection();
+   if (range != wxNOT_FOUND && RANGE_FILTERS[range].span)
+      query.from = m_referenceTime - *RANGE_FILTERS[range].span;
+
+   return query;
+}
+
+void AlarmJournalPanel::RunQuery()
+{
+   m_results = m_journal.Run(BuildQuery());
+}
+
+void AlarmJournalPanel::UpdateRowCount()
+{
+   m_syncedSize = m_journal.Size();
+
+   const size_t rows = GetRowCount();
+   m_list->SetItemCount(static_cast<long>(rows));
+   m_list->Refresh();
+
+   if (m_filtered && rows == MAX_QUERY_RESULTS) {
+      m_countLabel->SetLabel(wxString::Format("newest %zu events", rows));
+   } else {
+      m_countLabel->SetLabel(wxString::Format("%zu events", rows));
+   }
+   Layout();
+}
+
+size_t AlarmJournalPanel::GetRowCount() const
+{
+   return m_filtered ? m_results.size() : m_syncedSize;
+}
+
+size_t AlarmJournalPanel::EntryForRow(long row) const
+{
+   const size_t offset = static_cast<size_t>(row);
+   if (m_filtered)
+      return m_results[m_results.size() - 1 - offset];
+   return m_syncedSize - 1 - offset;
+}
+
+wxString AlarmJournalPanel::FormatCell(long row, long column) const
+{
+   if (row < 0 || static_cast<size_t>(row) >= GetRowCount())
+      return wxString();
+
+   const AlarmJournal::Entry &entry = m_journal.GetEntry(EntryForRow(row));
+   switch (column) {
+      case COL_AGE:
+         return wxString::Format("%.1f", std::chrono::duration<double>(m_referenceTime - entry.timestamp).count());
+      case COL_SENSOR:
+         return wxString::FromUTF8(m_journal.GetSensorPath(entry.sensorId).c_str());
+      case COL_TRANSITION:
+         return DescribeTransition(entry);
+      case COL_VALUE:
+         return wxString::FromUTF8(m_journal.GetValueText(entry).c_str());
+      default:
+         return wxString();
+   }
+}
+
+void AlarmJournalPanel::OnFilterChanged(wxCommandEvent &WXUNUSED(event))
+{
+   m_referenceTime = m_model ? m_model->GetReferenceTime() : std::chrono::steady_clock::now();
+   m_filtered      = HasFilter();
+   m_results.clear();
+   if (m_filtered)
+      RunQuery();
+   UpdateRowCount();
+}
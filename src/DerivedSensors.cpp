@@ -0,0 +1,496 @@
+#include "DerivedSensors.h"
+
+#include "PathUtils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <utility>
+
+class DerivedExpression::Parser
+{
+ public:
+   Parser(const std::string &text, DerivedExpression &expression) :
+       m_text(text),
+       m_position(0),
+       m_nesting(0),
+       m_expression(expression),
+       m_slots(),
+       m_error()
+   {
+   }
+
+   bool Parse(std::string &errorMessage)
+   {
+      ParseSum();
+      SkipSpace();
+      if (m_error.empty() && m_position < m_text.size())
+         Fail("unexpected '" + std::string(1, m_text[m_position]) + "'");
+
+      if (!m_error.empty()) {
+         errorMessage = m_error + " at column " + std::to_string(m_position + 1);
+         return false;
+      }
+      return true;
+   }
+
+ private:
+   void SkipSpace()
+   {
+      while (m_position < m_text.size() && std::isspace(static_cast<unsigned char>(m_text[m_position])))
+         ++m_position;
+   }
+
+   bool Accept(char token)
+   {
+      SkipSpace();
+      if (m_position < m_text.size() && m_text[m_position] == token) {
+         ++m_position;
+         return true;
+      }
+      return false;
+   }
+
+   void Expect(char token)
+   {
+      if (!Accept(token))
+         Fail(std::string("expected '") + token + "'");
+   }
+
+   void Fail(const std::string &message)
+   {
+      if (m_error.empty())
+         m_error = message;
+   }
+
+   void ParseSum()
+   {
+      ParseProduct();
+      while (m_error.empty()) {
+         if (Accept('+')) {
+            ParseProduct();
+            EmitBinary(OpCode::Add);
+         } else if (Accept('-')) {
+            ParseProduct();
+            EmitBinary(OpCode::Subtract);
+         } else {
+            break;
+         }
+      }
+   }
+
+   void ParseProduct()
+   {
+      ParseUnary();
+      while (m_error.empty()) {
+         if (Accept('*')) {
+            ParseUnary();
+            EmitBinary(OpCode::Multiply);
+         } else if (Accept('/')) {
+            ParseUnary();
+            EmitBinary(OpCode::Divide);
+         } else {
+            break;
+         }
+      }
+   }
+
+   void ParseUnary()
+   {
+      // Every level of nesting passes through here; bound the recursion.
+      if (++m_nesting > MAX_STACK_DEPTH) {
+         Fail("expression nests too deeply");
+      } else if (Accept('-')) {
+         ParseUnary();
+         EmitUnary(OpCode::Negate);
+      } else if (Accept('+')) {
+         ParseUnary();
+      } else {
+         ParsePrimary();
+      }
+      --m_nesting;
+   }
+
+   void ParsePrimary()
+   {
+      if (!m_error.empty())
+         return;
+
+      SkipSpace();
+      if (m_position >= m_text.size()) {
+         Fail("unexpected end of expression");
+         return;
+      }
+
+      const char next = m_text[m_position];
+      if (next == '(') {
+         ++m_position;
+         ParseSum();
+         Expect(')');
+      } else if (next == '{') {
+         ParseInput();
+      } else if (std::isdigit(static_cast<unsigned char>(next)) || next == '.') {
+         ParseNumber();
+      } else if (std::isalpha(static_cast<unsigned char>(next))) {
+         ParseCall();
+      } else {
+         Fail("unexpected '" + std::string(1, next) + "'");
+      }
+   }
+
+   void ParseInput()
+   {
+      ++m_position;
+      const size_t close = m_text.find('}', m_position);
+      if (close == std::string::npos) {
+         Fail("unterminated sensor path");
+         return;
+      }
+
+      std::vector<std::string> path = PathUtils::SplitPath(m_text.substr(m_position, close - m_position));
+      for (std::string &segment : path) {
+         const size_t first = segment.find_first_not_of(' ');
+         const size_t last  = segment.find_last_not_of(' ');
+         segment            = first == std::string::npos ? std::string() : segment.substr(first, last - first + 1);
+      }
+      path.erase(std::remove(path.begin(), path.end(), std::string()), path.end());
+      if (path.empty()) {
+         Fail("empty sensor path");
+         return;
+      }
+      m_position = close + 1;
+
+      // Repeated references share one input slot.
+      auto it = m_slots.find(path);
+      if (it == m_slots.end()) {
+         it = m_slots.emplace(path, static_cast<std::uint32_t>(m_expression.m_inputs.size())).first;
+         m_expression.m_inputs.push_back(path);
+      }
+      m_expression.m_code.push_back({OpCode::PushInput, it->second, 0.0});
+   }
+
+   void ParseNumber()
+   {
+      const char *begin = m_text.c_str() + m_position;
+      char *end         = nullptr;
+      const double value = std::strtod(begin, &end);
+      if (end == begin) {
+         Fail("invalid number");
+         return;
+      }
+      m_position += static_cast<size_t>(end - begin);
+      m_expression.m_code.push_back({OpCode::PushConstant, 0, value});
+   }
+
+   void ParseCall()
+   {
+      const size_t start = m_position;
+      while (m_position < m_text.size() && std::isalnum(static_cast<unsigned char>(m_text[m_position])))
+         ++m_position;
+      const std::string name = m_text.substr(start, m_position - start);
+
+      OpCode op;
+      size_t arity = 1;
+      if (name == "abs") {
+         op = OpCode::Abs;
+      } else if (name == "sqrt") {
+         op = OpCode::Sqrt;
+      } else if (name == "min") {
+         op    = OpCode::Min;
+         arity = 2;
+      } else if (name == "max") {
+         op    = OpCode::Max;
+         arity = 2;
+      } else {
+         m_position = start;
+         Fail("unknown function '" + name + "'");
+         return;
+      }
+
+      Expect('(');
+      ParseSum();
+      if (arity == 2) {
+         Expect(',');
+         ParseSum();
+      }
+      Expect(')');
+
+      if (arity == 2) {
+         EmitBinary(op);
+      } else {
+         EmitUnary(op);
+      }
+   }
+
+   void EmitUnary(OpCode op)
+   {
+      std::vector<Instruction> &code = m_expression.m_code;
+      if (!m_error.empty() || code.empty())
+         return;
+
+      if (code.back().op == OpCode::PushConstant) {
+         const double operand = code.back().constant;
+         code.back().constant = Apply(op, operand, 0.0);
+         return;
+      }
+      code.push_back({op, 0, 0.0});
+   }
+
+   void EmitBinary(OpCode op)
+   {
+      std::vector<Instruction> &code = m_expression.m_code;
+      if (!m_error.empty() || code.size() < 2)
+         return;
+
+      const Instruction &left  = code[code.size() - 2];
+      const Instruction &right = code.back();
+      if (left.op == OpCode::PushConstant && right.op == OpCode::PushConstant) {
+         const double folded = Apply(op, left.constant, right.constant);
+         code.pop_back();
+         code.back().constant = folded;
+         return;
+      }
+      code.push_back({op, 0, 0.0});
+   }
+
+   const std::string &m_text;
+   size_t m_position;
+   size_t m_nesting;
+   DerivedExpression &m_expression;
+   std::map<std::vector<std::string>, std::uint32_t> m_slots;
+   std::string m_error;
+};
+
+DerivedExpression::DerivedExpression() :
+    m_text(),
+    m_code(),
+    m_inputs()
+{
+}
+
+bool DerivedExpression::Compile(const std::string &text, DerivedExpression &expression, std::string &errorMessage)
+{
+   DerivedExpression compiled;
+   compiled.m_text = text;
+
+   Parser parser(text, compiled);
+   if (!parser.Parse(errorMessage))
+      return false;
+
+   // Evaluate runs on a fixed stack, so bound its depth up front.
+   size_t depth    = 0;
+   size_t maxDepth = 0;
+   for (const Instruction &instruction : compiled.m_code) {
+      switch (instruction.op) {
+         case OpCode::PushConstant:
+         case OpCode::PushInput:
+            maxDepth = std::max(maxDepth, ++depth);
+            break;
+         case OpCode::Negate:
+         case OpCode::Abs:
+         case OpCode::Sqrt:
+            break;
+         default:
+            --depth;
+            break;
+      }
+   }
+   if (maxDepth > MAX_STACK_DEPTH) {
+      errorMessage = "expression nests too deeply";
+      return false;
+   }
+
+   expression = std::move(compiled);
+   return true;
+}
+
+double DerivedExpression::Apply(OpCode op, double a, double b)
+{
+   switch (op) {
+      case OpCode::Add:
+         return a + b;
+      case OpCode::Subtract:
+         return a - b;
+      case OpCode::Multiply:
+         return a * b;
+      case OpCode::Divide:
+         return a / b;
+      case OpCode::Negate:
+         return -a;
+      case OpCode::Abs:
+         return std::abs(a);
+      case OpCode::Sqrt:
+         return std::sqrt(a);
+      case OpCode::Min:
+         return std::min(a, b);
+      case OpCode::Max:
+         return std::max(a, b);
+      case OpCode::PushConstant:
+      case OpCode::PushInput:
+         break;
+   }
+   return std::numeric_limits<double>::quiet_NaN();
+}
+
+double DerivedExpression::Evaluate(const double *inputs) const
+{
+   double stack[MAX_STACK_DEPTH];
+   size_t top = 0;
+
+   for (const Instruction &instruction : m_code) {
+      switch (instruction.op) {
+         case OpCode::PushConstant:
+            stack[top++] = instruction.constant;
+            break;
+         case OpCode::PushInput:
+            stack[top++] = inputs[instruction.input];
+            break;
+         case OpCode::Negate:
+         case OpCode::Abs:
+         case OpCode::Sqrt:
+            stack[top - 1] = Apply(instruction.op, stack[top - 1], 0.0);
+            break;
+         default:
+            --top;
+            stack[top - 1] = Apply(instruction.op, stack[top - 1], stack[top]);
+            break;
+      }
+   }
+
+   return top == 1 ? stack[0] : std::numeric_limits<double>::quiet_NaN();
+}
+
+DerivedSensorSet::DerivedSensorSet() :
+    m_definitions(),
+    m_outputKeys(),
+    m_inputStates(),
+    m_bindingsByInput(),
+    m_keyBuffer()
+{
+}
+
+bool DerivedSensorSet::Add(const std::vector<std::string> &outputPath,
+    const std::string &expressionText,
+    SensorThresholds thresholds,
+    std::string &errorMessage)
+{
+   if (outputPath.empty()) {
+      errorMessage = "The derived sensor needs a path.";
+      return false;
+   }
+
+   const std::string outputKey = JoinKey(outputPath);
+   if (std::find(m_outputKeys.begin(), m_outputKeys.end(), outputKey) != m_outputKeys.end()) {
+      errorMessage = "A derived sensor named " + outputKey + " already exists.";
+      return false;
+   }
+
+   DerivedExpression expression;
+   if (!DerivedExpression::Compile(expressionText, expression, errorMessage))
+      return false;
+
+   std::vector<std::string> inputKeys;
+   for (const std::vector<std::string> &input : expression.GetInputs())
+      inputKeys.push_back(JoinKey(input));
+   if (FeedsAny(outputKey, inputKeys)) {
+      errorMessage = "The expression depends on its own output.";
+      return false;
+   }
+
+   const size_t index = m_definitions.size();
+   for (size_t slot = 0; slot < inputKeys.size(); ++slot)
+      m_bindingsByInput[inputKeys[slot]].push_back({index, slot});
+
+   InputState state;
+   state.values.assign(inputKeys.size(), 0.0);
+   state.present.assign(inputKeys.size(), false);
+   state.missing = inputKeys.size();
+
+   m_definitions.push_back({outputPath, std::move(expression), std::move(thresholds)});
+   m_outputKeys.push_back(outputKey);
+   m_inputStates.push_back(std::move(state));
+   return true;
+}
+
+void DerivedSensorSet::OnInput(const std::vector<std::string> &path, const DataValue &value, std::vector<Output> &outputs)
+{
+   if (m_bindingsByInput.empty())
+      return;
+
+   m_keyBuffer.clear();
+   for (size_t i = 0; i < path.size(); ++i) {
+      if (i > 0)
+         m_keyBuffer += '/';
+      m_keyBuffer += path[i];
+   }
+
+   auto it = m_bindingsByInput.find(m_keyBuffer);
+   if (it == m_bindingsByInput.end())
+      return;
+
+   const bool numeric   = value.IsNumeric();
+   const double current = numeric ? value.GetNumeric() : 0.0;
+   for (const Binding &binding : it->second) {
+      InputState &state = m_inputStates[binding.definition];
+
+      // A non-numeric sample withdraws the input until it is numeric again.
+      if (state.present[binding.slot] != numeric) {
+         state.present[binding.slot] = numeric;
+         if (numeric) {
+            --state.missing;
+         } else {
+            ++state.missing;
+         }
+      }
+      state.values[binding.slot] = current;
+      if (state.missing > 0)
+         continue;
+
+      const double result = m_definitions[binding.definition].expression.Evaluate(state.values.data());
+      if (std::isfinite(result))
+         outputs.push_back({binding.definition, result});
+   }
+}
+
+void DerivedSensorSet::ResetInputs()
+{
+   for (InputState &state : m_inputStates) {
+      std::fill(state.values.begin(), state.values.end(), 0.0);
+      std::fill(state.present.begin(), state.present.end(), false);
+      state.missing = state.values.size();
+   }
+}
+
+std::string DerivedSensorSet::JoinKey(const std::vector<std::string> &path)
+{
+   return PathUtils::JoinPath(path);
+}
+
+bool DerivedSensorSet::FeedsAny(const std::string &outputKey, const std::vector<std::string> &inputKeys) const
+{
+   // Walk everything downstream of the new output; reaching one of its own
+   // inputs would close a cycle.
+   std::vector<std::string> pending{outputKey};
+   std::vector<bool> visited(m_definitions.size(), false);
+   while (!pending.empty()) {
+      const std::string key = std::move(pending.back());
+      pending.pop_back();
+
+      if (std::find(inputKeys.begin(), inputKeys.end(), key) != inputKeys.end())
+         return true;
+
+      auto it = m_bindingsByInput.find(key);
+      if (it == m_bindingsByInput.end())
+         continue;
+      for (const Binding &binding : it->second) {
+         if (visited[binding.definition])
+            continue;
+         visited[binding.definition] = true;
+         pending.push_back(m_outputKeys[binding.definition]);
+      }
+   }
+   return false;
+}
@@ -0,0 +1,106 @@
+#include "EpochDomain.h"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+// One cache line per pinned thread, so pinning never contends with readers
+// on other cores.
+struct alignas(64) ReaderSlot
+{
+   // Epoch the owner pinned, or zero while unpinned.
+   std::atomic<std::uint64_t> epoch{0};
+   std::atomic<bool> claimed{false};
+};
+
+struct ThreadPin
+{
+   ReaderSlot *slot = nullptr;
+   size_t depth     = 0;
+   // Slot this thread used last, tried first on its next pin.
+   size_t hint = 0;
+};
+
+std::atomic<std::uint64_t> g_epoch{1};
+ReaderSlot g_slots[EpochDomain::MAX_PINNED_THREADS];
+thread_local ThreadPin t_pin;
+
+ReaderSlot &ClaimSlot()
+{
+   for (;;) {
+      for (size_t step = 0; step < EpochDomain::MAX_PINNED_THREADS; ++step) {
+         const size_t index = (t_pin.hint + step) % EpochDomain::MAX_PINNED_THREADS;
+         ReaderSlot &slot   = g_slots[index];
+         bool expected      = false;
+         if (!slot.claimed.load(std::memory_order_relaxed) &&
+             slot.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            t_pin.hint = index;
+            return slot;
+         }
+      }
+      std::this_thread::yield();
+   }
+}
+
+bool IsPinnedAtOrBefore(const ReaderSlot &slot, std::uint64_t epoch)
+{
+   const std::uint64_t pinned = slot.epoch.load();
+   return pinned != 0 && pinned <= epoch;
+}
+
+} // namespace
+
+EpochDomain::Guard::Guard() :
+    m_pinned(true)
+{
+   if (t_pin.depth++ > 0)
+      return;
+
+   // Sequentially consistent, like the writers' publish and scan: either a
+   // writer's scan sees this pin, or everything read below sees what that
+   // writer published before retiring the old copy.
+   ReaderSlot &slot = ClaimSlot();
+   t_pin.slot       = &slot;
+   slot.epoch.store(g_epoch.load());
+}
+
+EpochDomain::Guard::~Guard()
+{
+   if (!m_pinned || --t_pin.depth > 0)
+      return;
+
+   t_pin.slot->epoch.store(0, std::memory_order_release);
+   t_pin.slot->claimed.store(false, std::memory_order_release);
+   t_pin.slot = nullptr;
+}
+
+EpochDomain::Guard::Guard(Guard &&other) noexcept :
+    m_pinned(other.m_pinned)
+{
+   other.m_pinned = false;
+}
+
+std::uint64_t EpochDomain::Advance()
+{
+   return g_epoch.fetch_add(1);
+}
+
+bool EpochDomain::IsReclaimable(std::uint64_t epoch)
+{
+   for (const ReaderSlot &slot : g_slots) {
+      if (IsPinnedAtOrBefore(slot, epoch))
+         return false;
+   }
+   return true;
+}
+
+void EpochDomain::WaitUntilReclaimable(std::uint64_t epoch)
+{
+   for (const ReaderSlot &slot : g_slots) {
+      if (&slot == t_pin.slot)
+         continue;
+      while (IsPinnedAtOrBefore(slot, epoch))
+         std::this_thread::yield();
+   }
+}
@@ -1,26 +1,34 @@
 #include "MainFrame.h"
 
+#include "AlarmJournalPanel.h"
 #include "PathUtils.h"
 
-#include "SensorDataEvent.h"
 #include "SensorDataGenerator.h"
 #include "SensorDataJsonReader.h"
+#include "SensorDataReplaySource.h"
 #include "SensorDataTestGenerator.h"
 #include "SensorTreeModel.h"
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <functional>
+#include <iterator>
+#include <optional>
 #include <string>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include <wx/accel.h>
+#include <wx/choicdlg.h>
+#include <wx/dirdlg.h>
 #include <wx/fileconf.h>
 #include <wx/filedlg.h>
 #include <wx/filename.h>
 #include <wx/log.h>
+#include <wx/numdlg.h>
+#include <wx/spinctrl.h>
 #include <wx/textctrl.h>
 #include <wx/textdlg.h>
 #include <wx/window.h>
@@ -30,11 +38,10 @@ namespace {
 static std::string AppTitle   = "Sensor Tree Viewer";
 static std::string AppVersion = "1.2";
 
-constexpr int STATUS_FIELD_NET_STATUS         = 0;
-constexpr int STATUS_FIELD_LOG_INFO           = 1;
-constexpr int STATUS_FIELD_MESSAGE_COUNT      = 2;
-constexpr int STATUS_FIELD_COUNT              = 3;
-constexpr size_t MAX_PENDING_SAMPLES_PER_TICK = 200;
+constexpr int STATUS_FIELD_NET_STATUS    = 0;
+constexpr int STATUS_FIELD_LOG_INFO      = 1;
+constexpr int STATUS_FIELD_MESSAGE_COUNT = 2;
+constexpr int STATUS_FIELD_COUNT         = 3;
 
 std::string GetNodePathKey(const Node *node)
 {
@@ -48,20 +55,26 @@ std::string GetNodePathKey(const Node *node)
 MainFrame::MainFrame() :
     wxFrame(nullptr, wxID_ANY, AppTitle + " v" + AppVersion,
         wxDefaultPosition, wxSize(800, 600)),
+    m_splitter(nullptr),
     m_treeCtrl(nullptr),
+    m_journalPanel(nullptr),
     m_filterCtrl(nullptr),
     m_showAlarmedOnlyCheck(nullptr),
-    m_networkIndicator(nullptr),
+    m_sourceIndicatorSizer(nullptr),
+    m_sourceIndicators(),
     m_rotateLogButton(nullptr),
     m_clearTreeButton(nullptr),
+    m_statisticsColumns(),
     m_treeModel(nullptr),
+    m_alarmJournal(),
     m_ageTimer(this, ID_AgeTimer),
     m_generationActive(false),
-    m_dataThread(nullptr),
-    m_testDataThread(nullptr),
-    m_messagesReceived(0),
+    m_sourceManager(),
+    m_testGenerator(nullptr),
+    m_modelThread(),
+    m_messageCountBaseline(0),
     m_currentLogFile(),
-    m_isNetworkConnected(false),
+    m_connectedSources(0),
     m_plotManager(nullptr)
 {
    CreateMenuBar();
@@ -72,17 +85,20 @@ MainFrame::MainFrame() :
 
    m_plotManager = std::make_unique<PlotManager>(this, m_treeModel);
 
-   m_dataThread = new SensorDataGenerator(this);
-   if (m_dataThread->Run() != wxTHREAD_NO_ERROR) {
-      delete m_dataThread;
-      m_dataThread = nullptr;
+   // Started before the sources so the first connection's log has a recorder to go to
+   m_treeModel->GetStore().StartWorkers();
+   m_modelThread = std::make_unique<SensorModelThread>(m_treeModel->GetStore(), m_sourceManager);
+   if (m_modelThread->Run() != wxTHREAD_NO_ERROR) {
+      wxLogError("Unable to start the model thread; live samples will not be shown.");
+      m_modelThread.reset();
    }
 
-   m_testDataThread = new SensorDataTestGenerator(m_generationActive, this);
-   if (m_testDataThread->Run() != wxTHREAD_NO_ERROR) {
-      delete m_testDataThread;
-      m_testDataThread = nullptr;
-   }
+   m_sourceManager.Start(std::make_unique<SensorDataGenerator>());
+   auto testGenerator = std::make_unique<SensorDataTestGenerator>(m_generationActive, m_treeModel->GetStore(), m_modelThread.get());
+   m_testGenerator    = testGenerator.get();
+   if (!m_sourceManager.Start(std::move(testGenerator)))
+      m_testGenerator = nullptr;
+   UpdateSourceIndicators();
 
    // Start automatic data generation (will run indefinitely)
    // StartDataTestGeneration();
@@ -98,6 +114,10 @@ void MainFrame::CreateMenuBar()
       // Toggle automatic data generator
       menuFile->AppendCheckItem(ID_ToggleDataGen, "&Toggle Data Generator",
           "Enable or disable automatic sensor data generation");
+      menuFile->Append(ID_ConfigureDataGen, "Configure Data &Generator...",
+          "Set the generated tree shape, sample rate, burstiness and alarm rate");
+      menuFile->Append(ID_LoadDataGenWorkload, "Load Generator &Workload...",
+          "Configure the data generator from a named workload in a JSON file");
    }
    menuFile->AppendSeparator();
    menuFile->Append(ID_RotateLog, "&Rotate Log",
@@ -109,6 +129,10 @@ void MainFrame::CreateMenuBar()
        "Open plots based on a previously saved configuration");
    menuFile->Append(ID_OpenSensorData, "&Open Sensor Data...",
        "Load a saved sensor recording into the tree view");
+   menuFile->Append(ID_ReplaySensorData, "Re&play Sensor Data...",
+       "Feed a saved sensor recording into the live tree at its recorded pace");
+   menuFile->Append(ID_ExportPlotsPng, "&Export Plots to PNG...",
+       "Render every open plot offscreen and save each as a PNG image");
    menuFile->AppendSeparator();
    menuFile->Append(wxID_EXIT);
 
@@ -121,6 +145,11 @@ void MainFrame::CreateMenuBar()
    menuView->Append(ID_CollapseAll, "&Collapse All\tCtrl-Shift-E", "Collapse all nodes in the tree view");
    menuView->AppendSeparator();
    menuView->Append(ID_ClearTree, "&Clear Entries", "Remove all sensor data from the tree view");
+   menuView->Append(ID_PlotFrameRate, "Plot &Frame Rate...", "Limit how often plot windows redraw");
+   menuView->AppendCheckItem(ID_ShowStatistics, "Show &Statistics Columns", "Show running statistics for each sensor");
+   menuView->Append(ID_AlarmPolicy, "&Alarm Debounce...", "Configure alarm hysteresis, dwell time and transition rate limits");
+   menuView->AppendCheckItem(ID_ShowAlarmJournal, "Show Alarm &Journal", "List recent alarm transitions below the tree");
+   menuView->Append(ID_AddDerivedSensor, "Add &Derived Sensor...", "Define a sensor computed from other sensors");
    menuBar->Append(menuView, "&View");
 
    SetMenuBar(menuBar);
@@ -133,7 +162,7 @@ void MainFrame::SetupStatusBar()
 
    SetStatusText("", STATUS_FIELD_NET_STATUS);
    SetStatusText("Current log: (no active log)", STATUS_FIELD_LOG_INFO);
-   SetStatusText(wxString::Format("Messages received: %zu", (unsigned long long)m_messagesReceived), STATUS_FIELD_MESSAGE_COUNT);
+   SetStatusText("Messages received: 0", STATUS_FIELD_MESSAGE_COUNT);
 }
 
 void MainFrame::OnExit(wxCommandEvent &event)
@@ -155,10 +184,16 @@ void MainFrame::CreateSensorTreeView()
    wxPanel *panel = new wxPanel(this, wxID_ANY);
 
    // Create the tree model
-   m_treeModel = new SensorTreeModel();
+   m_treeModel = new SensorTreeModel(SensorDataStore::GetDefaultShardCount());
+
+   // The tree shares a splitter with the alarm journal, which stays
+   // unsplit until it is shown
+   m_splitter = new wxSplitterWindow(panel, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxSP_LIVE_UPDATE | wxSP_3DSASH);
+   m_splitter->SetMinimumPaneSize(80);
+   m_splitter->SetSashGravity(1.0);
 
    // Create the data view control
-   m_treeCtrl = new wxDataViewCtrl(panel, wxID_ANY,
+   m_treeCtrl = new wxDataViewCtrl(m_splitter, wxID_ANY,
        wxDefaultPosition, wxDefaultSize,
        wxDV_MULTIPLE | wxDV_ROW_LINES | wxDV_HORIZ_RULES);
 
@@ -173,6 +208,15 @@ void MainFrame::CreateSensorTreeView()
       return m_treeCtrl->IsExpanded(item);
    });
 
+   m_treeModel->SetOnAlarmTransition([this](const SensorAlarmTransition &transition) {
+      m_alarmJournal.Append(transition.node->GetPath(), transition.kind, transition.previous, transition.state,
+          transition.value, transition.timestamp);
+   });
+
+   m_journalPanel = new AlarmJournalPanel(m_splitter, m_alarmJournal, m_treeModel);
+   m_journalPanel->Hide();
+   m_splitter->Initialize(m_treeCtrl);
+
    // Add columns
    m_treeCtrl->AppendTextColumn("Name", SensorTreeModel::COL_NAME, wxDATAVIEW_CELL_INERT, 200);
    m_treeCtrl->AppendTextColumn("Value", SensorTreeModel::COL_VALUE, wxDATAVIEW_CELL_INERT, 120, wxALIGN_CENTER); // value display
@@ -182,22 +226,30 @@ void MainFrame::CreateSensorTreeView()
    m_treeCtrl->AppendTextColumn("UCR", SensorTreeModel::COL_UPPER_CRITICAL_THRESHOLD, wxDATAVIEW_CELL_INERT, 90, wxALIGN_CENTER);
    m_treeCtrl->AppendTextColumn("Last Updated", SensorTreeModel::COL_ELAPSED, wxDATAVIEW_CELL_INERT, 100, wxALIGN_CENTER);
    m_treeCtrl->AppendTextColumn("Updates", SensorTreeModel::COL_UPDATE_COUNT, wxDATAVIEW_CELL_INERT, 90, wxALIGN_CENTER);
+   m_treeCtrl->AppendTextColumn("Aggregate", SensorTreeModel::COL_AGGREGATE, wxDATAVIEW_CELL_INERT, 110, wxALIGN_CENTER);
+
+   const std::pair<const char *, unsigned int> statisticsColumns[] = {
+       {"Mean", SensorTreeModel::COL_MEAN},
+       {"Std Dev", SensorTreeModel::COL_STDDEV},
+       {"EWMA", SensorTreeModel::COL_EWMA},
+       {"Min (60s)", SensorTreeModel::COL_WINDOW_MIN},
+       {"Max (60s)", SensorTreeModel::COL_WINDOW_MAX},
+       {"Rate (Hz)", SensorTreeModel::COL_UPDATE_RATE},
+       {"Time Warn (s)", SensorTreeModel::COL_TIME_IN_WARN},
+       {"Time Failed (s)", SensorTreeModel::COL_TIME_IN_FAILED},
+   };
+   for (const auto &column : statisticsColumns) {
+      wxDataViewColumn *added = m_treeCtrl->AppendTextColumn(column.first, column.second, wxDATAVIEW_CELL_INERT, 90, wxALIGN_CENTER);
+      added->SetHidden(true);
+      m_statisticsColumns.push_back(added);
+   }
 
    // Layout
    wxBoxSizer *sizer       = new wxBoxSizer(wxVERTICAL);
    wxBoxSizer *filterSizer = new wxBoxSizer(wxHORIZONTAL);
 
-   // Add a connection indicator
-   m_networkIndicator = new wxPanel(panel, wxID_ANY, wxDefaultPosition, wxSize(20, 20), wxSIMPLE_BORDER);
-
-   // Determine an aesthetically pleasing size based on default button height
-   const auto default_btn_size = wxButton::GetDefaultSize(this);
-   const wxSize indicator_size(default_btn_size.y, default_btn_size.y);
-   m_networkIndicator->SetMinSize(indicator_size);
-   m_networkIndicator->SetMaxSize(indicator_size);
-
-   UpdateNetworkIndicator(*wxYELLOW, "Network idle");
-   // TODO - click connect indicator to reset connection (not implemented)
+   // Connection indicators, one per source; filled in as sources start
+   m_sourceIndicatorSizer = new wxBoxSizer(wxHORIZONTAL);
 
    m_rotateLogButton = new wxButton(panel, ID_RotateLog, "&Rotate Log");
    m_rotateLogButton->SetToolTip("Finish the current log file and start a new one");
@@ -213,14 +265,14 @@ void MainFrame::CreateSensorTreeView()
    m_filterCtrl = new wxTextCtrl(panel, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize, wxTE_PROCESS_ENTER);
    m_filterCtrl->SetHint("Type to filter sensors... (Ctrl+F)");
 
-   filterSizer->Add(m_networkIndicator, 0, wxALIGN_CENTER_VERTICAL);
-   filterSizer->Add(m_rotateLogButton, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, 8);
+   filterSizer->Add(m_sourceIndicatorSizer, 0, wxALIGN_CENTER_VERTICAL);
+   filterSizer->Add(m_rotateLogButton, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, 4);
    filterSizer->Add(m_clearTreeButton, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, 8);
    filterSizer->Add(m_showAlarmedOnlyCheck, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, 8);
    filterSizer->Add(m_filterCtrl, 1, wxEXPAND | wxLEFT, 8);
 
    sizer->Add(filterSizer, 0, wxEXPAND | wxALL, 5);
-   sizer->Add(m_treeCtrl, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 5);
+   sizer->Add(m_splitter, 1, wxEXPAND | wxLEFT | wxRIGHT | wxBOTTOM, 5);
    panel->SetSizer(sizer);
 }
 
@@ -232,19 +284,27 @@ void MainFrame::BindEvents()
    Bind(wxEVT_MENU, &MainFrame::OnAbout, this, ID_Hello);
    if (SENSOR_TREE_ENABLE_TEST_DATA_GENERATOR_UI) {
       Bind(wxEVT_MENU, &MainFrame::OnToggleDataGenerator, this, ID_ToggleDataGen);
+      Bind(wxEVT_MENU, &MainFrame::OnConfigureDataGenerator, this, ID_ConfigureDataGen);
+      Bind(wxEVT_MENU, &MainFrame::OnLoadDataGeneratorWorkload, this, ID_LoadDataGenWorkload);
    }
    Bind(wxEVT_MENU, &MainFrame::OnExit, this, wxID_EXIT);
    // Bind close event to ensure model is disassociated before destruction
    Bind(wxEVT_CLOSE_WINDOW, &MainFrame::OnClose, this);
    Bind(wxEVT_TIMER, &MainFrame::OnAgeTimer, this, ID_AgeTimer);
-   Bind(wxEVT_SENSOR_DATA_SAMPLE, &MainFrame::OnSensorData, this);
    Bind(wxEVT_MENU, &MainFrame::OnExpandAll, this, ID_ExpandAll);
    Bind(wxEVT_MENU, &MainFrame::OnCollapseAll, this, ID_CollapseAll);
    Bind(wxEVT_MENU, &MainFrame::OnRotateLog, this, ID_RotateLog);
    Bind(wxEVT_MENU, &MainFrame::OnSavePlotConfig, this, ID_SavePlotConfig);
    Bind(wxEVT_MENU, &MainFrame::OnLoadPlotConfig, this, ID_LoadPlotConfig);
    Bind(wxEVT_MENU, &MainFrame::OnOpenSensorData, this, ID_OpenSensorData);
+   Bind(wxEVT_MENU, &MainFrame::OnReplaySensorData, this, ID_ReplaySensorData);
+   Bind(wxEVT_MENU, &MainFrame::OnExportPlotsPng, this, ID_ExportPlotsPng);
    Bind(wxEVT_MENU, &MainFrame::OnClearTree, this, ID_ClearTree);
+   Bind(wxEVT_MENU, &MainFrame::OnPlotFrameRate, this, ID_PlotFrameRate);
+   Bind(wxEVT_MENU, &MainFrame::OnShowStatistics, this, ID_ShowStatistics);
+   Bind(wxEVT_MENU, &MainFrame::OnAlarmPolicy, this, ID_AlarmPolicy);
+   Bind(wxEVT_MENU, &MainFrame::OnShowAlarmJournal, this, ID_ShowAlarmJournal);
+   Bind(wxEVT_MENU, &MainFrame::OnAddDerivedSensor, this, ID_AddDerivedSensor);
    Bind(wxEVT_MENU, &MainFrame::OnFocusFilter, this, ID_FocusFilter);
    // Toggle expand/collapse on double-click (item activated)
    Bind(wxEVT_DATAVIEW_ITEM_ACTIVATED, &MainFrame::OnItemActivated, this);
@@ -257,50 +317,37 @@ void MainFrame::BindEvents()
    Bind(wxEVT_MENU, &MainFrame::OnExpandAllHere, this, ID_ExpandAllHere);
    Bind(wxEVT_MENU, &MainFrame::OnCollapseChildrenHere, this, ID_CollapseChildrenHere);
    Bind(wxEVT_MENU, &MainFrame::OnSendToNewPlot, this, ID_SendToNewPlot);
+   Bind(wxEVT_MENU, &MainFrame::OnSetAggregate, this, ID_AggregateNone, ID_AggregateMax);
 
    m_filterCtrl->Bind(wxEVT_TEXT, &MainFrame::OnFilterTextChanged, this);
    m_filterCtrl->Bind(wxEVT_TEXT_ENTER, &MainFrame::OnFilterEnter, this);
 
    m_showAlarmedOnlyCheck->Bind(wxEVT_CHECKBOX, &MainFrame::OnShowAlarmedOnly, this);
-
-   Bind(wxEVT_THREAD, &MainFrame::OnConnectionStatus, this, ID_ConnectYes);
-   Bind(wxEVT_THREAD, &MainFrame::OnConnectionStatus, this, ID_ConnectNo);
-   Bind(wxEVT_THREAD, &MainFrame::OnNewMessage, this, ID_NewMessage);
 }
 
 void MainFrame::OnAgeTimer(wxTimerEvent &event)
 {
-   DrainPendingSamples();
-   m_treeModel->RefreshElapsedTimes();
-}
+   const std::uint64_t alarmVersion     = m_treeModel->GetAlarmVersion();
+   const std::uint64_t structureVersion = m_treeModel->GetStructureVersion();
 
-void MainFrame::ApplySample(const PendingSample &sample, bool recordSample)
-{
-   m_treeModel->AddDataSample(sample.path, sample.value,
-       sample.thresholds, sample.alarmState, sample.timestamp);
-
-   if (recordSample && m_dataRecorder) {
-      m_dataRecorder->RecordSample(sample.path, sample.value,
-          sample.thresholds, sample.alarmState);
-   }
-}
+   UpdateSourceIndicators();
+   m_treeModel->PublishChanges();
 
-void MainFrame::DrainPendingSamples()
-{
-   if (m_pendingSamples.empty())
-      return;
+   // The alarmed-only view only changes shape when some sensor's alarm or
+   // staleness state moved, or new sensors arrived.
+   const bool visibilityMayHaveChanged = m_treeModel->GetAlarmVersion() != alarmVersion ||
+                                         m_treeModel->GetStructureVersion() != structureVersion;
+   if (m_showAlarmedOnlyCheck->IsChecked() && visibilityMayHaveChanged)
+      RefreshVisibleTreeState();
 
-   m_treeModel->SetLiveDataMode(true);
+   m_treeModel->RefreshElapsedTimes();
+   if (m_journalPanel->IsShown())
+      m_journalPanel->SyncWithJournal();
 
-   size_t processed = 0;
-   while (processed < MAX_PENDING_SAMPLES_PER_TICK && !m_pendingSamples.empty()) {
-      ApplySample(m_pendingSamples.front(), true);
-      m_pendingSamples.pop_front();
-      ++processed;
+   if (m_modelThread) {
+      const uint64_t messagesReceived = m_modelThread->GetDrainedCount() - m_messageCountBaseline;
+      SetStatusText(wxString::Format("Messages received: %llu", static_cast<unsigned long long>(messagesReceived)), STATUS_FIELD_MESSAGE_COUNT);
    }
-
-   if (m_showAlarmedOnlyCheck->IsChecked())
-      RefreshVisibleTreeState();
 }
 
 void MainFrame::RefreshVisibleTreeState()
@@ -310,16 +357,6 @@ void MainFrame::RefreshVisibleTreeState()
    m_treeCtrl->Thaw();
 }
 
-void MainFrame::OnSensorData(wxCommandEvent &event)
-{
-   auto *sampleEvent = dynamic_cast<SensorDataEvent *>(&event);
-   if (!sampleEvent)
-      return;
-
-   m_pendingSamples.push_back({sampleEvent->GetPath(), sampleEvent->GetValue(), sampleEvent->GetThresholds(),
-       sampleEvent->GetAlarmState(), sampleEvent->GetTimestamp()});
-}
-
 // Recursively expand all descendants of a given item
 static void ExpandDescendants(wxDataViewCtrl *ctrl, const wxDataViewItem &parent, const SensorTreeModel *model)
 {
@@ -417,6 +454,7 @@ void MainFrame::PruneExpansionSubtree(Node *node, bool includeRoot)
    if (!node)
       return;
 
+   const auto lock = m_treeModel->LockStore();
    std::vector<Node *> stack;
    stack.push_back(node);
 
@@ -563,10 +601,37 @@ void MainFrame::OnItemContextMenu(wxDataViewEvent &event)
    wxMenu menu;
    menu.Append(ID_ExpandAllHere, "Expand All");
    menu.Append(ID_CollapseChildrenHere, "Collapse Children");
+   PopulateAggregateMenu(menu);
    PopulatePlotMenu(menu);
    PopupMenu(&menu);
 }
 
+void MainFrame::PopulateAggregateMenu(wxMenu &menu)
+{
+   const Node *node = m_contextItem.IsOk() ? static_cast<Node *>(m_contextItem.GetID()) : nullptr;
+   const auto lock  = m_treeModel->LockStore();
+   if (!node || node->IsLeaf())
+      return;
+
+   wxMenu *aggregateMenu = new wxMenu;
+   for (int id = ID_AggregateNone; id <= ID_AggregateMax; ++id) {
+      const AggregateKind kind = static_cast<AggregateKind>(id - ID_AggregateNone);
+      const wxString name      = wxString::FromUTF8(ToString(kind));
+      aggregateMenu->AppendRadioItem(id, name.Left(1).Upper() + name.Mid(1), "Show this aggregate here and on every group below");
+      aggregateMenu->Check(id, node->GetAggregateKind() == kind);
+   }
+   menu.AppendSubMenu(aggregateMenu, "Aggregate");
+}
+
+void MainFrame::OnSetAggregate(wxCommandEvent &event)
+{
+   if (!m_contextItem.IsOk())
+      return;
+
+   Node *node = static_cast<Node *>(m_contextItem.GetID());
+   m_treeModel->SetAggregateKind(node, static_cast<AggregateKind>(event.GetId() - ID_AggregateNone));
+}
+
 void MainFrame::OnExpandAllHere(wxCommandEvent &event)
 {
    wxDataViewItem start = m_contextItem.IsOk() ? m_contextItem : wxDataViewItem(NULL);
@@ -651,6 +716,7 @@ void MainFrame::OnFilterEnter(wxCommandEvent &event)
 
 std::vector<Node *> MainFrame::CollectPlotEligibleNodes(wxString &messageOut) const
 {
+   const auto lock = m_treeModel->LockStore();
    wxDataViewItemArray selections;
    m_treeCtrl->GetSelections(selections);
 
@@ -712,14 +778,139 @@ void MainFrame::OnRotateLog(wxCommandEvent &WXUNUSED(event))
 
 void MainFrame::OnClearTree(wxCommandEvent &WXUNUSED(event))
 {
-   m_pendingSamples.clear();
+   m_sourceManager.ClearQueues();
    m_treeCtrl->Freeze();
    m_treeCtrl->UnselectAll();
    m_treeModel->Clear();
+   m_alarmJournal.Clear();
+   m_journalPanel->Reset();
    m_expandedNodes.clear();
    m_treeCtrl->Thaw();
 }
 
+void MainFrame::OnPlotFrameRate(wxCommandEvent &WXUNUSED(event))
+{
+   const long current = static_cast<long>(std::lround(m_plotManager->GetMaxFrameRate()));
+   const long rate    = wxGetNumberFromUser("Plots redraw only when their sensors change, and at most this many times per second.",
+          "Frames per second:", "Plot Frame Rate", current, 1, 60, this);
+   if (rate <= 0)
+      return;
+
+   m_plotManager->SetMaxFrameRate(static_cast<double>(rate));
+}
+
+void MainFrame::OnShowStatistics(wxCommandEvent &event)
+{
+   for (wxDataViewColumn *column : m_statisticsColumns)
+      column->SetHidden(!event.IsChecked());
+}
+
+void MainFrame::OnShowAlarmJournal(wxCommandEvent &event)
+{
+   if (!event.IsChecked()) {
+      m_splitter->Unsplit(m_journalPanel);
+      return;
+   }
+
+   m_journalPanel->SyncWithJournal();
+   m_splitter->SplitHorizontally(m_treeCtrl, m_journalPanel, -220);
+}
+
+void MainFrame::OnAddDerivedSensor(wxCommandEvent &WXUNUSED(event))
+{
+   wxDialog dialog(this, wxID_ANY, "Add Derived Sensor");
+   wxFlexGridSizer *grid = new wxFlexGridSizer(2, wxSize(8, 6));
+   grid->AddGrowableCol(1);
+
+   auto addField = [&](const wxString &label, const wxString &hint) {
+      grid->Add(new wxStaticText(&dialog, wxID_ANY, label), 0, wxALIGN_CENTER_VERTICAL);
+      wxTextCtrl *field = new wxTextCtrl(&dialog, wxID_ANY, wxEmptyString, wxDefaultPosition, wxSize(360, -1));
+      field->SetHint(hint);
+      grid->Add(field, 1, wxEXPAND);
+      return field;
+   };
+
+   wxTextCtrl *pathField         = addField("Sensor path:", "Derived/Rack1/Power");
+   wxTextCtrl *expressionField   = addField("Expression:", "{Rack1/PSU/Voltage} * {Rack1/PSU/Current}");
+   wxTextCtrl *thresholdFields[] = {
+       addField("Lower critical:", "optional"),
+       addField("Lower warning:", "optional"),
+       addField("Upper warning:", "optional"),
+       addField("Upper critical:", "optional"),
+   };
+
+   wxBoxSizer *rootSizer = new wxBoxSizer(wxVERTICAL);
+   rootSizer->Add(new wxStaticText(&dialog, wxID_ANY, "Write input sensors as {path}; + - * / ( ) abs sqrt min max are available."), 0, wxALL, 10);
+   rootSizer->Add(grid, 1, wxEXPAND | wxLEFT | wxRIGHT, 10);
+   rootSizer->Add(dialog.CreateStdDialogButtonSizer(wxOK | wxCANCEL), 0, wxEXPAND | wxALL, 10);
+   dialog.SetSizerAndFit(rootSizer);
+
+   if (dialog.ShowModal() != wxID_OK)
+      return;
+
+   SensorThresholds thresholds;
+   std::optional<DataValue> *limits[] = {&thresholds.lowerCritical, &thresholds.lowerNonCritical, &thresholds.upperNonCritical, &thresholds.upperCritical};
+   for (size_t i = 0; i < std::size(limits); ++i) {
+      wxString text = thresholdFields[i]->GetValue();
+      if (text.Trim().Trim(false).IsEmpty())
+         continue;
+
+      double limit = 0.0;
+      if (!text.ToCDouble(&limit)) {
+         wxMessageBox("Thresholds must be numbers: " + text, "Add Derived Sensor", wxOK | wxICON_ERROR, this);
+         return;
+      }
+      *limits[i] = DataValue(limit);
+   }
+
+   std::string errorMessage;
+   const std::vector<std::string> path = PathUtils::SplitPath(PathUtils::ToUtf8(pathField->GetValue()));
+   if (!m_treeModel->AddDerivedSensor(path, PathUtils::ToUtf8(expressionField->GetValue()), std::move(thresholds), errorMessage))
+      wxMessageBox(wxString::FromUTF8(errorMessage.c_str()), "Add Derived Sensor", wxOK | wxICON_ERROR, this);
+}
+
+void MainFrame::OnAlarmPolicy(wxCommandEvent &WXUNUSED(event))
+{
+   AlarmPolicy policy = m_treeModel->GetAlarmPolicy();
+
+   wxDialog dialog(this, wxID_ANY, "Alarm Debounce");
+   wxFlexGridSizer *grid = new wxFlexGridSizer(2, wxSize(8, 6));
+
+   wxCheckBox *enabledCheck = new wxCheckBox(&dialog, wxID_ANY, "Evaluate alarms in the application");
+   enabledCheck->SetValue(policy.enabled);
+
+   auto addSpin = [&](const wxString &label, double value, double maximum, double increment) {
+      grid->Add(new wxStaticText(&dialog, wxID_ANY, label), 0, wxALIGN_CENTER_VERTICAL);
+      wxSpinCtrlDouble *spin = new wxSpinCtrlDouble(&dialog, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize,
+          wxSP_ARROW_KEYS, 0.0, maximum, value, increment);
+      grid->Add(spin, 1, wxEXPAND);
+      return spin;
+   };
+
+   wxSpinCtrlDouble *hysteresisSpin = addSpin("Hysteresis (% of threshold span):", policy.hysteresisFraction * 100.0, 50.0, 0.5);
+   wxSpinCtrlDouble *dwellSpin      = addSpin("Minimum dwell (s):", policy.minimumDwell.count() / 1000.0, 600.0, 0.1);
+   wxSpinCtrlDouble *burstSpin  = addSpin("Transitions per burst:", static_cast<double>(policy.transitionBurst), 100.0, 1.0);
+   wxSpinCtrlDouble *refillSpin     = addSpin("Seconds per extra transition:", static_cast<double>(policy.transitionRefill.count()), 3600.0, 1.0);
+   burstSpin->SetDigits(0);
+   refillSpin->SetDigits(0);
+
+   wxBoxSizer *rootSizer = new wxBoxSizer(wxVERTICAL);
+   rootSizer->Add(enabledCheck, 0, wxALL, 10);
+   rootSizer->Add(grid, 1, wxEXPAND | wxLEFT | wxRIGHT, 10);
+   rootSizer->Add(dialog.CreateStdDialogButtonSizer(wxOK | wxCANCEL), 0, wxEXPAND | wxALL, 10);
+   dialog.SetSizerAndFit(rootSizer);
+
+   if (dialog.ShowModal() != wxID_OK)
+      return;
+
+   policy.enabled            = enabledCheck->GetValue();
+   policy.hysteresisFraction = hysteresisSpin->GetValue() / 100.0;
+   policy.minimumDwell       = std::chrono::milliseconds(std::lround(dwellSpin->GetValue() * 1000.0));
+   policy.transitionBurst    = static_cast<size_t>(std::max(1L, std::lround(burstSpin->GetValue())));
+   policy.transitionRefill   = std::chrono::seconds(std::lround(refillSpin->GetValue()));
+   m_treeModel->SetAlarmPolicy(policy);
+}
+
 void MainFrame::OnSavePlotConfig(wxCommandEvent &WXUNUSED(event))
 {
    const auto configs = m_plotManager->GetPlotConfigurations();
@@ -881,6 +1072,29 @@ void MainFrame::OnLoadPlotConfig(wxCommandEvent &WXUNUSED(event))
    }
 }
 
+void MainFrame::OnExportPlotsPng(wxCommandEvent &WXUNUSED(event))
+{
+   if (m_plotManager->GetPlotNames().empty()) {
+      wxMessageBox("There are no plots to export.", "Export Plots to PNG", wxOK | wxICON_INFORMATION, this);
+      return;
+   }
+
+   wxDirDialog dialog(this, "Export Plots to PNG", wxEmptyString, wxDD_DEFAULT_STYLE | wxDD_DIR_MUST_EXIST);
+   if (dialog.ShowModal() != wxID_OK)
+      return;
+
+   std::vector<wxString> warnings;
+   const size_t written = m_plotManager->ExportPlotsToPng(dialog.GetPath(), wxSize(1920, 1080), warnings);
+   wxLogMessage("Exported %zu plot(s) to %s.", written, dialog.GetPath());
+
+   if (!warnings.empty()) {
+      wxString message = "Some plots could not be exported:\n";
+      for (const wxString &line : warnings)
+         message += "- " + line + "\n";
+      wxMessageBox(message, "Export Plots to PNG", wxOK | wxICON_WARNING, this);
+   }
+}
+
 void MainFrame::OnOpenSensorData(wxCommandEvent &WXUNUSED(event))
 {
    wxFileDialog dialog(this, "Open Sensor Data", wxEmptyString, wxEmptyString,
@@ -896,18 +1110,19 @@ void MainFrame::OnOpenSensorData(wxCommandEvent &WXUNUSED(event))
    }
 
    StopDataTestGeneration();
-   m_isNetworkConnected = false;
-   UpdateNetworkIndicator(*wxYELLOW, "Viewing loaded recording (offline)");
+   SetStatusText("Viewing loaded recording (offline)", STATUS_FIELD_NET_STATUS);
    CloseLogFile("Switched to loaded recording.");
 
    if (m_plotManager)
       m_plotManager->CloseAllPlots();
 
-   m_pendingSamples.clear();
+   m_sourceManager.ClearQueues();
    m_treeCtrl->Freeze();
    m_treeCtrl->UnselectAll();
    m_treeModel->SetLiveDataMode(false);
    m_treeModel->Clear();
+   m_alarmJournal.Clear();
+   m_journalPanel->Reset();
    m_expandedNodes.clear();
 
    double latestElapsedSeconds = 0.0;
@@ -919,16 +1134,20 @@ void MainFrame::OnOpenSensorData(wxCommandEvent &WXUNUSED(event))
    const auto recordedStart = loadAnchor - std::chrono::duration_cast<std::chrono::steady_clock::duration>(
                                                std::chrono::duration<double>(latestElapsedSeconds));
 
+   std::vector<SensorSample> samples;
+   samples.reserve(loadResult.samples.size());
    for (const RecordedSensorSample &sample : loadResult.samples) {
       const auto sampleTimestamp = recordedStart + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
                                                        std::chrono::duration<double>(sample.elapsedSeconds));
 
-      ApplySample({sample.path, sample.value, sample.thresholds, sample.alarmState, sampleTimestamp}, false);
+      samples.push_back({sample.path, sample.value, sample.thresholds, sample.alarmState, sampleTimestamp});
    }
+   m_treeModel->AddRecordedSamples(samples);
    m_treeCtrl->Thaw();
 
-   m_messagesReceived = 0;
-   SetStatusText(wxString::Format("Messages received: %zu", static_cast<unsigned long long>(m_messagesReceived)), STATUS_FIELD_MESSAGE_COUNT);
+   if (m_modelThread)
+      m_messageCountBaseline = m_modelThread->GetDrainedCount();
+   SetStatusText("Messages received: 0", STATUS_FIELD_MESSAGE_COUNT);
 
    wxLogMessage("Loaded %zu sample(s) from '%s'.", loadResult.samples.size(), dialog.GetPath());
 
@@ -948,40 +1167,81 @@ void MainFrame::OnOpenSensorData(wxCommandEvent &WXUNUSED(event))
    }
 }
 
-void MainFrame::OnConnectionStatus(wxThreadEvent &event)
+void MainFrame::OnReplaySensorData(wxCommandEvent &WXUNUSED(event))
 {
-   switch (event.GetId()) {
-      case ID_ConnectYes: {
-         const bool wasConnected = m_isNetworkConnected;
-         m_isNetworkConnected    = true;
-         UpdateNetworkIndicator(*wxGREEN, "Network connected");
-         if (!wasConnected) {
-            RotateLogFile("Network connected; new log file started.");
-         }
-         break;
-      }
-      case ID_ConnectNo: {
-         m_isNetworkConnected = false;
-         UpdateNetworkIndicator(*wxYELLOW, "Network idle");
-         CloseLogFile("Connection lost; log file closed.");
-         break;
-      }
-      default:
-         break;
+   wxFileDialog dialog(this, "Replay Sensor Data", wxEmptyString, wxEmptyString,
+       "Sensor recordings (*.json)|*.json|All files (*.*)|*.*", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+   if (dialog.ShowModal() != wxID_OK)
+      return;
+
+   if (!m_sourceManager.Start(std::make_unique<SensorDataReplaySource>(PathUtils::ToUtf8(dialog.GetPath())))) {
+      wxMessageBox("Unable to start the replay thread.", "Replay Sensor Data", wxOK | wxICON_ERROR, this);
+      return;
    }
+   UpdateSourceIndicators();
 }
 
-void MainFrame::OnNewMessage(wxThreadEvent &WXUNUSED(event))
+void MainFrame::UpdateSourceIndicators()
 {
-   ++m_messagesReceived;
-   SetStatusText(wxString::Format("Messages received: %zu", (unsigned long long)m_messagesReceived), STATUS_FIELD_MESSAGE_COUNT);
-}
+   wxWindow *parent = m_rotateLogButton->GetParent();
+   bool added       = false;
+   while (m_sourceIndicators.size() < m_sourceManager.GetSourceCount()) {
+      // Square, matching the default button height
+      const int side   = wxButton::GetDefaultSize(this).y;
+      wxPanel *control = new wxPanel(parent, wxID_ANY, wxDefaultPosition, wxSize(side, side), wxSIMPLE_BORDER);
+      control->SetMinSize(wxSize(side, side));
+      control->SetMaxSize(wxSize(side, side));
+      m_sourceIndicatorSizer->Add(control, 0, wxALIGN_CENTER_VERTICAL | wxRIGHT, 4);
+      m_sourceIndicators.push_back(control);
+      added = true;
+   }
+   if (added)
+      parent->Layout();
 
-void MainFrame::UpdateNetworkIndicator(const wxColour &colour, const wxString &tooltip)
-{
-   m_networkIndicator->SetBackgroundColour(colour);
-   m_networkIndicator->SetToolTip(tooltip);
-   m_networkIndicator->Refresh();
+   for (size_t index = 0; index < m_sourceIndicators.size(); ++index) {
+      const SampleSource &source    = m_sourceManager.GetSource(index);
+      const SampleSourceStats stats = source.GetQueue().GetStats();
+
+      wxColour colour = *wxYELLOW;
+      switch (source.GetState()) {
+         case SampleSourceState::Connected:
+            colour = stats.dropped > 0 ? wxColour(255, 165, 0) : *wxGREEN;
+            break;
+         case SampleSourceState::Idle:
+            colour = *wxYELLOW;
+            break;
+         case SampleSourceState::Finished:
+            colour = *wxLIGHT_GREY;
+            break;
+         case SampleSourceState::Failed:
+            colour = *wxRED;
+            break;
+      }
+
+      wxPanel *control = m_sourceIndicators[index];
+      if (control->GetBackgroundColour() != colour) {
+         control->SetBackgroundColour(colour);
+         control->Refresh();
+      }
+      const wxString tooltip = wxString::Format("%s (%s): %s\nReceived %llu, dropped %llu, queued %zu (peak %zu)",
+          wxString::FromUTF8(source.GetName().c_str()), ToString(source.GetKind()), ToString(source.GetState()),
+          static_cast<unsigned long long>(stats.received), static_cast<unsigned long long>(stats.dropped),
+          stats.depth, stats.highWater);
+      if (control->GetToolTipText() != tooltip)
+         control->SetToolTip(tooltip);
+   }
+
+   // Keep one log per stretch of live input, however many sources feed it.
+   const size_t connected = m_sourceManager.GetConnectedCount();
+   if (connected > 0 && m_connectedSources == 0) {
+      RotateLogFile("Source connected; new log file started.");
+   } else if (connected == 0 && m_connectedSources > 0) {
+      CloseLogFile("All sources disconnected; log file closed.");
+   }
+
+   if (added || connected != m_connectedSources)
+      SetStatusText(wxString::Format("Sources: %zu of %zu connected", connected, m_sourceManager.GetSourceCount()), STATUS_FIELD_NET_STATUS);
+   m_connectedSources = connected;
 }
 
 void MainFrame::StartDataTestGeneration()
@@ -1004,6 +1264,8 @@ void MainFrame::StopDataTestGeneration()
       return;
 
    m_generationActive = false;
+   if (m_testGenerator)
+      m_testGenerator->StopGenerating();
    // Uncheck the menu item if present on this frame
    if (GetMenuBar()) {
       wxMenuItem *mi = GetMenuBar()->FindItem(ID_ToggleDataGen);
@@ -1014,15 +1276,19 @@ void MainFrame::StopDataTestGeneration()
 
 void MainFrame::RotateLogFile(const wxString &reason)
 {
-   m_dataRecorder.reset();
+   if (m_modelThread)
+      m_modelThread->ReplaceRecorder(nullptr);
 
-   m_currentLogFile = SensorDataJsonWriter::GenerateTimestampedFilename();
-   m_dataRecorder   = std::make_unique<SensorDataJsonWriter>(m_currentLogFile);
+   m_currentLogFile  = SensorDataJsonWriter::GenerateTimestampedFilename();
+   auto dataRecorder = std::make_unique<SensorDataJsonWriter>(m_currentLogFile);
+   const bool isOpen = dataRecorder->IsOpen();
+   if (m_modelThread)
+      m_modelThread->ReplaceRecorder(std::move(dataRecorder));
 
    const wxString logFile = wxString::FromUTF8(m_currentLogFile.c_str());
    wxString logStatus;
 
-   if (m_dataRecorder->IsOpen()) {
+   if (isOpen) {
       logStatus = "Current log: " + logFile;
    } else {
       logStatus = "Current log: " + logFile + " (open failed)";
@@ -1034,7 +1300,8 @@ void MainFrame::RotateLogFile(const wxString &reason)
 
 void MainFrame::CloseLogFile(const wxString &reason)
 {
-   m_dataRecorder.reset();
+   if (m_modelThread)
+      m_modelThread->ReplaceRecorder(nullptr);
    m_currentLogFile.clear();
 
    SetStatusText("Current log: (no active log)", STATUS_FIELD_LOG_INFO);
@@ -1049,19 +1316,122 @@ void MainFrame::OnToggleDataGenerator(wxCommandEvent &event)
       StartDataTestGeneration();
 }
 
-void MainFrame::OnClose(wxCloseEvent &event)
+void MainFrame::OnConfigureDataGenerator(wxCommandEvent &WXUNUSED(event))
+{
+   if (!m_testGenerator)
+      return;
+
+   SyntheticLoadConfig config = m_testGenerator->GetConfig();
+
+   wxDialog dialog(this, wxID_ANY, "Configure Data Generator");
+   wxFlexGridSizer *grid = new wxFlexGridSizer(2, wxSize(8, 6));
+
+   wxChoice *profileChoice = new wxChoice(&dialog, wxID_ANY);
+   for (WorkloadProfile profile : {WorkloadProfile::Uniform, WorkloadProfile::HotSensors, WorkloadProfile::AlarmStorm,
+            WorkloadProfile::TreeGrowth, WorkloadProfile::Categorical})
+      profileChoice->Append(ToString(profile));
+   profileChoice->SetSelection(static_cast<int>(config.profile));
+   grid->Add(new wxStaticText(&dialog, wxID_ANY, "Profile:"), 0, wxALIGN_CENTER_VERTICAL);
+   grid->Add(profileChoice, 1, wxEXPAND);
+
+   auto addSpin = [&](const wxString &label, double value, double maximum, double increment, int digits) {
+      grid->Add(new wxStaticText(&dialog, wxID_ANY, label), 0, wxALIGN_CENTER_VERTICAL);
+      wxSpinCtrlDouble *spin = new wxSpinCtrlDouble(&dialog, wxID_ANY, wxEmptyString, wxDefaultPosition, wxDefaultSize,
+          wxSP_ARROW_KEYS, 0.0, maximum, value, increment);
+      spin->SetDigits(digits);
+      grid->Add(spin, 1, wxEXPAND);
+      return spin;
+   };
+
+   wxSpinCtrlDouble *seedSpin     = addSpin("Seed:", static_cast<double>(config.seed), 1e9, 1.0, 0);
+   wxSpinCtrlDouble *sensorSpin   = addSpin("Sensors:", static_cast<double>(config.sensorCount), 1000000.0, 100.0, 0);
+   wxSpinCtrlDouble *depthSpin    = addSpin("Group levels:", static_cast<double>(config.depth), 8.0, 1.0, 0);
+   wxSpinCtrlDouble *fanOutSpin   = addSpin("Groups per level:", static_cast<double>(config.fanOut), 1000.0, 1.0, 0);
+   wxSpinCtrlDouble *shareSpins[] = {
+       addSpin("Double share:", config.doubleShare, 100.0, 1.0, 1),
+       addSpin("Integer share:", config.integerShare, 100.0, 1.0, 1),
+       addSpin("String share:", config.stringShare, 100.0, 1.0, 1),
+       addSpin("Boolean share:", config.booleanShare, 100.0, 1.0, 1),
+   };
+   wxSpinCtrlDouble *rateSpin   = addSpin("Samples per second (0 = unlimited):", config.samplesPerSecond, 10000000.0, 1000.0, 0);
+   wxSpinCtrlDouble *burstSpin  = addSpin("Burst peak (x average):", config.burstFactor, 100.0, 0.5, 1);
+   wxSpinCtrlDouble *periodSpin = addSpin("Burst period (s):", config.burstPeriod.count() / 1000.0, 60.0, 0.1, 1);
+   wxSpinCtrlDouble *alarmSpin  = addSpin("Alarm rate (%):", config.alarmRate * 100.0, 100.0, 1.0, 1);
+   wxSpinCtrlDouble *threadSpin = addSpin("Threads:", static_cast<double>(config.threadCount), 64.0, 1.0, 0);
+   wxSpinCtrlDouble *batchSpin  = addSpin("Samples per batch:", static_cast<double>(config.batchSize), 100000.0, 100.0, 0);
+
+   wxBoxSizer *rootSizer = new wxBoxSizer(wxVERTICAL);
+   rootSizer->Add(grid, 1, wxEXPAND | wxALL, 10);
+   rootSizer->Add(dialog.CreateStdDialogButtonSizer(wxOK | wxCANCEL), 0, wxEXPAND | wxALL, 10);
+   dialog.SetSizerAndFit(rootSizer);
+
+   if (dialog.ShowModal() != wxID_OK)
+      return;
+
+   const auto toCount = [](const wxSpinCtrlDouble *spin) { return static_cast<size_t>(std::lround(spin->GetValue())); };
+
+   config.profile          = static_cast<WorkloadProfile>(std::max(0, profileChoice->GetSelection()));
+   config.seed             = toCount(seedSpin);
+   config.sensorCount      = std::max<size_t>(1, toCount(sensorSpin));
+   config.depth            = toCount(depthSpin);
+   config.fanOut           = std::max<size_t>(1, toCount(fanOutSpin));
+   config.doubleShare      = shareSpins[0]->GetValue();
+   config.integerShare     = shareSpins[1]->GetValue();
+   config.stringShare      = shareSpins[2]->GetValue();
+   config.booleanShare     = shareSpins[3]->GetValue();
+   config.samplesPerSecond = rateSpin->GetValue();
+   config.burstFactor      = std::max(1.0, burstSpin->GetValue());
+   config.burstPeriod      = std::chrono::milliseconds(std::max(1L, std::lround(periodSpin->GetValue() * 1000.0)));
+   config.alarmRate        = alarmSpin->GetValue() / 100.0;
+   config.threadCount      = std::max<size_t>(1, toCount(threadSpin));
+   config.batchSize        = std::max<size_t>(1, toCount(batchSpin));
+   m_testGenerator->SetConfig(config);
+}
+
+void MainFrame::OnLoadDataGeneratorWorkload(wxCommandEvent &WXUNUSED(event))
 {
-   // Stop accepting sensor data before tearing anything down.  The detached
-   // generator threads may still queue events after StopDataTestGeneration()
-   // returns, so unbinding the handler prevents those pending events from
-   // reaching OnSensorData after the model is deleted.
-   Unbind(wxEVT_SENSOR_DATA_SAMPLE, &MainFrame::OnSensorData, this);
+   if (!m_testGenerator)
+      return;
+
+   wxFileDialog dialog(this, "Load Generator Workload", wxEmptyString, wxEmptyString,
+       "Workload files (*.json)|*.json|All files (*.*)|*.*", wxFD_OPEN | wxFD_FILE_MUST_EXIST);
+   if (dialog.ShowModal() != wxID_OK)
+      return;
+
+   std::vector<SyntheticWorkload> workloads;
+   std::string errorMessage;
+   if (!LoadSyntheticWorkloads(dialog.GetPath().ToStdString(), workloads, errorMessage)) {
+      wxMessageBox(wxString::FromUTF8(errorMessage.c_str()), "Load Generator Workload", wxOK | wxICON_ERROR, this);
+      return;
+   }
 
+   int selection = 0;
+   if (workloads.size() > 1) {
+      wxArrayString names;
+      for (const SyntheticWorkload &workload : workloads)
+         names.Add(wxString::FromUTF8(workload.name.c_str()));
+      selection = wxGetSingleChoiceIndex("Workload to generate:", "Load Generator Workload", names, 0, this);
+      if (selection < 0)
+         return;
+   }
+
+   m_testGenerator->SetConfig(workloads[static_cast<size_t>(selection)].config);
+}
+
+void MainFrame::OnClose(wxCloseEvent &event)
+{
+   // Stop the timer first so nothing publishes while the model is torn down,
+   // then join the model thread before the sources it drains.
    StopDataTestGeneration();
    if (m_ageTimer.IsRunning()) {
       m_ageTimer.Stop();
    }
-   m_pendingSamples.clear();
+   if (m_modelThread) {
+      m_modelThread->Delete();
+      m_modelThread.reset();
+   }
+   m_treeModel->GetStore().StopWorkers();
+   m_sourceManager.StopAll();
 
    m_plotManager->CloseAllPlots();
    m_plotManager.reset();
@@ -1071,8 +1441,6 @@ void MainFrame::OnClose(wxCloseEvent &event)
    delete m_treeModel;
    m_treeModel = nullptr;
 
-   m_dataRecorder.reset();
-
    // Proceed with default close handling
    event.Skip();
 }
\ No newline at end of file
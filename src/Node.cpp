@@ -1,11 +1,39 @@
 #include "Node.h"
 
-#include <wx/debug.h>
-
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <limits>
 #include <sstream>
 
+namespace {
+
+double ColumnValue(const DataValue &value)
+{
+   return value.IsNumeric() ? value.GetNumeric() : std::numeric_limits<double>::quiet_NaN();
+}
+
+struct AlarmCounts
+{
+   size_t warnings = 0;
+   size_t failures = 0;
+   size_t stale    = 0;
+};
+
+AlarmCounts CountAlarms(const AggregateContribution &contribution)
+{
+   AlarmCounts counts;
+   if (!contribution.hasValue)
+      return counts;
+
+   counts.warnings = contribution.state == SensorAlarmState::Warn ? 1 : 0;
+   counts.failures = contribution.state == SensorAlarmState::Failed ? 1 : 0;
+   counts.stale    = contribution.stale ? 1 : 0;
+   return counts;
+}
+
+} // namespace
+
 Node::Node(const std::string &name, Node *parent) :
     m_name(name),
     m_parent(parent),
@@ -14,9 +42,17 @@ Node::Node(const std::string &name, Node *parent) :
     m_thresholds(),
     m_alarmState(SensorAlarmState::Ok),
     m_lastUpdate(std::chrono::steady_clock::time_point{}),
-    m_history(),
-    m_historyLimit(1024),
-    m_updateCount(0)
+    m_history(1024),
+    m_updateCount(0),
+    m_statistics(),
+    m_alarmEvaluator(),
+    m_stale(false),
+    m_stalenessArmed(false),
+    m_alarmDwellArmed(false),
+    m_changePending(false),
+    m_shownInView(false),
+    m_aggregate(),
+    m_aggregateKind(AggregateKind::None)
 {
 }
 
@@ -29,6 +65,19 @@ Node *Node::AddChild(std::unique_ptr<Node> child)
    Node *rawChild = child.get();
    // Insert in order received
    m_children.push_back(std::move(child));
+
+   // Fold in whatever the adopted subtree already holds.
+   const SubtreeAggregate &added = rawChild->GetAggregate();
+   for (Node *ancestor = this; ancestor; ancestor = ancestor->m_parent) {
+      SubtreeAggregate &aggregate = ancestor->m_aggregate;
+      aggregate.numericCount += added.numericCount;
+      aggregate.sum += added.sum;
+      aggregate.min = std::min(aggregate.min, added.min);
+      aggregate.max = std::max(aggregate.max, added.max);
+      aggregate.warningCount += added.warningCount;
+      aggregate.failureCount += added.failureCount;
+      aggregate.staleCount += added.staleCount;
+   }
    return rawChild;
 }
 
@@ -47,20 +96,46 @@ void Node::SetValue(const DataValue &value,
     SensorAlarmState alarmState,
     std::chrono::steady_clock::time_point timestamp)
 {
-   m_value      = value;
-   m_hasValue   = true;
    m_thresholds = std::move(thresholds);
-   m_alarmState = alarmState;
-   m_lastUpdate = timestamp;
+   AppendSample(DataValue(value), alarmState, timestamp);
+}
+
+void Node::AppendSample(DataValue &&value, SensorAlarmState alarmState, std::chrono::steady_clock::time_point timestamp)
+{
+   const AggregateContribution before = GetContribution();
+
+   const double numeric = ColumnValue(value);
+   m_value              = value;
+   m_hasValue           = true;
+   m_alarmState         = alarmState;
+   m_lastUpdate         = timestamp;
+   m_stale              = false;
    ++m_updateCount;
 
-   wxASSERT(m_historyLimit > 0);
+   m_history.Append({timestamp, std::move(value), alarmState}, numeric);
+   m_statistics.Update(numeric, alarmState, timestamp);
 
-   TimedSample sample{timestamp, value, alarmState};
-   m_history.push_back(sample);
-   while (m_history.size() > m_historyLimit) {
-      m_history.pop_front();
-   }
+   PropagateContribution(before, GetContribution());
+}
+
+void Node::SetAlarmState(SensorAlarmState alarmState)
+{
+   if (m_alarmState == alarmState)
+      return;
+
+   const AggregateContribution before = GetContribution();
+   m_alarmState                       = alarmState;
+   PropagateContribution(before, GetContribution());
+}
+
+void Node::SetStale(bool stale)
+{
+   if (m_stale == stale)
+      return;
+
+   const AggregateContribution before = GetContribution();
+   m_stale                            = stale;
+   PropagateContribution(before, GetContribution());
 }
 
 std::vector<std::string> Node::GetPath() const
@@ -151,5 +226,68 @@ double Node::GetSecondsSinceUpdate(std::chrono::steady_clock::time_point referen
 
 void Node::ClearHistory()
 {
-   m_history.clear();
-}
\ No newline at end of file
+   m_history.Clear();
+}
+
+void Node::SetHistoryLimit(size_t limit)
+{
+   m_history.SetLimit(limit);
+}
+
+AggregateContribution Node::GetContribution() const
+{
+   AggregateContribution contribution;
+   if (!m_hasValue)
+      return contribution;
+
+   contribution.hasValue = true;
+   contribution.numeric  = m_value.IsNumeric() && std::isfinite(m_value.GetNumeric());
+   contribution.value    = contribution.numeric ? m_value.GetNumeric() : 0.0;
+   contribution.state    = m_alarmState;
+   contribution.stale    = m_stale;
+   return contribution;
+}
+
+void Node::PropagateContribution(const AggregateContribution &before, const AggregateContribution &after)
+{
+   const AlarmCounts countsBefore = CountAlarms(before);
+   const AlarmCounts countsAfter  = CountAlarms(after);
+
+   // Leaving an extreme without matching it again invalidates it at every
+   // level that still holds the old value.
+   const bool minMayShrink = before.numeric && !(after.numeric && after.value <= before.value);
+   const bool maxMayShrink = before.numeric && !(after.numeric && after.value >= before.value);
+
+   for (Node *node = this; node; node = node->m_parent) {
+      SubtreeAggregate &aggregate = node->m_aggregate;
+      aggregate.numericCount      = aggregate.numericCount + (after.numeric ? 1 : 0) - (before.numeric ? 1 : 0);
+      aggregate.sum += (after.numeric ? after.value : 0.0) - (before.numeric ? before.value : 0.0);
+      aggregate.warningCount = aggregate.warningCount + countsAfter.warnings - countsBefore.warnings;
+      aggregate.failureCount = aggregate.failureCount + countsAfter.failures - countsBefore.failures;
+      aggregate.staleCount   = aggregate.staleCount + countsAfter.stale - countsBefore.stale;
+
+      // Sums of cancelling values drift; an empty subtree starts clean.
+      if (aggregate.numericCount == 0)
+         aggregate.sum = 0.0;
+
+      const bool rescan = (minMayShrink && before.value <= aggregate.min) || (maxMayShrink && before.value >= aggregate.max);
+      if (rescan) {
+         node->RescanExtremes();
+      } else if (after.numeric) {
+         aggregate.min = std::min(aggregate.min, after.value);
+         aggregate.max = std::max(aggregate.max, after.value);
+      }
+   }
+}
+
+void Node::RescanExtremes()
+{
+   // Children are already up to date, so one level is enough.
+   const AggregateContribution own = GetContribution();
+   m_aggregate.min                 = own.numeric ? own.value : std::numeric_limits<double>::infinity();
+   m_aggregate.max                 = own.numeric ? own.value : -std::numeric_limits<double>::infinity();
+   for (const auto &child : m_children) {
+      m_aggregate.min = std::min(m_aggregate.min, child->m_aggregate.min);
+      m_aggregate.max = std::max(m_aggregate.max, child->m_aggregate.max);
+   }
+}
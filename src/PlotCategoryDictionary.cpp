@@ -0,0 +1,65 @@
+#include "PlotCategoryDictionary.h"
+
+#include <algorithm>
+#include <limits>
+
+double PlotCategoryDictionary::LaneFor(const DataValue &value)
+{
+   if (value.IsBoolean()) {
+      // Reserve both boolean lanes together so "false" always sits below "true".
+      const size_t falseLane = Intern("false");
+      const size_t trueLane  = Intern("true");
+      return static_cast<double>(value.GetBoolean() ? trueLane : falseLane);
+   }
+
+   if (value.IsString())
+      return static_cast<double>(Intern(value.GetString()));
+
+   return std::numeric_limits<double>::quiet_NaN();
+}
+
+const std::deque<double> &PlotCategoryDictionary::GetNodeLanes(const Node &node, const Node::HistoryView &history)
+{
+   NodeLanes &entry                  = m_nodeLanes[&node];
+   const std::uint64_t firstSequence = history.GetFirstSequence();
+   const std::uint64_t endSequence   = history.GetEndSequence();
+
+   if (firstSequence < entry.firstSequence || endSequence < entry.endSequence)
+      entry = NodeLanes{};
+
+   // Lanes the history has evicted are dropped, and only samples appended
+   // since the last sync need a lookup.
+   const std::uint64_t known = entry.endSequence > firstSequence ? entry.endSequence - firstSequence : 0;
+   while (entry.lanes.size() > known)
+      entry.lanes.pop_front();
+   for (std::uint64_t sequence = firstSequence + known; sequence < endSequence; ++sequence)
+      entry.lanes.push_back(LaneFor(history[static_cast<size_t>(sequence - firstSequence)].value));
+
+   entry.firstSequence = firstSequence;
+   entry.endSequence   = endSequence;
+   return entry.lanes;
+}
+
+void PlotCategoryDictionary::SyncStructure(std::uint64_t structureVersion)
+{
+   if (structureVersion == m_structureVersion)
+      return;
+
+   m_structureVersion = structureVersion;
+   m_nodeLanes.clear();
+}
+
+void PlotCategoryDictionary::Clear()
+{
+   m_lanes.clear();
+   m_labels.clear();
+   m_nodeLanes.clear();
+}
+
+size_t PlotCategoryDictionary::Intern(const std::string &text)
+{
+   const auto [it, inserted] = m_lanes.try_emplace(text, m_labels.size());
+   if (inserted)
+      m_labels.push_back(wxString::FromUTF8(text.c_str()));
+   return it->second;
+}
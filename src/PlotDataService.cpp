@@ -0,0 +1,154 @@
+#include "PlotDataService.h"
+
+#include "Node.h"
+#include "PlotDecimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <limits>
+
+PlotDataService::PlotDataService() :
+    m_snapshots(),
+    m_categories(),
+    m_structureVersion(0),
+    m_tick(0),
+    m_frameTime(std::chrono::steady_clock::now())
+{
+}
+
+void PlotDataService::BeginTick(TimePoint now)
+{
+   ++m_tick;
+   m_frameTime = now;
+   SweepUnused();
+}
+
+std::shared_ptr<const PlotDataService::Snapshot> PlotDataService::Acquire(const SnapshotKey &key, std::uint64_t structureVersion, const SampleHistory::View &history)
+{
+   if (structureVersion != m_structureVersion) {
+      // Nodes may have been destroyed and their addresses reused.
+      m_snapshots.clear();
+      m_structureVersion = structureVersion;
+   }
+   m_categories.SyncStructure(structureVersion);
+
+   // Views can change many times between ticks (panning a paused plot), so
+   // the cache is also bounded by size; live snapshots stay owned by callers.
+   if (m_snapshots.size() >= MAX_CACHED_SNAPSHOTS)
+      m_snapshots.clear();
+
+   CacheEntry &entry = m_snapshots[key];
+   if (!entry.snapshot || entry.firstSequence != history.GetFirstSequence() || entry.endSequence != history.GetEndSequence()) {
+      entry.snapshot      = std::make_shared<const Snapshot>(BuildSnapshot(key, history, m_categories));
+      entry.firstSequence = history.GetFirstSequence();
+      entry.endSequence   = history.GetEndSequence();
+   }
+   entry.usedTick = m_tick;
+   return entry.snapshot;
+}
+
+void PlotDataService::Clear()
+{
+   m_snapshots.clear();
+   m_categories.Clear();
+}
+
+PlotDataService::Snapshot PlotDataService::BuildSnapshot(const SnapshotKey &key, const SampleHistory::View &history, PlotCategoryDictionary &categories)
+{
+   Snapshot snapshot;
+   if (history.empty())
+      return snapshot;
+
+   const auto [windowFirst, windowLast] = key.hasWindow ? history.FindWindow(key.viewStart, key.viewEnd)
+                                                        : std::make_pair(size_t{0}, history.size());
+   if (windowFirst >= windowLast)
+      return snapshot;
+
+   snapshot.numericExtents = history.ComputeExtents(windowFirst, windowLast);
+
+   const double *numeric           = history.GetNumericData();
+   const std::deque<double> &lanes = categories.GetNodeLanes(*key.node, history);
+
+   auto makeSample = [&](size_t index) {
+      const double value = numeric[index];
+      if (!std::isnan(value))
+         return Sample{history.GetTimestamp(index), value, false};
+      return Sample{history.GetTimestamp(index), lanes[index], true};
+   };
+
+   snapshot.samples.reserve(std::min(windowLast - windowFirst, static_cast<size_t>(key.pixelWidth) * 4) + 2);
+
+   // When plotting a time window, keep one pre/post window sample (if any)
+   // so the polyline can connect to the off-screen points and get clipped at
+   // the plot boundaries instead of disappearing.
+   if (key.hasWindow && windowFirst > 0) {
+      const Sample before = makeSample(windowFirst - 1);
+      if (!std::isnan(before.value))
+         snapshot.samples.push_back(before);
+   }
+
+   // One pass over the window: SelectM4 reads every value once, skipping
+   // rows without one, and the lanes in view are noted as they are read.
+   std::vector<bool> seenLanes;
+   auto valueOf = [&](size_t index) {
+      const double value = numeric[index];
+      if (!std::isnan(value))
+         return value;
+
+      const double lane = lanes[index];
+      if (!std::isnan(lane)) {
+         const size_t laneIndex = static_cast<size_t>(lane);
+         if (laneIndex >= seenLanes.size())
+            seenLanes.resize(laneIndex + 1, false);
+         seenLanes[laneIndex] = true;
+      }
+      return lane;
+   };
+
+   const double span           = std::max(1.0, static_cast<double>((key.viewEnd - key.viewStart).count()));
+   const double columnsPerTick = static_cast<double>(std::max(1, key.pixelWidth)) / span;
+   SelectM4(
+       windowFirst, windowLast,
+       [&](size_t index) { return std::floor(static_cast<double>((history.GetTimestamp(index) - key.viewStart).count()) * columnsPerTick); },
+       valueOf,
+       [&](size_t index) {
+          snapshot.samples.push_back(makeSample(index));
+          snapshot.hasData = true;
+       });
+
+   for (size_t lane = 0; lane < seenLanes.size(); ++lane) {
+      if (seenLanes[lane])
+         snapshot.visibleLanes.push_back(lane);
+   }
+
+   if (key.hasWindow && windowLast < history.size()) {
+      const Sample after = makeSample(windowLast);
+      if (!std::isnan(after.value))
+         snapshot.samples.push_back(after);
+   }
+
+   return snapshot;
+}
+
+size_t PlotDataService::KeyHash::operator()(const SnapshotKey &key) const
+{
+   size_t hash  = std::hash<const Node *>()(key.node);
+   auto combine = [&hash](size_t value) { hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2); };
+   combine(std::hash<bool>()(key.hasWindow));
+   combine(std::hash<long long>()(static_cast<long long>(key.viewStart.time_since_epoch().count())));
+   combine(std::hash<long long>()(static_cast<long long>(key.viewEnd.time_since_epoch().count())));
+   combine(std::hash<int>()(key.pixelWidth));
+   return hash;
+}
+
+void PlotDataService::SweepUnused()
+{
+   for (auto it = m_snapshots.begin(); it != m_snapshots.end();) {
+      if (it->second.usedTick + 1 < m_tick)
+         it = m_snapshots.erase(it);
+      else
+         ++it;
+   }
+}
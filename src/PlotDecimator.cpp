@@ -0,0 +1,18 @@
+#include "PlotDecimator.h"
+
+#include <cmath>
+
+void DecimateM4(const std::vector<PlotPoint> &points, std::vector<PlotPoint> &output)
+{
+   output.clear();
+   if (points.size() <= 4) {
+      output = points;
+      return;
+   }
+
+   SelectM4(
+       0, points.size(),
+       [&](size_t index) { return std::floor(points[index].x); },
+       [&](size_t index) { return points[index].y; },
+       [&](size_t index) { output.push_back(points[index]); });
+}
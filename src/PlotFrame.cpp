@@ -1,9 +1,13 @@
 #include "PlotFrame.h"
 
 #include "Node.h"
+#include "PlotDataService.h"
+#include "PlotRenderer.h"
 #include "SensorTreeModel.h"
 
 #include <wx/dcbuffer.h>
+#include <wx/dcclient.h>
+#include <wx/dcmemory.h>
 #include <wx/geometry.h>
 #include <wx/graphics.h>
 
@@ -11,12 +15,9 @@
 #include <array>
 #include <chrono>
 #include <cmath>
-#include <limits>
 #include <map>
 #include <memory>
-#include <set>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 namespace {
@@ -24,22 +25,6 @@ namespace {
 using SteadyTimePoint = std::chrono::steady_clock::time_point;
 using SteadyDuration  = std::chrono::steady_clock::duration;
 
-struct ResolvedXWindow
-{
-   bool hasWindow            = false;
-   SteadyTimePoint viewStart = SteadyTimePoint::min();
-   SteadyTimePoint viewEnd   = SteadyTimePoint::min();
-   SteadyTimePoint plotStart = SteadyTimePoint::min();
-   SteadyTimePoint plotEnd   = SteadyTimePoint::min();
-};
-
-SteadyDuration ClampPositiveDuration(SteadyDuration duration)
-{
-   if (duration <= SteadyDuration::zero())
-      return std::chrono::milliseconds(1);
-   return duration;
-}
-
 bool AreSameViewportState(const PlotViewportState &lhs, const PlotViewportState &rhs)
 {
    return lhs.presetRange == rhs.presetRange &&
@@ -62,39 +47,6 @@ PlotViewportState WithXWindow(PlotViewportState viewport,
    return viewport;
 }
 
-ResolvedXWindow ResolveXWindow(const PlotViewportState &viewport,
-    const std::optional<std::chrono::seconds> &windowDuration,
-    bool isLiveData,
-    SteadyTimePoint latestOverall,
-    SteadyTimePoint now,
-    SteadyTimePoint earliest,
-    SteadyTimePoint latest)
-{
-   ResolvedXWindow resolved;
-
-   const SteadyTimePoint defaultViewEnd = isLiveData ? std::max(now, latestOverall) : latestOverall;
-   const bool hasCustomXView            = viewport.xMin.has_value() && viewport.xMax.has_value();
-
-   resolved.hasWindow = hasCustomXView || static_cast<bool>(windowDuration);
-
-   if (hasCustomXView) {
-      const SteadyDuration customSpan = ClampPositiveDuration(*viewport.xMax - *viewport.xMin);
-      resolved.viewEnd                = viewport.followLatest ? defaultViewEnd : *viewport.xMax;
-      resolved.viewStart              = viewport.followLatest ? (resolved.viewEnd - customSpan) : *viewport.xMin;
-   } else if (windowDuration) {
-      const SteadyDuration presetSpan = std::chrono::duration_cast<SteadyDuration>(*windowDuration);
-      resolved.viewEnd                = defaultViewEnd;
-      resolved.viewStart              = resolved.viewEnd - presetSpan;
-   }
-
-   resolved.plotStart = resolved.hasWindow ? resolved.viewStart : earliest;
-   resolved.plotEnd   = resolved.hasWindow ? resolved.viewEnd : (isLiveData ? std::max(now, latest) : latest);
-   if (resolved.plotEnd <= resolved.plotStart)
-      resolved.plotStart = resolved.plotEnd - std::chrono::milliseconds(1);
-
-   return resolved;
-}
-
 } // namespace
 
 class PlotFrame::PlotCanvas : public wxPanel
@@ -115,6 +67,20 @@ class PlotFrame::PlotCanvas : public wxPanel
       Bind(wxEVT_MOUSE_CAPTURE_LOST, &PlotCanvas::OnMouseCaptureLost, this);
    }
 
+   // When the clock next moves the painted view by a pixel; empty for views
+   // that do not track the clock.
+   const std::optional<SteadyTimePoint> &GetNextClockMove() const { return m_nextClockMove; }
+
+   // Repaint only when a plotted node received samples or the series set
+   // changed; clock-driven movement is scheduled through GetNextClockMove().
+   void RefreshIfChanged()
+   {
+      const PlotRenderRequest request = m_owner->BuildRenderRequest();
+      const auto lock                 = request.model->LockStore();
+      if (CaptureDataSignature(PlotRenderer::ResolveNodes(request)) != m_paintedSignature)
+         Refresh();
+   }
+
  private:
    struct ViewSnapshot
    {
@@ -258,483 +224,235 @@ class PlotFrame::PlotCanvas : public wxPanel
       m_drag.active = false;
    }
 
-   void OnPaint(wxPaintEvent &WXUNUSED(event))
-   {
-      wxAutoBufferedPaintDC dc(this);
-
-      // Configure drawing surface and colours for dark-themed chart.
-      const wxColour background(18, 22, 30);
-      const wxColour textColour(235, 238, 245);
-      const wxColour gridColour(70, 78, 92);
-      const wxColour missingTextColour(160, 165, 180);
-
-      dc.SetBackground(wxBrush(background));
-      dc.Clear();
+   using FrameLayout = PlotRenderer::FrameLayout;
+   using LegendEntry = PlotRenderer::LegendEntry;
 
-      std::unique_ptr<wxGraphicsContext> gc(wxGraphicsContext::Create(dc));
-      if (!gc)
-         return;
-
-      ClearViewSnapshot();
-
-      gc->SetAntialiasMode(wxANTIALIAS_DEFAULT);
-      gc->SetInterpolationQuality(wxINTERPOLATION_DEFAULT);
+   // Grid-independent axis labels and background; rebuilt only when the size,
+   // value range, time span or category labels change.
+   struct ChromeLayerKey
+   {
+      wxSize size;
+      double minValue            = 0.0;
+      double maxValue            = 0.0;
+      double timeRange           = 0.0;
+      bool usingCategoricalAxis  = false;
+      bool hasCategoricalSamples = false;
+      std::map<double, wxString> categoricalLabels;
 
-      const auto &series = m_owner->GetSeries();
-      if (series.empty()) {
-         dc.SetTextForeground(textColour);
-         dc.DrawText("No sensors selected for plotting.", wxPoint(10, 10));
-         return;
+      bool operator==(const ChromeLayerKey &other) const
+      {
+         return size == other.size && minValue == other.minValue && maxValue == other.maxValue &&
+                timeRange == other.timeRange && usingCategoricalAxis == other.usingCategoricalAxis &&
+                hasCategoricalSamples == other.hasCategoricalSamples && categoricalLabels == other.categoricalLabels;
       }
+   };
 
-      const int leftMargin   = 55;
-      const int rightMargin  = 22;
-      const int topMargin    = 10;
-      const int bottomMargin = 30;
-
-      const wxSize size    = GetClientSize();
-      const int plotWidth  = std::max(1, size.GetWidth() - leftMargin - rightMargin);
-      const int plotHeight = std::max(1, size.GetHeight() - topMargin - bottomMargin);
-
-      const wxPoint origin(leftMargin, size.GetHeight() - bottomMargin);
-      const int plotTop = origin.y - plotHeight;
-
-      // Resolve each configured path to a live node in the model.
-      std::vector<const Node *> resolvedNodes(series.size(), nullptr);
-      bool anyResolved = false;
-
-      const SensorTreeModel *model = m_owner->GetModel();
-      for (size_t idx = 0; idx < series.size(); ++idx) {
-         const PlotSeries &entry = series[idx];
-         Node *node              = model->FindNodeByPath(entry.pathSegments);
-         resolvedNodes[idx]      = node;
-         if (node)
-            anyResolved = true;
-      }
+   // Tracks what the series layer currently shows so new frames can either
+   // scroll-append or fall back to a full redraw.
+   struct SeriesLayerState
+   {
+      bool valid = false;
+      wxSize size;
+      SteadyTimePoint plotStart;
+      SteadyTimePoint plotEnd;
+      double minValue = 0.0;
+      double maxValue = 0.0;
+      std::map<double, wxString> categoricalLabels;
+      std::vector<const Node *> nodes;
+      std::vector<SteadyTimePoint> drawnUntil;
+   };
 
-      auto drawLegend = [&](int startX, int startY) {
-         int legendX = startX;
-         int legendY = startY;
-         for (size_t idx = 0; idx < series.size(); ++idx) {
-            const auto &entry         = series[idx];
-            const bool missing        = !resolvedNodes[idx];
-            const wxColour legendText = missing ? missingTextColour : textColour;
-            const wxString baseLabel  = wxString::FromUTF8(entry.displayPath.c_str());
-            wxString legendLabel      = baseLabel;
-            if (missing)
-               legendLabel += " (no data)";
-            dc.SetBrush(wxBrush(entry.colour));
-            dc.SetPen(*wxTRANSPARENT_PEN);
-            dc.DrawRectangle(legendX, legendY, 10, 10);
-            dc.SetTextForeground(legendText);
-            dc.DrawText(legendLabel, legendX + 15, legendY - 2);
-            legendY += 16;
-         }
-      };
+   using DataSignature = std::vector<std::pair<const Node *, size_t>>;
 
-      if (!anyResolved) {
-         dc.SetTextForeground(textColour);
-         dc.DrawText("Assigned sensors are not available in the tree.", wxPoint(10, 10));
-         drawLegend(10, 40);
-         return;
-      }
+   // Needs the store's lock held.
+   DataSignature CaptureDataSignature(const std::vector<const Node *> &nodes) const
+   {
+      DataSignature signature;
+      signature.reserve(nodes.size());
+      for (const Node *node : nodes)
+         signature.emplace_back(node, node ? node->GetUpdateCount() : 0);
+      return signature;
+   }
 
-      using TimedSample = Node::TimedSample;
-
-      // Track newest sample across all series to detect available data.
-      auto latestOverall = std::chrono::steady_clock::time_point::min();
-      for (size_t idx = 0; idx < series.size(); ++idx) {
-         const Node *node = resolvedNodes[idx];
-         if (!node)
-            continue;
-         const auto &history = node->GetHistory();
-         if (history.empty())
-            continue;
-         latestOverall = std::max(latestOverall, history.back().timestamp);
-      }
+   // The same signature from the counts captured while preparing the frame.
+   static DataSignature GetDataSignature(const FrameLayout &layout)
+   {
+      DataSignature signature;
+      signature.reserve(layout.resolvedNodes.size());
+      for (size_t idx = 0; idx < layout.resolvedNodes.size(); ++idx)
+         signature.emplace_back(layout.resolvedNodes[idx], layout.updateCounts[idx]);
+      return signature;
+   }
 
-      if (latestOverall == std::chrono::steady_clock::time_point::min()) {
-         dc.SetTextForeground(textColour);
-         dc.DrawText("Waiting for samples...", wxPoint(10, 10));
-         drawLegend(leftMargin + 8, plotTop + 24);
+   void RenderChromeLayer(const FrameLayout &layout, const wxSize &size)
+   {
+      ChromeLayerKey key;
+      key.size                  = size;
+      key.minValue              = layout.minValue;
+      key.maxValue              = layout.maxValue;
+      key.timeRange             = layout.timeRange;
+      key.usingCategoricalAxis  = layout.usingCategoricalAxis;
+      key.hasCategoricalSamples = layout.hasCategoricalSamples;
+      key.categoricalLabels     = layout.categoricalLabels;
+
+      if (m_chromeLayer.IsOk() && m_chromeKey == key)
          return;
-      }
 
-      const auto windowDuration         = m_owner->GetTimeRangeDuration();
-      const PlotViewportState &viewport = m_owner->GetViewportState();
-      const bool isLiveData             = m_owner->GetModel()->IsLiveDataMode();
-      const auto now                    = std::chrono::steady_clock::now();
-
-      // Define the time window that maps to the plot rectangle.
-      // For fixed windows we end at the newest known sample (or now, whichever is later).
-      const ResolvedXWindow xWindow   = ResolveXWindow(viewport, windowDuration, isLiveData, latestOverall, now, std::chrono::steady_clock::time_point::min(), std::chrono::steady_clock::time_point::min());
-      const bool hasWindow            = xWindow.hasWindow;
-      const SteadyTimePoint viewStart = xWindow.viewStart;
-      const SteadyTimePoint viewEnd   = xWindow.viewEnd;
-
-      std::vector<std::vector<const TimedSample *>> raw(series.size());
-      bool hasNumericSamples = false;
-      bool hasBooleanSamples = false;
-      std::set<std::string> uniqueStrings;
-
-      bool hasData      = false;
-      auto earliest     = std::chrono::steady_clock::time_point::max();
-      auto latest       = std::chrono::steady_clock::time_point::min();
-      double numericMin = std::numeric_limits<double>::infinity();
-      double numericMax = -std::numeric_limits<double>::infinity();
-
-      for (size_t idx = 0; idx < series.size(); ++idx) {
-         const Node *node = resolvedNodes[idx];
-         if (!node)
-            continue;
-         const auto &history = node->GetHistory();
-         if (history.empty())
-            continue;
-
-         auto &bucket = raw[idx];
-         bucket.reserve(history.size());
-
-         // When plotting a time window, keep one pre/post window sample (if any)
-         // so the polyline can connect to the off-screen points and get clipped at
-         // the plot boundaries instead of disappearing.
-         const TimedSample *preWindowSample  = nullptr;
-         const TimedSample *postWindowSample = nullptr;
-         bool addedPreWindow                 = false;
-         bool addedPostWindow                = false;
-         bool hasVisibleSample               = false;
-
-         for (const TimedSample &sample : history) {
-            if (hasWindow && sample.timestamp < viewStart) {
-               preWindowSample = &sample;
-               continue;
-            }
-
-            if (hasWindow && sample.timestamp > viewEnd) {
-               // Keep only the first post-window point, and only if we have at least
-               // one in-window sample to connect from.
-               if (hasVisibleSample) {
-                  postWindowSample = &sample;
-               }
-               break;
-            }
-
-            if (hasWindow && !addedPreWindow && preWindowSample) {
-               bucket.push_back(preWindowSample);
-               addedPreWindow = true;
-            }
-
-            // Only compute axis ranges/labels based on samples in the visible window.
-            const bool isVisible = !hasWindow || (sample.timestamp >= viewStart && sample.timestamp <= viewEnd);
-            if (!isVisible)
-               continue;
-            hasVisibleSample = true;
-
-            const DataValue &value = sample.value;
-
-            if (value.IsNumeric()) {
-               const double numeric = value.GetNumeric();
-               hasNumericSamples    = true;
-               numericMin           = std::min(numericMin, numeric);
-               numericMax           = std::max(numericMax, numeric);
-            } else if (value.IsBoolean()) {
-               hasBooleanSamples = true;
-            } else if (value.IsString()) {
-               uniqueStrings.insert(value.GetString());
-            } else {
-               continue;
-            }
-
-            bucket.push_back(&sample);
-            hasData  = true;
-            earliest = std::min(earliest, sample.timestamp);
-            latest   = std::max(latest, sample.timestamp);
-         }
+      m_chromeLayer = wxBitmap(size);
+      m_chromeKey   = std::move(key);
 
-         if (postWindowSample && !addedPostWindow)
-            bucket.push_back(postWindowSample);
-      }
+      wxMemoryDC dc(m_chromeLayer);
+      dc.SetFont(GetFont());
+      PlotRenderer::DrawChrome(dc, layout);
+   }
 
-      if (!hasData) {
-         dc.SetTextForeground(textColour);
-         dc.DrawText("No samples in selected timescale.", wxPoint(10, 10));
-         drawLegend(leftMargin + 8, plotTop + 24);
+   void RenderLegendLayer(const std::vector<LegendEntry> &entries)
+   {
+      if (m_legendLayer.IsOk() && m_legendEntries == entries)
          return;
-      }
 
-      if (std::chrono::duration<double>(latest - earliest).count() <= 0.0) {
-         latest = earliest + std::chrono::milliseconds(1);
-      }
+      m_legendEntries = entries;
 
-      std::unordered_map<std::string, double> categoryPositions;
-      categoryPositions.reserve(uniqueStrings.size() + (hasBooleanSamples ? 2 : 0));
+      wxClientDC measureDc(this);
+      measureDc.SetFont(GetFont());
+      m_legendLayer = wxBitmap(PlotRenderer::MeasureLegend(measureDc, entries));
 
-      std::map<double, wxString> categoricalLabels;
-      double nextCategory = 0.0;
-
-      if (hasBooleanSamples) {
-         categoryPositions["false"]      = nextCategory;
-         categoricalLabels[nextCategory] = "false";
-         ++nextCategory;
-         categoryPositions["true"]       = nextCategory;
-         categoricalLabels[nextCategory] = "true";
-         ++nextCategory;
-      }
+      wxMemoryDC dc(m_legendLayer);
+      dc.SetFont(GetFont());
+      PlotRenderer::DrawLegendBox(dc, wxPoint(0, 0), entries);
+   }
 
-      for (const std::string &label : uniqueStrings) {
-         if (categoryPositions.find(label) != categoryPositions.end())
-            continue;
-         const double position       = nextCategory++;
-         categoryPositions[label]    = position;
-         categoricalLabels[position] = wxString::FromUTF8(label.c_str());
+   void RenderSeriesLayer(const FrameLayout &layout)
+   {
+      const wxSize layerSize = layout.plotRect.GetSize();
+
+      // Follow-latest frames whose scale and series are unchanged only need the
+      // existing layer shifted left by the elapsed pixels plus the new segments.
+      // Dense envelopes are recomputed per column and always redrawn whole.
+      bool canAppend = m_seriesState.valid && layout.followsLatest && !layout.denseMode && m_seriesLayer.IsOk() &&
+                       m_seriesState.size == layerSize &&
+                       m_seriesState.minValue == layout.minValue && m_seriesState.maxValue == layout.maxValue &&
+                       m_seriesState.categoricalLabels == layout.categoricalLabels &&
+                       m_seriesState.nodes == layout.resolvedNodes &&
+                       (m_seriesState.plotEnd - m_seriesState.plotStart) == (layout.plotEnd - layout.plotStart) &&
+                       layout.plotEnd >= m_seriesState.plotEnd;
+
+      long long shiftPixels = 0;
+      if (canAppend) {
+         shiftPixels = static_cast<long long>((layout.plotEnd - m_seriesState.plotEnd) / layout.pixelDuration);
+         canAppend   = shiftPixels < layerSize.GetWidth();
       }
 
-      bool hasCategoricalSamples = !categoryPositions.empty();
-      double categoricalMin      = std::numeric_limits<double>::infinity();
-      double categoricalMax      = -std::numeric_limits<double>::infinity();
-      if (hasCategoricalSamples) {
-         for (const auto &entry : categoryPositions) {
-            categoricalMin = std::min(categoricalMin, entry.second);
-            categoricalMax = std::max(categoricalMax, entry.second);
-         }
-      }
+      if (canAppend && shiftPixels > 0) {
+         if (!m_scratchLayer.IsOk() || m_scratchLayer.GetSize() != layerSize)
+            m_scratchLayer = wxBitmap(layerSize);
 
-      double falsePosition = 0.0;
-      double truePosition  = 0.0;
-      if (hasBooleanSamples) {
-         if (const auto it = categoryPositions.find("false"); it != categoryPositions.end())
-            falsePosition = it->second;
-         if (const auto it = categoryPositions.find("true"); it != categoryPositions.end())
-            truePosition = it->second;
+         {
+            wxMemoryDC scrollDc(m_scratchLayer);
+            scrollDc.SetBackground(wxBrush(PlotRenderer::BackgroundColour()));
+            scrollDc.Clear();
+            scrollDc.DrawBitmap(m_seriesLayer, -static_cast<int>(shiftPixels), 0, false);
+         }
+         std::swap(m_seriesLayer, m_scratchLayer);
+      } else if (!canAppend) {
+         m_seriesLayer = wxBitmap(layerSize);
+         wxMemoryDC clearDc(m_seriesLayer);
+         clearDc.SetBackground(wxBrush(PlotRenderer::BackgroundColour()));
+         clearDc.Clear();
       }
 
-      struct PreparedSample
       {
-         const TimedSample *sample;
-         double mappedValue;
-      };
-
-      std::vector<std::vector<PreparedSample>> filtered(series.size());
-      for (size_t idx = 0; idx < series.size(); ++idx) {
-         const auto &rawBucket = raw[idx];
-         if (rawBucket.empty())
-            continue;
-
-         auto &preparedBucket = filtered[idx];
-         preparedBucket.reserve(rawBucket.size());
-
-         for (const TimedSample *rawSample : rawBucket) {
-            if (!rawSample)
-               continue;
-
-            double mapped          = 0.0;
-            const DataValue &value = rawSample->value;
-            if (value.IsNumeric()) {
-               mapped = value.GetNumeric();
-            } else if (value.IsBoolean()) {
-               mapped = value.GetBoolean() ? truePosition : falsePosition;
-            } else if (value.IsString()) {
-               auto it = categoryPositions.find(value.GetString());
-               if (it == categoryPositions.end())
-                  continue;
-               mapped = it->second;
-            } else {
-               continue;
-            }
-            preparedBucket.push_back(PreparedSample{rawSample, mapped});
+         wxMemoryDC layerDc(m_seriesLayer);
+         std::unique_ptr<wxGraphicsContext> gc(wxGraphicsContext::Create(layerDc));
+         if (!gc) {
+            m_seriesState = SeriesLayerState{};
+            return;
          }
-      }
-
-      double minValue = std::numeric_limits<double>::infinity();
-      double maxValue = -std::numeric_limits<double>::infinity();
 
-      auto updateRange = [&](double candidateMin, double candidateMax) {
-         minValue = std::min(minValue, candidateMin);
-         maxValue = std::max(maxValue, candidateMax);
-      };
+         gc->SetAntialiasMode(wxANTIALIAS_DEFAULT);
+         gc->SetInterpolationQuality(wxINTERPOLATION_DEFAULT);
+         gc->Translate(-layout.plotRect.GetLeft(), -layout.plotRect.GetTop());
+         PlotRenderer::DrawSeries(*gc, layout, m_owner->GetSeries(), canAppend ? &m_seriesState.drawnUntil : nullptr);
+      }
 
-      if (hasNumericSamples && std::isfinite(numericMin) && std::isfinite(numericMax))
-         updateRange(numericMin, numericMax);
+      m_seriesState.valid             = true;
+      m_seriesState.size              = layerSize;
+      m_seriesState.plotStart         = layout.plotStart;
+      m_seriesState.plotEnd           = layout.plotEnd;
+      m_seriesState.minValue          = layout.minValue;
+      m_seriesState.maxValue          = layout.maxValue;
+      m_seriesState.categoricalLabels = layout.categoricalLabels;
+      m_seriesState.nodes             = layout.resolvedNodes;
+      m_seriesState.drawnUntil.assign(layout.prepared.size(), SteadyTimePoint::min());
+      for (size_t idx = 0; idx < layout.prepared.size(); ++idx) {
+         if (!layout.prepared[idx].empty())
+            m_seriesState.drawnUntil[idx] = layout.prepared[idx].back().timestamp;
+      }
+   }
 
-      if (hasCategoricalSamples && std::isfinite(categoricalMin) && std::isfinite(categoricalMax))
-         updateRange(categoricalMin - 0.5, categoricalMax + 0.5);
+   void OnPaint(wxPaintEvent &WXUNUSED(event))
+   {
+      wxAutoBufferedPaintDC dc(this);
+      ClearViewSnapshot();
 
-      if (!std::isfinite(minValue) || !std::isfinite(maxValue)) {
-         minValue = -1.0;
-         maxValue = 1.0;
-      } else if (minValue == maxValue) {
-         minValue -= 1.0;
-         maxValue += 1.0;
-      }
+      // Node history is read through views, so the store is only locked
+      // while the frame resolves its nodes.
+      const PlotRenderRequest request = m_owner->BuildRenderRequest();
+      FrameLayout layout;
+      PlotRenderer::PrepareFrame(request, GetClientSize(), layout);
+      const std::vector<LegendEntry> legend = PlotRenderer::BuildLegendEntries(request, layout.resolvedNodes);
 
-      // Compute the plot start time based on the window duration (or the earliest sample
-      // when no window is set).
-      const ResolvedXWindow plotWindow = ResolveXWindow(viewport, windowDuration, isLiveData, latestOverall, now, earliest, latest);
-      const SteadyTimePoint plotStart  = plotWindow.plotStart;
-      const SteadyTimePoint plotEnd    = plotWindow.plotEnd;
-
-      const double timeRange  = std::max(1e-9, std::chrono::duration<double>(plotEnd - plotStart).count());
-      const double valueRange = std::max(1e-9, maxValue - minValue);
-
-      // Translate a sample to device coordinates inside the plot rectangle.
-      auto toPoint = [&](const PreparedSample &sample) {
-         const double tSeconds = std::chrono::duration<double>(sample.sample->timestamp - plotStart).count();
-         const double xNorm    = tSeconds / timeRange;
-         const double yNorm    = (sample.mappedValue - minValue) / valueRange;
-         const double x        = origin.x + xNorm * plotWidth;
-         const double y        = origin.y - yNorm * plotHeight;
-         return wxPoint2DDouble(x, y);
-      };
-
-      const bool usingCategoricalAxis = hasCategoricalSamples && !hasNumericSamples;
-      UpdateViewSnapshot(wxRect(origin.x, plotTop, plotWidth, plotHeight), plotStart, plotEnd);
-
-      wxGraphicsPath gridPath = gc->CreatePath();
-      const double leftX      = static_cast<double>(leftMargin);
-      const double rightX     = static_cast<double>(leftMargin + plotWidth);
-      const double topY       = static_cast<double>(plotTop);
-      const double bottomY    = static_cast<double>(origin.y);
-
-      if (usingCategoricalAxis) {
-         for (const auto &tick : categoricalLabels) {
-            const double fraction = (tick.first - minValue) / valueRange;
-            const double y        = bottomY - fraction * static_cast<double>(plotHeight);
-            gridPath.MoveToPoint(leftX, y);
-            gridPath.AddLineToPoint(rightX, y);
-         }
-      } else {
-         for (int i = 0; i <= 5; ++i) {
-            const double y = bottomY - (static_cast<double>(plotHeight) * i) / 5.0;
-            gridPath.MoveToPoint(leftX, y);
-            gridPath.AddLineToPoint(rightX, y);
-         }
-      }
-      for (int i = 0; i <= 5; ++i) {
-         const double x = leftX + (static_cast<double>(plotWidth) * i) / 5.0;
-         gridPath.MoveToPoint(x, bottomY);
-         gridPath.AddLineToPoint(x, topY);
-      }
-      gc->SetPen(wxPen(gridColour, 1, wxPENSTYLE_DOT));
-      gc->StrokePath(gridPath);
-
-      auto formatSeconds = [](double seconds) {
-         if (seconds < 1.0)
-            return wxString::Format("%.2fs", seconds);
-         if (seconds < 60.0)
-            return wxString::Format("%.1fs", seconds);
-         const int totalSeconds = static_cast<int>(std::round(seconds));
-         const int minutes      = totalSeconds / 60;
-         const int remSeconds   = totalSeconds % 60;
-         if (minutes < 60)
-            return wxString::Format("%dm %02ds", minutes, remSeconds);
-         const int hours  = minutes / 60;
-         const int remMin = minutes % 60;
-         return wxString::Format("%dh %02dm", hours, remMin);
-      };
-
-      auto formatValue = [](double value) {
-         const double absVal = std::fabs(value);
-         if (absVal >= 1000.0)
-            return wxString::Format("%.0f", value);
-         if (absVal >= 100.0)
-            return wxString::Format("%.1f", value);
-         return wxString::Format("%.2f", value);
-      };
-
-      wxFont baseFont = GetFont();
-      dc.SetFont(baseFont);
-      dc.SetTextForeground(textColour);
-
-      // Annotate value axis.
-      if (usingCategoricalAxis) {
-         for (const auto &tick : categoricalLabels) {
-            const double fraction = (tick.first - minValue) / valueRange;
-            const double yPos     = static_cast<double>(origin.y) - fraction * static_cast<double>(plotHeight);
-            const wxSize textSz   = dc.GetTextExtent(tick.second);
-            dc.DrawText(tick.second, wxPoint(leftMargin - textSz.GetWidth() - 6, static_cast<int>(std::round(yPos)) - textSz.GetHeight() / 2));
-         }
-      } else {
-         for (int i = 0; i <= 5; ++i) {
-            const double fraction = static_cast<double>(i) / 5.0;
-            const double value    = minValue + fraction * (maxValue - minValue);
-            const wxString label  = formatValue(value);
-            const int y           = origin.y - static_cast<int>(fraction * plotHeight);
-            const wxSize textSz   = dc.GetTextExtent(label);
-            dc.DrawText(label, wxPoint(leftMargin - textSz.GetWidth() - 6, y - textSz.GetHeight() / 2));
-         }
+      m_paintedSignature = GetDataSignature(layout);
+      m_nextClockMove    = ComputeNextClockMove(layout);
 
-         if (hasCategoricalSamples) {
-            for (const auto &tick : categoricalLabels) {
-               const double fraction = (tick.first - minValue) / valueRange;
-               const double yPos     = static_cast<double>(origin.y) - fraction * static_cast<double>(plotHeight);
-               const wxSize textSz   = dc.GetTextExtent(tick.second);
-               dc.DrawText(tick.second, wxPoint(leftMargin + plotWidth + 6, static_cast<int>(std::round(yPos)) - textSz.GetHeight() / 2));
-            }
-         }
-      }
+      if (!layout.statusMessage.IsEmpty()) {
+         m_seriesState = SeriesLayerState{};
 
-      // Annotate time axis at the bottom.
-      for (int i = 0; i <= 5; ++i) {
-         const double fraction = static_cast<double>(i) / 5.0;
-         const double seconds  = fraction * timeRange;
-         const wxString label  = formatSeconds(seconds);
-         const int x           = leftMargin + static_cast<int>(fraction * plotWidth);
-         const wxSize textSz   = dc.GetTextExtent(label);
-         dc.DrawText(label, wxPoint(x - textSz.GetWidth() / 2, origin.y + 4));
+         dc.SetFont(GetFont());
+         PlotRenderer::DrawStatus(dc, layout, legend);
+         return;
       }
 
-      // Reuse a scratch buffer so we only allocate when a series exceeds prior size.
-      std::vector<wxPoint2DDouble> pointCache;
-      pointCache.reserve(128);
-      const double markerRadius   = 2.0;
-      const double markerDiameter = markerRadius * 2.0;
-
-      auto isPointInsidePlot = [&](const wxPoint2DDouble &point) {
-         return point.m_x >= leftX && point.m_x <= rightX && point.m_y >= topY && point.m_y <= bottomY;
-      };
-
-      for (size_t idx = 0; idx < series.size(); ++idx) {
-         const auto &entry           = series[idx];
-         const auto &filteredHistory = filtered[idx];
-         if (filteredHistory.empty())
-            continue;
-
-         // Render polylines and markers for each active series.
-         pointCache.clear();
-         pointCache.reserve(filteredHistory.size());
-         for (const PreparedSample &sample : filteredHistory) {
-            pointCache.push_back(toPoint(sample));
-         }
+      UpdateViewSnapshot(layout.plotRect, layout.plotStart, layout.plotEnd);
 
-         // Clip series rendering to the plot rectangle so off-screen points still
-         // contribute to the stroke, but nothing bleeds into the margins.
-         gc->PushState();
-         gc->Clip(leftX, topY, static_cast<double>(plotWidth), static_cast<double>(plotHeight));
-
-         gc->SetPen(entry.pen);
-         if (pointCache.size() >= 2) {
-            wxGraphicsPath seriesPath = gc->CreatePath();
-            seriesPath.MoveToPoint(pointCache.front().m_x, pointCache.front().m_y);
-            for (size_t i = 1; i < pointCache.size(); ++i)
-               seriesPath.AddLineToPoint(pointCache[i].m_x, pointCache[i].m_y);
-            gc->StrokePath(seriesPath);
-         }
+      // Composite the cached layers: axes/background, series, grid, legend.
+      RenderChromeLayer(layout, GetClientSize());
+      RenderSeriesLayer(layout);
+      RenderLegendLayer(legend);
 
-         gc->SetBrush(entry.brush);
-         for (const wxPoint2DDouble &point : pointCache) {
-            if (!isPointInsidePlot(point))
-               continue;
-            gc->DrawEllipse(point.m_x - markerRadius, point.m_y - markerRadius, markerDiameter, markerDiameter);
-         }
+      dc.DrawBitmap(m_chromeLayer, 0, 0, false);
+      dc.DrawBitmap(m_seriesLayer, layout.plotRect.GetLeft(), layout.plotRect.GetTop(), false);
+      PlotRenderer::DrawGrid(dc, layout);
+      PlotRenderer::DrawStatisticsOverlay(dc, layout, m_owner->GetSeries());
+      dc.DrawBitmap(m_legendLayer, PlotRenderer::GetLegendBoxOrigin(layout), false);
+   }
 
-         gc->PopState();
-      }
+   // A snapped window scrolls by one pixel per pixel duration. A view of the
+   // whole history stretches instead, and its newest samples move a pixel
+   // once the span has grown by one pixel's worth.
+   static std::optional<SteadyTimePoint> ComputeNextClockMove(const FrameLayout &layout)
+   {
+      if (!layout.tracksClock || !layout.statusMessage.IsEmpty() || layout.plotRect.GetWidth() <= 0)
+         return std::nullopt;
 
-      drawLegend(leftMargin + 8, plotTop + 24);
+      SteadyDuration step = layout.pixelDuration;
+      if (step == SteadyDuration::zero())
+         step = (layout.plotEnd - layout.plotStart) / layout.plotRect.GetWidth();
+      return layout.plotEnd + std::max(step, SteadyDuration(std::chrono::milliseconds(1)));
    }
 
    PlotFrame *m_owner;
    ViewSnapshot m_lastView;
    DragState m_drag;
+   wxBitmap m_chromeLayer;
+   ChromeLayerKey m_chromeKey;
+   wxBitmap m_seriesLayer;
+   wxBitmap m_scratchLayer;
+   SeriesLayerState m_seriesState;
+   wxBitmap m_legendLayer;
+   std::vector<LegendEntry> m_legendEntries;
+   DataSignature m_paintedSignature;
+   std::optional<SteadyTimePoint> m_nextClockMove;
 };
 
 PlotFrame::PlotFrame(wxWindow *parent, const wxString &title, SensorTreeModel *model) :
@@ -742,11 +460,15 @@ PlotFrame::PlotFrame(wxWindow *parent, const wxString &title, SensorTreeModel *m
     m_title(title),
     m_model(model),
     m_canvas(new PlotCanvas(this)),
-    m_timer(this),
+    m_dirty(false),
+    m_onRenderRequested(),
+    m_dataService(nullptr),
     m_series(),
     m_onClosed(),
     m_nextColourIndex(0),
     m_timeButtons(),
+    m_statisticsButton(nullptr),
+    m_showStatistics(false),
     m_lockAllButton(nullptr),
     m_lockAllPlots(false),
     m_viewport(),
@@ -781,6 +503,11 @@ PlotFrame::PlotFrame(wxWindow *parent, const wxString &title, SensorTreeModel *m
       Bind(wxEVT_TOGGLEBUTTON, &PlotFrame::OnTimeRangeButton, this, id);
    }
 
+   m_statisticsButton = new wxToggleButton(controlPanel, wxID_ANY, "Stats");
+   m_statisticsButton->SetToolTip("Overlay each sensor's running mean and one standard deviation band.");
+   controlSizer->Add(m_statisticsButton, 0, wxALIGN_CENTER_VERTICAL | wxLEFT, 8);
+   m_statisticsButton->Bind(wxEVT_TOGGLEBUTTON, &PlotFrame::OnStatisticsButton, this);
+
    controlSizer->AddStretchSpacer();
 
    m_lockAllButton = new wxToggleButton(controlPanel, wxID_ANY, "Lock All Plots");
@@ -795,8 +522,7 @@ PlotFrame::PlotFrame(wxWindow *parent, const wxString &title, SensorTreeModel *m
 
    SetTimeRange(TimeRange::Last1Minute);
 
-   m_timer.Start(100);
-   Bind(wxEVT_TIMER, &PlotFrame::OnTimer, this, m_timer.GetId());
+   Bind(wxEVT_ICONIZE, &PlotFrame::OnIconize, this);
    Bind(wxEVT_CLOSE_WINDOW, &PlotFrame::OnClose, this);
 }
 
@@ -867,14 +593,74 @@ void PlotFrame::ApplyLockAllPlotsState(bool locked, bool notify)
       m_onLockAllPlotsChanged(locked);
 }
 
-void PlotFrame::OnTimer(wxTimerEvent &WXUNUSED(event))
+PlotRenderRequest PlotFrame::BuildRenderRequest() const
 {
-   m_canvas->Refresh();
+   PlotRenderRequest request;
+   request.series         = &m_series;
+   request.model          = m_model;
+   request.viewport       = m_viewport;
+   request.windowDuration = GetTimeRangeDuration();
+   request.now            = m_dataService ? m_dataService->GetFrameTime() : std::chrono::steady_clock::now();
+   request.dataService    = m_dataService;
+   request.showStatistics = m_showStatistics;
+   return request;
+}
+
+wxImage PlotFrame::RenderToImage(const wxSize &size) const
+{
+   return PlotRenderer::RenderToImage(BuildRenderRequest(), size);
+}
+
+void PlotFrame::MarkDirty()
+{
+   m_dirty = true;
+   if (m_onRenderRequested)
+      m_onRenderRequested();
+}
+
+void PlotFrame::SetOnRenderRequested(std::function<void()> callback)
+{
+   m_onRenderRequested = std::move(callback);
+}
+
+bool PlotFrame::IsRenderable() const
+{
+   return !IsIconized() && IsShownOnScreen();
+}
+
+void PlotFrame::RenderTick(std::chrono::steady_clock::time_point now)
+{
+   if (m_dirty) {
+      m_dirty = false;
+      m_canvas->RefreshIfChanged();
+   }
+
+   // Live windows keep scrolling with the clock even when no samples arrive;
+   // the view only needs the clock, not the store.
+   const std::optional<SteadyTimePoint> &nextClockMove = m_canvas->GetNextClockMove();
+   if (nextClockMove && now >= *nextClockMove)
+      m_canvas->Refresh();
+
+   // Paint now rather than on idle so every plot in the tick renders against
+   // the same clock and shared snapshots.
+   m_canvas->Update();
+}
+
+std::optional<std::chrono::steady_clock::time_point> PlotFrame::GetNextClockMove() const
+{
+   return m_canvas->GetNextClockMove();
+}
+
+void PlotFrame::OnIconize(wxIconizeEvent &event)
+{
+   // Ticks skip minimised frames, so catch up with anything missed meanwhile.
+   if (!event.IsIconized())
+      MarkDirty();
+   event.Skip();
 }
 
 void PlotFrame::OnClose(wxCloseEvent &event)
 {
-   m_timer.Stop();
    if (m_onClosed)
       m_onClosed();
    event.Skip();
@@ -926,6 +712,7 @@ bool PlotFrame::AddSensorPath(std::vector<std::string> pathSegments, std::string
    series.pen.SetJoin(wxJOIN_ROUND);
    series.brush = wxBrush(series.colour);
    m_series.push_back(std::move(series));
+   m_canvas->Refresh();
 
    return true;
 }
@@ -964,6 +751,12 @@ void PlotFrame::OnTimeRangeButton(wxCommandEvent &event)
    }
 }
 
+void PlotFrame::OnStatisticsButton(wxCommandEvent &event)
+{
+   m_showStatistics = event.GetInt() != 0;
+   m_canvas->Refresh();
+}
+
 void PlotFrame::OnLockAllPlotsButton(wxCommandEvent &event)
 {
    ApplyLockAllPlotsState(event.GetInt() != 0, true);
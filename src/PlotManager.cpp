@@ -5,24 +5,58 @@
 #include "PlotFrame.h"
 #include "SensorTreeModel.h"
 
+#include <wx/filename.h>
+#include <wx/imagpng.h>
+#include <wx/timer.h>
 #include <wx/window.h>
 
 #include <algorithm>
+#include <cmath>
 #include <optional>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+class PlotManager::RenderTimer : public wxTimer
+{
+ public:
+   explicit RenderTimer(PlotManager &manager) :
+       wxTimer(),
+       m_manager(manager)
+   {
+   }
+
+   void Notify() override { m_manager.RenderTick(); }
+
+ private:
+   PlotManager &m_manager;
+};
+
 PlotManager::PlotManager(wxWindow *parent, SensorTreeModel *model) :
     m_parent(parent),
     m_model(model),
     m_lockAllPlots(false),
-    m_plots()
+    m_maxFrameRate(DEFAULT_PLOT_MAX_FRAME_RATE),
+    m_plots(),
+    m_dataService(),
+    m_renderTimer(std::make_unique<RenderTimer>(*this)),
+    m_lastRenderTick(),
+    m_renderTickDue(),
+    m_pendingViewport(),
+    m_pendingViewportSource(nullptr),
+    m_subscriptions(),
+    m_subscriptionsValid(false),
+    m_subscribedStructureVersion(0)
 {
+   m_model->SetOnSensorUpdated([this](const Node *node) {
+      HandleSensorUpdated(node);
+   });
 }
 
 PlotManager::~PlotManager()
 {
+   m_model->SetOnSensorUpdated(nullptr);
+   m_renderTimer->Stop();
    CloseAllPlots();
 }
 
@@ -39,8 +73,8 @@ PlotFrame *PlotManager::CreatePlot(const wxString &name, const std::vector<Node
    if (existing != m_plots.end())
       return existing->second.frame;
 
-   std::optional<PlotViewportState> initialViewport;
-   if (m_lockAllPlots) {
+   std::optional<PlotViewportState> initialViewport = m_pendingViewport;
+   if (m_lockAllPlots && !initialViewport) {
       for (const auto &entry : m_plots) {
          if (entry.second.frame) {
             initialViewport = entry.second.frame->GetViewportState();
@@ -57,6 +91,10 @@ PlotFrame *PlotManager::CreatePlot(const wxString &name, const std::vector<Node
       SetLockAllPlotsEnabled(locked);
    });
    frame->SetLockAllPlotsEnabled(m_lockAllPlots);
+   frame->SetDataService(&m_dataService);
+   frame->SetOnRenderRequested([this]() {
+      ScheduleRenderTick();
+   });
    if (initialViewport.has_value())
       frame->SetSynchronizedViewportState(*initialViewport);
    frame->AddSensors(nodes);
@@ -67,6 +105,7 @@ PlotFrame *PlotManager::CreatePlot(const wxString &name, const std::vector<Node
    frame->Raise();
 
    m_plots.emplace(key, PlotEntry{wxString(name), frame});
+   InvalidateSubscriptions();
    return frame;
 }
 
@@ -80,12 +119,18 @@ bool PlotManager::AddSensorsToPlot(const wxString &name, const std::vector<Node
    PlotFrame *frame    = it->second.frame;
    const bool appended = frame->AddSensors(nodes);
    frame->Raise();
+   if (appended)
+      InvalidateSubscriptions();
    return appended;
 }
 
 void PlotManager::SetLockAllPlotsEnabled(bool locked)
 {
    m_lockAllPlots = locked;
+   if (!locked) {
+      m_pendingViewport.reset();
+      m_pendingViewportSource = nullptr;
+   }
    for (auto &entry : m_plots) {
       if (entry.second.frame)
          entry.second.frame->SetLockAllPlotsEnabled(locked);
@@ -147,6 +192,7 @@ size_t PlotManager::RestorePlotConfigurations(const std::vector<PlotConfiguratio
 
       std::unordered_set<std::string> seenPaths;
 
+      const auto lock = m_model->LockStore();
       for (const std::string &rawPath : cfg.sensorPaths) {
          if (rawPath.empty())
             continue;
@@ -192,6 +238,7 @@ size_t PlotManager::RestorePlotConfigurations(const std::vector<PlotConfiguratio
          ++plotsCreated;
    }
 
+   InvalidateSubscriptions();
    return plotsCreated;
 }
 
@@ -203,16 +250,53 @@ void PlotManager::CloseAllPlots()
       PlotFrame *frame = entry.second.frame;
       if (!frame->IsBeingDeleted()) {
          frame->SetOnClosed(nullptr);
+         frame->SetOnRenderRequested(nullptr);
+         // Destruction is deferred, so detach from state this manager owns.
+         frame->SetDataService(nullptr);
          frames.push_back(frame);
       }
    }
    m_plots.clear();
+   m_subscriptions.clear();
+   InvalidateSubscriptions();
+   m_dataService.Clear();
+   m_pendingViewport.reset();
+   m_pendingViewportSource = nullptr;
 
    for (auto *frame : frames) {
       frame->Destroy();
    }
 }
 
+size_t PlotManager::ExportPlotsToPng(const wxString &directory, const wxSize &size, std::vector<wxString> &warnings) const
+{
+   if (!wxImage::FindHandler(wxBITMAP_TYPE_PNG))
+      wxImage::AddHandler(new wxPNGHandler);
+
+   size_t written = 0;
+   for (const wxString &name : GetPlotNames()) {
+      const auto it = m_plots.find(NormalizeName(name));
+      if (it == m_plots.end() || !it->second.frame)
+         continue;
+
+      wxString fileStem = name;
+      for (wxString::iterator ch = fileStem.begin(); ch != fileStem.end(); ++ch) {
+         if (!wxIsalnum(*ch) && *ch != '-' && *ch != '_')
+            *ch = '_';
+      }
+
+      const wxFileName fileName(directory, fileStem, "png");
+      const wxImage image = it->second.frame->RenderToImage(size);
+      if (!image.IsOk() || !image.SaveFile(fileName.GetFullPath(), wxBITMAP_TYPE_PNG)) {
+         warnings.push_back(wxString::Format("Plot '%s' could not be written to %s.", name, fileName.GetFullPath()));
+         continue;
+      }
+      ++written;
+   }
+
+   return written;
+}
+
 std::string PlotManager::NormalizeName(const wxString &name)
 {
    wxString trimmed = name;
@@ -226,6 +310,22 @@ void PlotManager::HandleViewportChanged(PlotFrame *source, const PlotViewportSta
    if (!m_lockAllPlots)
       return;
 
+   // A second source within the same tick also receives the latest state.
+   m_pendingViewport       = viewport;
+   m_pendingViewportSource = source;
+   ScheduleRenderTick();
+}
+
+void PlotManager::FlushViewportSync()
+{
+   if (!m_pendingViewport)
+      return;
+
+   const PlotViewportState viewport = *m_pendingViewport;
+   PlotFrame *source                = m_pendingViewportSource;
+   m_pendingViewport.reset();
+   m_pendingViewportSource = nullptr;
+
    for (auto &entry : m_plots) {
       PlotFrame *frame = entry.second.frame;
       if (!frame || frame == source)
@@ -234,9 +334,106 @@ void PlotManager::HandleViewportChanged(PlotFrame *source, const PlotViewportSta
    }
 }
 
+void PlotManager::ScheduleRenderTick()
+{
+   ScheduleRenderTick(std::chrono::steady_clock::time_point::min());
+}
+
+void PlotManager::ScheduleRenderTick(std::chrono::steady_clock::time_point due)
+{
+   const std::chrono::duration<double> frameInterval(1.0 / m_maxFrameRate);
+   due = std::max(due, m_lastRenderTick + std::chrono::duration_cast<std::chrono::steady_clock::duration>(frameInterval));
+   if (m_renderTimer->IsRunning() && m_renderTickDue <= due)
+      return;
+
+   m_renderTickDue      = due;
+   const auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(due - std::chrono::steady_clock::now());
+   m_renderTimer->StartOnce(static_cast<int>(std::max<std::chrono::milliseconds::rep>(1, remaining.count())));
+}
+
+void PlotManager::RenderTick()
+{
+   m_lastRenderTick = std::chrono::steady_clock::now();
+   m_dataService.BeginTick(m_lastRenderTick);
+   FlushViewportSync();
+
+   // Painting never re-arms the timer, so m_plots is stable for the whole
+   // pass. Skipped frames stay dirty until they are restored.
+   std::optional<std::chrono::steady_clock::time_point> nextClockMove;
+   for (auto &entry : m_plots) {
+      PlotFrame *frame = entry.second.frame;
+      if (!frame || !frame->IsRenderable())
+         continue;
+
+      frame->RenderTick(m_lastRenderTick);
+      const auto frameMove = frame->GetNextClockMove();
+      if (frameMove && (!nextClockMove || *frameMove < *nextClockMove))
+         nextClockMove = frameMove;
+   }
+
+   // Live views wake the scheduler when they next scroll by a pixel rather
+   // than on every frame.
+   if (nextClockMove)
+      ScheduleRenderTick(*nextClockMove);
+}
+
 void PlotManager::HandlePlotClosed(const std::string &name)
 {
    auto it = m_plots.find(name);
-   if (it != m_plots.end())
+   if (it != m_plots.end()) {
+      if (it->second.frame == m_pendingViewportSource)
+         m_pendingViewportSource = nullptr;
       m_plots.erase(it);
+   }
+   m_subscriptions.clear();
+   InvalidateSubscriptions();
+}
+
+void PlotManager::SetMaxFrameRate(double framesPerSecond)
+{
+   if (!std::isfinite(framesPerSecond) || framesPerSecond <= 0.0)
+      return;
+
+   m_maxFrameRate = framesPerSecond;
+}
+
+void PlotManager::HandleSensorUpdated(const Node *node)
+{
+   if (!node) {
+      // The tree was cleared; every plot has to drop its stale series.
+      m_subscriptions.clear();
+      InvalidateSubscriptions();
+      for (auto &entry : m_plots) {
+         if (entry.second.frame)
+            entry.second.frame->MarkDirty();
+      }
+      return;
+   }
+
+   if (!m_subscriptionsValid || m_subscribedStructureVersion != m_model->GetStructureVersion())
+      RebuildSubscriptions();
+
+   const auto it = m_subscriptions.find(node);
+   if (it == m_subscriptions.end())
+      return;
+
+   for (PlotFrame *frame : it->second)
+      frame->MarkDirty();
+}
+
+void PlotManager::RebuildSubscriptions()
+{
+   m_subscriptions.clear();
+   for (const auto &entry : m_plots) {
+      PlotFrame *frame = entry.second.frame;
+      if (!frame)
+         continue;
+      for (const PlotSeries &series : frame->GetSeries()) {
+         if (const Node *node = m_model->FindNodeByPath(series.pathSegments))
+            m_subscriptions[node].push_back(frame);
+      }
+   }
+
+   m_subscriptionsValid         = true;
+   m_subscribedStructureVersion = m_model->GetStructureVersion();
 }
@@ -0,0 +1,838 @@
+#include "PlotRenderer.h"
+
+#include "PlotCategoryDictionary.h"
+#include "PlotDataService.h"
+#include "PlotDecimator.h"
+#include "SensorTreeModel.h"
+
+#include <wx/dcmemory.h>
+#include <wx/graphics.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <string>
+
+namespace {
+
+using TimePoint = PlotRenderer::TimePoint;
+using Duration  = PlotRenderer::Duration;
+
+struct ResolvedXWindow
+{
+   bool hasWindow      = false;
+   TimePoint viewStart = TimePoint::min();
+   TimePoint viewEnd   = TimePoint::min();
+   TimePoint plotStart = TimePoint::min();
+   TimePoint plotEnd   = TimePoint::min();
+};
+
+Duration ClampPositiveDuration(Duration duration)
+{
+   if (duration <= Duration::zero())
+      return std::chrono::milliseconds(1);
+   return duration;
+}
+
+ResolvedXWindow ResolveXWindow(const PlotViewportState &viewport,
+    const std::optional<std::chrono::seconds> &windowDuration,
+    bool isLiveData,
+    TimePoint latestOverall,
+    TimePoint now,
+    TimePoint earliest,
+    TimePoint latest)
+{
+   ResolvedXWindow resolved;
+
+   const TimePoint defaultViewEnd = isLiveData ? std::max(now, latestOverall) : latestOverall;
+   const bool hasCustomXView      = viewport.xMin.has_value() && viewport.xMax.has_value();
+
+   resolved.hasWindow = hasCustomXView || static_cast<bool>(windowDuration);
+
+   if (hasCustomXView) {
+      const Duration customSpan = ClampPositiveDuration(*viewport.xMax - *viewport.xMin);
+      resolved.viewEnd          = viewport.followLatest ? defaultViewEnd : *viewport.xMax;
+      resolved.viewStart        = viewport.followLatest ? (resolved.viewEnd - customSpan) : *viewport.xMin;
+   } else if (windowDuration) {
+      const Duration presetSpan = std::chrono::duration_cast<Duration>(*windowDuration);
+      resolved.viewEnd          = defaultViewEnd;
+      resolved.viewStart        = resolved.viewEnd - presetSpan;
+   }
+
+   resolved.plotStart = resolved.hasWindow ? resolved.viewStart : earliest;
+   resolved.plotEnd   = resolved.hasWindow ? resolved.viewEnd : (isLiveData ? std::max(now, latest) : latest);
+   if (resolved.plotEnd <= resolved.plotStart)
+      resolved.plotStart = resolved.plotEnd - std::chrono::milliseconds(1);
+
+   return resolved;
+}
+
+PlotPoint ToPoint(const PlotRenderer::FrameLayout &layout, const PlotRenderer::PreparedSample &sample)
+{
+   const double tSeconds = std::chrono::duration<double>(sample.timestamp - layout.plotStart).count();
+   const double xNorm    = tSeconds / layout.timeRange;
+   const double yNorm    = (sample.mappedValue - layout.minValue) / layout.valueRange;
+   const double x        = layout.plotRect.GetLeft() + xNorm * layout.plotRect.GetWidth();
+   const double y        = (layout.plotRect.GetTop() + layout.plotRect.GetHeight()) - yNorm * layout.plotRect.GetHeight();
+   return PlotPoint{x, y};
+}
+
+void DrawLegendEntries(wxDC &dc, const wxPoint &origin, const std::vector<PlotRenderer::LegendEntry> &entries)
+{
+   int legendY = origin.y;
+   for (const PlotRenderer::LegendEntry &entry : entries) {
+      dc.SetBrush(wxBrush(entry.colour));
+      dc.SetPen(*wxTRANSPARENT_PEN);
+      dc.DrawRectangle(origin.x, legendY, 10, 10);
+      dc.SetTextForeground(entry.missing ? PlotRenderer::MissingTextColour() : PlotRenderer::TextColour());
+      dc.DrawText(entry.label, origin.x + 15, legendY - 2);
+      legendY += 16;
+   }
+}
+
+// Opacity of the min/max, 10-90 and interquartile envelope bands.
+constexpr unsigned char RANGE_BAND_ALPHA    = 60;
+constexpr unsigned char DECILE_BAND_ALPHA   = 110;
+constexpr unsigned char QUARTILE_BAND_ALPHA = 170;
+
+wxColour WithAlpha(const wxColour &colour, unsigned char alpha)
+{
+   return wxColour(colour.Red(), colour.Green(), colour.Blue(), alpha);
+}
+
+// Solid colour a translucent band shows over the plot background, for the legend.
+wxColour BlendOverBackground(const wxColour &colour, unsigned char alpha)
+{
+   const wxColour background = PlotRenderer::BackgroundColour();
+   auto blend                = [alpha](unsigned char top, unsigned char bottom) {
+      return static_cast<unsigned char>((top * alpha + bottom * (255 - alpha)) / 255);
+   };
+   return wxColour(blend(colour.Red(), background.Red()), blend(colour.Green(), background.Green()), blend(colour.Blue(), background.Blue()));
+}
+
+void DrawEnvelope(wxGraphicsContext &gc, const PlotRenderer::FrameLayout &layout)
+{
+   using EnvelopeColumn                       = PlotRenderer::EnvelopeColumn;
+   const std::vector<EnvelopeColumn> &columns = layout.envelope;
+
+   const double left   = layout.plotRect.GetLeft();
+   const double bottom = layout.plotRect.GetTop() + layout.plotRect.GetHeight();
+   const double height = layout.plotRect.GetHeight();
+   auto yOf            = [&](double value) { return bottom - (value - layout.minValue) / layout.valueRange * height; };
+
+   // Each run of columns with data becomes one closed band between two
+   // statistics, stepping across whole pixel columns.
+   auto fillBand = [&](double EnvelopeColumn::*upper, double EnvelopeColumn::*lower, const wxColour &colour) {
+      gc.SetPen(*wxTRANSPARENT_PEN);
+      gc.SetBrush(wxBrush(colour));
+      wxGraphicsPath path = gc.CreatePath();
+      size_t column       = 0;
+      while (column < columns.size()) {
+         if (!columns[column].valid) {
+            ++column;
+            continue;
+         }
+         const size_t runStart = column;
+         while (column < columns.size() && columns[column].valid)
+            ++column;
+
+         path.MoveToPoint(left + runStart, yOf(columns[runStart].*upper));
+         for (size_t idx = runStart; idx < column; ++idx) {
+            path.AddLineToPoint(left + idx, yOf(columns[idx].*upper));
+            path.AddLineToPoint(left + idx + 1, yOf(columns[idx].*upper));
+         }
+         for (size_t idx = column; idx-- > runStart;) {
+            path.AddLineToPoint(left + idx + 1, yOf(columns[idx].*lower));
+            path.AddLineToPoint(left + idx, yOf(columns[idx].*lower));
+         }
+         path.CloseSubpath();
+      }
+      gc.FillPath(path);
+   };
+
+   const wxColour base = PlotRenderer::EnvelopeColour();
+   fillBand(&EnvelopeColumn::max, &EnvelopeColumn::min, WithAlpha(base, RANGE_BAND_ALPHA));
+   fillBand(&EnvelopeColumn::p90, &EnvelopeColumn::p10, WithAlpha(base, DECILE_BAND_ALPHA));
+   fillBand(&EnvelopeColumn::p75, &EnvelopeColumn::p25, WithAlpha(base, QUARTILE_BAND_ALPHA));
+
+   wxGraphicsPath medianPath = gc.CreatePath();
+   bool penDown              = false;
+   for (size_t column = 0; column < columns.size(); ++column) {
+      if (!columns[column].valid) {
+         penDown = false;
+         continue;
+      }
+      const double x = left + column + 0.5;
+      const double y = yOf(columns[column].median);
+      if (penDown)
+         medianPath.AddLineToPoint(x, y);
+      else
+         medianPath.MoveToPoint(x, y);
+      penDown = true;
+   }
+   gc.SetPen(wxPen(PlotRenderer::TextColour(), 1));
+   gc.StrokePath(medianPath);
+
+   // Outliers arrive grouped by column; repeats on the same pixel are drawn once.
+   wxGraphicsPath outlierPath = gc.CreatePath();
+   std::vector<int> rows;
+   for (size_t first = 0; first < layout.outliers.size();) {
+      const int column = layout.outliers[first].column;
+      size_t last      = first;
+      rows.clear();
+      for (; last < layout.outliers.size() && layout.outliers[last].column == column; ++last)
+         rows.push_back(static_cast<int>(std::lround(yOf(layout.outliers[last].value))));
+      std::sort(rows.begin(), rows.end());
+      rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+      for (int row : rows)
+         outlierPath.AddRectangle(left + column - 1.0, row - 1.0, 3.0, 3.0);
+      first = last;
+   }
+   gc.SetPen(*wxTRANSPARENT_PEN);
+   gc.SetBrush(wxBrush(PlotRenderer::OutlierColour()));
+   gc.FillPath(outlierPath);
+}
+
+} // namespace
+
+std::vector<const Node *> PlotRenderer::ResolveNodes(const PlotRenderRequest &request)
+{
+   const std::vector<PlotSeries> &series = *request.series;
+
+   std::vector<const Node *> nodes(series.size(), nullptr);
+   for (size_t idx = 0; idx < series.size(); ++idx)
+      nodes[idx] = request.model->FindNodeByPath(series[idx].pathSegments);
+   return nodes;
+}
+
+void PlotRenderer::PrepareFrame(const PlotRenderRequest &request, const wxSize &size, FrameLayout &layout)
+{
+   const std::vector<PlotSeries> &series = *request.series;
+
+   const int plotWidth  = std::max(1, size.GetWidth() - LEFT_MARGIN - RIGHT_MARGIN);
+   const int plotHeight = std::max(1, size.GetHeight() - TOP_MARGIN - BOTTOM_MARGIN);
+   const int plotTop    = size.GetHeight() - BOTTOM_MARGIN - plotHeight;
+
+   layout.plotRect     = wxRect(LEFT_MARGIN, plotTop, plotWidth, plotHeight);
+   layout.legendOrigin = wxPoint(LEFT_MARGIN + 8, plotTop + 24);
+
+   if (series.empty()) {
+      layout.statusMessage = "No sensors selected for plotting.";
+      return;
+   }
+
+   // Resolve each configured path to a live node in the model and capture
+   // what drawing needs from it. Only this holds up writers; the history
+   // views stay consistent after the lock is released.
+   std::vector<std::optional<Node::HistoryView>> histories(series.size());
+   {
+      const auto lock      = request.model->LockStore();
+      layout.resolvedNodes = ResolveNodes(request);
+      layout.updateCounts.assign(series.size(), 0);
+      layout.statistics.assign(series.size(), SeriesStatistics{});
+      for (size_t idx = 0; idx < series.size(); ++idx) {
+         const Node *node = layout.resolvedNodes[idx];
+         if (!node)
+            continue;
+
+         const SensorStatistics &statistics = node->GetStatistics();
+         layout.updateCounts[idx]           = node->GetUpdateCount();
+         layout.statistics[idx]             = SeriesStatistics{statistics.HasNumeric(), statistics.GetMean(), statistics.GetStdDev()};
+         histories[idx].emplace(node->GetHistory());
+      }
+   }
+
+   const bool anyResolved = std::any_of(layout.resolvedNodes.begin(), layout.resolvedNodes.end(),
+       [](const Node *node) { return node != nullptr; });
+
+   if (!anyResolved) {
+      layout.statusMessage    = "Assigned sensors are not available in the tree.";
+      layout.showStatusLegend = true;
+      layout.legendOrigin     = wxPoint(10, 40);
+      return;
+   }
+
+   // Track the oldest and newest samples across all series to detect
+   // available data and to bound plots that show the whole history.
+   auto earliest      = std::chrono::steady_clock::time_point::max();
+   auto latestOverall = std::chrono::steady_clock::time_point::min();
+   for (const std::optional<Node::HistoryView> &history : histories) {
+      if (!history || history->empty())
+         continue;
+      earliest      = std::min(earliest, history->front().timestamp);
+      latestOverall = std::max(latestOverall, history->back().timestamp);
+   }
+
+   if (latestOverall == std::chrono::steady_clock::time_point::min()) {
+      layout.statusMessage    = "Waiting for samples...";
+      layout.showStatusLegend = true;
+      return;
+   }
+
+   TimePoint latest = latestOverall;
+   if (latest <= earliest)
+      latest = earliest + std::chrono::milliseconds(1);
+
+   const auto &windowDuration        = request.windowDuration;
+   const PlotViewportState &viewport = request.viewport;
+   const bool isLiveData             = request.model->IsLiveDataMode();
+   const auto now                    = request.now;
+
+   // Define the time window that maps to the plot rectangle.
+   // For fixed windows we end at the newest known sample (or now, whichever is later).
+   const ResolvedXWindow xWindow = ResolveXWindow(viewport, windowDuration, isLiveData, latestOverall, now, earliest, latest);
+   const bool hasWindow          = xWindow.hasWindow;
+   TimePoint viewStart           = xWindow.viewStart;
+   TimePoint viewEnd             = xWindow.viewEnd;
+
+   layout.followsLatest = hasWindow && viewport.followLatest;
+   layout.tracksClock   = isLiveData && (!hasWindow || viewport.followLatest);
+   if (layout.followsLatest) {
+      layout.pixelDuration = std::max(Duration(1), (viewEnd - viewStart) / plotWidth);
+      const auto endPixel  = (viewEnd.time_since_epoch() + layout.pixelDuration - Duration(1)) / layout.pixelDuration;
+      viewEnd              = TimePoint(endPixel * layout.pixelDuration);
+      viewStart            = viewEnd - layout.pixelDuration * plotWidth;
+   }
+
+   // Windowed views use the (possibly pixel-snapped) bounds; otherwise the
+   // plot spans the whole history.
+   layout.plotStart = hasWindow ? viewStart : xWindow.plotStart;
+   layout.plotEnd   = hasWindow ? viewEnd : xWindow.plotEnd;
+
+   // Per-sensor scanning and decimation is shared through the data service so
+   // plots showing the same sensor and window reuse one snapshot. One-off
+   // renders without a service build theirs against a throwaway dictionary.
+   PlotCategoryDictionary localCategories;
+   const PlotCategoryDictionary &categories = request.dataService ? request.dataService->GetCategories() : localCategories;
+
+   // Categorical lanes have no shared scale across hundreds of sensors, so
+   // dense plots summarise numeric samples only.
+   layout.denseMode = series.size() >= DENSE_SERIES_THRESHOLD;
+
+   std::vector<std::shared_ptr<const PlotDataService::Snapshot>> snapshots(series.size());
+   std::vector<bool> usedLanes;
+   bool hasNumericSamples = false;
+   bool hasData           = false;
+   NumericExtents numericExtents;
+
+   for (size_t idx = 0; idx < series.size(); ++idx) {
+      const std::optional<Node::HistoryView> &history = histories[idx];
+      if (!history || history->empty())
+         continue;
+
+      PlotDataService::SnapshotKey key;
+      key.node       = layout.resolvedNodes[idx];
+      key.hasWindow  = hasWindow;
+      key.viewStart  = layout.plotStart;
+      key.viewEnd    = layout.plotEnd;
+      key.pixelWidth = plotWidth;
+
+      snapshots[idx] = request.dataService
+                           ? request.dataService->Acquire(key, request.model->GetStructureVersion(), *history)
+                           : std::make_shared<const PlotDataService::Snapshot>(PlotDataService::BuildSnapshot(key, *history, localCategories));
+
+      const PlotDataService::Snapshot &snapshot = *snapshots[idx];
+      numericExtents.Merge(snapshot.numericExtents);
+      hasNumericSamples = hasNumericSamples || snapshot.numericExtents.IsValid();
+      hasData           = hasData || snapshot.hasData;
+      if (layout.denseMode)
+         continue;
+      for (size_t lane : snapshot.visibleLanes) {
+         if (lane >= usedLanes.size())
+            usedLanes.resize(lane + 1, false);
+         usedLanes[lane] = true;
+      }
+   }
+
+   if (!hasData) {
+      layout.statusMessage    = "No samples in selected timescale.";
+      layout.showStatusLegend = true;
+      return;
+   }
+
+   // Lanes visible in this plot are packed into consecutive rows in
+   // dictionary order; the mapping is monotonic, so the per-column extremes
+   // kept by decimation remain the extremes after mapping.
+   std::vector<double> laneRows(usedLanes.size(), std::numeric_limits<double>::quiet_NaN());
+   double nextRow = 0.0;
+   for (size_t lane = 0; lane < usedLanes.size(); ++lane) {
+      if (!usedLanes[lane])
+         continue;
+      laneRows[lane]                    = nextRow;
+      layout.categoricalLabels[nextRow] = categories.GetLabel(lane);
+      ++nextRow;
+   }
+   layout.hasCategoricalSamples = nextRow > 0.0;
+
+   layout.prepared.assign(series.size(), {});
+   for (size_t idx = 0; idx < series.size(); ++idx) {
+      if (!snapshots[idx])
+         continue;
+
+      const std::vector<PlotDataService::Sample> &samples = snapshots[idx]->samples;
+      std::vector<PreparedSample> &bucket                  = layout.prepared[idx];
+      bucket.reserve(samples.size());
+      for (const PlotDataService::Sample &sample : samples) {
+         double mapped = sample.value;
+         if (sample.categorical) {
+            const size_t lane = static_cast<size_t>(sample.value);
+            // Off-window neighbours may carry a category this plot does not show.
+            if (lane >= laneRows.size() || std::isnan(laneRows[lane]))
+               continue;
+            mapped = laneRows[lane];
+         }
+         bucket.push_back(PreparedSample{sample.timestamp, mapped});
+      }
+   }
+
+   double minValue = std::numeric_limits<double>::infinity();
+   double maxValue = -std::numeric_limits<double>::infinity();
+
+   auto updateRange = [&](double candidateMin, double candidateMax) {
+      minValue = std::min(minValue, candidateMin);
+      maxValue = std::max(maxValue, candidateMax);
+   };
+
+   if (hasNumericSamples && std::isfinite(numericExtents.min) && std::isfinite(numericExtents.max))
+      updateRange(numericExtents.min, numericExtents.max);
+
+   if (layout.hasCategoricalSamples)
+      updateRange(-0.5, nextRow - 0.5);
+
+   if (!std::isfinite(minValue) || !std::isfinite(maxValue)) {
+      minValue = -1.0;
+      maxValue = 1.0;
+   } else if (minValue == maxValue) {
+      minValue -= 1.0;
+      maxValue += 1.0;
+   }
+
+   layout.timeRange            = std::max(1e-9, std::chrono::duration<double>(layout.plotEnd - layout.plotStart).count());
+   layout.minValue             = minValue;
+   layout.maxValue             = maxValue;
+   layout.valueRange           = std::max(1e-9, maxValue - minValue);
+   layout.usingCategoricalAxis = layout.hasCategoricalSamples && !hasNumericSamples;
+   layout.showStatistics       = request.showStatistics && !layout.denseMode && !layout.usingCategoricalAxis;
+
+   if (layout.denseMode)
+      BuildEnvelope(layout);
+}
+
+void PlotRenderer::BuildEnvelope(FrameLayout &layout)
+{
+   const int width = layout.plotRect.GetWidth();
+   layout.envelope.assign(static_cast<size_t>(width), EnvelopeColumn{});
+   layout.outliers.clear();
+
+   const double columnsPerSecond = static_cast<double>(width) / layout.timeRange;
+   auto columnOf                 = [&](TimePoint timestamp) {
+      return static_cast<long long>(std::floor(std::chrono::duration<double>(timestamp - layout.plotStart).count() * columnsPerSecond));
+   };
+
+   // Visits the value(s) each series contributes to every column. Gaps
+   // between a series' samples hold its previous value so sparse sensors are
+   // still counted; nothing is extrapolated past a series' newest sample.
+   auto visitSeries = [&](const std::vector<PreparedSample> &samples, auto &&emit) {
+      size_t cursor = 0;
+      double held   = 0.0;
+      bool holding  = false;
+      while (cursor < samples.size() && columnOf(samples[cursor].timestamp) < 0) {
+         held    = samples[cursor++].mappedValue;
+         holding = true;
+      }
+
+      for (long long column = 0; column < width && cursor < samples.size(); ++column) {
+         bool emitted = false;
+         while (cursor < samples.size() && columnOf(samples[cursor].timestamp) == column) {
+            held    = samples[cursor++].mappedValue;
+            holding = true;
+            emitted = true;
+            emit(static_cast<size_t>(column), held);
+         }
+         if (!emitted && holding && cursor < samples.size())
+            emit(static_cast<size_t>(column), held);
+      }
+   };
+
+   // Two passes lay every column's values out contiguously so the per-column
+   // reductions below run over flat buffers.
+   std::vector<size_t> offsets(static_cast<size_t>(width) + 1, 0);
+   for (const std::vector<PreparedSample> &samples : layout.prepared)
+      visitSeries(samples, [&](size_t column, double) { ++offsets[column + 1]; });
+   for (size_t column = 0; column < static_cast<size_t>(width); ++column)
+      offsets[column + 1] += offsets[column];
+
+   std::vector<double> values(offsets.back());
+   std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+   for (const std::vector<PreparedSample> &samples : layout.prepared)
+      visitSeries(samples, [&](size_t column, double value) { values[fill[column]++] = value; });
+
+   for (size_t column = 0; column < static_cast<size_t>(width); ++column) {
+      double *begin      = values.data() + offsets[column];
+      double *end        = values.data() + offsets[column + 1];
+      const size_t count = static_cast<size_t>(end - begin);
+      if (count == 0)
+         continue;
+
+      EnvelopeColumn &stats        = layout.envelope[column];
+      const NumericExtents extents = SampleHistory::ScanExtents(begin, count);
+      stats.valid                  = true;
+      stats.min                    = extents.min;
+      stats.max                    = extents.max;
+
+      // Increasing ranks let each selection work on the tail left by the
+      // previous one, so all quantiles cost about one linear pass.
+      double *partitioned = begin;
+      auto quantile       = [&](double fraction) {
+         double *nth = begin + static_cast<std::ptrdiff_t>(std::lround(fraction * static_cast<double>(count - 1)));
+         std::nth_element(partitioned, nth, end);
+         partitioned = nth;
+         return *nth;
+      };
+      stats.p10    = quantile(0.10);
+      stats.p25    = quantile(0.25);
+      stats.median = quantile(0.50);
+      stats.p75    = quantile(0.75);
+      stats.p90    = quantile(0.90);
+
+      const double spread    = stats.p75 - stats.p25;
+      const double lowFence  = stats.p25 - 1.5 * spread;
+      const double highFence = stats.p75 + 1.5 * spread;
+      if (stats.min >= lowFence && stats.max <= highFence)
+         continue;
+      for (const double *value = begin; value != end; ++value) {
+         if (*value < lowFence || *value > highFence)
+            layout.outliers.push_back(EnvelopeOutlier{static_cast<int>(column), *value});
+      }
+   }
+}
+
+std::vector<PlotRenderer::LegendEntry> PlotRenderer::BuildLegendEntries(const PlotRenderRequest &request, const std::vector<const Node *> &resolvedNodes)
+{
+   const std::vector<PlotSeries> &series = *request.series;
+
+   if (series.size() >= DENSE_SERIES_THRESHOLD) {
+      // One line per sensor would not fit; describe the envelope instead.
+      const size_t available = static_cast<size_t>(std::count_if(resolvedNodes.begin(), resolvedNodes.end(),
+          [](const Node *node) { return node != nullptr; }));
+      const size_t missing   = series.size() - available;
+
+      std::vector<LegendEntry> entries = {
+          {wxString::Format("%zu sensors: min to max", available), BlendOverBackground(EnvelopeColour(), RANGE_BAND_ALPHA), false},
+          {"10th to 90th percentile", BlendOverBackground(EnvelopeColour(), DECILE_BAND_ALPHA), false},
+          {"Interquartile range", BlendOverBackground(EnvelopeColour(), QUARTILE_BAND_ALPHA), false},
+          {"Median", TextColour(), false},
+          {"Outliers beyond 1.5 IQR", OutlierColour(), false}};
+      if (missing > 0)
+         entries.push_back(LegendEntry{wxString::Format("%zu sensors (no data)", missing), MissingTextColour(), true});
+      return entries;
+   }
+
+   std::vector<LegendEntry> entries;
+   entries.reserve(series.size());
+   for (size_t idx = 0; idx < series.size(); ++idx) {
+      const bool missing = idx >= resolvedNodes.size() || !resolvedNodes[idx];
+      wxString label     = wxString::FromUTF8(series[idx].displayPath.c_str());
+      if (missing)
+         label += " (no data)";
+      entries.push_back(LegendEntry{label, series[idx].colour, missing});
+   }
+   return entries;
+}
+
+wxSize PlotRenderer::MeasureLegend(wxDC &dc, const std::vector<LegendEntry> &entries)
+{
+   int textWidth = 0;
+   for (const LegendEntry &entry : entries)
+      textWidth = std::max(textWidth, dc.GetTextExtent(entry.label).GetWidth());
+
+   return wxSize(LEGEND_PADDING * 2 + 15 + textWidth, LEGEND_PADDING * 2 + 16 * static_cast<int>(entries.size()));
+}
+
+wxPoint PlotRenderer::GetLegendBoxOrigin(const FrameLayout &layout)
+{
+   return wxPoint(layout.legendOrigin.x - LEGEND_PADDING, layout.legendOrigin.y - LEGEND_PADDING - 2);
+}
+
+void PlotRenderer::DrawLegendBox(wxDC &dc, const wxPoint &boxOrigin, const std::vector<LegendEntry> &entries)
+{
+   dc.SetBrush(wxBrush(BackgroundColour()));
+   dc.SetPen(*wxTRANSPARENT_PEN);
+   dc.DrawRectangle(boxOrigin, MeasureLegend(dc, entries));
+   DrawLegendEntries(dc, wxPoint(boxOrigin.x + LEGEND_PADDING, boxOrigin.y + LEGEND_PADDING + 2), entries);
+}
+
+void PlotRenderer::DrawStatus(wxDC &dc, const FrameLayout &layout, const std::vector<LegendEntry> &legend)
+{
+   dc.SetBackground(wxBrush(BackgroundColour()));
+   dc.Clear();
+   dc.SetTextForeground(TextColour());
+   dc.DrawText(layout.statusMessage, wxPoint(10, 10));
+   if (layout.showStatusLegend)
+      DrawLegendEntries(dc, layout.legendOrigin, legend);
+}
+
+void PlotRenderer::DrawChrome(wxDC &dc, const FrameLayout &layout)
+{
+   dc.SetBackground(wxBrush(BackgroundColour()));
+   dc.Clear();
+
+   auto formatSeconds = [](double seconds) {
+      if (seconds < 1.0)
+         return wxString::Format("%.2fs", seconds);
+      if (seconds < 60.0)
+         return wxString::Format("%.1fs", seconds);
+      const int totalSeconds = static_cast<int>(std::round(seconds));
+      const int minutes      = totalSeconds / 60;
+      const int remSeconds   = totalSeconds % 60;
+      if (minutes < 60)
+         return wxString::Format("%dm %02ds", minutes, remSeconds);
+      const int hours  = minutes / 60;
+      const int remMin = minutes % 60;
+      return wxString::Format("%dh %02dm", hours, remMin);
+   };
+
+   auto formatValue = [](double value) {
+      const double absVal = std::fabs(value);
+      if (absVal >= 1000.0)
+         return wxString::Format("%.0f", value);
+      if (absVal >= 100.0)
+         return wxString::Format("%.1f", value);
+      return wxString::Format("%.2f", value);
+   };
+
+   const wxRect &rect   = layout.plotRect;
+   const int leftMargin = rect.GetLeft();
+   const int plotWidth  = rect.GetWidth();
+   const int plotHeight = rect.GetHeight();
+   const wxPoint origin(rect.GetLeft(), rect.GetTop() + plotHeight);
+
+   dc.SetTextForeground(TextColour());
+
+   // Annotate value axis.
+   if (layout.usingCategoricalAxis) {
+      for (const auto &tick : layout.categoricalLabels) {
+         const double fraction = (tick.first - layout.minValue) / layout.valueRange;
+         const double yPos     = static_cast<double>(origin.y) - fraction * static_cast<double>(plotHeight);
+         const wxSize textSz   = dc.GetTextExtent(tick.second);
+         dc.DrawText(tick.second, wxPoint(leftMargin - textSz.GetWidth() - 6, static_cast<int>(std::round(yPos)) - textSz.GetHeight() / 2));
+      }
+   } else {
+      for (int i = 0; i <= 5; ++i) {
+         const double fraction = static_cast<double>(i) / 5.0;
+         const double value    = layout.minValue + fraction * (layout.maxValue - layout.minValue);
+         const wxString label  = formatValue(value);
+         const int y           = origin.y - static_cast<int>(fraction * plotHeight);
+         const wxSize textSz   = dc.GetTextExtent(label);
+         dc.DrawText(label, wxPoint(leftMargin - textSz.GetWidth() - 6, y - textSz.GetHeight() / 2));
+      }
+
+      if (layout.hasCategoricalSamples) {
+         for (const auto &tick : layout.categoricalLabels) {
+            const double fraction = (tick.first - layout.minValue) / layout.valueRange;
+            const double yPos     = static_cast<double>(origin.y) - fraction * static_cast<double>(plotHeight);
+            const wxSize textSz   = dc.GetTextExtent(tick.second);
+            dc.DrawText(tick.second, wxPoint(leftMargin + plotWidth + 6, static_cast<int>(std::round(yPos)) - textSz.GetHeight() / 2));
+         }
+      }
+   }
+
+   // Annotate time axis at the bottom. Labels are relative to the window
+   // start, so they stay valid while a follow-latest window scrolls.
+   for (int i = 0; i <= 5; ++i) {
+      const double fraction = static_cast<double>(i) / 5.0;
+      const double seconds  = fraction * layout.timeRange;
+      const wxString label  = formatSeconds(seconds);
+      const int x           = leftMargin + static_cast<int>(fraction * plotWidth);
+      const wxSize textSz   = dc.GetTextExtent(label);
+      dc.DrawText(label, wxPoint(x - textSz.GetWidth() / 2, origin.y + 4));
+   }
+}
+
+void PlotRenderer::DrawGrid(wxDC &dc, const FrameLayout &layout)
+{
+   const wxRect &rect = layout.plotRect;
+   const int leftX    = rect.GetLeft();
+   const int rightX   = rect.GetLeft() + rect.GetWidth();
+   const int topY     = rect.GetTop();
+   const int bottomY  = rect.GetTop() + rect.GetHeight();
+
+   dc.SetPen(wxPen(GridColour(), 1, wxPENSTYLE_DOT));
+   if (layout.usingCategoricalAxis) {
+      for (const auto &tick : layout.categoricalLabels) {
+         const double fraction = (tick.first - layout.minValue) / layout.valueRange;
+         const int y           = static_cast<int>(std::round(bottomY - fraction * rect.GetHeight()));
+         dc.DrawLine(leftX, y, rightX, y);
+      }
+   } else {
+      for (int i = 0; i <= 5; ++i) {
+         const int y = static_cast<int>(std::round(bottomY - (static_cast<double>(rect.GetHeight()) * i) / 5.0));
+         dc.DrawLine(leftX, y, rightX, y);
+      }
+   }
+   for (int i = 0; i <= 5; ++i) {
+      const int x = static_cast<int>(std::round(leftX + (static_cast<double>(rect.GetWidth()) * i) / 5.0));
+      dc.DrawLine(x, bottomY, x, topY);
+   }
+}
+
+void PlotRenderer::DrawStatisticsOverlay(wxDC &dc, const FrameLayout &layout, const std::vector<PlotSeries> &series)
+{
+   if (!layout.showStatistics)
+      return;
+
+   const wxRect &rect = layout.plotRect;
+   const int leftX    = rect.GetLeft();
+   const int rightX   = rect.GetLeft() + rect.GetWidth();
+   const int topY     = rect.GetTop();
+   const int bottomY  = rect.GetTop() + rect.GetHeight();
+
+   auto drawLevel = [&](double value, wxPenStyle style, const wxColour &colour) {
+      const double fraction = (value - layout.minValue) / layout.valueRange;
+      const int y           = static_cast<int>(std::round(bottomY - fraction * rect.GetHeight()));
+      if (y < topY || y > bottomY)
+         return;
+      dc.SetPen(wxPen(colour, 1, style));
+      dc.DrawLine(leftX, y, rightX, y);
+   };
+
+   for (size_t idx = 0; idx < series.size() && idx < layout.statistics.size(); ++idx) {
+      const SeriesStatistics &statistics = layout.statistics[idx];
+      if (!statistics.hasNumeric)
+         continue;
+
+      const double mean   = statistics.mean;
+      const double stdDev = statistics.stdDev;
+      drawLevel(mean, wxPENSTYLE_SHORT_DASH, series[idx].colour);
+      if (stdDev > 0.0) {
+         drawLevel(mean - stdDev, wxPENSTYLE_DOT, series[idx].colour);
+         drawLevel(mean + stdDev, wxPENSTYLE_DOT, series[idx].colour);
+      }
+   }
+}
+
+void PlotRenderer::DrawSeries(wxGraphicsContext &gc,
+    const FrameLayout &layout,
+    const std::vector<PlotSeries> &series,
+    const std::vector<TimePoint> *drawnUntil)
+{
+   if (layout.denseMode) {
+      DrawEnvelope(gc, layout);
+      return;
+   }
+
+   const double leftX   = layout.plotRect.GetLeft();
+   const double rightX  = layout.plotRect.GetLeft() + layout.plotRect.GetWidth();
+   const double topY    = layout.plotRect.GetTop();
+   const double bottomY = layout.plotRect.GetTop() + layout.plotRect.GetHeight();
+
+   const double markerRadius   = 2.0;
+   const double markerDiameter = markerRadius * 2.0;
+
+   auto isPointInsidePlot = [&](const PlotPoint &point) {
+      return point.x >= leftX && point.x <= rightX && point.y >= topY && point.y <= bottomY;
+   };
+
+   // Reuse scratch buffers so we only allocate when a series exceeds prior size.
+   std::vector<PlotPoint> pointCache;
+   pointCache.reserve(128);
+
+   for (size_t idx = 0; idx < series.size() && idx < layout.prepared.size(); ++idx) {
+      const auto &entry           = series[idx];
+      const auto &filteredHistory = layout.prepared[idx];
+      if (filteredHistory.empty())
+         continue;
+
+      // When appending, restart from the newest sample already on the layer
+      // so the new segment connects to the existing polyline.
+      size_t firstSample = 0;
+      if (drawnUntil && idx < drawnUntil->size() && (*drawnUntil)[idx] != TimePoint::min()) {
+         const TimePoint until = (*drawnUntil)[idx];
+         const auto next       = std::upper_bound(filteredHistory.begin(), filteredHistory.end(), until,
+             [](const TimePoint &time, const PreparedSample &sample) { return time < sample.timestamp; });
+         if (next == filteredHistory.end())
+            continue;
+         firstSample = static_cast<size_t>(std::max<std::ptrdiff_t>(0, (next - filteredHistory.begin()) - 1));
+      }
+
+      // Render polylines and markers for each active series. The snapshots
+      // were already reduced to first/min/max/last per column of this plot
+      // width, so path and marker cost is bounded by the width as it is.
+      pointCache.clear();
+      pointCache.reserve(filteredHistory.size() - firstSample);
+      for (size_t sampleIdx = firstSample; sampleIdx < filteredHistory.size(); ++sampleIdx) {
+         pointCache.push_back(ToPoint(layout, filteredHistory[sampleIdx]));
+      }
+
+      gc.SetPen(entry.pen);
+      if (pointCache.size() >= 2) {
+         wxGraphicsPath seriesPath = gc.CreatePath();
+         seriesPath.MoveToPoint(pointCache.front().x, pointCache.front().y);
+         for (size_t i = 1; i < pointCache.size(); ++i)
+            seriesPath.AddLineToPoint(pointCache[i].x, pointCache[i].y);
+         gc.StrokePath(seriesPath);
+      }
+
+      gc.SetBrush(entry.brush);
+      for (const PlotPoint &point : pointCache) {
+         if (!isPointInsidePlot(point))
+            continue;
+         gc.DrawEllipse(point.x - markerRadius, point.y - markerRadius, markerDiameter, markerDiameter);
+      }
+   }
+}
+
+PlotRenderer::FrameLayout PlotRenderer::Render(wxGCDC &dc, const PlotRenderRequest &request, const wxSize &size)
+{
+   FrameLayout layout;
+   PrepareFrame(request, size, layout);
+
+   const std::vector<LegendEntry> legend = BuildLegendEntries(request, layout.resolvedNodes);
+   if (!layout.statusMessage.IsEmpty()) {
+      DrawStatus(dc, layout, legend);
+      return layout;
+   }
+
+   DrawChrome(dc, layout);
+
+   wxGraphicsContext *gc = dc.GetGraphicsContext();
+   if (gc) {
+      // Clip series rendering to the plot rectangle so off-screen points still
+      // contribute to the stroke, but nothing bleeds into the margins.
+      gc->PushState();
+      gc->Clip(layout.plotRect.GetLeft(), layout.plotRect.GetTop(), layout.plotRect.GetWidth(), layout.plotRect.GetHeight());
+      gc->SetAntialiasMode(wxANTIALIAS_DEFAULT);
+      DrawSeries(*gc, layout, *request.series, nullptr);
+      gc->PopState();
+   }
+
+   DrawGrid(dc, layout);
+   DrawStatisticsOverlay(dc, layout, *request.series);
+   DrawLegendBox(dc, GetLegendBoxOrigin(layout), legend);
+   return layout;
+}
+
+wxBitmap PlotRenderer::RenderToBitmap(const PlotRenderRequest &request, const wxSize &size)
+{
+   wxBitmap bitmap(size);
+   {
+      wxMemoryDC memoryDc(bitmap);
+      wxGCDC dc(memoryDc);
+      dc.SetFont(*wxNORMAL_FONT);
+      Render(dc, request, size);
+   }
+   return bitmap;
+}
+
+wxImage PlotRenderer::RenderToImage(const PlotRenderRequest &request, const wxSize &size)
+{
+   wxImage image(size);
+   {
+      // The image-backed context writes its pixels back when destroyed.
+      wxGCDC dc(wxGraphicsContext::Create(image));
+      dc.SetFont(*wxNORMAL_FONT);
+      Render(dc, request, size);
+   }
+   return image;
+}
@@ -0,0 +1,271 @@
+#include "SampleHistory.h"
+
+#include <algorithm>
+#include <new>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SENSOR_TREE_HAS_SSE2 1
+#endif
+
+namespace {
+
+size_t RoundUpToBlock(size_t count)
+{
+   const size_t blocks = (count + SampleHistory::kBlockSize - 1) / SampleHistory::kBlockSize;
+   return std::max<size_t>(1, blocks) * SampleHistory::kBlockSize;
+}
+
+} // namespace
+
+// Slots [0, end) are constructed and never modified again except for the
+// extents of the block holding the newest sample. Readers only trust blocks
+// lying wholly below the end they loaded, which are complete and immutable.
+struct SampleHistory::Generation
+{
+   Generation(size_t generationCapacity, std::uint64_t generationFirstSequence) :
+       capacity(generationCapacity),
+       firstSequence(generationFirstSequence),
+       rows(std::allocator<TimedSample>().allocate(generationCapacity)),
+       timestamps(new TimePoint[generationCapacity]),
+       numeric(new double[generationCapacity]),
+       blocks(new NumericExtents[generationCapacity / kBlockSize]),
+       head(0),
+       end(0)
+   {
+   }
+
+   ~Generation()
+   {
+      std::destroy_n(rows, end.load(std::memory_order_relaxed));
+      std::allocator<TimedSample>().deallocate(rows, capacity);
+   }
+
+   Generation(const Generation &)            = delete;
+   Generation &operator=(const Generation &) = delete;
+
+   void Push(const TimedSample &sample, double value)
+   {
+      const size_t position = end.load(std::memory_order_relaxed);
+      timestamps[position]  = sample.timestamp;
+      numeric[position]     = value;
+      new (rows + position) TimedSample(sample);
+      blocks[position / kBlockSize].Include(value);
+      end.store(position + 1, std::memory_order_release);
+   }
+
+   void Push(TimedSample &&sample, double value)
+   {
+      const size_t position = end.load(std::memory_order_relaxed);
+      timestamps[position]  = sample.timestamp;
+      numeric[position]     = value;
+      new (rows + position) TimedSample(std::move(sample));
+      blocks[position / kBlockSize].Include(value);
+      end.store(position + 1, std::memory_order_release);
+   }
+
+   const size_t capacity;
+   // Sequence number of slot 0.
+   const std::uint64_t firstSequence;
+   TimedSample *const rows;
+   const std::unique_ptr<TimePoint[]> timestamps;
+   const std::unique_ptr<double[]> numeric;
+   const std::unique_ptr<NumericExtents[]> blocks;
+   // Oldest retained slot; slots below it stay constructed until the
+   // generation is freed, so a reader that loaded an older head is safe.
+   std::atomic<size_t> head;
+   // One past the newest published slot.
+   std::atomic<size_t> end;
+};
+
+SampleHistory::View::View(EpochDomain::Guard &&guard, const Generation &generation) :
+    m_guard(std::move(guard)),
+    m_rows(generation.rows),
+    m_timestamps(generation.timestamps.get()),
+    m_numeric(generation.numeric.get()),
+    m_blocks(generation.blocks.get()),
+    m_head(generation.head.load(std::memory_order_acquire)),
+    m_size(0),
+    m_firstSequence(generation.firstSequence + m_head)
+{
+   // The head is loaded first: it never passes the end, so the range is
+   // never inverted even if the writer moves both in between.
+   m_size = generation.end.load(std::memory_order_acquire) - m_head;
+}
+
+std::pair<size_t, size_t> SampleHistory::View::FindWindow(TimePoint start, TimePoint end) const
+{
+   const TimePoint *begin = GetTimestampData();
+   const TimePoint *stop  = begin + m_size;
+
+   const TimePoint *lower = std::lower_bound(begin, stop, start);
+   const TimePoint *upper = std::upper_bound(lower, stop, end);
+   return {static_cast<size_t>(lower - begin), static_cast<size_t>(upper - begin)};
+}
+
+NumericExtents SampleHistory::View::ComputeExtents(size_t first, size_t last) const
+{
+   last = std::min(last, m_size);
+   if (first >= last)
+      return {};
+
+   const size_t start = m_head + first;
+   const size_t stop  = m_head + last;
+
+   // Blocks that lie entirely inside the range come from the cached summaries;
+   // only the partial blocks at either edge are scanned.
+   const size_t firstFullBlock = (start + kBlockSize - 1) / kBlockSize;
+   const size_t endFullBlock   = stop / kBlockSize;
+   if (firstFullBlock >= endFullBlock)
+      return ScanExtents(m_numeric + start, stop - start);
+
+   NumericExtents extents = ScanExtents(m_numeric + start, firstFullBlock * kBlockSize - start);
+   for (size_t block = firstFullBlock; block < endFullBlock; ++block)
+      extents.Merge(m_blocks[block]);
+   extents.Merge(ScanExtents(m_numeric + endFullBlock * kBlockSize, stop - endFullBlock * kBlockSize));
+   return extents;
+}
+
+SampleHistory::SampleHistory(size_t limit) :
+    m_current(new Generation(kBlockSize, 0)),
+    m_limit(std::max<size_t>(1, limit)),
+    m_retired()
+{
+}
+
+SampleHistory::~SampleHistory()
+{
+   for (const RetiredGeneration &retired : m_retired)
+      delete retired.generation;
+   delete m_current.load();
+}
+
+void SampleHistory::Append(TimedSample &&sample, double numeric)
+{
+   if (!m_retired.empty())
+      ReclaimRetired();
+
+   Generation *generation = m_current.load(std::memory_order_relaxed);
+   size_t end             = generation->end.load(std::memory_order_relaxed);
+   if (end == generation->capacity) {
+      const size_t live = end - generation->head.load(std::memory_order_relaxed);
+      Reallocate(std::min(GetMaximumCapacity(), RoundUpToBlock(live * 2)), live);
+      generation = m_current.load(std::memory_order_relaxed);
+      end        = generation->end.load(std::memory_order_relaxed);
+   }
+
+   generation->Push(std::move(sample), numeric);
+   ++end;
+   if (end - generation->head.load(std::memory_order_relaxed) > m_limit)
+      generation->head.store(end - m_limit, std::memory_order_release);
+}
+
+void SampleHistory::Clear()
+{
+   Reallocate(kBlockSize, 0);
+}
+
+void SampleHistory::SetLimit(size_t limit)
+{
+   m_limit = std::max<size_t>(1, limit);
+
+   const Generation *generation = m_current.load(std::memory_order_relaxed);
+   const size_t live            = generation->end.load(std::memory_order_relaxed) - generation->head.load(std::memory_order_relaxed);
+   const size_t keep            = std::min(live, m_limit);
+   Reallocate(std::min(GetMaximumCapacity(), RoundUpToBlock(keep * 2)), keep);
+}
+
+SampleHistory::View SampleHistory::Snapshot() const
+{
+   EpochDomain::Guard guard;
+   return View(std::move(guard), *m_current.load());
+}
+
+bool SampleHistory::Empty() const
+{
+   EpochDomain::Guard guard;
+   const Generation *generation = m_current.load();
+   return generation->head.load(std::memory_order_acquire) == generation->end.load(std::memory_order_acquire);
+}
+
+void SampleHistory::Reallocate(size_t capacity, size_t keep)
+{
+   Generation *previous = m_current.load(std::memory_order_relaxed);
+   const size_t end     = previous->end.load(std::memory_order_relaxed);
+   const size_t first   = end - keep;
+
+   auto next = std::make_unique<Generation>(capacity, previous->firstSequence + first);
+   for (size_t slot = first; slot < end; ++slot)
+      next->Push(previous->rows[slot], previous->numeric[slot]);
+
+   m_current.store(next.release());
+   m_retired.push_back({previous, EpochDomain::Advance()});
+   ReclaimRetired();
+}
+
+void SampleHistory::ReclaimRetired()
+{
+   const auto reclaimable = std::partition(m_retired.begin(), m_retired.end(),
+       [](const RetiredGeneration &retired) { return !EpochDomain::IsReclaimable(retired.epoch); });
+   for (auto it = reclaimable; it != m_retired.end(); ++it)
+      delete it->generation;
+   m_retired.erase(reclaimable, m_retired.end());
+}
+
+size_t SampleHistory::GetMaximumCapacity() const
+{
+   return RoundUpToBlock(m_limit + m_limit / 2);
+}
+
+NumericExtents SampleHistory::ScanExtents(const double *values, size_t count)
+{
+   NumericExtents extents;
+   size_t index = 0;
+
+   // MINPD/MAXPD return the second operand when either input is NaN, so keeping
+   // the accumulator second skips non-numeric placeholders for free.
+#if defined(__AVX__)
+   if (count >= 4) {
+      __m256d lowest  = _mm256_set1_pd(extents.min);
+      __m256d highest = _mm256_set1_pd(extents.max);
+      for (; index + 4 <= count; index += 4) {
+         const __m256d chunk = _mm256_loadu_pd(values + index);
+         lowest              = _mm256_min_pd(chunk, lowest);
+         highest             = _mm256_max_pd(chunk, highest);
+      }
+
+      double lanes[4];
+      _mm256_storeu_pd(lanes, lowest);
+      for (double lane : lanes)
+         extents.Include(lane);
+      _mm256_storeu_pd(lanes, highest);
+      for (double lane : lanes)
+         extents.Include(lane);
+   }
+#elif defined(SENSOR_TREE_HAS_SSE2)
+   if (count >= 2) {
+      __m128d lowest  = _mm_set1_pd(extents.min);
+      __m128d highest = _mm_set1_pd(extents.max);
+      for (; index + 2 <= count; index += 2) {
+         const __m128d chunk = _mm_loadu_pd(values + index);
+         lowest              = _mm_min_pd(chunk, lowest);
+         highest             = _mm_max_pd(chunk, highest);
+      }
+
+      double lanes[2];
+      _mm_storeu_pd(lanes, lowest);
+      for (double lane : lanes)
+         extents.Include(lane);
+      _mm_storeu_pd(lanes, highest);
+      for (double lane : lanes)
+         extents.Include(lane);
+   }
+#endif
+
+   for (; index < count; ++index)
+      extents.Include(values[index]);
+
+   return extents;
+}
@@ -0,0 +1,144 @@
+#include "SampleSourceQueue.h"
+
+#include <algorithm>
+#include <iterator>
+
+SampleSourceQueue::SampleSourceQueue(size_t capacity) :
+    m_capacity(std::max<size_t>(capacity, 1)),
+    m_mutex(),
+    m_spaceAvailable(),
+    m_samples(),
+    m_stats(),
+    m_closed(false)
+{
+}
+
+size_t SampleSourceQueue::Push(std::vector<SensorSample> &&samples, std::chrono::milliseconds maxWait)
+{
+   if (samples.empty())
+      return 0;
+
+   const bool waitUntilClosed = maxWait < std::chrono::milliseconds(0);
+   const auto deadline        = std::chrono::steady_clock::now() + (waitUntilClosed ? std::chrono::milliseconds(0) : maxWait);
+   const auto hasRoom         = [this] { return m_closed || m_samples.size() < m_capacity; };
+   size_t accepted            = 0;
+
+   std::unique_lock<std::mutex> lock(m_mutex);
+   while (accepted < samples.size() && !m_closed) {
+      if (waitUntilClosed)
+         m_spaceAvailable.wait(lock, hasRoom);
+      else if (!m_spaceAvailable.wait_until(lock, deadline, hasRoom))
+         break;
+      if (m_closed)
+         break;
+
+      const size_t room  = m_capacity - m_samples.size();
+      const size_t count = std::min(room, samples.size() - accepted);
+      m_samples.insert(m_samples.end(), std::make_move_iterator(samples.begin() + static_cast<std::ptrdiff_t>(accepted)),
+          std::make_move_iterator(samples.begin() + static_cast<std::ptrdiff_t>(accepted + count)));
+      accepted += count;
+   }
+
+   m_stats.received += samples.size();
+   m_stats.dropped += samples.size() - accepted;
+   m_stats.lastReceived = std::chrono::steady_clock::now();
+   m_stats.highWater    = std::max(m_stats.highWater, m_samples.size());
+   return accepted;
+}
+
+size_t SampleSourceQueue::PopInto(size_t maxCount, std::vector<SensorSample> &out)
+{
+   size_t count = 0;
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      count = std::min(maxCount, m_samples.size());
+      if (count == 0)
+         return 0;
+
+      const auto end = m_samples.begin() + static_cast<std::ptrdiff_t>(count);
+      out.insert(out.end(), std::make_move_iterator(m_samples.begin()), std::make_move_iterator(end));
+      m_samples.erase(m_samples.begin(), end);
+      m_stats.delivered += count;
+   }
+   m_spaceAvailable.notify_all();
+   return count;
+}
+
+void SampleSourceQueue::Clear()
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_samples.clear();
+   }
+   m_spaceAvailable.notify_all();
+}
+
+void SampleSourceQueue::Close()
+{
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_closed = true;
+   }
+   m_spaceAvailable.notify_all();
+}
+
+void SampleSourceQueue::RecordDelivered(size_t count)
+{
+   if (count == 0)
+      return;
+
+   std::lock_guard<std::mutex> lock(m_mutex);
+   m_stats.received += count;
+   m_stats.delivered += count;
+   m_stats.lastReceived = std::chrono::steady_clock::now();
+}
+
+size_t SampleSourceQueue::GetDepth() const
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   return m_samples.size();
+}
+
+SampleSourceStats SampleSourceQueue::GetStats() const
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   SampleSourceStats stats = m_stats;
+   stats.depth             = m_samples.size();
+   return stats;
+}
+
+FairSampleMerger::FairSampleMerger() :
+    m_nextStart(0)
+{
+}
+
+size_t FairSampleMerger::Drain(const std::vector<SampleSourceQueue *> &queues, size_t budget, std::vector<SensorSample> &out)
+{
+   if (queues.empty() || budget == 0)
+      return 0;
+
+   const size_t queueCount = queues.size();
+   const size_t start      = m_nextStart % queueCount;
+   m_nextStart             = (start + 1) % queueCount;
+
+   std::vector<bool> exhausted(queueCount, false);
+   size_t active = queueCount;
+   size_t taken  = 0;
+   while (taken < budget && active > 0) {
+      const size_t quantum = std::max<size_t>(1, (budget - taken) / active);
+      for (size_t step = 0; step < queueCount && taken < budget; ++step) {
+         const size_t index = (start + step) % queueCount;
+         if (exhausted[index])
+            continue;
+
+         const size_t want = std::min(quantum, budget - taken);
+         const size_t got  = queues[index]->PopInto(want, out);
+         taken += got;
+         if (got < want) {
+            exhausted[index] = true;
+            --active;
+         }
+      }
+   }
+   return taken;
+}
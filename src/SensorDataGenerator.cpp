@@ -1,33 +1,175 @@
 #include "SensorDataGenerator.h"
 
-#include "MainFrame.h"
+#include "PathUtils.h"
 
-#include <wx/event.h>
+#include <wx/log.h>
+#include <wx/socket.h>
 
-SensorDataGenerator::SensorDataGenerator(wxEvtHandler *target) :
-    wxThread(wxTHREAD_DETACHED),
-    m_target(target)
+#include <algorithm>
+#include <utility>
+
+SensorDataGenerator::SensorDataGenerator(std::uint16_t port) :
+    SampleSource("Network :" + std::to_string(port), SampleSourceKind::Network),
+    m_port(port),
+    m_server(),
+    m_datagramSocket(),
+    m_streams(),
+    m_datagramSources(),
+    m_readBuffer(READ_BUFFER_SIZE),
+    m_errorMessage()
+{
+}
+
+SensorDataGenerator::~SensorDataGenerator()
 {
+   CloseSockets();
+}
+
+bool SensorDataGenerator::OpenSockets()
+{
+   wxIPV4address address;
+   address.AnyAddress();
+   address.Service(m_port);
+
+   // Worker threads may only use blocking sockets; NOWAIT keeps reads from
+   // waiting for a full buffer.
+   m_server = std::make_unique<wxSocketServer>(address, wxSOCKET_BLOCK | wxSOCKET_REUSEADDR);
+   if (!m_server->IsOk()) {
+      wxLogWarning("Sensor ingest: cannot listen on TCP port %u.", static_cast<unsigned>(m_port));
+      m_server.reset();
+   }
+
+   m_datagramSocket = std::make_unique<wxDatagramSocket>(address, wxSOCKET_BLOCK | wxSOCKET_NOWAIT | wxSOCKET_REUSEADDR);
+   if (!m_datagramSocket->IsOk()) {
+      wxLogWarning("Sensor ingest: cannot bind UDP port %u.", static_cast<unsigned>(m_port));
+      m_datagramSocket.reset();
+   }
+
+   return m_server || m_datagramSocket;
 }
 
-void SensorDataGenerator::QueueNewMessageEvent()
+void SensorDataGenerator::CloseSockets()
 {
-   auto *evt = new wxThreadEvent(wxEVT_THREAD, ID_NewMessage);
-   wxQueueEvent(m_target, evt);
+   m_streams.clear();
+   m_datagramSources.clear();
+   m_datagramSocket.reset();
+   m_server.reset();
 }
 
-void SensorDataGenerator::QueueConnectionEvent(bool connected)
+void SensorDataGenerator::AcceptClients()
 {
-   auto *evt = new wxThreadEvent(wxEVT_THREAD,
-       connected ? ID_ConnectYes : ID_ConnectNo);
-   wxQueueEvent(m_target, evt);
+   // The accept wait doubles as the idle sleep of the poll loop, so only
+   // block here when no connection has data waiting.
+   const bool streamsReady = std::any_of(m_streams.begin(), m_streams.end(),
+       [](const StreamSource &source) { return source.socket->WaitForRead(0, 0); });
+   const bool datagramReady = m_datagramSocket && m_datagramSocket->WaitForRead(0, 0);
+   const long waitMs        = streamsReady || datagramReady ? 0 : POLL_INTERVAL_MS;
+
+   if (!m_server) {
+      if (waitMs > 0)
+         wxThread::Sleep(waitMs);
+      return;
+   }
+
+   if (!m_server->WaitForAccept(0, waitMs))
+      return;
+
+   wxSocketBase *client = m_server->Accept(false);
+   if (!client)
+      return;
+
+   client->SetFlags(wxSOCKET_BLOCK | wxSOCKET_NOWAIT);
+   client->SetNotify(0);
+   m_streams.push_back({std::unique_ptr<wxSocketBase>(client), SensorWireDecoder()});
+}
+
+void SensorDataGenerator::ReadStreams(std::vector<SensorSample> &batch)
+{
+   bool dropped = false;
+   for (StreamSource &source : m_streams) {
+      if (!source.socket->WaitForRead(0, 0))
+         continue;
+
+      source.socket->Read(m_readBuffer.data(), static_cast<wxUint32>(m_readBuffer.size()));
+      const size_t count = source.socket->LastCount();
+      if (count == 0 || source.socket->IsDisconnected()) {
+         source.socket->Close();
+      } else if (!source.decoder.Feed(m_readBuffer.data(), count, std::chrono::steady_clock::now(), batch, m_errorMessage)) {
+         wxLogWarning("Sensor ingest: dropping TCP client: %s", m_errorMessage);
+         source.socket->Close();
+      }
+      dropped = dropped || !source.socket->IsConnected();
+   }
+
+   if (dropped) {
+      m_streams.erase(std::remove_if(m_streams.begin(), m_streams.end(),
+                          [](const StreamSource &source) { return !source.socket->IsConnected(); }),
+          m_streams.end());
+   }
+}
+
+void SensorDataGenerator::ReadDatagrams(std::vector<SensorSample> &batch)
+{
+   if (!m_datagramSocket)
+      return;
+
+   wxIPV4address peer;
+   while (m_datagramSocket->WaitForRead(0, 0)) {
+      m_datagramSocket->RecvFrom(peer, m_readBuffer.data(), static_cast<wxUint32>(m_readBuffer.size()));
+      const size_t count = m_datagramSocket->LastCount();
+      if (count == 0)
+         break;
+
+      const std::string key  = PathUtils::ToUtf8(peer.IPAddress()) + ":" + std::to_string(peer.Service());
+      DatagramSource &source = m_datagramSources[key];
+      source.lastSeen        = std::chrono::steady_clock::now();
+
+      // Datagrams carry whole frames, so a failure only loses this sender's
+      // path ids until it defines them again.
+      if (!source.decoder.Feed(m_readBuffer.data(), count, source.lastSeen, batch, m_errorMessage))
+         source.decoder.Reset();
+   }
+}
+
+void SensorDataGenerator::ExpireDatagramSources(std::chrono::steady_clock::time_point now)
+{
+   for (auto it = m_datagramSources.begin(); it != m_datagramSources.end();) {
+      if (now - it->second.lastSeen > UDP_TIMEOUT) {
+         it = m_datagramSources.erase(it);
+      } else {
+         ++it;
+      }
+   }
+}
+
+bool SensorDataGenerator::HasSources() const
+{
+   return !m_streams.empty() || !m_datagramSources.empty();
 }
 
 wxThread::ExitCode SensorDataGenerator::Entry()
 {
+   if (!OpenSockets()) {
+      SetState(SampleSourceState::Failed);
+      return static_cast<ExitCode>(0);
+   }
+
+   std::vector<SensorSample> batch;
    while (!TestDestroy()) {
-      wxThread::Sleep(100);
+      AcceptClients();
+      ReadStreams(batch);
+      ReadDatagrams(batch);
+      ExpireDatagramSources(std::chrono::steady_clock::now());
+
+      if (!batch.empty()) {
+         Publish(std::move(batch));
+         batch = std::vector<SensorSample>();
+      }
+
+      SetState(HasSources() ? SampleSourceState::Connected : SampleSourceState::Idle);
    }
-   QueueConnectionEvent(false);
+
+   CloseSockets();
+   SetState(SampleSourceState::Idle);
    return static_cast<ExitCode>(0);
 }
@@ -0,0 +1,59 @@
+#include "SensorDataReplaySource.h"
+
+#include "SensorDataJsonReader.h"
+
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+#include <vector>
+
+SensorDataReplaySource::SensorDataReplaySource(std::string filePath, double speed) :
+    SampleSource("Replay " + wxFileName(wxString::FromUTF8(filePath.c_str())).GetFullName().ToStdString(), SampleSourceKind::Replay),
+    m_filePath(std::move(filePath)),
+    m_speed(speed > 0.0 ? speed : 1.0)
+{
+}
+
+wxThread::ExitCode SensorDataReplaySource::Entry()
+{
+   SensorDataJsonReader::LoadResult recording;
+   std::string errorMessage;
+   if (!SensorDataJsonReader::LoadFromFile(m_filePath, recording, errorMessage)) {
+      wxLogWarning("Replay of '%s' failed: %s", m_filePath, errorMessage);
+      SetState(SampleSourceState::Failed);
+      return static_cast<ExitCode>(0);
+   }
+
+   std::stable_sort(recording.samples.begin(), recording.samples.end(),
+       [](const RecordedSensorSample &a, const RecordedSensorSample &b) { return a.elapsedSeconds < b.elapsedSeconds; });
+
+   SetState(SampleSourceState::Connected);
+   const double firstElapsed = recording.samples.empty() ? 0.0 : recording.samples.front().elapsedSeconds;
+   const auto start          = std::chrono::steady_clock::now();
+
+   size_t next = 0;
+   std::vector<SensorSample> due;
+   while (next < recording.samples.size() && !TestDestroy()) {
+      const auto now        = std::chrono::steady_clock::now();
+      const double position = std::chrono::duration<double>(now - start).count() * m_speed + firstElapsed;
+
+      while (next < recording.samples.size() && recording.samples[next].elapsedSeconds <= position) {
+         RecordedSensorSample &sample = recording.samples[next++];
+         due.push_back({std::move(sample.path), std::move(sample.value), std::move(sample.thresholds), sample.alarmState, now});
+      }
+
+      if (!due.empty()) {
+         Publish(std::move(due), SampleSourceQueue::WAIT_UNTIL_CLOSED);
+         due = std::vector<SensorSample>();
+      } else {
+         const double waitSeconds = (recording.samples[next].elapsedSeconds - position) / m_speed;
+         wxThread::Sleep(static_cast<unsigned long>(std::clamp(waitSeconds * 1000.0, 1.0, double(MAX_SLEEP_MS))));
+      }
+   }
+
+   SetState(SampleSourceState::Finished);
+   return static_cast<ExitCode>(0);
+}
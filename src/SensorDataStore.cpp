@@ -0,0 +1,771 @@
+#include "SensorDataStore.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+
+void SensorChangeSet::Clear()
+{
+   createdNodes.clear();
+   updatedNodes.clear();
+   transitions.clear();
+}
+
+SensorDataStore::ReadLock::ReadLock(const SensorDataStore &store) :
+    m_locks()
+{
+   m_locks.reserve(store.m_shards.size());
+   for (const auto &shard : store.m_shards)
+      m_locks.emplace_back(shard->mutex);
+}
+
+SensorDataStore::SensorDataStore(size_t shardCount) :
+    m_shards(),
+    m_workersRunning(false),
+    m_rootOrderMutex(),
+    m_rootOrder(),
+    m_isLiveDataMode(true),
+    m_referenceTimeMutex(),
+    m_elapsedReferenceTime(),
+    m_structureVersion(0),
+    m_alarmVersion(0),
+    m_clearGeneration(0),
+    m_derivedMutex(),
+    m_hasDerivedSensors(false),
+    m_derivedSensors(),
+    m_registryMutex(),
+    m_registeredSensors(),
+    m_sensorIdsByPath()
+{
+   const size_t count = std::max<size_t>(shardCount, 1);
+   for (size_t idx = 0; idx < count; ++idx)
+      m_shards.push_back(std::make_unique<Shard>());
+}
+
+SensorDataStore::~SensorDataStore()
+{
+   StopWorkers();
+   // Node histories no longer wait for readers themselves; see Clear().
+   EpochDomain::WaitUntilReclaimable(EpochDomain::Advance());
+}
+
+size_t SensorDataStore::GetDefaultShardCount()
+{
+   return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+size_t SensorDataStore::GetShardIndex(const std::string &rootName) const
+{
+   if (m_shards.size() == 1)
+      return 0;
+   return std::hash<std::string>{}(rootName) % m_shards.size();
+}
+
+size_t SensorDataStore::GetShardIndex(const Node *node) const
+{
+   while (node->GetParent())
+      node = node->GetParent();
+   return GetShardIndex(node->GetName());
+}
+
+std::unique_lock<std::recursive_mutex> SensorDataStore::LockSubtree(const Node *node) const
+{
+   if (!node)
+      return {};
+   return std::unique_lock<std::recursive_mutex>(m_shards[GetShardIndex(node)]->mutex);
+}
+
+void SensorDataStore::StartWorkers()
+{
+   if (m_workersRunning.exchange(true))
+      return;
+
+   for (const auto &shard : m_shards) {
+      {
+         std::lock_guard<std::mutex> lock(shard->queueMutex);
+         shard->stopping = false;
+      }
+      shard->worker = std::thread(&SensorDataStore::RunWorker, this, std::ref(*shard));
+   }
+}
+
+void SensorDataStore::StopWorkers()
+{
+   if (!m_workersRunning.load())
+      return;
+
+   for (const auto &shard : m_shards) {
+      {
+         std::lock_guard<std::mutex> lock(shard->queueMutex);
+         shard->stopping = true;
+      }
+      shard->queueReady.notify_all();
+      shard->queueSpace.notify_all();
+   }
+   for (const auto &shard : m_shards) {
+      if (shard->worker.joinable())
+         shard->worker.join();
+   }
+   m_workersRunning = false;
+
+   // Derived samples a worker routed to a shard whose worker had already
+   // finished are still queued.
+   std::vector<SensorSample> leftovers;
+   for (const auto &shard : m_shards) {
+      {
+         std::lock_guard<std::mutex> lock(shard->queueMutex);
+         leftovers.swap(shard->queue);
+      }
+      AddDataSamples(leftovers);
+      leftovers.clear();
+   }
+}
+
+void SensorDataStore::SubmitSamples(std::vector<SensorSample> &samples)
+{
+   if (!m_workersRunning.load()) {
+      AddDataSamples(samples);
+      samples.clear();
+      return;
+   }
+
+   EnqueueByShard(samples, true);
+}
+
+void SensorDataStore::EnqueueByShard(std::vector<SensorSample> &samples, bool waitForSpace)
+{
+   // Derived samples never wait for space: two workers feeding each other's
+   // full queues would otherwise deadlock.
+   if (m_shards.size() == 1) {
+      EnqueueSamples(0, samples, waitForSpace);
+      return;
+   }
+
+   std::vector<std::vector<SensorSample>> samplesByShard(m_shards.size());
+   for (SensorSample &sample : samples)
+      samplesByShard[GetShardIndex(sample.path)].push_back(std::move(sample));
+   samples.clear();
+
+   for (size_t idx = 0; idx < samplesByShard.size(); ++idx) {
+      if (!samplesByShard[idx].empty())
+         EnqueueSamples(idx, samplesByShard[idx], waitForSpace);
+   }
+}
+
+void SensorDataStore::EnqueueSamples(size_t shardIndex, std::vector<SensorSample> &samples, bool waitForSpace)
+{
+   Shard &shard = *m_shards[shardIndex];
+   {
+      std::unique_lock<std::mutex> lock(shard.queueMutex);
+      if (waitForSpace)
+         shard.queueSpace.wait(lock, [&shard] { return shard.stopping || shard.queue.size() < SHARD_QUEUE_CAPACITY; });
+
+      if (shard.queue.empty())
+         shard.queue.swap(samples);
+      else
+         shard.queue.insert(shard.queue.end(), std::make_move_iterator(samples.begin()), std::make_move_iterator(samples.end()));
+   }
+   samples.clear();
+   shard.queueReady.notify_one();
+}
+
+void SensorDataStore::RunWorker(Shard &shard)
+{
+   std::vector<SensorSample> batch;
+   std::vector<const SensorSample *> pointers;
+   for (;;) {
+      {
+         std::unique_lock<std::mutex> lock(shard.queueMutex);
+         shard.queueReady.wait(lock, [&shard] { return shard.stopping || !shard.queue.empty(); });
+         if (shard.queue.empty())
+            return;
+         batch.swap(shard.queue);
+      }
+      shard.queueSpace.notify_all();
+
+      pointers.clear();
+      for (const SensorSample &sample : batch)
+         pointers.push_back(&sample);
+      ApplyBatch(shard, pointers, true);
+      batch.clear();
+   }
+}
+
+void SensorDataStore::AddDataSample(const std::vector<std::string> &path, const DataValue &value,
+    SensorThresholds thresholds,
+    SensorAlarmState alarmState,
+    std::chrono::steady_clock::time_point timestamp)
+{
+   Shard &shard = *m_shards[GetShardIndex(path)];
+   std::vector<SensorSample> derivedSamples;
+   {
+      std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+      ApplySample(shard, path, value, std::move(thresholds), alarmState, timestamp, shard.alarmPolicy.enabled);
+      derivedSamples.swap(shard.derivedSamples);
+   }
+   RouteDerivedSamples(derivedSamples);
+}
+
+void SensorDataStore::AddDataSamples(const std::vector<SensorSample> &samples)
+{
+   AddSamplesByShard(samples, true);
+}
+
+void SensorDataStore::AddRecordedSamples(const std::vector<SensorSample> &samples)
+{
+   AddSamplesByShard(samples, false);
+}
+
+void SensorDataStore::AddSamplesByShard(const std::vector<SensorSample> &samples, bool evaluateAlarms)
+{
+   if (samples.empty())
+      return;
+
+   std::vector<std::vector<const SensorSample *>> samplesByShard(m_shards.size());
+   for (const SensorSample &sample : samples)
+      samplesByShard[GetShardIndex(sample.path)].push_back(&sample);
+
+   for (size_t idx = 0; idx < samplesByShard.size(); ++idx) {
+      if (!samplesByShard[idx].empty())
+         ApplyBatch(*m_shards[idx], samplesByShard[idx], evaluateAlarms);
+   }
+}
+
+void SensorDataStore::ApplyBatch(Shard &shard, const std::vector<const SensorSample *> &samples, bool evaluateAlarms)
+{
+   std::vector<SensorSample> derivedSamples;
+   {
+      std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+      const bool evaluateAlarm = evaluateAlarms && shard.alarmPolicy.enabled;
+      for (const SensorSample *sample : samples)
+         ApplySample(shard, sample->path, sample->value, sample->thresholds, sample->alarmState, sample->timestamp, evaluateAlarm);
+      derivedSamples.swap(shard.derivedSamples);
+   }
+   RouteDerivedSamples(derivedSamples);
+}
+
+void SensorDataStore::RouteDerivedSamples(std::vector<SensorSample> &samples)
+{
+   if (samples.empty())
+      return;
+
+   if (!m_workersRunning.load()) {
+      // Outputs feeding further definitions are routed again from here, so
+      // chains of definitions settle within the same call.
+      AddDataSamples(samples);
+      return;
+   }
+
+   EnqueueByShard(samples, false);
+}
+
+Node *SensorDataStore::ApplySample(Shard &shard, const std::vector<std::string> &path, const DataValue &value,
+    SensorThresholds thresholds,
+    SensorAlarmState alarmState,
+    std::chrono::steady_clock::time_point timestamp,
+    bool evaluateAlarm)
+{
+   Node *node = FindOrCreatePath(shard, path);
+   if (!node)
+      return nullptr;
+
+   // Flapping producers are debounced here so only committed transitions
+   // reach the tree and its alarm filters.
+   const SensorAlarmState previousState = node->GetAlarmState();
+   const bool wasStale                  = node->IsStale();
+   const bool hadValue                  = node->HasValue();
+   if (evaluateAlarm) {
+      alarmState = node->GetAlarmEvaluator().Evaluate(value, thresholds, alarmState, timestamp, shard.alarmPolicy);
+      ArmAlarmDwell(shard, node);
+   }
+
+   node->SetValue(value, std::move(thresholds), alarmState, timestamp);
+   ArmStaleness(shard, node);
+   MarkUpdated(shard, node);
+   UpdateReferenceTime(timestamp);
+
+   SensorStoreTotals &totals = shard.totals;
+   ++totals.sampleCount;
+   if (!hadValue) {
+      ++totals.sensorCount;
+      CountAlarmState(totals, alarmState, 1);
+   } else if (alarmState != previousState) {
+      CountAlarmState(totals, previousState, -1);
+      CountAlarmState(totals, alarmState, 1);
+   }
+   if (wasStale)
+      --totals.staleCount;
+
+   if (alarmState != previousState || wasStale)
+      ++m_alarmVersion;
+   if (wasStale)
+      shard.changes.transitions.push_back({node, AlarmEventKind::Recovered, previousState, alarmState, node->GetValue(), timestamp});
+   if (alarmState != previousState)
+      shard.changes.transitions.push_back({node, AlarmEventKind::StateChanged, previousState, alarmState, node->GetValue(), timestamp});
+
+   FeedDerivedSensors(shard, path, value, timestamp);
+   return node;
+}
+
+void SensorDataStore::FeedDerivedSensors(Shard &shard, const std::vector<std::string> &path, const DataValue &value,
+    std::chrono::steady_clock::time_point timestamp)
+{
+   if (!m_hasDerivedSensors.load())
+      return;
+
+   // Outputs may belong to another shard, whose lock must not be taken while
+   // this one is held; they are applied once the batch is done.
+   std::vector<DerivedSensorSet::Output> outputs;
+   std::lock_guard<std::mutex> lock(m_derivedMutex);
+   m_derivedSensors.OnInput(path, value, outputs);
+   for (const DerivedSensorSet::Output &output : outputs) {
+      const DerivedSensorSet::Definition &definition = m_derivedSensors.GetDefinition(output.definition);
+      shard.derivedSamples.push_back({definition.outputPath, DataValue(output.value), definition.thresholds,
+          ClassifyNumericAlarm(output.value, definition.thresholds), timestamp});
+   }
+
+   // Queued while still evaluating, so outputs computed on different workers
+   // are applied in the order they were computed.
+   if (m_workersRunning.load() && !shard.derivedSamples.empty())
+      EnqueueByShard(shard.derivedSamples, false);
+}
+
+SensorDataStore::SensorId SensorDataStore::RegisterSensor(const std::vector<std::string> &path, SensorThresholds thresholds)
+{
+   // NUL never appears in a segment, so distinct paths never share a key.
+   std::string key;
+   for (const std::string &segment : path) {
+      key += segment;
+      key += '\0';
+   }
+
+   std::lock_guard<std::shared_mutex> lock(m_registryMutex);
+   auto it = m_sensorIdsByPath.find(key);
+   if (it != m_sensorIdsByPath.end()) {
+      // New thresholds reach the node through the next sample's full path.
+      RegisteredSensor &sensor = m_registeredSensors[it->second];
+      sensor.thresholds        = std::move(thresholds);
+      sensor.node              = nullptr;
+      return it->second;
+   }
+
+   const SensorId id = static_cast<SensorId>(m_registeredSensors.size());
+   m_registeredSensors.push_back({path, std::move(thresholds), GetShardIndex(path), nullptr, 0});
+   m_sensorIdsByPath.emplace(std::move(key), id);
+   return id;
+}
+
+size_t SensorDataStore::AddPackedSamples(const PackedSampleRecord *records, size_t count, std::string_view text)
+{
+   std::vector<SensorSample> derivedSamples;
+   size_t applied = 0;
+   {
+      // Shared, so producers on several threads only meet on the shards their
+      // records belong to.
+      std::shared_lock<std::shared_mutex> registryLock(m_registryMutex);
+      std::vector<std::vector<const PackedSampleRecord *>> recordsByShard(m_shards.size());
+      for (size_t i = 0; i < count; ++i) {
+         if (records[i].sensorId < m_registeredSensors.size())
+            recordsByShard[m_registeredSensors[records[i].sensorId].shard].push_back(&records[i]);
+      }
+
+      for (size_t idx = 0; idx < recordsByShard.size(); ++idx) {
+         if (recordsByShard[idx].empty())
+            continue;
+
+         Shard &shard = *m_shards[idx];
+         std::lock_guard<std::recursive_mutex> shardLock(shard.mutex);
+         for (const PackedSampleRecord *record : recordsByShard[idx]) {
+            if (ApplyPackedRecord(shard, *record, text))
+               ++applied;
+         }
+         derivedSamples.insert(derivedSamples.end(), std::make_move_iterator(shard.derivedSamples.begin()),
+             std::make_move_iterator(shard.derivedSamples.end()));
+         shard.derivedSamples.clear();
+      }
+   }
+
+   RouteDerivedSamples(derivedSamples);
+   return applied;
+}
+
+bool SensorDataStore::ApplyPackedRecord(Shard &shard, const PackedSampleRecord &record, std::string_view text)
+{
+   if (record.alarmState > static_cast<std::uint8_t>(SensorAlarmState::Failed))
+      return false;
+   std::optional<DataValue> value = DecodePackedValue(record, text);
+   if (!value)
+      return false;
+
+   // Only this shard's lock guards the sensor's cached node, as no other
+   // shard's records resolve it.
+   RegisteredSensor &sensor       = m_registeredSensors[record.sensorId];
+   const auto timestamp           = record.GetTimestamp();
+   SensorAlarmState alarmState    = record.GetAlarmState();
+   const std::uint64_t generation = m_clearGeneration.load();
+
+   Node *node = sensor.clearGeneration == generation ? sensor.node : nullptr;
+   if (!node) {
+      sensor.node            = ApplySample(shard, sensor.path, *value, sensor.thresholds, alarmState, timestamp, shard.alarmPolicy.enabled);
+      sensor.clearGeneration = generation;
+      return true;
+   }
+
+   if (shard.alarmPolicy.enabled) {
+      alarmState = node->GetAlarmEvaluator().Evaluate(*value, sensor.thresholds, alarmState, timestamp, shard.alarmPolicy);
+      ArmAlarmDwell(shard, node);
+   }
+
+   // Transitions and recoveries are journalled and change visibility under
+   // the alarm filter, so they keep the per-sample bookkeeping.
+   if (alarmState != node->GetAlarmState() || node->IsStale()) {
+      ApplySample(shard, sensor.path, *value, sensor.thresholds, alarmState, timestamp, false);
+      return true;
+   }
+
+   FeedDerivedSensors(shard, sensor.path, *value, timestamp);
+   node->AppendSample(std::move(*value), alarmState, timestamp);
+   ArmStaleness(shard, node);
+   MarkUpdated(shard, node);
+   UpdateReferenceTime(timestamp);
+   ++shard.totals.sampleCount;
+   return true;
+}
+
+bool SensorDataStore::AddDerivedSensor(const std::vector<std::string> &path,
+    const std::string &expression,
+    SensorThresholds thresholds,
+    std::string &errorMessage)
+{
+   std::lock_guard<std::mutex> lock(m_derivedMutex);
+   const bool added    = m_derivedSensors.Add(path, expression, std::move(thresholds), errorMessage);
+   m_hasDerivedSensors = !m_derivedSensors.Empty();
+   return added;
+}
+
+void SensorDataStore::SetAlarmPolicy(const AlarmPolicy &policy)
+{
+   for (const auto &shard : m_shards) {
+      std::lock_guard<std::recursive_mutex> lock(shard->mutex);
+      shard->alarmPolicy = policy;
+   }
+}
+
+AlarmPolicy SensorDataStore::GetAlarmPolicy() const
+{
+   std::lock_guard<std::recursive_mutex> lock(m_shards.front()->mutex);
+   return m_shards.front()->alarmPolicy;
+}
+
+void SensorDataStore::SetAggregateKind(Node *node, AggregateKind kind)
+{
+   if (!node)
+      return;
+
+   Shard &shard = *m_shards[GetShardIndex(node)];
+   std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+   SetAggregateKind(shard, node, kind);
+}
+
+void SensorDataStore::SetAggregateKind(Shard &shard, Node *node, AggregateKind kind)
+{
+   if (node->IsLeaf())
+      return;
+
+   node->SetAggregateKind(kind);
+   MarkUpdated(shard, node);
+
+   for (const auto &child : node->GetChildren())
+      SetAggregateKind(shard, child.get(), kind);
+}
+
+void SensorDataStore::SetLiveDataMode(bool isLiveData)
+{
+   if (m_isLiveDataMode.exchange(isLiveData) == isLiveData)
+      return;
+
+   // Clear any stored offline anchor so elapsed times are recalculated for the new mode.
+   std::lock_guard<std::mutex> lock(m_referenceTimeMutex);
+   m_elapsedReferenceTime.reset();
+}
+
+bool SensorDataStore::IsLiveDataMode() const
+{
+   return m_isLiveDataMode.load();
+}
+
+std::chrono::steady_clock::time_point SensorDataStore::GetReferenceTime() const
+{
+   if (!m_isLiveDataMode.load()) {
+      std::lock_guard<std::mutex> lock(m_referenceTimeMutex);
+      if (m_elapsedReferenceTime.has_value())
+         return *m_elapsedReferenceTime;
+   }
+   return std::chrono::steady_clock::now();
+}
+
+void SensorDataStore::UpdateReferenceTime(std::chrono::steady_clock::time_point timestamp)
+{
+   if (m_isLiveDataMode.load())
+      return;
+
+   std::lock_guard<std::mutex> lock(m_referenceTimeMutex);
+   if (!m_elapsedReferenceTime.has_value() || timestamp > *m_elapsedReferenceTime)
+      m_elapsedReferenceTime = timestamp;
+}
+
+void SensorDataStore::AdvanceStaleness()
+{
+   const auto now = GetReferenceTime();
+   for (const auto &shardPtr : m_shards) {
+      Shard &shard = *shardPtr;
+      std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+      shard.expired.clear();
+      shard.staleness.Advance(now, shard.expired);
+
+      for (Node *node : shard.expired) {
+         node->SetStalenessArmed(false);
+         if (!node->HasValue() || node->IsStale())
+            continue;
+
+         // Sensors that kept reporting are re-armed from their newest sample
+         // rather than rescheduled on every update.
+         if (now < node->GetLastUpdateTime() + GetStaleTimeout(node)) {
+            ArmStaleness(shard, node);
+            continue;
+         }
+
+         node->SetStale(true);
+         MarkUpdated(shard, node);
+         ++shard.totals.staleCount;
+         ++m_alarmVersion;
+         shard.changes.transitions.push_back({node, AlarmEventKind::WentStale, node->GetAlarmState(), node->GetAlarmState(), node->GetValue(), now});
+      }
+
+      // Pending alarm states of sensors that went quiet are committed here,
+      // as no later sample will do it.
+      shard.expired.clear();
+      shard.alarmDwell.Advance(now, shard.expired);
+      for (Node *node : shard.expired) {
+         node->SetAlarmDwellArmed(false);
+         if (!shard.alarmPolicy.enabled)
+            continue;
+
+         const SensorAlarmState previousState = node->GetAlarmState();
+         if (!node->GetAlarmEvaluator().CommitPending(now, shard.alarmPolicy)) {
+            ArmAlarmDwell(shard, node);
+            continue;
+         }
+
+         const SensorAlarmState alarmState = node->GetAlarmEvaluator().GetState();
+         node->SetAlarmState(alarmState);
+         MarkUpdated(shard, node);
+         CountAlarmState(shard.totals, previousState, -1);
+         CountAlarmState(shard.totals, alarmState, 1);
+         ++m_alarmVersion;
+         shard.changes.transitions.push_back({node, AlarmEventKind::StateChanged, previousState, alarmState, node->GetValue(), now});
+      }
+   }
+}
+
+void SensorDataStore::Clear()
+{
+   std::vector<std::unique_ptr<Node>> retiredNodes;
+   {
+      const ReadLock lock(*this);
+      for (const auto &shard : m_shards) {
+         shard->changes.Clear();
+         std::move(shard->rootNodes.begin(), shard->rootNodes.end(), std::back_inserter(retiredNodes));
+         shard->rootNodes.clear();
+         shard->staleness.Clear();
+         shard->alarmDwell.Clear();
+         shard->expired.clear();
+         shard->totals = SensorStoreTotals{};
+         shard->derivedSamples.clear();
+         {
+            std::lock_guard<std::mutex> queueLock(shard->queueMutex);
+            shard->queue.clear();
+         }
+         shard->queueSpace.notify_all();
+      }
+      {
+         std::lock_guard<std::mutex> rootOrderLock(m_rootOrderMutex);
+         m_rootOrder.clear();
+      }
+      ++m_clearGeneration;
+      {
+         std::lock_guard<std::mutex> derivedLock(m_derivedMutex);
+         m_derivedSensors.ResetInputs();
+      }
+      {
+         std::lock_guard<std::mutex> referenceLock(m_referenceTimeMutex);
+         m_elapsedReferenceTime.reset();
+      }
+      ++m_structureVersion;
+   }
+
+   // Plots may still be reading the old histories through Views. The tree is
+   // retired as a whole once the shards are unlocked, so ingest does not wait
+   // for the readers or pay for one epoch per node.
+   EpochDomain::WaitUntilReclaimable(EpochDomain::Advance());
+}
+
+Node *SensorDataStore::FindNodeByPath(const std::vector<std::string> &path) const
+{
+   if (path.empty())
+      return nullptr;
+
+   const Shard &shard = *m_shards[GetShardIndex(path[0])];
+   std::lock_guard<std::recursive_mutex> lock(shard.mutex);
+   auto it = std::find_if(shard.rootNodes.begin(), shard.rootNodes.end(),
+       [&path](const std::unique_ptr<Node> &root) {
+          return root && root->GetName() == path[0];
+       });
+   if (it == shard.rootNodes.end())
+      return nullptr;
+
+   Node *current = it->get();
+   for (size_t idx = 1; idx < path.size() && current; ++idx)
+      current = current->FindChild(path[idx]);
+   return current;
+}
+
+void SensorDataStore::TakeChanges(SensorChangeSet &changes)
+{
+   changes.Clear();
+   for (const auto &shard : m_shards) {
+      std::lock_guard<std::recursive_mutex> lock(shard->mutex);
+      SensorChangeSet &pending = shard->changes;
+      for (Node *node : pending.updatedNodes)
+         node->SetChangePending(false);
+
+      if (changes.Empty()) {
+         // Swapping hands the consumer's previous buffers back for reuse.
+         std::swap(changes, pending);
+      } else {
+         changes.createdNodes.insert(changes.createdNodes.end(), pending.createdNodes.begin(), pending.createdNodes.end());
+         changes.updatedNodes.insert(changes.updatedNodes.end(), pending.updatedNodes.begin(), pending.updatedNodes.end());
+         changes.transitions.insert(changes.transitions.end(), pending.transitions.begin(), pending.transitions.end());
+      }
+      pending.Clear();
+   }
+   changes.structureVersion = m_structureVersion;
+   changes.alarmVersion     = m_alarmVersion;
+}
+
+SensorStoreTotals SensorDataStore::GetTotals() const
+{
+   SensorStoreTotals totals;
+   for (const auto &shard : m_shards) {
+      std::lock_guard<std::recursive_mutex> lock(shard->mutex);
+      totals.sensorCount += shard->totals.sensorCount;
+      totals.sampleCount += shard->totals.sampleCount;
+      totals.warningCount += shard->totals.warningCount;
+      totals.failedCount += shard->totals.failedCount;
+      totals.staleCount += shard->totals.staleCount;
+   }
+   return totals;
+}
+
+Node *SensorDataStore::FindOrCreatePath(Shard &shard, const std::vector<std::string> &path)
+{
+   if (path.empty())
+      return nullptr;
+
+   // Find or create root node
+   Node *current = nullptr;
+   auto it       = std::find_if(shard.rootNodes.begin(), shard.rootNodes.end(),
+             [&path](const std::unique_ptr<Node> &node) {
+          return node->GetName() == path[0];
+       });
+
+   if (it != shard.rootNodes.end()) {
+      current = it->get();
+   } else {
+      shard.rootNodes.push_back(std::make_unique<Node>(path[0]));
+      current = shard.rootNodes.back().get();
+      {
+         // Insert in order received
+         std::lock_guard<std::mutex> lock(m_rootOrderMutex);
+         m_rootOrder.push_back(current);
+      }
+      shard.changes.createdNodes.push_back(current);
+      ++m_structureVersion;
+   }
+
+   // Traverse/create the rest of the path
+   for (size_t i = 1; i < path.size(); ++i) {
+      Node *child = current->FindChild(path[i]);
+      if (!child) {
+         child = current->AddChild(std::make_unique<Node>(path[i]));
+         shard.changes.createdNodes.push_back(child);
+         ++m_structureVersion;
+      }
+      current = child;
+   }
+
+   return current;
+}
+
+void SensorDataStore::MarkUpdated(Shard &shard, Node *node)
+{
+   if (node->IsChangePending())
+      return;
+
+   node->SetChangePending(true);
+   shard.changes.updatedNodes.push_back(node);
+}
+
+void SensorDataStore::CountAlarmState(SensorStoreTotals &totals, SensorAlarmState state, int delta)
+{
+   size_t *count = nullptr;
+   if (state == SensorAlarmState::Warn)
+      count = &totals.warningCount;
+   else if (state == SensorAlarmState::Failed)
+      count = &totals.failedCount;
+   if (!count)
+      return;
+
+   if (delta > 0)
+      ++*count;
+   else
+      --*count;
+}
+
+void SensorDataStore::ArmStaleness(Shard &shard, Node *node)
+{
+   if (node->IsStalenessArmed())
+      return;
+
+   const auto timeout = GetStaleTimeout(node);
+   if (timeout == std::chrono::steady_clock::duration::zero())
+      return;
+
+   shard.staleness.Schedule(node, node->GetLastUpdateTime() + timeout);
+   node->SetStalenessArmed(true);
+}
+
+void SensorDataStore::ArmAlarmDwell(Shard &shard, Node *node)
+{
+   if (!node->GetAlarmEvaluator().HasPending() || node->IsAlarmDwellArmed())
+      return;
+
+   std::chrono::steady_clock::time_point deadline;
+   if (!node->GetAlarmEvaluator().GetPendingDeadline(shard.alarmPolicy, deadline))
+      return;
+
+   shard.alarmDwell.Schedule(node, deadline);
+   node->SetAlarmDwellArmed(true);
+}
+
+std::chrono::steady_clock::duration SensorDataStore::GetStaleTimeout(const Node *node)
+{
+   // Periods are only known from the second sample onwards.
+   const auto expected = node->GetStatistics().GetExpectedInterval();
+   if (expected <= std::chrono::steady_clock::duration::zero())
+      return std::chrono::steady_clock::duration::zero();
+
+   const auto scaled = std::chrono::duration_cast<std::chrono::steady_clock::duration>(expected * STALE_PERIOD_MULTIPLIER);
+   return std::max<std::chrono::steady_clock::duration>(scaled, STALE_MINIMUM_TIMEOUT);
+}
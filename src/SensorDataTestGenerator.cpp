@@ -1,274 +1,110 @@
 #include "SensorDataTestGenerator.h"
 
-#include "MainFrame.h"
-#include "SensorDataEvent.h"
-
-#include <wx/event.h>
-
-#include <algorithm>
-#include <chrono>
-#include <cstdint>
 #include <optional>
-#include <random>
+#include <vector>
 
 namespace {
-struct SampleDefinition
-{
-   std::vector<std::string> path;
-   enum class ValueType
-   {
-      Double,
-      Integer,
-      String,
-      Boolean
-   } type;
-   double minDouble        = 0.0;
-   double maxDouble        = 0.0;
-   std::int64_t minInteger = 0;
-   std::int64_t maxInteger = 0;
-   std::vector<std::string> stringOptions;
-   SensorThresholds thresholds;
-   double failureProbability = 0.0;
-   std::vector<std::string> failureStringValues;
-   double booleanTrueProbability = 0.5;
-   std::vector<bool> failureBooleanValues;
-};
 
-SensorAlarmState ClassifyNumericAlarm(double numeric, const SensorThresholds &thresholds)
+void ReportBatch(SensorModelThread &modelThread, const SyntheticLoadGenerator &generator, const PackedSampleBatch &batch)
 {
-   if (thresholds.lowerCritical && numeric < thresholds.lowerCritical->GetNumeric())
-      return SensorAlarmState::Failed;
-   if (thresholds.upperCritical && numeric > thresholds.upperCritical->GetNumeric())
-      return SensorAlarmState::Failed;
-   if (thresholds.lowerNonCritical && numeric < thresholds.lowerNonCritical->GetNumeric())
-      return SensorAlarmState::Warn;
-   if (thresholds.upperNonCritical && numeric > thresholds.upperNonCritical->GetNumeric())
-      return SensorAlarmState::Warn;
-   return SensorAlarmState::Ok;
-}
-
-std::vector<SampleDefinition> GenerateTestSensors()
-{
-   std::vector<SampleDefinition> defs;
-   defs.reserve(10 * 10 * 10);
-
-   for (int i = 0; i < 10; ++i) {
-      std::string cat = "Category" + std::to_string(i + 1);
-      for (int j = 0; j < 10; ++j) {
-         std::string sub = "SubCategory" + std::to_string(j + 1);
-         for (int k = 0; k < 10; ++k) {
-            int type = k % 4;
-            std::string typeSuffix;
-            if (type == 0)
-               typeSuffix = "Double";
-            else if (type == 1)
-               typeSuffix = "Int";
-            else if (type == 2)
-               typeSuffix = "String";
-            else
-               typeSuffix = "Bool";
-
-            std::string sensor = "Sensor" + std::to_string(k + 1) + "_" + typeSuffix;
-
-            SampleDefinition def;
-            def.path = {cat, sub, sensor};
-
-            // Distribute types
-            if (type == 0) { // Double
-               def.type                        = SampleDefinition::ValueType::Double;
-               def.minDouble                   = 0.0;
-               def.maxDouble                   = 100.0;
-               def.thresholds.lowerCritical    = DataValue(5.0);
-               def.thresholds.lowerNonCritical = DataValue(10.0);
-               def.thresholds.upperNonCritical = DataValue(90.0);
-               def.thresholds.upperCritical    = DataValue(95.0);
-               def.failureProbability          = 0.05;
-            } else if (type == 1) { // Integer
-               def.type                        = SampleDefinition::ValueType::Integer;
-               def.minInteger                  = 0;
-               def.maxInteger                  = 1000;
-               def.thresholds.lowerCritical    = DataValue(std::int64_t{50});
-               def.thresholds.lowerNonCritical = DataValue(std::int64_t{100});
-               def.thresholds.upperNonCritical = DataValue(std::int64_t{900});
-               def.thresholds.upperCritical    = DataValue(std::int64_t{950});
-               def.failureProbability          = 0.05;
-            } else if (type == 2) { // String
-               def.type                = SampleDefinition::ValueType::String;
-               def.stringOptions       = {"OK", "Warning", "Error", "Unknown"};
-               def.failureStringValues = {"Error", "Unknown"};
-               def.failureProbability  = 0.05;
-            } else { // Boolean
-               def.type                   = SampleDefinition::ValueType::Boolean;
-               def.booleanTrueProbability = 0.8;
-               def.failureBooleanValues   = {false};
-               def.failureProbability     = 0.05;
-            }
+   modelThread.CountApplied(batch.Size());
+   if (!modelThread.IsRecording())
+      return;
 
-            defs.push_back(def);
-         }
-      }
+   std::vector<SensorSample> samples;
+   samples.reserve(batch.Size());
+   for (size_t idx = 0; idx < batch.Size(); ++idx) {
+      const PackedSampleRecord &record = batch.GetRecords()[idx];
+      const auto *sensor               = generator.FindSensor(record.sensorId);
+      std::optional<DataValue> value   = DecodePackedValue(record, batch.GetText());
+      if (sensor && value)
+         samples.push_back({sensor->path, std::move(*value), sensor->thresholds, record.GetAlarmState(), record.GetTimestamp()});
    }
-   return defs;
+   modelThread.RecordApplied(samples);
 }
+
 } // namespace
 
-SensorDataTestGenerator::SensorDataTestGenerator(std::atomic<bool> &activeFlag, wxEvtHandler *target) :
-    wxThread(wxTHREAD_DETACHED),
+SensorDataTestGenerator::SensorDataTestGenerator(std::atomic<bool> &activeFlag, SensorDataStore &store, SensorModelThread *modelThread) :
+    SampleSource("Test generator", SampleSourceKind::Synthetic),
     m_activeFlag(activeFlag),
-    m_target(target),
-    m_rng(static_cast<unsigned int>(std::chrono::steady_clock::now().time_since_epoch().count()))
+    m_store(store),
+    m_modelThread(modelThread),
+    m_mutex(),
+    m_config(),
+    m_generator(),
+    m_reportedCount(0)
 {
 }
 
-wxThread::ExitCode SensorDataTestGenerator::Entry()
+void SensorDataTestGenerator::SetConfig(const SyntheticLoadConfig &config)
 {
-   QueueConnectionEvent(m_activeFlag.load());
-
-   bool lastActive = m_activeFlag.load();
-   while (!TestDestroy()) {
-      bool isActive = m_activeFlag.load();
-      if (isActive != lastActive) {
-         QueueConnectionEvent(isActive);
-         lastActive = isActive;
-      }
-
-      if (isActive) {
-         QueueRandomDataSample();
-         wxThread::Sleep(1);
-      } else {
-         wxThread::Sleep(100);
-      }
-   }
+   std::lock_guard<std::mutex> lock(m_mutex);
+   m_config = config;
+   if (m_generator)
+      StopLocked();
+}
 
-   QueueConnectionEvent(false);
-   return static_cast<ExitCode>(0);
+SyntheticLoadConfig SensorDataTestGenerator::GetConfig() const
+{
+   std::lock_guard<std::mutex> lock(m_mutex);
+   return m_config;
 }
 
-void SensorDataTestGenerator::QueueRandomDataSample()
+void SensorDataTestGenerator::StopGenerating()
 {
-   static const std::vector<SampleDefinition> definitions = GenerateTestSensors();
+   std::lock_guard<std::mutex> lock(m_mutex);
+   StopLocked();
+}
 
-   if (definitions.empty())
+void SensorDataTestGenerator::StopLocked()
+{
+   if (!m_generator)
       return;
 
-   std::uniform_int_distribution<size_t> defDist(0, definitions.size() - 1);
-   const auto &def = definitions[defDist(m_rng)];
-
-   DataValue value             = DataValue(std::int64_t{0});
-   SensorAlarmState alarmState = SensorAlarmState::Ok;
-   SensorThresholds thresholds = def.thresholds;
-
-   switch (def.type) {
-      case SampleDefinition::ValueType::Double: {
-         std::uniform_real_distribution<double> valDist(def.minDouble, def.maxDouble);
-         double generated = valDist(m_rng);
-
-         bool induceAlarm = def.failureProbability > 0.0 && thresholds.HasAny() && std::bernoulli_distribution(def.failureProbability)(m_rng);
-         if (induceAlarm) {
-            const double range        = std::max(1.0, def.maxDouble - def.minDouble);
-            const bool induceCritical = std::bernoulli_distribution(0.5)(m_rng);
-            const bool useLower       = (thresholds.lowerNonCritical || thresholds.lowerCritical) &&
-                                  (!(thresholds.upperNonCritical || thresholds.upperCritical) || std::bernoulli_distribution(0.5)(m_rng));
-            if (useLower) {
-               if (induceCritical && thresholds.lowerCritical) {
-                  generated = thresholds.lowerCritical->GetNumeric() - range * 0.1;
-               } else if (thresholds.lowerNonCritical) {
-                  generated = thresholds.lowerNonCritical->GetNumeric() - range * 0.05;
-               }
-            } else {
-               if (induceCritical && thresholds.upperCritical) {
-                  generated = thresholds.upperCritical->GetNumeric() + range * 0.1;
-               } else if (thresholds.upperNonCritical) {
-                  generated = thresholds.upperNonCritical->GetNumeric() + range * 0.05;
-               }
-            }
-         }
+   m_generator->Stop();
+   ReportGenerated();
+   m_generator.reset();
+}
 
-         value      = DataValue(generated);
-         alarmState = ClassifyNumericAlarm(generated, thresholds);
-         break;
-      }
-      case SampleDefinition::ValueType::Integer: {
-         std::uniform_int_distribution<std::int64_t> valDist(def.minInteger, def.maxInteger);
-         std::int64_t generated = valDist(m_rng);
+void SensorDataTestGenerator::ReportGenerated()
+{
+   const std::uint64_t generated = m_generator->GetGeneratedCount();
+   GetQueue().RecordDelivered(static_cast<size_t>(generated - m_reportedCount));
+   m_reportedCount = generated;
+}
 
-         bool induceAlarm = def.failureProbability > 0.0 && thresholds.HasAny() && std::bernoulli_distribution(def.failureProbability)(m_rng);
-         if (induceAlarm) {
-            const std::int64_t range  = std::max<std::int64_t>(1, def.maxInteger - def.minInteger);
-            const bool induceCritical = std::bernoulli_distribution(0.5)(m_rng);
-            const bool useLower       = (thresholds.lowerNonCritical || thresholds.lowerCritical) &&
-                                  (!(thresholds.upperNonCritical || thresholds.upperCritical) || std::bernoulli_distribution(0.5)(m_rng));
-            if (useLower) {
-               if (induceCritical && thresholds.lowerCritical) {
-                  generated = static_cast<std::int64_t>(thresholds.lowerCritical->GetNumeric()) - std::max<std::int64_t>(1, range / 10);
-               } else if (thresholds.lowerNonCritical) {
-                  generated = static_cast<std::int64_t>(thresholds.lowerNonCritical->GetNumeric()) - std::max<std::int64_t>(1, range / 20);
-               }
-            } else {
-               if (induceCritical && thresholds.upperCritical) {
-                  generated = static_cast<std::int64_t>(thresholds.upperCritical->GetNumeric()) + std::max<std::int64_t>(1, range / 10);
-               } else if (thresholds.upperNonCritical) {
-                  generated = static_cast<std::int64_t>(thresholds.upperNonCritical->GetNumeric()) + std::max<std::int64_t>(1, range / 20);
-               }
+wxThread::ExitCode SensorDataTestGenerator::Entry()
+{
+   while (!TestDestroy()) {
+      bool isGenerating = false;
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         const bool isActive = m_activeFlag.load();
+         if (!isActive) {
+            StopLocked();
+         } else if (!m_generator) {
+            m_generator     = std::make_unique<SyntheticLoadGenerator>(m_config);
+            m_reportedCount = 0;
+            if (m_modelThread) {
+               SensorModelThread &modelThread = *m_modelThread;
+               m_generator->SetBatchObserver([&modelThread](const SyntheticLoadGenerator &generator, const PackedSampleBatch &batch) {
+                  ReportBatch(modelThread, generator, batch);
+               });
             }
-         }
-
-         value      = DataValue(generated);
-         alarmState = ClassifyNumericAlarm(static_cast<double>(generated), thresholds);
-         break;
-      }
-      case SampleDefinition::ValueType::String: {
-         if (def.stringOptions.empty())
-            return;
-
-         bool induceFailure = def.failureProbability > 0.0 && !def.failureStringValues.empty() && std::bernoulli_distribution(def.failureProbability)(m_rng);
-         std::string chosen;
-         if (induceFailure) {
-            std::uniform_int_distribution<size_t> failureDist(0, def.failureStringValues.size() - 1);
-            chosen = def.failureStringValues[failureDist(m_rng)];
+            m_store.SetLiveDataMode(true);
+            m_generator->Start(m_store);
          } else {
-            std::uniform_int_distribution<size_t> strDist(0, def.stringOptions.size() - 1);
-            chosen = def.stringOptions[strDist(m_rng)];
+            ReportGenerated();
          }
-
-         value      = DataValue(chosen);
-         alarmState = std::find(def.failureStringValues.begin(), def.failureStringValues.end(), chosen) != def.failureStringValues.end()
-                          ? SensorAlarmState::Failed
-                          : SensorAlarmState::Ok;
-         break;
+         isGenerating = m_generator != nullptr;
       }
-      case SampleDefinition::ValueType::Boolean: {
-         bool generated = std::bernoulli_distribution(def.booleanTrueProbability)(m_rng);
 
-         bool induceFailure = def.failureProbability > 0.0 && !def.failureBooleanValues.empty() &&
-                              std::bernoulli_distribution(def.failureProbability)(m_rng);
-         if (induceFailure) {
-            std::uniform_int_distribution<size_t> failureDist(0, def.failureBooleanValues.size() - 1);
-            generated = def.failureBooleanValues[failureDist(m_rng)];
-         }
-
-         value      = DataValue(generated);
-         alarmState = std::any_of(def.failureBooleanValues.begin(), def.failureBooleanValues.end(),
-                          [generated](bool failureVal) { return failureVal == generated; })
-                          ? SensorAlarmState::Failed
-                          : SensorAlarmState::Ok;
-         break;
-      }
+      SetState(isGenerating ? SampleSourceState::Connected : SampleSourceState::Idle);
+      wxThread::Sleep(100);
    }
 
-   auto *evt = new SensorDataEvent(def.path, value, thresholds, alarmState);
-   wxQueueEvent(m_target, evt);
-   QueueNewMessageEvent();
-}
-
-void SensorDataTestGenerator::QueueConnectionEvent(bool connected)
-{
-   auto *evt = new wxThreadEvent(wxEVT_THREAD, connected ? ID_ConnectYes : ID_ConnectNo);
-   wxQueueEvent(m_target, evt);
-}
-
-void SensorDataTestGenerator::QueueNewMessageEvent()
-{
-   auto *evt = new wxThreadEvent(wxEVT_THREAD, ID_NewMessage);
-   wxQueueEvent(m_target, evt);
+   StopGenerating();
+   SetState(SampleSourceState::Idle);
+   return static_cast<ExitCode>(0);
 }
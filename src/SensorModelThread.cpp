@@ -0,0 +1,60 @@
+#include "SensorModelThread.h"
+
+#include <utility>
+
+SensorModelThread::SensorModelThread(SensorDataStore &store, SourceManager &sources) :
+    wxThread(wxTHREAD_JOINABLE),
+    m_store(store),
+    m_sources(sources),
+    m_recorderMutex(),
+    m_recorder(),
+    m_isRecording(false),
+    m_drained(0),
+    m_batch()
+{
+}
+
+std::unique_ptr<SensorDataJsonWriter> SensorModelThread::ReplaceRecorder(std::unique_ptr<SensorDataJsonWriter> recorder)
+{
+   std::lock_guard<std::mutex> lock(m_recorderMutex);
+   std::swap(m_recorder, recorder);
+   m_isRecording = m_recorder != nullptr;
+   return recorder;
+}
+
+void SensorModelThread::RecordApplied(const std::vector<SensorSample> &samples)
+{
+   std::lock_guard<std::mutex> lock(m_recorderMutex);
+   if (!m_recorder)
+      return;
+
+   for (const SensorSample &sample : samples)
+      m_recorder->RecordSample(sample.path, sample.value, sample.thresholds, sample.alarmState);
+}
+
+wxThread::ExitCode SensorModelThread::Entry()
+{
+   while (!TestDestroy()) {
+      m_batch.clear();
+      if (m_sources.Drain(MAX_SAMPLES_PER_BATCH, m_batch) == 0) {
+         m_store.AdvanceStaleness();
+         wxThread::Sleep(IDLE_SLEEP_MS);
+         continue;
+      }
+
+      {
+         std::lock_guard<std::mutex> lock(m_recorderMutex);
+         if (m_recorder) {
+            for (const SensorSample &sample : m_batch)
+               m_recorder->RecordSample(sample.path, sample.value, sample.thresholds, sample.alarmState);
+         }
+      }
+
+      m_drained += m_batch.size();
+      m_store.SetLiveDataMode(true);
+      m_store.SubmitSamples(m_batch);
+      m_store.AdvanceStaleness();
+   }
+
+   return static_cast<ExitCode>(0);
+}
@@ -0,0 +1,133 @@
+#include "SensorStatistics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+SensorStatistics::SensorStatistics() :
+    m_numericCount(0),
+    m_mean(0.0),
+    m_m2(0.0),
+    m_ewma(0.0),
+    m_windowMin(),
+    m_windowMax(),
+    m_sampleCount(0),
+    m_lastSample(),
+    m_meanIntervalSeconds(0.0),
+    m_expectedIntervalSeconds(0.0),
+    m_lastState(SensorAlarmState::Ok),
+    m_timeInWarn(Duration::zero()),
+    m_timeInFailed(Duration::zero())
+{
+}
+
+void SensorStatistics::Update(double numeric, SensorAlarmState alarmState, TimePoint timestamp)
+{
+   if (m_sampleCount > 0 && timestamp > m_lastSample) {
+      // The interval since the previous sample is charged to the state that
+      // sample reported.
+      const Duration interval = timestamp - m_lastSample;
+      if (m_lastState == SensorAlarmState::Warn)
+         m_timeInWarn += interval;
+      else if (m_lastState == SensorAlarmState::Failed)
+         m_timeInFailed += interval;
+
+      const double seconds  = std::chrono::duration<double>(interval).count();
+      m_meanIntervalSeconds = m_sampleCount == 1 ? seconds : m_meanIntervalSeconds + EWMA_ALPHA * (seconds - m_meanIntervalSeconds);
+
+      const double capped       = m_sampleCount == 1 ? seconds : std::min(seconds, m_expectedIntervalSeconds * EXPECTED_INTERVAL_MAX_STEP);
+      m_expectedIntervalSeconds = m_sampleCount == 1 ? capped : m_expectedIntervalSeconds + EWMA_ALPHA * (capped - m_expectedIntervalSeconds);
+   }
+
+   ++m_sampleCount;
+   m_lastSample = std::max(m_lastSample, timestamp);
+   m_lastState  = alarmState;
+
+   if (std::isnan(numeric))
+      return;
+
+   ++m_numericCount;
+   const double delta = numeric - m_mean;
+   m_mean += delta / static_cast<double>(m_numericCount);
+   m_m2 += delta * (numeric - m_mean);
+   m_ewma = m_numericCount == 1 ? numeric : m_ewma + EWMA_ALPHA * (numeric - m_ewma);
+
+   while (!m_windowMin.empty() && m_windowMin.back().value >= numeric)
+      m_windowMin.pop_back();
+   m_windowMin.push_back({timestamp, numeric});
+   while (!m_windowMax.empty() && m_windowMax.back().value <= numeric)
+      m_windowMax.pop_back();
+   m_windowMax.push_back({timestamp, numeric});
+   EvictWindow(timestamp);
+}
+
+void SensorStatistics::Reset()
+{
+   *this = SensorStatistics();
+}
+
+double SensorStatistics::GetVariance() const
+{
+   return m_numericCount > 1 ? m_m2 / static_cast<double>(m_numericCount - 1) : 0.0;
+}
+
+double SensorStatistics::GetStdDev() const
+{
+   return std::sqrt(GetVariance());
+}
+
+double SensorStatistics::GetWindowMin(TimePoint now) const
+{
+   return GetWindowFront(m_windowMin, now);
+}
+
+double SensorStatistics::GetWindowMax(TimePoint now) const
+{
+   return GetWindowFront(m_windowMax, now);
+}
+
+double SensorStatistics::GetUpdateRate() const
+{
+   return m_meanIntervalSeconds > 0.0 ? 1.0 / m_meanIntervalSeconds : 0.0;
+}
+
+SensorStatistics::Duration SensorStatistics::GetExpectedInterval() const
+{
+   return std::chrono::duration_cast<Duration>(std::chrono::duration<double>(m_expectedIntervalSeconds));
+}
+
+SensorStatistics::Duration SensorStatistics::GetTimeInState(SensorAlarmState state, TimePoint now) const
+{
+   Duration total = Duration::zero();
+   if (state == SensorAlarmState::Warn)
+      total = m_timeInWarn;
+   else if (state == SensorAlarmState::Failed)
+      total = m_timeInFailed;
+   else
+      return total;
+
+   if (m_sampleCount > 0 && m_lastState == state && now > m_lastSample)
+      total += now - m_lastSample;
+   return total;
+}
+
+double SensorStatistics::GetWindowFront(const std::deque<WindowSample> &window, TimePoint now)
+{
+   // Update() only evicts against the newest sample, so entries a quiet
+   // sensor left behind are skipped here. Later entries still hold the
+   // extreme of what remains.
+   const TimePoint cutoff = now - EXTREMES_WINDOW;
+   const auto inWindow    = std::find_if(window.begin(), window.end(), [cutoff](const WindowSample &sample) {
+      return sample.timestamp >= cutoff;
+   });
+   return inWindow == window.end() ? std::numeric_limits<double>::quiet_NaN() : inWindow->value;
+}
+
+void SensorStatistics::EvictWindow(TimePoint now)
+{
+   const TimePoint cutoff = now - EXTREMES_WINDOW;
+   while (!m_windowMin.empty() && m_windowMin.front().timestamp < cutoff)
+      m_windowMin.pop_front();
+   while (!m_windowMax.empty() && m_windowMax.front().timestamp < cutoff)
+      m_windowMax.pop_front();
+}
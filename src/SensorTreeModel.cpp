@@ -1,6 +1,7 @@
 #include "SensorTreeModel.h"
 
 #include <algorithm>
+#include <cmath>
 #include <utility>
 
 namespace {
@@ -15,6 +16,18 @@ const wxColour &FailColor()
    return *wxRED;
 }
 
+wxColour StaleColor()
+{
+   return wxColour(128, 128, 128);
+}
+
+wxColour SummaryColor(const SensorTreeModel::AlarmSummary &summary)
+{
+   if (summary.failureCount > 0)
+      return FailColor();
+   return summary.warningCount > 0 ? WarningColor() : StaleColor();
+}
+
 bool IsAlarmSummaryColumn(unsigned int col)
 {
    switch (col) {
@@ -30,6 +43,20 @@ bool IsAlarmSummaryColumn(unsigned int col)
    }
 }
 
+wxString FormatStatistic(const Node *node, double value)
+{
+   if (!node->HasValue() || !node->GetStatistics().HasNumeric() || std::isnan(value))
+      return wxString("");
+   return wxString::Format("%.4g", value);
+}
+
+wxString FormatStatisticSeconds(const Node *node, std::chrono::steady_clock::duration duration)
+{
+   if (!node->HasValue())
+      return wxString("");
+   return wxString::Format("%.1f", std::chrono::duration<double>(duration).count());
+}
+
 wxString FormatAlarmSummaryText(const SensorTreeModel::AlarmSummary &summary)
 {
    wxString text;
@@ -47,12 +74,22 @@ wxString FormatAlarmSummaryText(const SensorTreeModel::AlarmSummary &summary)
       }
    }
 
+   if (summary.staleCount > 0) {
+      wxString staleText = wxString::Format("%zu stale", summary.staleCount);
+      if (text.IsEmpty()) {
+         text = staleText;
+      } else {
+         text += ", " + staleText;
+      }
+   }
+
    return text;
 }
 
 } // namespace
 
-SensorTreeModel::SensorTreeModel()
+SensorTreeModel::SensorTreeModel(size_t shardCount) :
+    m_store(shardCount)
 {
 }
 
@@ -60,15 +97,122 @@ SensorTreeModel::~SensorTreeModel()
 {
 }
 
+bool SensorTreeModel::PublishChanges()
+{
+   // Only the change set and the row structure need the whole store; row
+   // refreshes and callbacks run unlocked so ingest is not held up by them.
+   // GetValue locks each row's shard on its own.
+   m_changedRows.clear();
+   {
+      const auto lock = m_store.Lock();
+      m_store.TakeChanges(m_changes);
+      m_structureVersion = m_changes.structureVersion;
+      m_alarmVersion     = m_changes.alarmVersion;
+      if (m_changes.Empty())
+         return false;
+
+      // Parents are listed before their children, so a new subtree is added
+      // once at its top and its descendants are picked up from GetChildren.
+      for (Node *node : m_changes.createdNodes)
+         SyncRowPath(node);
+
+      for (Node *node : m_changes.updatedNodes) {
+         if (SyncRowPath(node) && node->IsShownInView())
+            m_changedRows.push_back(node);
+      }
+   }
+
+   for (Node *node : m_changedRows)
+      ItemChanged(CreateItemFromNode(node));
+   if (!m_changes.updatedNodes.empty())
+      m_rowsChanged = true;
+
+   if (m_onAlarmTransition) {
+      for (const SensorAlarmTransition &transition : m_changes.transitions)
+         m_onAlarmTransition(transition);
+   }
+
+   if (m_onSensorUpdated) {
+      for (Node *node : m_changes.updatedNodes)
+         m_onSensorUpdated(node);
+   }
+
+   return true;
+}
+
+void SensorTreeModel::AddDataSample(const std::vector<std::string> &path, const DataValue &value,
+    SensorThresholds thresholds,
+    SensorAlarmState alarmState,
+    std::chrono::steady_clock::time_point timestamp)
+{
+   m_store.AddDataSample(path, value, std::move(thresholds), alarmState, timestamp);
+   PublishChanges();
+}
+
+void SensorTreeModel::AddDataSamples(const std::vector<SensorSample> &samples)
+{
+   m_store.AddDataSamples(samples);
+   PublishChanges();
+}
+
+void SensorTreeModel::AddRecordedSamples(const std::vector<SensorSample> &samples)
+{
+   m_store.AddRecordedSamples(samples);
+   PublishChanges();
+}
+
+SensorTreeModel::SensorId SensorTreeModel::RegisterSensor(const std::vector<std::string> &path, SensorThresholds thresholds)
+{
+   return m_store.RegisterSensor(path, std::move(thresholds));
+}
+
+size_t SensorTreeModel::AddPackedSamples(const PackedSampleRecord *records, size_t count, std::string_view text)
+{
+   const size_t applied = m_store.AddPackedSamples(records, count, text);
+   PublishChanges();
+   return applied;
+}
+
+bool SensorTreeModel::AddDerivedSensor(const std::vector<std::string> &path,
+    const std::string &expression,
+    SensorThresholds thresholds,
+    std::string &errorMessage)
+{
+   return m_store.AddDerivedSensor(path, expression, std::move(thresholds), errorMessage);
+}
+
+void SensorTreeModel::SetAggregateKind(Node *node, AggregateKind kind)
+{
+   m_store.SetAggregateKind(node, kind);
+   PublishChanges();
+}
+
 void SensorTreeModel::SetLiveDataMode(bool isLiveData)
 {
-   if (m_isLiveDataMode == isLiveData)
+   if (m_store.IsLiveDataMode() == isLiveData)
       return;
 
-   m_isLiveDataMode = isLiveData;
+   m_store.SetLiveDataMode(isLiveData);
+   m_lastElapsedRefresh.reset();
+}
 
-   // Clear any stored offline anchor so elapsed times are recalculated for the new mode.
-   m_elapsedReferenceTime.reset();
+void SensorTreeModel::AdvanceStaleness()
+{
+   m_store.AdvanceStaleness();
+   PublishChanges();
+}
+
+void SensorTreeModel::Clear()
+{
+   m_store.Clear();
+   m_changes.Clear();
+   m_lastElapsedRefresh.reset();
+   m_structureVersion = m_store.GetStructureVersion();
+   m_alarmVersion     = m_store.GetAlarmVersion();
+   Cleared();
+
+   if (m_onSensorUpdated)
+      m_onSensorUpdated(nullptr);
 }
 
 void SensorTreeModel::SetShowAlarmedOnly(bool showAlarmedOnly)
@@ -77,6 +221,7 @@ void SensorTreeModel::SetShowAlarmedOnly(bool showAlarmedOnly)
       return;
 
    m_showAlarmedOnly = showAlarmedOnly;
+   RebuildShownRows();
    Cleared();
 }
 
@@ -93,6 +238,7 @@ void SensorTreeModel::SetFilter(const wxString &filterText)
    m_filter      = trimmed;
    m_filterLower = lower;
 
+   RebuildShownRows();
    Cleared();
 }
 
@@ -101,153 +247,83 @@ void SensorTreeModel::SetExpansionQuery(std::function<bool(const Node *)> query)
    m_isNodeExpanded = std::move(query);
 }
 
-void SensorTreeModel::AddDataSample(const std::vector<std::string> &path, const DataValue &value,
-    SensorThresholds thresholds,
-    SensorAlarmState alarmState,
-    std::chrono::steady_clock::time_point timestamp)
+void SensorTreeModel::SetOnSensorUpdated(std::function<void(const Node *)> callback)
 {
-   if (path.empty())
-      return;
-
-   std::vector<Node *> existingPath;
-   existingPath.reserve(path.size());
-
-   Node *current = nullptr;
-   for (size_t i = 0; i < path.size(); ++i) {
-      Node *next = nullptr;
-      if (i == 0) {
-         auto it = std::find_if(m_rootNodes.begin(), m_rootNodes.end(),
-             [&path](const std::unique_ptr<Node> &root) {
-                return root->GetName() == path[0];
-             });
-         if (it != m_rootNodes.end()) {
-            next = it->get();
-         }
-      } else if (current) {
-         next = current->FindChild(path[i]);
-      }
-
-      if (!next)
-         break;
-
-      existingPath.push_back(next);
-      current = next;
-   }
-
-   std::vector<bool> beforeExisting;
-   beforeExisting.reserve(existingPath.size());
-   for (Node *existingNode : existingPath) {
-      beforeExisting.push_back(IsNodeVisible(existingNode));
-   }
+   m_onSensorUpdated = std::move(callback);
+}
 
-   std::vector<CreatedEdge> createdEdges;
-   bool structureChanged = false;
-   Node *node            = FindOrCreatePath(path, structureChanged, createdEdges);
+void SensorTreeModel::SetOnAlarmTransition(AlarmTransitionCallback callback)
+{
+   m_onAlarmTransition = std::move(callback);
+}
 
-   if (!node)
-      return;
+bool SensorTreeModel::SyncRowPath(Node *node)
+{
+   m_pathScratch.clear();
+   for (Node *current = node; current; current = current->GetParent())
+      m_pathScratch.push_back(current);
 
-   std::vector<Node *> fullPath = BuildPath(node);
+   // Walk down from the root. The first row whose visibility disagrees with
+   // what the view was told is added or removed together with its subtree,
+   // which settles everything below it on this path.
+   Node *parent = nullptr;
+   for (auto it = m_pathScratch.rbegin(); it != m_pathScratch.rend(); ++it) {
+      Node *current                   = *it;
+      const bool visible              = IsNodeVisible(current);
+      const bool shown                = current->IsShownInView();
+      const wxDataViewItem parentItem = parent ? CreateItemFromNode(parent) : wxDataViewItem(nullptr);
 
-   std::vector<bool> beforeStates;
-   beforeStates.reserve(fullPath.size());
-   for (size_t i = 0; i < fullPath.size(); ++i) {
-      if (i < beforeExisting.size() && fullPath[i] == existingPath[i]) {
-         beforeStates.push_back(beforeExisting[i]);
-      } else {
-         beforeStates.push_back(false);
+      if (visible && !shown) {
+         const bool parentHadRows = parent && HasShownChildren(parent);
+         ShowSubtree(current);
+         ItemAdded(parentItem, CreateItemFromNode(current));
+         // A row that just became a container needs its expander drawn.
+         if (parent && !parentHadRows)
+            ItemChanged(parentItem);
+         return false;
       }
-   }
-
-   node->SetValue(value, std::move(thresholds), alarmState, timestamp);
 
-   if (!m_isLiveDataMode) {
-      if (!m_elapsedReferenceTime.has_value() || timestamp > *m_elapsedReferenceTime)
-         m_elapsedReferenceTime = timestamp;
-   }
-
-   std::vector<bool> afterStates;
-   afterStates.reserve(fullPath.size());
-   for (Node *pathNode : fullPath) {
-      afterStates.push_back(IsNodeVisible(pathNode));
-   }
-
-   // Remove nodes that are no longer visible starting from the deepest node.
-   for (size_t idx = fullPath.size(); idx-- > 0;) {
-      if (beforeStates[idx] && !afterStates[idx]) {
-         Node *currentNode         = fullPath[idx];
-         wxDataViewItem parentItem = currentNode->GetParent() ? CreateItemFromNode(currentNode->GetParent()) : wxDataViewItem(nullptr);
-         ItemDeleted(parentItem, CreateItemFromNode(currentNode));
+      if (!visible && shown) {
+         HideSubtree(current);
+         ItemDeleted(parentItem, CreateItemFromNode(current));
+         return false;
       }
-   }
 
-   // Add nodes that became visible, starting from the root to ensure parents exist first.
-   for (size_t idx = 0; idx < fullPath.size(); ++idx) {
-      if (!beforeStates[idx] && afterStates[idx]) {
-         Node *currentNode         = fullPath[idx];
-         wxDataViewItem parentItem = currentNode->GetParent() ? CreateItemFromNode(currentNode->GetParent()) : wxDataViewItem(nullptr);
-         ItemAdded(parentItem, CreateItemFromNode(currentNode));
-      }
+      if (!shown)
+         return false;
+      parent = current;
    }
 
-   // Refresh the node whose data changed if it remains visible.
-   if (!fullPath.empty()) {
-      size_t leafIndex = fullPath.size() - 1;
-      if (beforeStates[leafIndex] && afterStates[leafIndex]) {
-         ItemChanged(CreateItemFromNode(fullPath[leafIndex]));
-      }
-   }
+   return true;
+}
 
-   if (structureChanged) {
-      for (const auto &edge : createdEdges) {
-         if (edge.parent && edge.parentWasLeaf && IsNodeVisible(edge.parent)) {
-            ItemChanged(CreateItemFromNode(edge.parent));
-         }
-      }
+void SensorTreeModel::ShowSubtree(Node *node)
+{
+   node->SetShownInView(true);
+   for (const auto &child : node->GetChildren()) {
+      if (IsNodeVisible(child.get()))
+         ShowSubtree(child.get());
+      else
+         HideSubtree(child.get());
    }
 }
 
-Node *SensorTreeModel::FindOrCreatePath(const std::vector<std::string> &path, bool &structureChanged, std::vector<CreatedEdge> &createdEdges)
+void SensorTreeModel::HideSubtree(Node *node)
 {
-   structureChanged = false;
-   createdEdges.clear();
-
-   if (path.empty())
-      return nullptr;
-
-   // Find or create root node
-   Node *current = nullptr;
-   auto it       = std::find_if(m_rootNodes.begin(), m_rootNodes.end(),
-             [&path](const std::unique_ptr<Node> &node) {
-          return node->GetName() == path[0];
-       });
-
-   if (it != m_rootNodes.end()) {
-      current = it->get();
-   } else {
-      // Create new root node
-      auto newRoot     = std::make_unique<Node>(path[0]);
-      current          = newRoot.get();
-      structureChanged = true;
-      // Insert in order received
-      m_rootNodes.push_back(std::move(newRoot));
-      createdEdges.push_back({nullptr, current, false});
-   }
+   node->SetShownInView(false);
+   for (const auto &child : node->GetChildren())
+      HideSubtree(child.get());
+}
 
-   // Traverse/create the rest of the path
-   for (size_t i = 1; i < path.size(); ++i) {
-      Node *child = current->FindChild(path[i]);
-      if (!child) {
-         const bool parentWasLeaf = current->IsLeaf();
-         auto newChild            = std::make_unique<Node>(path[i]);
-         child                    = current->AddChild(std::move(newChild));
-         structureChanged         = true;
-         createdEdges.push_back({current, child, parentWasLeaf});
-      }
-      current = child;
+void SensorTreeModel::RebuildShownRows()
+{
+   const auto lock = m_store.Lock();
+   for (Node *root : m_store.GetRootNodes()) {
+      if (IsNodeVisible(root))
+         ShowSubtree(root);
+      else
+         HideSubtree(root);
    }
-
-   return current;
 }
 
 // wxDataViewModel interface implementation
@@ -263,7 +339,8 @@ wxString SensorTreeModel::GetColumnType(unsigned int col) const
 
 void SensorTreeModel::GetValue(wxVariant &variant, const wxDataViewItem &item, unsigned int col) const
 {
-   Node *node = GetNodeFromItem(item);
+   Node *node      = GetNodeFromItem(item);
+   const auto lock = m_store.LockSubtree(node);
    if (!node)
       return;
 
@@ -285,7 +362,7 @@ void SensorTreeModel::GetValue(wxVariant &variant, const wxDataViewItem &item, u
          }
 
          const AlarmSummary alarmSummary = CountAlarmedDescendants(node);
-         if (alarmSummary.failureCount > 0 || alarmSummary.warningCount > 0) {
+         if (alarmSummary.Any()) {
             variant = FormatAlarmSummaryText(alarmSummary);
          } else {
             variant = wxString("");
@@ -322,10 +399,8 @@ void SensorTreeModel::GetValue(wxVariant &variant, const wxDataViewItem &item, u
          break;
       case COL_ELAPSED:
          if (node->HasValue()) {
-            const double seconds = (!m_isLiveDataMode && m_elapsedReferenceTime.has_value())
-                                       ? node->GetSecondsSinceUpdate(*m_elapsedReferenceTime)
-                                       : node->GetSecondsSinceUpdate();
-            variant              = wxString::Format("%.1f", seconds);
+            const double seconds = node->GetSecondsSinceUpdate(GetReferenceTime());
+            variant              = node->IsStale() ? wxString::Format("%.1f (stale)", seconds) : wxString::Format("%.1f", seconds);
          } else {
             variant = wxString("");
          }
@@ -337,6 +412,43 @@ void SensorTreeModel::GetValue(wxVariant &variant, const wxDataViewItem &item, u
             variant = wxString("");
          }
          break;
+      case COL_AGGREGATE: {
+         const double aggregate = node->GetAggregate().Get(node->GetAggregateKind());
+         if (node->IsLeaf() || std::isnan(aggregate)) {
+            variant = wxString("");
+         } else {
+            variant = wxString::Format("%s %.4g", ToString(node->GetAggregateKind()), aggregate);
+         }
+         break;
+      }
+      case COL_MEAN:
+         variant = FormatStatistic(node, node->GetStatistics().GetMean());
+         break;
+      case COL_STDDEV:
+         variant = FormatStatistic(node, node->GetStatistics().GetStdDev());
+         break;
+      case COL_EWMA:
+         variant = FormatStatistic(node, node->GetStatistics().GetEwma());
+         break;
+      case COL_WINDOW_MIN:
+         variant = FormatStatistic(node, node->GetStatistics().GetWindowMin(GetReferenceTime()));
+         break;
+      case COL_WINDOW_MAX:
+         variant = FormatStatistic(node, node->GetStatistics().GetWindowMax(GetReferenceTime()));
+         break;
+      case COL_UPDATE_RATE:
+         if (node->HasValue()) {
+            variant = wxString::Format("%.2f", node->GetStatistics().GetUpdateRate());
+         } else {
+            variant = wxString("");
+         }
+         break;
+      case COL_TIME_IN_WARN:
+         variant = FormatStatisticSeconds(node, node->GetStatistics().GetTimeInState(SensorAlarmState::Warn, GetReferenceTime()));
+         break;
+      case COL_TIME_IN_FAILED:
+         variant = FormatStatisticSeconds(node, node->GetStatistics().GetTimeInState(SensorAlarmState::Failed, GetReferenceTime()));
+         break;
       default:
          variant = wxString("");
    }
@@ -350,7 +462,8 @@ bool SensorTreeModel::SetValue(const wxVariant &variant, const wxDataViewItem &i
 
 bool SensorTreeModel::GetAttr(const wxDataViewItem &item, unsigned int col, wxDataViewItemAttr &attr) const
 {
-   Node *node = GetNodeFromItem(item);
+   Node *node      = GetNodeFromItem(item);
+   const auto lock = m_store.LockSubtree(node);
    if (!node)
       return false;
 
@@ -367,13 +480,18 @@ bool SensorTreeModel::GetAttr(const wxDataViewItem &item, unsigned int col, wxDa
       }
 
       const AlarmSummary summary = CountAlarmedDescendants(node);
-      const bool hasAlarmedChild = summary.failureCount > 0 || summary.warningCount > 0;
-      if (hasAlarmedChild) {
-         attr.SetColour(summary.failureCount > 0 ? FailColor() : WarningColor());
+      if (summary.Any()) {
+         attr.SetColour(SummaryColor(summary));
          return true;
       }
    }
 
+   if (col == COL_ELAPSED && node->HasValue() && node->IsStale()) {
+      attr.SetColour(StaleColor());
+      attr.SetItalic(true);
+      return true;
+   }
+
    if (m_filterLower.IsEmpty())
       return false;
 
@@ -402,8 +520,9 @@ bool SensorTreeModel::IsContainer(const wxDataViewItem &item) const
    if (!item.IsOk())
       return true;
 
-   Node *node = GetNodeFromItem(item);
-   return node && HasVisibleChildren(node);
+   Node *node      = GetNodeFromItem(item);
+   const auto lock = m_store.LockSubtree(node);
+   return node && HasShownChildren(node);
 }
 
 bool SensorTreeModel::HasContainerColumns(const wxDataViewItem &item) const
@@ -413,24 +532,28 @@ bool SensorTreeModel::HasContainerColumns(const wxDataViewItem &item) const
 
 unsigned int SensorTreeModel::GetChildren(const wxDataViewItem &parent, wxDataViewItemArray &array) const
 {
+   // Only rows the view has been told about; anything newer waits for the
+   // next PublishChanges.
    Node *parentNode = GetNodeFromItem(parent);
 
    if (!parentNode) {
       // Root level - return root nodes
+      const auto lock    = m_store.Lock();
       unsigned int count = 0;
-      for (const auto &node : m_rootNodes) {
-         if (IsNodeVisible(node.get())) {
-            array.Add(CreateItemFromNode(node.get()));
+      for (Node *node : m_store.GetRootNodes()) {
+         if (node->IsShownInView()) {
+            array.Add(CreateItemFromNode(node));
             ++count;
          }
       }
       return count;
    } else {
       // Return children of the specified parent
+      const auto lock      = m_store.LockSubtree(parentNode);
       const auto &children = parentNode->GetChildren();
       unsigned int count   = 0;
       for (const auto &child : children) {
-         if (IsNodeVisible(child.get())) {
+         if (child->IsShownInView()) {
             array.Add(CreateItemFromNode(child.get()));
             ++count;
          }
@@ -441,11 +564,23 @@ unsigned int SensorTreeModel::GetChildren(const wxDataViewItem &parent, wxDataVi
 
 void SensorTreeModel::RefreshElapsedTimes()
 {
+   // Loaded recordings have a frozen reference time, so their rows only need
+   // repainting when samples or staleness actually changed something.
+   const auto referenceTime = GetReferenceTime();
+   const bool clockAdvanced = !m_lastElapsedRefresh.has_value() || referenceTime < *m_lastElapsedRefresh ||
+                              referenceTime - *m_lastElapsedRefresh >= ELAPSED_REFRESH_INTERVAL;
+   if (!clockAdvanced && !m_rowsChanged)
+      return;
+
+   m_lastElapsedRefresh = referenceTime;
+   m_rowsChanged        = false;
+
+   const auto lock = m_store.Lock();
    std::function<void(Node *)> refresh = [&](Node *node) {
       if (!node)
          return;
 
-      if (IsNodeVisible(node)) {
+      if (node->IsShownInView()) {
          ItemChanged(CreateItemFromNode(node));
       }
 
@@ -459,47 +594,11 @@ void SensorTreeModel::RefreshElapsedTimes()
       }
    };
 
-   for (const auto &root : m_rootNodes) {
-      refresh(root.get());
+   for (Node *root : m_store.GetRootNodes()) {
+      refresh(root);
    }
 }
 
-void SensorTreeModel::Clear()
-{
-   m_rootNodes.clear();
-   m_elapsedReferenceTime.reset();
-   Cleared();
-}
-
-Node *SensorTreeModel::FindNodeByPath(const std::vector<std::string> &path) const
-{
-   if (path.empty())
-      return nullptr;
-
-   Node *current = nullptr;
-   for (size_t idx = 0; idx < path.size(); ++idx) {
-      const std::string &segment = path[idx];
-      if (idx == 0) {
-         auto it = std::find_if(m_rootNodes.begin(), m_rootNodes.end(),
-             [&segment](const std::unique_ptr<Node> &root) {
-                return root && root->GetName() == segment;
-             });
-         if (it == m_rootNodes.end())
-            return nullptr;
-         current = it->get();
-      } else {
-         if (!current)
-            return nullptr;
-         current = current->FindChild(segment);
-         if (!current)
-            return nullptr;
-      }
-   }
-
-   return current;
-}
-
-// Helper methods
 Node *SensorTreeModel::GetNodeFromItem(const wxDataViewItem &item) const
 {
    return static_cast<Node *>(item.GetID());
@@ -510,20 +609,13 @@ wxDataViewItem SensorTreeModel::CreateItemFromNode(Node *node) const
    return wxDataViewItem(static_cast<void *>(node));
 }
 
-std::vector<Node *> SensorTreeModel::BuildPath(Node *node) const
-{
-   std::vector<Node *> reversed;
-   Node *current = node;
-   while (current) {
-      reversed.push_back(current);
-      current = current->GetParent();
-   }
-
-   return std::vector<Node *>(reversed.rbegin(), reversed.rend());
-}
-
 bool SensorTreeModel::IsNodeVisible(const Node *node) const
 {
+   // Without filters every row is shown, whatever its subtree holds.
+   if (m_filterLower.IsEmpty() && !m_showAlarmedOnly)
+      return node != nullptr;
+
+   const auto lock = m_store.LockSubtree(node);
    return EvaluateVisibleSubtree(node).isVisible;
 }
 
@@ -547,7 +639,7 @@ bool SensorTreeModel::NodeNameMatchesFilter(const Node *node) const
 
 bool SensorTreeModel::NodeMatchesAlarmFilter(const Node *node) const
 {
-   return node && node->HasValue() && node->IsAlarmed();
+   return node && node->HasValue() && (node->IsAlarmed() || node->IsStale());
 }
 
 SensorTreeModel::VisibleSubtreeState SensorTreeModel::EvaluateVisibleSubtree(const Node *node) const
@@ -566,6 +658,7 @@ SensorTreeModel::VisibleSubtreeState SensorTreeModel::EvaluateVisibleSubtree(con
       anyChildVisible = true;
       summary.warningCount += childState.alarmSummary.warningCount;
       summary.failureCount += childState.alarmSummary.failureCount;
+      summary.staleCount += childState.alarmSummary.staleCount;
    }
 
    if (m_showAlarmedOnly && !NodeMatchesAlarmFilter(node) && !anyChildVisible)
@@ -581,18 +674,20 @@ SensorTreeModel::VisibleSubtreeState SensorTreeModel::EvaluateVisibleSubtree(con
       } else if (node->IsWarn()) {
          summary.warningCount++;
       }
+      if (node->IsStale())
+         summary.staleCount++;
    }
 
    return {true, summary};
 }
 
-bool SensorTreeModel::HasVisibleChildren(const Node *node) const
+bool SensorTreeModel::HasShownChildren(const Node *node) const
 {
    if (!node)
       return false;
 
    for (const auto &child : node->GetChildren()) {
-      if (EvaluateVisibleSubtree(child.get()).isVisible)
+      if (child->IsShownInView())
          return true;
    }
    return false;
@@ -603,6 +698,22 @@ SensorTreeModel::AlarmSummary SensorTreeModel::CountAlarmedDescendants(const Nod
    if (!node)
       return {};
 
+   // Without a name filter every alarmed or stale sensor is visible, so the
+   // incrementally maintained subtree counts answer directly.
+   if (m_filterLower.IsEmpty()) {
+      const SubtreeAggregate &aggregate = node->GetAggregate();
+      AlarmSummary total;
+      total.warningCount = aggregate.warningCount;
+      total.failureCount = aggregate.failureCount;
+      total.staleCount   = aggregate.staleCount;
+      if (node->HasValue()) {
+         total.warningCount -= node->IsWarn() ? 1 : 0;
+         total.failureCount -= node->IsFailed() ? 1 : 0;
+         total.staleCount -= node->IsStale() ? 1 : 0;
+      }
+      return total;
+   }
+
    AlarmSummary total;
    for (const auto &child : node->GetChildren()) {
       const VisibleSubtreeState childState = EvaluateVisibleSubtree(child.get());
@@ -611,7 +722,8 @@ SensorTreeModel::AlarmSummary SensorTreeModel::CountAlarmedDescendants(const Nod
 
       total.warningCount += childState.alarmSummary.warningCount;
       total.failureCount += childState.alarmSummary.failureCount;
+      total.staleCount += childState.alarmSummary.staleCount;
    }
 
    return total;
-}
\ No newline at end of file
+}
@@ -0,0 +1,388 @@
+#include "SensorWireProtocol.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <utility>
+
+namespace {
+
+constexpr std::uint8_t THRESHOLD_LOWER_CRITICAL     = 0x01;
+constexpr std::uint8_t THRESHOLD_LOWER_NON_CRITICAL = 0x02;
+constexpr std::uint8_t THRESHOLD_UPPER_NON_CRITICAL = 0x04;
+constexpr std::uint8_t THRESHOLD_UPPER_CRITICAL     = 0x08;
+
+template <typename T>
+void PutLittleEndian(std::vector<std::uint8_t> &buffer, T value)
+{
+   for (size_t i = 0; i < sizeof(T); ++i)
+      buffer.push_back(static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (8 * i)));
+}
+
+template <typename T>
+void PatchLittleEndian(std::vector<std::uint8_t> &buffer, size_t offset, T value)
+{
+   for (size_t i = 0; i < sizeof(T); ++i)
+      buffer[offset + i] = static_cast<std::uint8_t>(static_cast<std::uint64_t>(value) >> (8 * i));
+}
+
+void PutDouble(std::vector<std::uint8_t> &buffer, double value)
+{
+   std::uint64_t bits = 0;
+   std::memcpy(&bits, &value, sizeof(bits));
+   PutLittleEndian(buffer, bits);
+}
+
+void PutString(std::vector<std::uint8_t> &buffer, const std::string &text)
+{
+   const size_t length = std::min<size_t>(text.size(), std::numeric_limits<std::uint16_t>::max());
+   PutLittleEndian(buffer, static_cast<std::uint16_t>(length));
+   buffer.insert(buffer.end(), text.begin(), text.begin() + static_cast<std::ptrdiff_t>(length));
+}
+
+void PutValue(std::vector<std::uint8_t> &buffer, const DataValue &value)
+{
+   buffer.push_back(static_cast<std::uint8_t>(value.GetType()));
+   switch (value.GetType()) {
+      case DataValue::INTEGER:
+         PutLittleEndian(buffer, static_cast<std::uint64_t>(value.GetInteger()));
+         break;
+      case DataValue::BOOLEAN:
+         buffer.push_back(value.GetBoolean() ? 1 : 0);
+         break;
+      case DataValue::DOUBLE:
+         PutDouble(buffer, value.GetDouble());
+         break;
+      case DataValue::STRING:
+         PutString(buffer, value.GetString());
+         break;
+   }
+}
+
+std::uint32_t ReadU32(const std::uint8_t *data)
+{
+   return static_cast<std::uint32_t>(data[0]) | (static_cast<std::uint32_t>(data[1]) << 8) |
+          (static_cast<std::uint32_t>(data[2]) << 16) | (static_cast<std::uint32_t>(data[3]) << 24);
+}
+
+// Bounds-checked reads over one frame payload. Any short read latches the
+// cursor into a failed state, so callers check once per record.
+class PayloadCursor
+{
+ public:
+   PayloadCursor(const std::uint8_t *data, size_t size) :
+       m_data(data),
+       m_size(size),
+       m_offset(0),
+       m_failed(false)
+   {
+   }
+
+   bool Failed() const { return m_failed; }
+   bool AtEnd() const { return m_offset == m_size; }
+
+   template <typename T>
+   T Read()
+   {
+      if (!Require(sizeof(T)))
+         return T();
+
+      std::uint64_t value = 0;
+      for (size_t i = 0; i < sizeof(T); ++i)
+         value |= static_cast<std::uint64_t>(m_data[m_offset + i]) << (8 * i);
+      m_offset += sizeof(T);
+      return static_cast<T>(value);
+   }
+
+   double ReadDouble()
+   {
+      const std::uint64_t bits = Read<std::uint64_t>();
+      double value             = 0.0;
+      std::memcpy(&value, &bits, sizeof(value));
+      return value;
+   }
+
+   std::string ReadString()
+   {
+      const std::uint16_t length = Read<std::uint16_t>();
+      if (!Require(length))
+         return std::string();
+
+      std::string text(reinterpret_cast<const char *>(m_data + m_offset), length);
+      m_offset += length;
+      return text;
+   }
+
+   bool ReadValue(DataValue &value)
+   {
+      const std::uint8_t type = Read<std::uint8_t>();
+      switch (type) {
+         case DataValue::INTEGER:
+            value = DataValue(static_cast<std::int64_t>(Read<std::uint64_t>()));
+            break;
+         case DataValue::BOOLEAN:
+            value = DataValue(Read<std::uint8_t>() != 0);
+            break;
+         case DataValue::DOUBLE:
+            value = DataValue(ReadDouble());
+            break;
+         case DataValue::STRING:
+            value = DataValue(ReadString());
+            break;
+         default:
+            m_failed = true;
+            break;
+      }
+      return !m_failed;
+   }
+
+ private:
+   bool Require(size_t count)
+   {
+      if (m_failed || m_size - m_offset < count) {
+         m_failed = true;
+         return false;
+      }
+      return true;
+   }
+
+   const std::uint8_t *m_data;
+   size_t m_size;
+   size_t m_offset;
+   bool m_failed;
+};
+
+} // namespace
+
+SensorWireEncoder::SensorWireEncoder() :
+    m_buffer(),
+    m_samplesFrameStart(0),
+    m_sampleCount(0)
+{
+}
+
+void SensorWireEncoder::DefinePath(std::uint32_t id, const std::vector<std::string> &path, const SensorThresholds &thresholds)
+{
+   // Keep frames in order: samples appended earlier may use an older
+   // definition of the same id.
+   Flush();
+
+   const size_t frameStart = BeginFrame(SensorWire::FrameType::DefinePath);
+   PutLittleEndian(m_buffer, id);
+   PutLittleEndian(m_buffer, static_cast<std::uint16_t>(path.size()));
+   for (const std::string &segment : path)
+      PutString(m_buffer, segment);
+
+   std::uint8_t mask = 0;
+   mask |= thresholds.lowerCritical ? THRESHOLD_LOWER_CRITICAL : 0;
+   mask |= thresholds.lowerNonCritical ? THRESHOLD_LOWER_NON_CRITICAL : 0;
+   mask |= thresholds.upperNonCritical ? THRESHOLD_UPPER_NON_CRITICAL : 0;
+   mask |= thresholds.upperCritical ? THRESHOLD_UPPER_CRITICAL : 0;
+   m_buffer.push_back(mask);
+
+   for (const std::optional<DataValue> *threshold : {&thresholds.lowerCritical, &thresholds.lowerNonCritical,
+            &thresholds.upperNonCritical, &thresholds.upperCritical}) {
+      if (threshold->has_value())
+         PutValue(m_buffer, **threshold);
+   }
+
+   EndFrame(frameStart);
+}
+
+void SensorWireEncoder::AppendSample(std::uint32_t id, const DataValue &value, SensorAlarmState alarmState, std::chrono::microseconds age)
+{
+   if (m_sampleCount == 0) {
+      m_samplesFrameStart = BeginFrame(SensorWire::FrameType::Samples);
+      PutLittleEndian(m_buffer, std::uint32_t(0));
+   }
+
+   const auto ageMicros = std::min<std::chrono::microseconds::rep>(
+       std::max<std::chrono::microseconds::rep>(age.count(), 0), std::numeric_limits<std::uint32_t>::max());
+
+   PutLittleEndian(m_buffer, id);
+   PutLittleEndian(m_buffer, static_cast<std::uint32_t>(ageMicros));
+   m_buffer.push_back(static_cast<std::uint8_t>(alarmState));
+   PutValue(m_buffer, value);
+   ++m_sampleCount;
+}
+
+void SensorWireEncoder::Flush()
+{
+   if (m_sampleCount == 0)
+      return;
+
+   PatchLittleEndian(m_buffer, m_samplesFrameStart + SensorWire::FRAME_HEADER_SIZE, m_sampleCount);
+   EndFrame(m_samplesFrameStart);
+   m_sampleCount = 0;
+}
+
+std::vector<std::uint8_t> SensorWireEncoder::TakeBuffer()
+{
+   Flush();
+   std::vector<std::uint8_t> buffer;
+   buffer.swap(m_buffer);
+   return buffer;
+}
+
+void SensorWireEncoder::Clear()
+{
+   m_buffer.clear();
+   m_sampleCount = 0;
+}
+
+size_t SensorWireEncoder::BeginFrame(SensorWire::FrameType type)
+{
+   const size_t frameStart = m_buffer.size();
+   PutLittleEndian(m_buffer, std::uint32_t(0));
+   m_buffer.push_back(static_cast<std::uint8_t>(type));
+   return frameStart;
+}
+
+void SensorWireEncoder::EndFrame(size_t frameStart)
+{
+   // The length counts everything after itself, including the type byte.
+   const size_t payloadSize = m_buffer.size() - frameStart - sizeof(std::uint32_t);
+   PatchLittleEndian(m_buffer, frameStart, static_cast<std::uint32_t>(payloadSize));
+}
+
+SensorWireDecoder::SensorWireDecoder() :
+    m_pending(),
+    m_paths(),
+    m_stats()
+{
+}
+
+bool SensorWireDecoder::Feed(const void *data, size_t size,
+    std::chrono::steady_clock::time_point receivedAt,
+    std::vector<SensorSample> &samples,
+    std::string &errorMessage)
+{
+   const auto *bytes = static_cast<const std::uint8_t *>(data);
+   m_stats.bytes += size;
+
+   // Decode straight out of the caller's buffer when nothing is carried over
+   // from a previous fragment; only a trailing partial frame is copied.
+   const std::uint8_t *cursor = bytes;
+   size_t available           = size;
+   if (!m_pending.empty()) {
+      m_pending.insert(m_pending.end(), bytes, bytes + size);
+      cursor    = m_pending.data();
+      available = m_pending.size();
+   }
+
+   size_t consumed = 0;
+   bool ok         = true;
+   while (available - consumed >= sizeof(std::uint32_t)) {
+      const std::uint32_t length = ReadU32(cursor + consumed);
+      if (length == 0 || length > SensorWire::MAX_FRAME_SIZE) {
+         errorMessage = "Invalid frame length " + std::to_string(length);
+         ok           = false;
+         break;
+      }
+      if (available - consumed - sizeof(std::uint32_t) < length)
+         break;
+
+      if (!DecodeFrame(cursor + consumed + sizeof(std::uint32_t), length, receivedAt, samples, errorMessage)) {
+         ok = false;
+         break;
+      }
+      consumed += sizeof(std::uint32_t) + length;
+      ++m_stats.frames;
+   }
+
+   if (!ok) {
+      m_pending.clear();
+      return false;
+   }
+
+   if (m_pending.empty()) {
+      m_pending.assign(cursor + consumed, cursor + available);
+   } else {
+      m_pending.erase(m_pending.begin(), m_pending.begin() + static_cast<std::ptrdiff_t>(consumed));
+   }
+   return true;
+}
+
+void SensorWireDecoder::Reset()
+{
+   m_pending.clear();
+   m_paths.clear();
+   m_stats = Stats();
+}
+
+bool SensorWireDecoder::DecodeFrame(const std::uint8_t *payload, size_t size,
+    std::chrono::steady_clock::time_point receivedAt,
+    std::vector<SensorSample> &samples,
+    std::string &errorMessage)
+{
+   PayloadCursor reader(payload, size);
+   const auto type = static_cast<SensorWire::FrameType>(reader.Read<std::uint8_t>());
+
+   switch (type) {
+      case SensorWire::FrameType::DefinePath: {
+         const std::uint32_t id           = reader.Read<std::uint32_t>();
+         const std::uint16_t segmentCount = reader.Read<std::uint16_t>();
+
+         PathDefinition definition;
+         definition.path.reserve(segmentCount);
+         for (std::uint16_t i = 0; i < segmentCount && !reader.Failed(); ++i)
+            definition.path.push_back(reader.ReadString());
+
+         const std::uint8_t mask = reader.Read<std::uint8_t>();
+         const std::pair<std::uint8_t, std::optional<DataValue> *> thresholds[] = {
+             {THRESHOLD_LOWER_CRITICAL, &definition.thresholds.lowerCritical},
+             {THRESHOLD_LOWER_NON_CRITICAL, &definition.thresholds.lowerNonCritical},
+             {THRESHOLD_UPPER_NON_CRITICAL, &definition.thresholds.upperNonCritical},
+             {THRESHOLD_UPPER_CRITICAL, &definition.thresholds.upperCritical},
+         };
+         for (const auto &[bit, threshold] : thresholds) {
+            if (!(mask & bit))
+               continue;
+            DataValue value(0.0);
+            if (reader.ReadValue(value))
+               *threshold = std::move(value);
+         }
+
+         if (reader.Failed() || !reader.AtEnd() || definition.path.empty()) {
+            errorMessage = "Malformed path definition";
+            return false;
+         }
+         m_paths[id] = std::move(definition);
+         return true;
+      }
+
+      case SensorWire::FrameType::Samples: {
+         const std::uint32_t count = reader.Read<std::uint32_t>();
+         for (std::uint32_t i = 0; i < count; ++i) {
+            const std::uint32_t id        = reader.Read<std::uint32_t>();
+            const std::uint32_t ageMicros = reader.Read<std::uint32_t>();
+            const std::uint8_t state      = reader.Read<std::uint8_t>();
+            DataValue value(0.0);
+            if (!reader.ReadValue(value) || state > static_cast<std::uint8_t>(SensorAlarmState::Failed)) {
+               errorMessage = "Malformed sample record";
+               return false;
+            }
+
+            const auto definition = m_paths.find(id);
+            if (definition == m_paths.end()) {
+               ++m_stats.unknownPaths;
+               continue;
+            }
+
+            samples.push_back({definition->second.path, std::move(value), definition->second.thresholds,
+                static_cast<SensorAlarmState>(state), receivedAt - std::chrono::microseconds(ageMicros)});
+            ++m_stats.samples;
+         }
+
+         if (!reader.AtEnd()) {
+            errorMessage = "Trailing bytes after sample records";
+            return false;
+         }
+         return true;
+      }
+   }
+
+   errorMessage = "Unknown frame type " + std::to_string(static_cast<unsigned>(type));
+   return false;
+}
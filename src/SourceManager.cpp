@@ -0,0 +1,88 @@
+#include "SourceManager.h"
+
+#include <utility>
+
+SampleSource::SampleSource(std::string name, SampleSourceKind kind, size_t queueCapacity) :
+    wxThread(wxTHREAD_JOINABLE),
+    m_name(std::move(name)),
+    m_kind(kind),
+    m_state(SampleSourceState::Idle),
+    m_queue(queueCapacity)
+{
+}
+
+size_t SampleSource::Publish(std::vector<SensorSample> &&samples, std::chrono::milliseconds maxWait)
+{
+   return m_queue.Push(std::move(samples), maxWait);
+}
+
+SourceManager::SourceManager() :
+    m_sources(),
+    m_drainMutex(),
+    m_queues(),
+    m_merger()
+{
+}
+
+SourceManager::~SourceManager()
+{
+   StopAll();
+}
+
+bool SourceManager::Start(std::unique_ptr<SampleSource> source)
+{
+   if (!source || source->Run() != wxTHREAD_NO_ERROR)
+      return false;
+
+   {
+      std::lock_guard<std::mutex> lock(m_drainMutex);
+      m_queues.push_back(&source->GetQueue());
+   }
+   m_sources.push_back(std::move(source));
+   return true;
+}
+
+void SourceManager::StopAll()
+{
+   // Close every queue first so producers blocked on a full queue notice the
+   // stop request instead of waiting out their timeout one after another.
+   std::vector<SampleSourceQueue *> queues;
+   {
+      std::lock_guard<std::mutex> lock(m_drainMutex);
+      queues.swap(m_queues);
+   }
+   for (SampleSourceQueue *queue : queues)
+      queue->Close();
+
+   for (const std::unique_ptr<SampleSource> &source : m_sources) {
+      if (source->IsRunning() || source->IsPaused())
+         source->Delete();
+      else
+         source->Wait();
+   }
+
+   m_sources.clear();
+}
+
+size_t SourceManager::Drain(size_t budget, std::vector<SensorSample> &out)
+{
+   std::lock_guard<std::mutex> lock(m_drainMutex);
+   return m_merger.Drain(m_queues, budget, out);
+}
+
+void SourceManager::ClearQueues()
+{
+   std::lock_guard<std::mutex> lock(m_drainMutex);
+   for (SampleSourceQueue *queue : m_queues)
+      queue->Clear();
+}
+
+size_t SourceManager::GetConnectedCount() const
+{
+   size_t connected = 0;
+   for (const std::unique_ptr<SampleSource> &source : m_sources) {
+      if (source->GetState() == SampleSourceState::Connected)
+         ++connected;
+   }
+   return connected;
+}
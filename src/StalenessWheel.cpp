@@ -0,0 +1,158 @@
+#include "StalenessWheel.h"
+
+#include <utility>
+
+namespace {
+
+constexpr std::uint64_t SLOT_MASK = StalenessWheel::SLOT_COUNT - 1;
+
+// Ticks spanned by one slot at the given level.
+constexpr std::uint64_t LevelStride(size_t level)
+{
+   return std::uint64_t(1) << (StalenessWheel::SLOT_BITS * level);
+}
+
+} // namespace
+
+StalenessWheel::StalenessWheel() :
+    m_started(false),
+    m_pending(),
+    m_currentTick(0),
+    m_size(0),
+    m_levels(),
+    m_levelSizes(),
+    m_cascade()
+{
+}
+
+void StalenessWheel::Schedule(Node *node, TimePoint deadline)
+{
+   ++m_size;
+   const Entry entry{node, TickOf(deadline, true)};
+   if (!m_started) {
+      m_pending.push_back(entry);
+      return;
+   }
+
+   // The current tick's slot has already been processed.
+   Entry clamped = entry;
+   if (clamped.tick <= m_currentTick)
+      clamped.tick = m_currentTick + 1;
+   Insert(clamped);
+}
+
+void StalenessWheel::Advance(TimePoint now, std::vector<Node *> &expired)
+{
+   const std::uint64_t target = TickOf(now, false);
+
+   if (!m_started) {
+      m_started     = true;
+      m_currentTick = target;
+      for (const Entry &entry : m_pending) {
+         if (entry.tick <= m_currentTick) {
+            --m_size;
+            expired.push_back(entry.node);
+         } else {
+            Insert(entry);
+         }
+      }
+      m_pending.clear();
+      return;
+   }
+
+   while (m_currentTick < target) {
+      if (m_size == 0) {
+         m_currentTick = target;
+         break;
+      }
+
+      // Jump straight to the next tick that fires or cascades anything: with
+      // the lowest occupied level at L, nothing happens before the next
+      // multiple of that level's stride.
+      size_t level = 0;
+      while (level + 1 < LEVEL_COUNT && m_levelSizes[level] == 0)
+         ++level;
+      const std::uint64_t stride = LevelStride(level);
+      const std::uint64_t next   = (m_currentTick / stride + 1) * stride;
+      if (next > target) {
+         m_currentTick = target;
+         break;
+      }
+
+      m_currentTick = next;
+      ProcessTick(expired);
+   }
+}
+
+void StalenessWheel::Clear()
+{
+   m_started     = false;
+   m_currentTick = 0;
+   m_size        = 0;
+   m_pending.clear();
+   for (Level &level : m_levels) {
+      for (std::vector<Entry> &slot : level)
+         slot.clear();
+   }
+   m_levelSizes.fill(0);
+}
+
+std::uint64_t StalenessWheel::TickOf(TimePoint time, bool roundUp)
+{
+   const Duration sinceEpoch = time.time_since_epoch();
+   if (sinceEpoch <= Duration::zero())
+      return 0;
+
+   const Duration tick        = std::chrono::duration_cast<Duration>(TICK);
+   const std::uint64_t ticks  = static_cast<std::uint64_t>(sinceEpoch / tick);
+   const bool hasRemainder    = sinceEpoch % tick != Duration::zero();
+   return roundUp && hasRemainder ? ticks + 1 : ticks;
+}
+
+void StalenessWheel::Insert(const Entry &entry)
+{
+   std::uint64_t tick  = entry.tick < m_currentTick ? m_currentTick : entry.tick;
+   std::uint64_t delta = tick - m_currentTick;
+
+   // Deadlines beyond the top level's reach are parked in its furthest slot
+   // and placed again when that slot cascades.
+   const std::uint64_t span = LevelStride(LEVEL_COUNT);
+   if (delta >= span) {
+      tick  = m_currentTick + span - 1;
+      delta = span - 1;
+   }
+
+   size_t level = 0;
+   while (level + 1 < LEVEL_COUNT && delta >= LevelStride(level + 1))
+      ++level;
+
+   m_levels[level][(tick >> (SLOT_BITS * level)) & SLOT_MASK].push_back(entry);
+   ++m_levelSizes[level];
+}
+
+void StalenessWheel::ProcessTick(std::vector<Node *> &expired)
+{
+   const std::uint64_t tick = m_currentTick;
+
+   // Cascade from the highest level whose rotation boundary this is, so
+   // entries moved down land in slots that are visited later in this pass.
+   size_t top = 0;
+   while (top + 1 < LEVEL_COUNT && tick % LevelStride(top + 1) == 0)
+      ++top;
+
+   for (size_t level = top; level >= 1; --level) {
+      std::vector<Entry> &slot = m_levels[level][(tick >> (SLOT_BITS * level)) & SLOT_MASK];
+      m_cascade.swap(slot);
+      m_levelSizes[level] -= m_cascade.size();
+      for (const Entry &entry : m_cascade)
+         Insert(entry);
+      m_cascade.clear();
+   }
+
+   std::vector<Entry> &due = m_levels[0][tick & SLOT_MASK];
+   m_levelSizes[0] -= due.size();
+   m_size -= due.size();
+   for (const Entry &entry : due)
+      expired.push_back(entry.node);
+   due.clear();
+}
@@ -0,0 +1,488 @@
+#include "SyntheticLoad.h"
+
+#include "AlarmEvaluator.h"
+#include "SensorDataStore.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+
+// Longest a throttled worker sleeps before looking for Stop().
+constexpr std::chrono::milliseconds MAX_PACING_SLEEP{50};
+// Throttled workers send at least this many batches a second, so a low rate
+// still trickles rather than arriving in one lump.
+constexpr double MIN_BATCHES_PER_SECOND = 100.0;
+// Alarm values sit mid-way inside each band below or above the thresholds at
+// 5, 10, 90 and 95 percent of the range, never on a threshold itself.
+constexpr double ALARM_BAND_CENTRES[] = {2.5, 7.5, 92.5, 97.5};
+constexpr double ALARM_BAND_SPREAD    = 4.0;
+constexpr double NORMAL_LOW           = 15.0;
+constexpr double NORMAL_SPAN          = 70.0;
+constexpr double INTEGER_SCALE        = 10.0;
+// AlarmStorm: the last STORM_ROUNDS of every STORM_CYCLE_ROUNDS rounds of a
+// worker's sensors are storms.
+constexpr std::uint64_t STORM_CYCLE_ROUNDS = 10;
+constexpr std::uint64_t STORM_ROUNDS       = 2;
+constexpr double STORM_ALARM_RATE          = 0.8;
+// TreeGrowth: sensors join in GROWTH_STEPS bursts, each after
+// GROWTH_ROUNDS rounds of the sensors already reporting.
+constexpr size_t GROWTH_STEPS         = 16;
+constexpr std::uint64_t GROWTH_ROUNDS = 4;
+constexpr size_t CATEGORY_LABELS      = 64;
+
+using json = nlohmann::json;
+
+const std::vector<std::string> &GetCategoryLabels()
+{
+   static const std::vector<std::string> labels = [] {
+      std::vector<std::string> names;
+      for (size_t index = 0; index < CATEGORY_LABELS; ++index)
+         names.push_back("Mode" + std::to_string(index + 1));
+      return names;
+   }();
+   return labels;
+}
+
+bool ReadNumber(const json &settings, const char *key, double minimum, double &value, std::string &errorMessage)
+{
+   const auto it = settings.find(key);
+   if (it == settings.end())
+      return true;
+   if (!it->is_number() || it->get<double>() < minimum) {
+      errorMessage = std::string("'") + key + "' must be a number of at least " + std::to_string(minimum);
+      return false;
+   }
+
+   value = it->get<double>();
+   return true;
+}
+
+template <typename Count>
+bool ReadCount(const json &settings, const char *key, Count minimum, Count &value, std::string &errorMessage)
+{
+   const auto it = settings.find(key);
+   if (it == settings.end())
+      return true;
+   if (!it->is_number_unsigned() || it->get<std::uint64_t>() < minimum) {
+      errorMessage = std::string("'") + key + "' must be an integer of at least " + std::to_string(minimum);
+      return false;
+   }
+
+   value = static_cast<Count>(it->get<std::uint64_t>());
+   return true;
+}
+
+bool ParseWorkload(const json &settings, SyntheticLoadConfig &config, std::string &errorMessage)
+{
+   static const char *const keys[] = {"profile", "seed", "sensors", "depth", "fan_out", "double_share", "integer_share",
+       "string_share", "boolean_share", "samples_per_second", "burst_factor", "burst_period_ms", "alarm_rate",
+       "zipf_exponent", "threads", "batch_size"};
+
+   if (!settings.is_object()) {
+      errorMessage = "settings must be a JSON object";
+      return false;
+   }
+   // A misspelt setting would silently fall back to its default and skew
+   // every comparison made with the workload.
+   for (const auto &item : settings.items()) {
+      if (std::none_of(std::begin(keys), std::end(keys), [&item](const char *key) { return item.key() == key; })) {
+         errorMessage = "unknown setting '" + item.key() + "'";
+         return false;
+      }
+   }
+
+   WorkloadProfile profile = WorkloadProfile::Uniform;
+   const auto profileIt    = settings.find("profile");
+   if (profileIt != settings.end() && (!profileIt->is_string() || !TryParseWorkloadProfile(profileIt->get<std::string>(), profile))) {
+      errorMessage = "'profile' must be one of uniform, hot-sensors, alarm-storm, tree-growth or categorical";
+      return false;
+   }
+   config = MakeWorkloadConfig(profile);
+
+   std::uint64_t burstPeriod = static_cast<std::uint64_t>(config.burstPeriod.count());
+   const bool parsed         = ReadCount<std::uint64_t>(settings, "seed", 0, config.seed, errorMessage) &&
+                       ReadCount<size_t>(settings, "sensors", 1, config.sensorCount, errorMessage) &&
+                       ReadCount<size_t>(settings, "depth", 0, config.depth, errorMessage) &&
+                       ReadCount<size_t>(settings, "fan_out", 1, config.fanOut, errorMessage) &&
+                       ReadNumber(settings, "double_share", 0.0, config.doubleShare, errorMessage) &&
+                       ReadNumber(settings, "integer_share", 0.0, config.integerShare, errorMessage) &&
+                       ReadNumber(settings, "string_share", 0.0, config.stringShare, errorMessage) &&
+                       ReadNumber(settings, "boolean_share", 0.0, config.booleanShare, errorMessage) &&
+                       ReadNumber(settings, "samples_per_second", 0.0, config.samplesPerSecond, errorMessage) &&
+                       ReadNumber(settings, "burst_factor", 1.0, config.burstFactor, errorMessage) &&
+                       ReadCount<std::uint64_t>(settings, "burst_period_ms", 1, burstPeriod, errorMessage) &&
+                       ReadNumber(settings, "alarm_rate", 0.0, config.alarmRate, errorMessage) &&
+                       ReadNumber(settings, "zipf_exponent", 0.0, config.zipfExponent, errorMessage) &&
+                       ReadCount<size_t>(settings, "threads", 1, config.threadCount, errorMessage) &&
+                       ReadCount<size_t>(settings, "batch_size", 1, config.batchSize, errorMessage);
+   config.burstPeriod = std::chrono::milliseconds(burstPeriod);
+   return parsed;
+}
+
+const char *GetTypeSuffix(DataValue::e_Type type)
+{
+   switch (type) {
+      case DataValue::DOUBLE:
+         return "Double";
+      case DataValue::INTEGER:
+         return "Int";
+      case DataValue::STRING:
+         return "String";
+      case DataValue::BOOLEAN:
+         return "Bool";
+   }
+
+   return "Double";
+}
+
+SensorThresholds MakeThresholds(DataValue::e_Type type)
+{
+   SensorThresholds thresholds;
+   if (type == DataValue::DOUBLE) {
+      thresholds.lowerCritical    = DataValue(5.0);
+      thresholds.lowerNonCritical = DataValue(10.0);
+      thresholds.upperNonCritical = DataValue(90.0);
+      thresholds.upperCritical    = DataValue(95.0);
+   } else if (type == DataValue::INTEGER) {
+      thresholds.lowerCritical    = DataValue(std::int64_t{50});
+      thresholds.lowerNonCritical = DataValue(std::int64_t{100});
+      thresholds.upperNonCritical = DataValue(std::int64_t{900});
+      thresholds.upperCritical    = DataValue(std::int64_t{950});
+   }
+   return thresholds;
+}
+
+std::vector<SyntheticLoadGenerator::SensorDefinition> BuildSensors(const SyntheticLoadConfig &config)
+{
+   const DataValue::e_Type types[] = {DataValue::DOUBLE, DataValue::INTEGER, DataValue::STRING, DataValue::BOOLEAN};
+   const double shares[]           = {std::max(0.0, config.doubleShare), std::max(0.0, config.integerShare),
+                 std::max(0.0, config.stringShare), std::max(0.0, config.booleanShare)};
+   const bool hasShares            = std::any_of(std::begin(shares), std::end(shares), [](double share) { return share > 0.0; });
+
+   // Leaf groups in use; beyond one per sensor the extra ones would stay empty.
+   const size_t fanOut = std::max<size_t>(1, config.fanOut);
+   size_t groupCount   = 1;
+   for (size_t level = 0; level < config.depth && groupCount < config.sensorCount; ++level)
+      groupCount *= fanOut;
+
+   std::vector<SyntheticLoadGenerator::SensorDefinition> sensors;
+   sensors.reserve(config.sensorCount);
+   // Smooth weighted round-robin, so each type is spread across the tree in
+   // proportion to its share.
+   double credit[std::size(types)] = {};
+   for (size_t index = 0; index < config.sensorCount; ++index) {
+      size_t chosen = 0;
+      for (size_t type = 0; type < std::size(types); ++type) {
+         credit[type] += hasShares ? shares[type] : 1.0;
+         if (credit[type] > credit[chosen])
+            chosen = type;
+      }
+      credit[chosen] -= hasShares ? shares[0] + shares[1] + shares[2] + shares[3] : std::size(types);
+
+      SyntheticLoadGenerator::SensorDefinition sensor;
+      sensor.type       = types[chosen];
+      sensor.thresholds = MakeThresholds(sensor.type);
+
+      // Least significant level first; every sensor gets all `depth` levels.
+      std::vector<std::string> groups;
+      size_t group = index % groupCount;
+      for (size_t level = 0; level < config.depth; ++level) {
+         groups.push_back(std::to_string(group % fanOut + 1));
+         group /= fanOut;
+      }
+      for (auto it = groups.rbegin(); it != groups.rend(); ++it)
+         sensor.path.push_back((sensor.path.empty() ? "Category" : "Group") + *it);
+      sensor.path.push_back("Sensor" + std::to_string(index + 1) + "_" + GetTypeSuffix(sensor.type));
+      sensors.push_back(std::move(sensor));
+   }
+   return sensors;
+}
+
+} // namespace
+
+SyntheticLoadConfig MakeWorkloadConfig(WorkloadProfile profile)
+{
+   SyntheticLoadConfig config;
+   config.profile = profile;
+   if (profile == WorkloadProfile::AlarmStorm) {
+      config.alarmRate = 0.01;
+   } else if (profile == WorkloadProfile::Categorical) {
+      config.doubleShare  = 1.0;
+      config.integerShare = 0.0;
+      config.stringShare  = 8.0;
+      config.booleanShare = 1.0;
+   }
+   return config;
+}
+
+bool LoadSyntheticWorkloads(const std::string &filePath, std::vector<SyntheticWorkload> &workloads, std::string &errorMessage)
+{
+   workloads.clear();
+   errorMessage.clear();
+
+   std::ifstream input(filePath);
+   if (!input.is_open()) {
+      errorMessage = "Unable to open workload file.";
+      return false;
+   }
+
+   json document;
+   try {
+      input >> document;
+   } catch (const json::parse_error &error) {
+      errorMessage = std::string("Invalid JSON: ") + error.what();
+      return false;
+   }
+
+   if (!document.is_object() || document.empty()) {
+      errorMessage = "Workload file must be a JSON object of named workloads.";
+      return false;
+   }
+
+   for (const auto &item : document.items()) {
+      SyntheticWorkload workload{item.key(), {}};
+      if (!ParseWorkload(item.value(), workload.config, errorMessage)) {
+         errorMessage = "Workload '" + item.key() + "': " + errorMessage;
+         workloads.clear();
+         return false;
+      }
+      workloads.push_back(std::move(workload));
+   }
+   return true;
+}
+
+SyntheticLoadGenerator::Stream::Stream(const SyntheticLoadGenerator &generator, const std::vector<std::uint32_t> &sensorIds,
+    size_t worker, std::uint64_t seed) :
+    m_generator(generator),
+    m_sensorIds(sensorIds),
+    m_sensors(),
+    m_hotWeights(),
+    m_cursor(0),
+    m_activeCount(0),
+    m_nextGrowth(0),
+    m_filled(0),
+    m_state(0)
+{
+   for (size_t index = worker; index < generator.m_sensors.size(); index += generator.m_threadCount)
+      m_sensors.push_back(index);
+
+   m_activeCount = m_sensors.size();
+   if (generator.m_config.profile == WorkloadProfile::TreeGrowth)
+      m_activeCount = std::min(m_sensors.size(), std::max<size_t>(1, m_sensors.size() / GROWTH_STEPS));
+   m_nextGrowth = GROWTH_ROUNDS * m_activeCount;
+
+   if (generator.m_config.profile == WorkloadProfile::HotSensors) {
+      double total = 0.0;
+      for (size_t rank = 0; rank < m_sensors.size(); ++rank) {
+         total += 1.0 / std::pow(static_cast<double>(rank + 1), generator.m_config.zipfExponent);
+         m_hotWeights.push_back(total);
+      }
+      for (double &weight : m_hotWeights)
+         weight /= total;
+   }
+
+   // SplitMix64 of the seed and worker, so neighbouring seeds and workers
+   // start from unrelated states; xorshift needs a non-zero one.
+   std::uint64_t mixed = seed + (worker + 1) * 0x9E3779B97F4A7C15ull;
+   mixed               = (mixed ^ (mixed >> 30)) * 0xBF58476D1CE4E5B9ull;
+   mixed               = (mixed ^ (mixed >> 27)) * 0x94D049BB133111EBull;
+   m_state             = (mixed ^ (mixed >> 31)) | 1;
+}
+
+void SyntheticLoadGenerator::Stream::Fill(PackedSampleBatch &batch, size_t count, std::chrono::steady_clock::time_point timestamp)
+{
+   if (m_sensors.empty())
+      return;
+
+   const SyntheticLoadConfig &config = m_generator.m_config;
+   for (size_t n = 0; n < count; ++n) {
+      const size_t index             = m_sensors[NextSlot()];
+      const SensorDefinition &sensor = m_generator.m_sensors[index];
+      const std::uint32_t id         = m_sensorIds[index];
+
+      const bool alarm = NextUnit() < (IsInStorm() ? STORM_ALARM_RATE : config.alarmRate);
+      ++m_filled;
+      double numeric = NORMAL_LOW + NORMAL_SPAN * NextUnit();
+      if (alarm) {
+         const double band = ALARM_BAND_CENTRES[NextRandom() % std::size(ALARM_BAND_CENTRES)];
+         numeric           = band + ALARM_BAND_SPREAD * (NextUnit() - 0.5);
+      }
+
+      switch (sensor.type) {
+         case DataValue::DOUBLE:
+            batch.AppendDouble(id, timestamp, numeric, ClassifyNumericAlarm(numeric, sensor.thresholds));
+            break;
+         case DataValue::INTEGER: {
+            const std::int64_t value = std::llround(numeric * INTEGER_SCALE);
+            batch.AppendInteger(id, timestamp, value, ClassifyNumericAlarm(static_cast<double>(value), sensor.thresholds));
+            break;
+         }
+         case DataValue::STRING: {
+            static const char *const normal[] = {"OK", "Warning"};
+            static const char *const failed[] = {"Error", "Unknown"};
+            const SensorAlarmState state      = alarm ? SensorAlarmState::Failed : SensorAlarmState::Ok;
+            if (config.profile == WorkloadProfile::Categorical && !alarm)
+               batch.AppendString(id, timestamp, GetCategoryLabels()[NextRandom() % CATEGORY_LABELS], state);
+            else
+               batch.AppendString(id, timestamp, (alarm ? failed : normal)[NextRandom() & 1], state);
+            break;
+         }
+         case DataValue::BOOLEAN:
+            batch.AppendBoolean(id, timestamp, !alarm, alarm ? SensorAlarmState::Failed : SensorAlarmState::Ok);
+            break;
+      }
+   }
+}
+
+size_t SyntheticLoadGenerator::Stream::NextSlot()
+{
+   if (!m_hotWeights.empty()) {
+      const auto it = std::lower_bound(m_hotWeights.begin(), m_hotWeights.end(), NextUnit());
+      return std::min(static_cast<size_t>(it - m_hotWeights.begin()), m_hotWeights.size() - 1);
+   }
+
+   if (m_filled >= m_nextGrowth && m_activeCount < m_sensors.size()) {
+      m_activeCount = std::min(m_sensors.size(), m_activeCount + std::max<size_t>(1, m_sensors.size() / GROWTH_STEPS));
+      m_nextGrowth  = m_filled + GROWTH_ROUNDS * m_activeCount;
+   }
+
+   const size_t slot = m_cursor;
+   if (++m_cursor >= m_activeCount)
+      m_cursor = 0;
+   return slot;
+}
+
+bool SyntheticLoadGenerator::Stream::IsInStorm() const
+{
+   if (m_generator.m_config.profile != WorkloadProfile::AlarmStorm)
+      return false;
+
+   const std::uint64_t round = m_filled / m_sensors.size();
+   return round % STORM_CYCLE_ROUNDS >= STORM_CYCLE_ROUNDS - STORM_ROUNDS;
+}
+
+std::uint64_t SyntheticLoadGenerator::Stream::NextRandom()
+{
+   // xorshift64*: a few cycles per draw, far below the cost of the sample.
+   m_state ^= m_state >> 12;
+   m_state ^= m_state << 25;
+   m_state ^= m_state >> 27;
+   return m_state * 0x2545F4914F6CDD1Dull;
+}
+
+double SyntheticLoadGenerator::Stream::NextUnit()
+{
+   return static_cast<double>(NextRandom() >> 11) * 0x1.0p-53;
+}
+
+SyntheticLoadGenerator::SyntheticLoadGenerator(const SyntheticLoadConfig &config) :
+    m_config(config),
+    m_sensors(BuildSensors(config)),
+    m_threadCount(std::max<size_t>(1, std::min(config.threadCount, config.sensorCount))),
+    m_sensorIds(),
+    m_sensorsById(),
+    m_batchObserver(),
+    m_threads(),
+    m_stopRequested(false),
+    m_generatedCount(0)
+{
+}
+
+SyntheticLoadGenerator::~SyntheticLoadGenerator()
+{
+   Stop();
+}
+
+void SyntheticLoadGenerator::Start(SensorDataStore &store)
+{
+   Stop();
+   if (m_sensors.empty())
+      return;
+
+   m_sensorIds.clear();
+   m_sensorsById.clear();
+   m_sensorIds.reserve(m_sensors.size());
+   for (size_t index = 0; index < m_sensors.size(); ++index) {
+      m_sensorIds.push_back(store.RegisterSensor(m_sensors[index].path, m_sensors[index].thresholds));
+      m_sensorsById.emplace(m_sensorIds.back(), index);
+   }
+
+   m_stopRequested = false;
+   for (size_t worker = 0; worker < m_threadCount; ++worker)
+      m_threads.emplace_back(&SyntheticLoadGenerator::Run, this, worker, std::ref(store), m_config.seed);
+}
+
+void SyntheticLoadGenerator::Stop()
+{
+   m_stopRequested = true;
+   for (std::thread &thread : m_threads)
+      thread.join();
+   m_threads.clear();
+}
+
+const SyntheticLoadGenerator::SensorDefinition *SyntheticLoadGenerator::FindSensor(std::uint32_t sensorId) const
+{
+   const auto it = m_sensorsById.find(sensorId);
+   return it == m_sensorsById.end() ? nullptr : &m_sensors[it->second];
+}
+
+std::chrono::duration<double> SyntheticLoadGenerator::GetDueOffset(std::uint64_t sampleIndex) const
+{
+   const double rate = m_config.samplesPerSecond / static_cast<double>(m_threadCount);
+   if (rate <= 0.0)
+      return std::chrono::duration<double>(0.0);
+
+   const double burstFactor = std::max(1.0, m_config.burstFactor);
+   const double period      = std::chrono::duration<double>(m_config.burstPeriod).count();
+   const double index       = static_cast<double>(sampleIndex);
+   if (burstFactor == 1.0 || period <= 0.0)
+      return std::chrono::duration<double>(index / rate);
+
+   const double perPeriod = rate * period;
+   const double periods   = std::floor(index / perPeriod);
+   return std::chrono::duration<double>(periods * period + (index - periods * perPeriod) / (rate * burstFactor));
+}
+
+void SyntheticLoadGenerator::Run(size_t worker, SensorDataStore &store, std::uint64_t seed)
+{
+   Stream stream(*this, m_sensorIds, worker, seed);
+   PackedSampleBatch batch;
+
+   const double rate = m_config.samplesPerSecond / static_cast<double>(m_threadCount);
+   size_t batchSize  = std::max<size_t>(1, m_config.batchSize);
+   if (rate > 0.0)
+      batchSize = std::max<size_t>(1, std::min(batchSize, static_cast<size_t>(rate / MIN_BATCHES_PER_SECOND)));
+   const auto maxLag  = std::max<std::chrono::steady_clock::duration>(m_config.burstPeriod, MAX_PACING_SLEEP);
+   auto start         = std::chrono::steady_clock::now();
+   std::uint64_t sent = 0;
+
+   while (!m_stopRequested.load(std::memory_order_relaxed)) {
+      auto now = std::chrono::steady_clock::now();
+      if (rate > 0.0) {
+         const auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(GetDueOffset(sent));
+         if (due > now) {
+            std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(due - now, MAX_PACING_SLEEP));
+            continue;
+         }
+         // A worker that fell far behind (a stalled store, a suspended
+         // process) resumes the schedule from now instead of catching up in
+         // one burst.
+         if (now - due > maxLag) {
+            start = now;
+            sent  = 0;
+         }
+      }
+
+      batch.Clear();
+      stream.Fill(batch, batchSize, now);
+      store.AddPackedSamples(batch.GetRecords(), batch.Size(), batch.GetText());
+      if (m_batchObserver)
+         m_batchObserver(*this, batch);
+      sent += batchSize;
+      m_generatedCount.fetch_add(batchSize, std::memory_order_relaxed);
+   }
+}
@@ -1,18 +1,41 @@
+#include "AlarmEvaluator.h"
+#include "AlarmJournal.h"
+#include "DerivedSensors.h"
+#include "Node.h"
+#include "PackedSampleBatch.h"
 #include "PathUtils.h"
+#include "PlotCategoryDictionary.h"
+#include "PlotDataService.h"
+#include "PlotDecimator.h"
+#include "PlotRenderer.h"
+#include "SampleHistory.h"
+#include "SampleSourceQueue.h"
 #include "SensorData.h"
 #include "SensorDataJsonReader.h"
 #include "SensorDataJsonWriter.h"
+#include "SensorDataStore.h"
 #include "SensorTreeModel.h"
+#include "SensorWireProtocol.h"
+#include "StalenessWheel.h"
+#include "SyntheticLoad.h"
 
 #include <nlohmann/json.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <chrono>
+#include <cmath>
+#include <deque>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <limits>
+#include <set>
 #include <stdexcept>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -92,6 +115,271 @@ void TestUnsignedRangeCheck()
    Expect(didThrow, "Out-of-range unsigned values should throw");
 }
 
+void TestSampleHistoryWindowExtents()
+{
+   SampleHistory history(256);
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(50));
+   for (int index = 0; index < 600; ++index) {
+      const double value     = (index % 7 == 0) ? std::nan("") : static_cast<double>((index * 37) % 101);
+      const DataValue stored = (index % 7 == 0) ? DataValue("gap") : DataValue(value);
+      history.Append({baseTime + std::chrono::milliseconds(index * 10), stored, SensorAlarmState::Ok}, value);
+   }
+
+   const SampleHistory::View view = history.Snapshot();
+
+   Expect(view.size() == 256, "History should evict samples beyond the history limit");
+   Expect(view.GetTimestamp(0) == baseTime + std::chrono::milliseconds(344 * 10), "Eviction should drop the oldest samples first");
+
+   const auto window = view.FindWindow(baseTime + std::chrono::milliseconds(4000), baseTime + std::chrono::milliseconds(5000));
+   Expect(view.GetTimestamp(window.first) == baseTime + std::chrono::milliseconds(4000), "Window start should be located by binary search");
+   Expect(window.second - window.first == 101, "Window bounds should be inclusive of both edges");
+
+   NumericExtents expected;
+   for (size_t index = window.first; index < window.second; ++index)
+      expected.Include(view.GetNumeric(index));
+
+   const NumericExtents actual = view.ComputeExtents(window.first, window.second);
+   Expect(actual.IsValid(), "Window extents should contain numeric samples");
+   Expect(actual.min == expected.min && actual.max == expected.max, "Block-cached extents should match a scalar scan");
+   Expect(!SampleHistory::ScanExtents(nullptr, 0).IsValid(), "Empty scans should produce an invalid range");
+}
+
+void TestHistoryViewsStayConsistentUnderWriter()
+{
+   constexpr int SAMPLE_COUNT = 200000;
+   SampleHistory history(100);
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(10));
+   std::atomic<bool> done{false};
+
+   // A small limit keeps the writer copying the history forward while the
+   // reader checks that every view it takes is internally consistent.
+   std::thread writer([&] {
+      for (int index = 0; index < SAMPLE_COUNT; ++index) {
+         const double value = static_cast<double>(index);
+         history.Append({baseTime + std::chrono::milliseconds(index), DataValue(value), SensorAlarmState::Ok}, value);
+      }
+      done = true;
+   });
+
+   bool consistent       = true;
+   std::uint64_t lastEnd = 0;
+   while (consistent && !done) {
+      const SampleHistory::View view = history.Snapshot();
+      consistent                     = view.GetEndSequence() >= lastEnd;
+      lastEnd                        = view.GetEndSequence();
+      if (view.empty())
+         continue;
+
+      const double first = static_cast<double>(view.GetFirstSequence());
+      for (size_t index = 0; index < view.size() && consistent; ++index) {
+         const double expected = first + static_cast<double>(index);
+         consistent            = view[index].value.GetNumeric() == expected && view.GetNumeric(index) == expected &&
+                      view.GetTimestamp(index) == baseTime + std::chrono::milliseconds(static_cast<long long>(expected));
+      }
+      const NumericExtents extents = view.ComputeExtents(0, view.size());
+      consistent                   = consistent && extents.min == first && extents.max == first + static_cast<double>(view.size() - 1);
+   }
+   writer.join();
+
+   Expect(consistent, "Views should never see a sample change or go missing while the writer appends");
+   const SampleHistory::View view = history.Snapshot();
+   Expect(view.size() == 100 && view.GetEndSequence() == SAMPLE_COUNT && view.back().value.GetNumeric() == SAMPLE_COUNT - 1,
+       "The final view should hold the newest samples up to the limit");
+}
+
+void TestM4DecimationKeepsColumnExtremes()
+{
+   std::vector<PlotPoint> points;
+   for (int index = 0; index < 1000; ++index) {
+      const double x = 10.0 + static_cast<double>(index) / 100.0;
+      const double y = (index == 137) ? -50.0 : (index == 642) ? 75.0 : static_cast<double>(index % 13);
+      points.push_back({x, y});
+   }
+
+   std::vector<PlotPoint> decimated;
+   DecimateM4(points, decimated);
+
+   Expect(decimated.size() <= 10 * 4, "M4 should keep at most four points per pixel column");
+   Expect(decimated.front().x == points.front().x && decimated.back().x == points.back().x, "M4 should keep the first and last points");
+
+   bool keptMinimum = false;
+   bool keptMaximum = false;
+   for (size_t index = 0; index < decimated.size(); ++index) {
+      keptMinimum |= decimated[index].y == -50.0;
+      keptMaximum |= decimated[index].y == 75.0;
+      if (index > 0)
+         Expect(decimated[index - 1].x <= decimated[index].x, "M4 should preserve point order");
+   }
+   Expect(keptMinimum && keptMaximum, "M4 should keep per-column extremes");
+}
+
+void TestCategoryDictionaryKeepsStableLanes()
+{
+   Node node("mode");
+   node.SetHistoryLimit(4);
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(80));
+   const char *states[] = {"idle", "run", "idle", "fault"};
+   for (int index = 0; index < 4; ++index)
+      node.SetValue(DataValue(states[index]), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(index));
+
+   PlotCategoryDictionary categories;
+   const std::deque<double> &lanes = categories.GetNodeLanes(node, node.GetHistory());
+   Expect(lanes.size() == 4, "Lane column should mirror the node history");
+   Expect(lanes[0] == 0.0 && lanes[1] == 1.0 && lanes[2] == 0.0 && lanes[3] == 2.0, "Lanes should be assigned by first appearance");
+   Expect(categories.GetLabel(2) == "fault", "Lane labels should be kept for each category");
+
+   node.SetValue(DataValue(true), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(4));
+   node.SetValue(DataValue(12.5), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(5));
+   const std::deque<double> &updated = categories.GetNodeLanes(node, node.GetHistory());
+   Expect(updated.size() == 4, "Lane column should follow history eviction");
+   Expect(updated[0] == 0.0 && updated[1] == 2.0, "Existing lanes should not move as new categories appear");
+   Expect(updated[2] == 4.0 && categories.GetLabel(3) == "false", "Booleans should reserve false below true");
+   Expect(std::isnan(updated[3]), "Numeric samples should not occupy a lane");
+   Expect(categories.GetLaneCount() == 5, "Dictionary should grow only with new categories");
+}
+
+void TestPlotDataServiceSharesSnapshots()
+{
+   SensorTreeModel model;
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(500));
+   for (int index = 0; index < 2000; ++index)
+      model.AddDataSample({"bus", "current"}, DataValue(static_cast<double>((index * 17) % 29)), {}, SensorAlarmState::Ok, baseTime + std::chrono::milliseconds(index));
+
+   const Node *node = model.FindNodeByPath({"bus", "current"});
+   PlotDataService::SnapshotKey key;
+   key.node       = node;
+   key.hasWindow  = true;
+   key.viewStart  = baseTime + std::chrono::milliseconds(500);
+   key.viewEnd    = baseTime + std::chrono::milliseconds(1499);
+   key.pixelWidth = 50;
+
+   PlotDataService service;
+   const auto first  = service.Acquire(key, model.GetStructureVersion(), node->GetHistory());
+   const auto second = service.Acquire(key, model.GetStructureVersion(), node->GetHistory());
+   Expect(first == second, "Identical requests should share one snapshot");
+   Expect(first->samples.size() <= 50 * 4 + 2, "Snapshots should be decimated to the pixel width");
+   Expect(first->numericExtents.min == 0.0 && first->numericExtents.max == 28.0, "Snapshot extents should cover the whole window");
+
+   key.pixelWidth = 80;
+   Expect(service.Acquire(key, model.GetStructureVersion(), node->GetHistory()) != first, "A different pixel width should build its own snapshot");
+   Expect(service.GetCachedCount() == 2, "Each distinct key should be cached once");
+
+   key.pixelWidth = 50;
+   model.AddDataSample({"bus", "current"}, DataValue(99.0), {}, SensorAlarmState::Ok, baseTime + std::chrono::milliseconds(2000));
+   Expect(service.Acquire(key, model.GetStructureVersion(), node->GetHistory()) != first, "New samples should invalidate cached snapshots");
+}
+
+void TestDenseEnvelopeSummarisesSeries()
+{
+   PlotRenderer::FrameLayout layout;
+   layout.plotRect  = wxRect(0, 0, 10, 10);
+   layout.plotStart = std::chrono::steady_clock::time_point(std::chrono::seconds(700));
+   layout.timeRange = 10.0;
+
+   // Forty series sampled twice per column; the last one sits far above the rest.
+   layout.prepared.resize(40);
+   for (size_t series = 0; series < layout.prepared.size(); ++series) {
+      const double value = series == 39 ? 1000.0 : static_cast<double>(series);
+      for (int sample = 0; sample < 20; ++sample)
+         layout.prepared[series].push_back({layout.plotStart + std::chrono::milliseconds(250 + sample * 500), value});
+   }
+   // A sparse series holds its value across the columns between its samples.
+   layout.prepared.push_back({{layout.plotStart + std::chrono::milliseconds(100), 5.0},
+       {layout.plotStart + std::chrono::milliseconds(9900), 5.0}});
+
+   PlotRenderer::BuildEnvelope(layout);
+
+   Expect(layout.envelope.size() == 10, "Envelope should have one entry per pixel column");
+   bool allColumnsMatch = true;
+   for (const PlotRenderer::EnvelopeColumn &column : layout.envelope) {
+      allColumnsMatch = allColumnsMatch && column.valid && column.min == 0.0 && column.max == 1000.0;
+      allColumnsMatch = allColumnsMatch && column.p25 <= column.median && column.median <= column.p75 && column.median < 25.0;
+   }
+   Expect(allColumnsMatch, "Every column should span all series with ordered percentiles");
+   Expect(layout.outliers.size() == 20, "Only the outlying series should be flagged, once per sample");
+}
+
+void TestSensorStatisticsTrackRunningValues()
+{
+   Node node("Pressure");
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(500));
+   const double values[] = {2.0, 4.0, 4.0, 4.0, 5.0, 5.0, 7.0, 9.0};
+   for (size_t index = 0; index < 8; ++index) {
+      const SensorAlarmState state = index >= 6 ? SensorAlarmState::Warn : SensorAlarmState::Ok;
+      node.SetValue(DataValue(values[index]), {}, state, baseTime + std::chrono::seconds(index * 10));
+   }
+
+   const SensorStatistics &statistics = node.GetStatistics();
+   Expect(statistics.GetNumericCount() == 8, "Every numeric sample should be counted");
+   Expect(std::abs(statistics.GetMean() - 5.0) < 1e-12, "Running mean should match the batch mean");
+   Expect(std::abs(statistics.GetVariance() - 32.0 / 7.0) < 1e-12, "Running variance should be the sample variance");
+   Expect(std::abs(statistics.GetUpdateRate() - 0.1) < 1e-9, "Regular 10s updates should report 0.1 Hz");
+
+   // Only samples from the last 60s (t=10..70) remain in the extremes window.
+   const auto newest = baseTime + std::chrono::seconds(70);
+   Expect(statistics.GetWindowMin(newest) == 4.0, "Samples older than the window should be evicted from the minimum");
+   Expect(statistics.GetWindowMax(newest) == 9.0, "Window maximum should track the newest peak");
+   Expect(statistics.GetWindowMin(newest + std::chrono::seconds(25)) == 5.0, "Extremes should age out while a sensor is quiet");
+   Expect(std::isnan(statistics.GetWindowMax(newest + std::chrono::seconds(61))), "A quiet sensor's window should empty out");
+
+   const auto warnTime = statistics.GetTimeInState(SensorAlarmState::Warn, baseTime + std::chrono::seconds(75));
+   Expect(warnTime == std::chrono::seconds(15), "Time in warn should include the still-open interval");
+   Expect(statistics.GetTimeInState(SensorAlarmState::Failed, baseTime + std::chrono::seconds(75)) == std::chrono::seconds(0),
+       "A sensor that never failed should report no failed time");
+
+   node.SetValue(DataValue(std::string("offline")), {}, SensorAlarmState::Failed, baseTime + std::chrono::seconds(80));
+   Expect(statistics.GetNumericCount() == 8, "Non-numeric samples should not affect numeric statistics");
+   Expect(statistics.GetTimeInState(SensorAlarmState::Warn, baseTime + std::chrono::seconds(90)) == std::chrono::seconds(20),
+       "Warn time should stop accruing once the state changes");
+}
+
+void TestAlarmEvaluatorDebouncesFlapping()
+{
+   SensorThresholds thresholds;
+   thresholds.lowerCritical    = DataValue(0.0);
+   thresholds.lowerNonCritical = DataValue(10.0);
+   thresholds.upperNonCritical = DataValue(80.0);
+   thresholds.upperCritical    = DataValue(95.0);
+   Expect(ClassifyNumericAlarm(96.0, thresholds) == SensorAlarmState::Failed, "Values beyond a critical limit should fail");
+   Expect(ClassifyNumericAlarm(79.0, thresholds, 2.0) == SensorAlarmState::Warn, "A margin should pull limits towards the normal range");
+
+   AlarmPolicy policy;
+   policy.hysteresisFraction = 0.02;
+   policy.minimumDwell       = std::chrono::seconds(1);
+   policy.transitionBurst    = 2;
+   policy.transitionRefill   = std::chrono::seconds(10);
+
+   AlarmEvaluator evaluator;
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(100));
+   auto evaluate       = [&](int milliseconds, double value) {
+      return evaluator.Evaluate(DataValue(value), thresholds, SensorAlarmState::Ok, baseTime + std::chrono::milliseconds(milliseconds), policy);
+   };
+
+   Expect(evaluate(0, 50.0) == SensorAlarmState::Ok, "The first sample should be classified immediately");
+   Expect(evaluate(100, 81.0) == SensorAlarmState::Ok, "A new state should wait out the dwell time");
+   Expect(evaluate(500, 79.0) == SensorAlarmState::Ok, "A blip that reverts within the dwell time should be dropped");
+   Expect(evaluator.GetSuppressedCount() == 1, "Dropped blips should be counted");
+
+   evaluate(1000, 81.0);
+   Expect(evaluate(2000, 82.0) == SensorAlarmState::Warn, "A state held for the dwell time should be committed");
+   Expect(evaluate(2500, 79.5) == SensorAlarmState::Warn, "Values inside the hysteresis band should not clear the alarm");
+   evaluate(3000, 77.0);
+   Expect(evaluate(4000, 77.0) == SensorAlarmState::Ok, "Values past the hysteresis band should clear after the dwell time");
+
+   evaluate(4100, 90.0);
+   Expect(evaluate(5100, 90.0) == SensorAlarmState::Ok, "Transitions beyond the burst budget should be held back");
+   Expect(evaluate(13000, 90.0) == SensorAlarmState::Warn, "Held transitions should commit once the budget refills");
+   Expect(evaluator.GetTransitionCount() == 3, "Only committed transitions should be counted");
+
+   AlarmEvaluator reported;
+   const SensorThresholds none;
+   reported.Evaluate(DataValue("idle"), none, SensorAlarmState::Ok, baseTime, policy);
+   Expect(reported.Evaluate(DataValue("fault"), none, SensorAlarmState::Failed, baseTime + std::chrono::seconds(2), policy) == SensorAlarmState::Ok,
+       "Producer states should also be debounced");
+   Expect(reported.Evaluate(DataValue("fault"), none, SensorAlarmState::Failed, baseTime + std::chrono::seconds(3), policy) == SensorAlarmState::Failed,
+       "Producer states should be used when no numeric thresholds apply");
+}
+
 void TestWriterUsesCanonicalAlarmSchemaAndPreservesWarnState()
 {
    TempFile tempFile(MakeTempPath("_writer.json"));
@@ -220,6 +508,330 @@ void TestReaderRejectsInvalidStatusValue()
        "Invalid status files should report the accepted status values");
 }
 
+void TestSubtreeAggregatesUpdateIncrementally()
+{
+   SensorTreeModel model;
+   AlarmPolicy policy;
+   policy.enabled = false;
+   model.SetAlarmPolicy(policy);
+
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(50));
+   model.AddDataSample({"Rack", "Board1", "Current"}, DataValue(2.0), {}, SensorAlarmState::Ok, baseTime);
+   model.AddDataSample({"Rack", "Board1", "Temp"}, DataValue(40.0), {}, SensorAlarmState::Warn, baseTime);
+   model.AddDataSample({"Rack", "Board2", "Current"}, DataValue(3.0), {}, SensorAlarmState::Ok, baseTime);
+   model.AddDataSample({"Rack", "Board2", "Mode"}, DataValue("auto"), {}, SensorAlarmState::Failed, baseTime);
+
+   Node *rack   = model.FindNodeByPath({"Rack"});
+   Node *board1 = model.FindNodeByPath({"Rack", "Board1"});
+   Expect(rack && board1, "Aggregate test nodes should exist");
+   Expect(rack->GetAggregate().numericCount == 3, "Only numeric sensors should feed numeric aggregates");
+   Expect(rack->GetAggregate().Get(AggregateKind::Sum) == 45.0, "Sums should cover every numeric descendant");
+   Expect(rack->GetAggregate().Get(AggregateKind::Max) == 40.0 && rack->GetAggregate().Get(AggregateKind::Min) == 2.0,
+       "Extremes should cover every numeric descendant");
+   Expect(board1->GetAggregate().Get(AggregateKind::Mean) == 21.0, "Means should divide by numeric sensors only");
+   Expect(rack->GetAggregate().warningCount == 1 && rack->GetAggregate().failureCount == 1, "Alarm counts should be maintained per subtree");
+
+   // Lowering the current maximum forces a rescan of the affected levels.
+   model.AddDataSample({"Rack", "Board1", "Temp"}, DataValue(1.0), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(1));
+   Expect(rack->GetAggregate().Get(AggregateKind::Max) == 3.0 && rack->GetAggregate().Get(AggregateKind::Min) == 1.0,
+       "Extremes should follow values leaving them");
+   Expect(board1->GetAggregate().Get(AggregateKind::Max) == 2.0, "Intermediate levels should rescan their own children");
+   Expect(rack->GetAggregate().Get(AggregateKind::Sum) == 6.0 && rack->GetAggregate().warningCount == 0,
+       "Sums and alarm counts should follow replaced samples");
+
+   model.AddDataSample({"Rack", "Board2", "Current"}, DataValue("offline"), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(2));
+   Expect(rack->GetAggregate().numericCount == 2 && rack->GetAggregate().Get(AggregateKind::Sum) == 3.0,
+       "Sensors turning non-numeric should leave the numeric aggregates");
+
+   model.FindNodeByPath({"Rack", "Board1", "Current"})->SetStale(true);
+   Expect(rack->GetAggregate().staleCount == 1, "Staleness should propagate to ancestors");
+
+   model.SetAggregateKind(rack, AggregateKind::Max);
+   Expect(board1->GetAggregateKind() == AggregateKind::Max, "Aggregate choices should apply to the groups below");
+
+   wxVariant shown;
+   model.GetValue(shown, wxDataViewItem(board1), SensorTreeModel::COL_AGGREGATE);
+   Expect(shown.GetString() == "max 2", "Configured aggregates should be displayed for groups");
+}
+
+void TestDerivedSensorsEvaluateIncrementally()
+{
+   DerivedExpression expression;
+   std::string error;
+   Expect(DerivedExpression::Compile("max({A/x}, 2 * 3) - -{A/x} / (1 + 1)", expression, error), "Valid expressions should compile");
+   Expect(expression.GetInputs().size() == 1, "Repeated inputs should share a slot");
+   Expect(expression.GetInstructionCount() == 8, "Constant subexpressions should be folded");
+   const double input = 10.0;
+   Expect(expression.Evaluate(&input) == 15.0, "Bytecode should respect precedence and functions");
+   Expect(!DerivedExpression::Compile("{A/x} * ", expression, error) && !error.empty(), "Incomplete expressions should be rejected");
+   Expect(!DerivedExpression::Compile("pow({A/x}, 2)", expression, error), "Unknown functions should be rejected");
+   Expect(!DerivedExpression::Compile(std::string(200, '(') + "1" + std::string(200, ')'), expression, error),
+       "Runaway nesting should be rejected");
+
+   SensorTreeModel model;
+   AlarmPolicy policy;
+   policy.enabled = false;
+   model.SetAlarmPolicy(policy);
+
+   SensorThresholds powerLimits;
+   powerLimits.upperCritical = DataValue(100.0);
+   Expect(model.AddDerivedSensor({"Derived", "Power"}, "{PSU/Voltage} * {PSU/Current}", powerLimits, error), "Derived sensors should be accepted");
+   Expect(model.AddDerivedSensor({"Derived", "PowerKw"}, "{Derived/Power} / 1000", {}, error), "Derived sensors may read other derived sensors");
+   Expect(!model.AddDerivedSensor({"PSU", "Current"}, "{Derived/PowerKw}", {}, error), "Definitions that feed their own inputs should be rejected");
+   Expect(!model.AddDerivedSensor({"Derived", "Power"}, "1", {}, error), "Output paths should be unique");
+
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(20));
+   model.AddDataSample({"PSU", "Voltage"}, DataValue(12.0), {}, SensorAlarmState::Ok, baseTime);
+   Expect(model.FindNodeByPath({"Derived", "Power"}) == nullptr, "Derived sensors should wait for every input");
+
+   model.AddDataSample({"PSU", "Current"}, DataValue(5.0), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(1));
+   const Node *power   = model.FindNodeByPath({"Derived", "Power"});
+   const Node *powerKw = model.FindNodeByPath({"Derived", "PowerKw"});
+   Expect(power && power->GetValue().GetNumeric() == 60.0 && !power->IsAlarmed(), "Derived sensors should become ordinary nodes");
+   Expect(powerKw && powerKw->GetValue().GetNumeric() == 0.06, "Chained derived sensors should settle within one sample");
+   Expect(power->GetLastUpdateTime() == baseTime + std::chrono::seconds(1), "Derived samples should carry the input timestamp");
+
+   model.AddDataSample({"PSU", "Current"}, DataValue(10.0), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(2));
+   Expect(power->GetValue().GetNumeric() == 120.0 && power->IsFailed(), "Derived sensors should be classified against their thresholds");
+   Expect(power->GetUpdateCount() == 2 && power->GetHistory().size() == 2, "Derived sensors should keep history");
+
+   model.AddDataSample({"PSU", "Current"}, DataValue("tripped"), {}, SensorAlarmState::Failed, baseTime + std::chrono::seconds(3));
+   model.AddDataSample({"PSU", "Voltage"}, DataValue(11.0), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(4));
+   Expect(power->GetUpdateCount() == 2, "Non-numeric inputs should hold derived sensors back");
+}
+
+void TestSensorWireProtocolRoundTrip()
+{
+   SensorThresholds limits;
+   limits.lowerCritical = DataValue(std::int64_t(-5));
+   limits.upperCritical = DataValue(80.5);
+
+   SensorWireEncoder encoder;
+   encoder.DefinePath(7, {"Rack1", "PSU", "Voltage"}, limits);
+   encoder.DefinePath(9, {"Rack1", "Door"});
+   encoder.AppendSample(7, DataValue(12.25), SensorAlarmState::Warn, std::chrono::milliseconds(3));
+   encoder.AppendSample(9, DataValue(true));
+   encoder.AppendSample(42, DataValue(1.0));
+   encoder.AppendSample(7, DataValue(std::int64_t(-3)));
+   encoder.AppendSample(9, DataValue("open"), SensorAlarmState::Failed);
+   const std::vector<std::uint8_t> bytes = encoder.TakeBuffer();
+   Expect(encoder.GetBuffer().empty() && encoder.GetPendingSampleCount() == 0, "Taking the buffer should flush and reset the encoder");
+
+   // Feed in awkward fragments so frames straddle reads.
+   const auto receivedAt = std::chrono::steady_clock::time_point(std::chrono::seconds(50));
+   SensorWireDecoder decoder;
+   std::vector<SensorSample> samples;
+   std::string error;
+   for (size_t offset = 0; offset < bytes.size(); offset += 3) {
+      const size_t size = std::min<size_t>(3, bytes.size() - offset);
+      Expect(decoder.Feed(bytes.data() + offset, size, receivedAt, samples, error), "Fragmented frames should decode: " + error);
+   }
+
+   Expect(samples.size() == 4 && decoder.GetStats().unknownPaths == 1, "Samples for undefined ids should be counted and skipped");
+   Expect(decoder.GetStats().bytes == bytes.size() && decoder.GetStats().frames == 3, "Decoder stats should count bytes and frames");
+   Expect(samples[0].path == std::vector<std::string>({"Rack1", "PSU", "Voltage"}) && samples[0].value.GetDouble() == 12.25,
+       "Samples should resolve their path id");
+   Expect(samples[0].alarmState == SensorAlarmState::Warn && samples[0].timestamp == receivedAt - std::chrono::milliseconds(3),
+       "Samples should keep their state and age");
+   Expect(samples[0].thresholds.lowerCritical->GetInteger() == -5 && samples[0].thresholds.upperCritical->GetDouble() == 80.5 &&
+              !samples[0].thresholds.upperNonCritical,
+       "Thresholds should travel with the path definition");
+   Expect(samples[1].value.IsBoolean() && samples[1].value.GetBoolean() && !samples[1].thresholds.HasAny(), "Booleans should round-trip");
+   Expect(samples[2].value.IsInteger() && samples[2].value.GetInteger() == -3, "Integers should round-trip");
+   Expect(samples[3].value.GetString() == "open" && samples[3].alarmState == SensorAlarmState::Failed, "Strings should round-trip");
+
+   std::vector<std::uint8_t> corrupt = {2, 0, 0, 0, 99, 0};
+   Expect(!decoder.Feed(corrupt.data(), corrupt.size(), receivedAt, samples, error) && !error.empty(), "Unknown frame types should be rejected");
+   corrupt = {0xff, 0xff, 0xff, 0xff};
+   Expect(!decoder.Feed(corrupt.data(), corrupt.size(), receivedAt, samples, error), "Oversized frames should be rejected");
+}
+
+void TestSourceQueuesMergeFairly()
+{
+   auto makeSamples = [](const std::string &source, size_t count) {
+      std::vector<SensorSample> samples;
+      for (size_t i = 0; i < count; ++i)
+         samples.push_back({{source, "S" + std::to_string(i)}, DataValue(static_cast<double>(i))});
+      return samples;
+   };
+
+   SampleSourceQueue chatty(1000);
+   SampleSourceQueue quiet(1000);
+   SampleSourceQueue idle(1000);
+   Expect(chatty.Push(makeSamples("chatty", 1500)) == 1000, "A full queue should accept only what fits");
+   Expect(quiet.Push(makeSamples("quiet", 30)) == 30, "Queues should accept samples while there is room");
+
+   SampleSourceStats stats = chatty.GetStats();
+   Expect(stats.received == 1500 && stats.dropped == 500 && stats.depth == 1000 && stats.highWater == 1000,
+       "Queue stats should count drops and depth");
+
+   FairSampleMerger merger;
+   std::vector<SensorSample> out;
+   Expect(merger.Drain({&chatty, &quiet, &idle}, 200, out) == 200, "The merger should use the whole budget when data is waiting");
+   const size_t fromQuiet = static_cast<size_t>(std::count_if(out.begin(), out.end(),
+       [](const SensorSample &sample) { return sample.path[0] == "quiet"; }));
+   Expect(fromQuiet == 30, "A chatty source should not starve a quiet one");
+   Expect(out[0].path[1] == "S0" && chatty.GetDepth() == 830, "Unused shares should pass to sources that still have data");
+
+   // Equal backlogs share the budget evenly, whoever comes first.
+   Expect(quiet.Push(makeSamples("quiet", 500)) == 500, "Drained queues should accept new samples");
+   size_t quietTotal = 0;
+   for (int tick = 0; tick < 3; ++tick) {
+      out.clear();
+      merger.Drain({&chatty, &quiet, &idle}, 101, out);
+      const size_t quietShare = static_cast<size_t>(std::count_if(out.begin(), out.end(),
+          [](const SensorSample &sample) { return sample.path[0] == "quiet"; }));
+      Expect(out.size() == 101 && (quietShare == 50 || quietShare == 51), "Busy sources should split the budget evenly");
+      quietTotal += quietShare;
+   }
+   Expect(quietTotal == 151 || quietTotal == 152, "The source served first should rotate between drains");
+
+   // A blocked producer gives up after its wait, or at once when closed.
+   Expect(chatty.Push(makeSamples("chatty", 1000), std::chrono::milliseconds(5)) < 1000, "Waiting producers should time out");
+   chatty.Close();
+   Expect(chatty.Push(makeSamples("chatty", 1), SampleSourceQueue::WAIT_UNTIL_CLOSED) == 0, "Closed queues should refuse samples");
+   Expect(chatty.GetStats().delivered == 170 + 303 - quietTotal, "Delivered counts should follow drains");
+}
+
+void TestPackedSamplesWriteIntoHistory()
+{
+   SensorTreeModel model;
+   AlarmPolicy policy;
+   policy.enabled = false;
+   model.SetAlarmPolicy(policy);
+
+   std::vector<std::pair<AlarmEventKind, SensorAlarmState>> transitions;
+   model.SetOnAlarmTransition([&transitions](const SensorAlarmTransition &transition) {
+      transitions.emplace_back(transition.kind, transition.previous);
+   });
+
+   const SensorTreeModel::SensorId voltage = model.RegisterSensor({"PSU", "Voltage"});
+   const SensorTreeModel::SensorId door    = model.RegisterSensor({"Rack", "Door"});
+   Expect(voltage != door && model.RegisterSensor({"PSU", "Voltage"}) == voltage, "Registering a known path should return its id");
+   Expect(model.FindNodeByPath({"PSU", "Voltage"}) == nullptr, "Registration alone should not create nodes");
+
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(40));
+   PackedSampleBatch batch;
+   batch.AppendDouble(voltage, baseTime, 12.0);
+   batch.AppendString(door, baseTime, "closed");
+   batch.AppendDouble(voltage, baseTime + std::chrono::seconds(1), 12.5);
+   batch.AppendInteger(voltage, baseTime + std::chrono::seconds(2), 13);
+   batch.AppendString(door, baseTime + std::chrono::seconds(2), "open");
+   batch.AppendBoolean(99, baseTime, true);
+   Expect(model.AddPackedSamples(batch) == 5, "Records for unknown sensors should be skipped");
+
+   const Node *voltageNode = model.FindNodeByPath({"PSU", "Voltage"});
+   const Node *doorNode    = model.FindNodeByPath({"Rack", "Door"});
+   Expect(voltageNode && voltageNode->GetHistory().size() == 3 && voltageNode->GetUpdateCount() == 3, "Packed samples should land in history");
+   Expect(voltageNode->GetValue().GetType() == DataValue::INTEGER && voltageNode->GetValue().GetNumeric() == 13.0,
+       "The newest packed sample should become the current value");
+   Expect(voltageNode->GetHistory()[1].value.GetNumeric() == 12.5 && voltageNode->GetLastUpdateTime() == baseTime + std::chrono::seconds(2),
+       "Packed samples should keep their order and timestamps");
+   Expect(doorNode && doorNode->GetValue().GetString() == "open" && doorNode->GetHistory().front().value.GetString() == "closed",
+       "Strings should be read from the batch's text arena");
+
+   batch.Clear();
+   batch.AppendDouble(voltage, baseTime + std::chrono::seconds(3), 15.0, SensorAlarmState::Failed);
+   batch.AppendDouble(voltage, baseTime + std::chrono::seconds(4), 15.5, SensorAlarmState::Failed);
+   model.AddPackedSamples(batch);
+   Expect(voltageNode->IsFailed() && voltageNode->GetHistory().size() == 5, "State changes should still be applied from packed samples");
+   Expect(transitions.size() == 1 && transitions[0].first == AlarmEventKind::StateChanged && transitions[0].second == SensorAlarmState::Ok,
+       "Packed alarm transitions should be reported once");
+
+   PackedSampleRecord truncated = {door, DataValue::STRING, 0, 0, 0, (std::uint64_t(4) << 32) | 10};
+   Expect(model.AddPackedSamples(&truncated, 1, "short") == 0, "Strings outside the text arena should be rejected");
+
+   model.Clear();
+   batch.Clear();
+   batch.AppendDouble(voltage, baseTime + std::chrono::seconds(5), 12.0);
+   model.AddPackedSamples(batch);
+   const Node *recreated = model.FindNodeByPath({"PSU", "Voltage"});
+   Expect(recreated && recreated->GetHistory().size() == 1, "Registered sensors should survive clearing the tree");
+}
+
+void TestAlarmJournalIndexesQueries()
+{
+   AlarmJournal journal;
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::hours(10));
+   auto at             = [&](int seconds) { return baseTime + std::chrono::seconds(seconds); };
+
+   // Enough entries to span several index blocks.
+   for (int i = 0; i < 3000; ++i) {
+      const std::string category   = i % 2 == 0 ? "Category3" : "Category30";
+      const SensorAlarmState state = i % 3 == 0 ? SensorAlarmState::Failed : SensorAlarmState::Warn;
+      journal.Append({category, "Rack" + std::to_string(i % 5), "Temp"}, AlarmEventKind::StateChanged, SensorAlarmState::Ok, state,
+          DataValue(static_cast<double>(i)), at(i));
+   }
+   journal.Append({"Category3", "Rack0", "Mode"}, AlarmEventKind::WentStale, SensorAlarmState::Ok, SensorAlarmState::Ok, DataValue("idle"), at(3000));
+
+   Expect(journal.Size() == 3001, "Every appended event should be kept");
+   Expect(journal.GetSensorCount() == 11, "Sensor paths should be interned once");
+
+   AlarmJournal::Query failures;
+   failures.pathPrefix = {"Category3"};
+   failures.state      = SensorAlarmState::Failed;
+   failures.from       = at(2400);
+   const std::vector<size_t> recent = journal.Run(failures);
+   Expect(recent.size() == 100, "Failures under a subtree and time window should be found");
+   for (size_t index : recent) {
+      const AlarmJournal::Entry &entry = journal.GetEntry(index);
+      Expect(journal.GetSensorPath(entry.sensorId).rfind("Category3/", 0) == 0, "Prefixes should stop at segment boundaries");
+      Expect(entry.state == SensorAlarmState::Failed && entry.timestamp >= at(2400), "Results should honour every filter");
+   }
+   Expect(std::is_sorted(recent.begin(), recent.end()), "Results should be returned oldest first");
+
+   AlarmJournal::Query window;
+   window.from  = at(1000);
+   window.to    = at(1999);
+   window.limit = 10;
+   const std::vector<size_t> newest = journal.Run(window);
+   Expect(newest.size() == 10 && journal.GetEntry(newest.back()).timestamp == at(1999) && journal.GetEntry(newest.front()).timestamp == at(1990),
+       "Limits should keep the newest matches inside the window");
+
+   AlarmJournal::Query stale;
+   stale.pathPrefix = {"Category3", "Rack0", "Mode"};
+   stale.kind       = AlarmEventKind::WentStale;
+   const std::vector<size_t> staleEvents = journal.Run(stale);
+   Expect(staleEvents.size() == 1 && journal.GetValueText(journal.GetEntry(staleEvents.front())) == "idle",
+       "Exact sensor paths should match and keep text values");
+
+   // A state change stamped with its sample's age lands before the stale
+   // event journaled just ahead of it.
+   journal.Append({"Category3", "Rack0", "Mode"}, AlarmEventKind::StateChanged, SensorAlarmState::Ok, SensorAlarmState::Failed,
+       DataValue("fault"), at(2999));
+   AlarmJournal::Query late;
+   late.pathPrefix = {"Category3", "Rack0", "Mode"};
+   late.from       = at(2999);
+   late.to         = at(2999);
+   const std::vector<size_t> lateEvents = journal.Run(late);
+   Expect(lateEvents.size() == 1 && journal.GetEntry(lateEvents.front()).kind == AlarmEventKind::StateChanged,
+       "Events arriving out of time order should still be found");
+   late.from = at(3000);
+   late.to.reset();
+   const std::vector<size_t> afterLate = journal.Run(late);
+   Expect(afterLate.size() == 1 && journal.GetEntry(afterLate.front()).kind == AlarmEventKind::WentStale,
+       "An older event journaled later should not hide newer ones");
+
+   SensorTreeModel model;
+   AlarmPolicy policy;
+   policy.enabled = false;
+   model.SetAlarmPolicy(policy);
+
+   AlarmJournal modelJournal;
+   model.SetOnAlarmTransition([&](const SensorAlarmTransition &transition) {
+      modelJournal.Append(transition.node->GetPath(), transition.kind, transition.previous, transition.state, transition.value, transition.timestamp);
+   });
+
+   model.AddDataSample({"Cab", "Fan"}, DataValue(10.0), {}, SensorAlarmState::Ok, at(0));
+   model.AddDataSample({"Cab", "Fan"}, DataValue(11.0), {}, SensorAlarmState::Ok, at(1));
+   model.AddDataSample({"Cab", "Fan"}, DataValue(99.0), {}, SensorAlarmState::Failed, at(2));
+   Expect(modelJournal.Size() == 1, "Only samples that change the alarm state should be journaled");
+   const AlarmJournal::Entry &transition = modelJournal.GetEntry(0);
+   Expect(transition.kind == AlarmEventKind::StateChanged && transition.previous == SensorAlarmState::Ok &&
+              transition.state == SensorAlarmState::Failed && transition.value == 99.0,
+       "Transitions should record both states and the triggering value");
+}
+
 void TestModelVisibilityAndAlarmSummary()
 {
    SensorTreeModel model;
@@ -313,6 +925,123 @@ void TestLoadedRecordingsFreezeElapsedColumn()
    Expect(speedElapsedAfterRefresh.GetString() == "0.0", "Offline newest-sample elapsed should stay fixed across timer refreshes");
 }
 
+void TestStalenessWheelFiresAtDeadlines()
+{
+   Node fast("fast");
+   Node slow("slow");
+   Node distant("distant");
+
+   StalenessWheel wheel;
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(1000));
+   std::vector<Node *> expired;
+   wheel.Advance(baseTime, expired);
+
+   wheel.Schedule(&fast, baseTime + std::chrono::milliseconds(250));
+   wheel.Schedule(&slow, baseTime + std::chrono::seconds(10));
+   wheel.Schedule(&distant, baseTime + std::chrono::hours(24 * 30));
+   Expect(wheel.Size() == 3, "Scheduled deadlines should be counted");
+
+   wheel.Advance(baseTime + std::chrono::milliseconds(200), expired);
+   Expect(expired.empty(), "Deadlines should never fire early");
+   wheel.Advance(baseTime + std::chrono::milliseconds(300), expired);
+   Expect(expired.size() == 1 && expired[0] == &fast, "Level-zero deadlines should fire on their tick");
+
+   expired.clear();
+   wheel.Advance(baseTime + std::chrono::seconds(9), expired);
+   Expect(expired.empty(), "Cascaded deadlines should not fire before they are due");
+   wheel.Advance(baseTime + std::chrono::seconds(10), expired);
+   Expect(expired.size() == 1 && expired[0] == &slow, "Higher-level deadlines should cascade down and fire");
+
+   expired.clear();
+   wheel.Advance(baseTime + std::chrono::hours(24 * 30) - std::chrono::seconds(1), expired);
+   Expect(expired.empty(), "Deadlines beyond the wheel span should be parked rather than fired");
+   wheel.Advance(baseTime + std::chrono::hours(24 * 30), expired);
+   Expect(expired.size() == 1 && expired[0] == &distant, "Parked deadlines should fire after large time jumps");
+   Expect(wheel.Empty(), "Fired deadlines should leave the wheel");
+}
+
+void TestModelSurfacesStaleSensors()
+{
+   SensorTreeModel model;
+   model.SetLiveDataMode(false);
+
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(100));
+   for (int second = 0; second <= 10; ++second) {
+      const auto timestamp = baseTime + std::chrono::seconds(second);
+      model.AddDataSample({"rack", "fan", "speed"}, DataValue(std::int64_t{3000}), {}, SensorAlarmState::Ok, timestamp);
+      if (second <= 2)
+         model.AddDataSample({"rack", "psu", "voltage"}, DataValue(12.0), {}, SensorAlarmState::Ok, timestamp);
+   }
+
+   Node *rackNode    = model.FindNodeByPath({"rack"});
+   Node *voltageNode = model.FindNodeByPath({"rack", "psu", "voltage"});
+   Node *speedNode   = model.FindNodeByPath({"rack", "fan", "speed"});
+   Expect(rackNode && voltageNode && speedNode, "Staleness test should create every node");
+
+   model.AdvanceStaleness();
+   Expect(voltageNode->IsStale(), "A sensor silent for more than three periods should be stale");
+   Expect(!speedNode->IsStale(), "A sensor still reporting should be re-armed instead of going stale");
+
+   wxVariant summaryValue;
+   model.GetValue(summaryValue, wxDataViewItem(static_cast<void *>(rackNode)), SensorTreeModel::COL_VALUE);
+   Expect(summaryValue.GetString() == "1 stale", "Stale sensors should appear in container alarm summaries");
+
+   wxVariant elapsedValue;
+   model.GetValue(elapsedValue, wxDataViewItem(static_cast<void *>(voltageNode)), SensorTreeModel::COL_ELAPSED);
+   Expect(elapsedValue.GetString() == "8.0 (stale)", "Stale sensors should be marked in the elapsed column");
+
+   model.SetShowAlarmedOnly(true);
+   Expect(model.IsNodeVisible(voltageNode), "Stale sensors should be shown when filtering alarmed nodes");
+   Expect(!model.IsNodeVisible(speedNode), "Healthy sensors should stay hidden when filtering alarmed nodes");
+
+   model.AddDataSample({"rack", "psu", "voltage"}, DataValue(12.1), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(11));
+   Expect(!voltageNode->IsStale(), "A new sample should recover a stale sensor");
+   Expect(!model.IsNodeVisible(voltageNode), "Recovered sensors should leave the alarmed-only view");
+}
+
+void TestStoreCommitsPendingAlarmOfQuietSensor()
+{
+   SensorDataStore store;
+   store.SetLiveDataMode(false);
+
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(100));
+   store.AddDataSample({"rack", "psu", "status"}, DataValue("ok"), {}, SensorAlarmState::Ok, baseTime);
+   store.AddDataSample({"rack", "psu", "status"}, DataValue("fault"), {}, SensorAlarmState::Failed, baseTime + std::chrono::milliseconds(100));
+
+   Node *statusNode = store.FindNodeByPath({"rack", "psu", "status"});
+   Expect(statusNode && statusNode->GetAlarmState() == SensorAlarmState::Ok, "A new alarm should wait out the dwell time");
+
+   store.AdvanceStaleness();
+   Expect(statusNode->GetAlarmState() == SensorAlarmState::Ok, "A pending alarm should not commit before its dwell time");
+
+   // Another sensor moves the reference time past the dwell deadline.
+   store.AddDataSample({"rack", "fan", "speed"}, DataValue(std::int64_t{3000}), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(2));
+   SensorChangeSet changes;
+   store.TakeChanges(changes);
+   store.AdvanceStaleness();
+   Expect(statusNode->GetAlarmState() == SensorAlarmState::Failed, "A quiet sensor's pending alarm should commit once its dwell time passes");
+   Expect(store.GetTotals().failedCount == 1, "Committed alarms should be counted");
+   Expect(statusNode->GetParent()->GetAggregate().failureCount == 1, "Committed alarms should reach the parent aggregates");
+
+   // The sensor has also gone stale by now; the alarm commits regardless.
+   store.TakeChanges(changes);
+   const auto committed = std::find_if(changes.transitions.begin(), changes.transitions.end(), [](const SensorAlarmTransition &transition) {
+      return transition.kind == AlarmEventKind::StateChanged;
+   });
+   Expect(statusNode->IsStale(), "The quiet sensor should also have gone stale");
+   Expect(committed != changes.transitions.end() && committed->state == SensorAlarmState::Failed,
+       "A committed alarm should be reported as a state change");
+
+   SensorDataStore recorded;
+   recorded.SetLiveDataMode(false);
+   SensorThresholds thresholds;
+   thresholds.upperCritical = DataValue(95.0);
+   recorded.AddRecordedSamples({{{"rack", "temp"}, DataValue(50.0), thresholds, SensorAlarmState::Ok, baseTime},
+       {{"rack", "temp"}, DataValue(90.0), thresholds, SensorAlarmState::Warn, baseTime + std::chrono::milliseconds(100)}});
+   Expect(recorded.FindNodeByPath({"rack", "temp"})->GetAlarmState() == SensorAlarmState::Warn,
+       "Recorded samples should keep their recorded alarm states");
+}
+
 void TestModelKeepsFilteredVisibilityStableAcrossRepeatedUpdates()
 {
    SensorTreeModel model;
@@ -357,14 +1086,363 @@ void TestModelKeepsFilteredVisibilityStableAcrossRepeatedUpdates()
    Expect(static_cast<Node *>(visibleChildren[0].GetID()) == alphaNode, "The visible child should be the matching branch");
 }
 
+void TestModelNotifiesSensorUpdates()
+{
+   SensorTreeModel model;
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(300));
+
+   std::vector<const Node *> notified;
+   model.SetOnSensorUpdated([&notified](const Node *node) { notified.push_back(node); });
+
+   model.AddDataSample({"rack", "psu", "voltage"}, DataValue(12.0), {}, SensorAlarmState::Ok, baseTime);
+   const std::uint64_t versionAfterCreate = model.GetStructureVersion();
+   model.AddDataSample({"rack", "psu", "voltage"}, DataValue(12.5), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(1));
+
+   const Node *voltageNode = model.FindNodeByPath({"rack", "psu", "voltage"});
+   Expect(notified.size() == 2, "Every applied sample should notify the updated sensor");
+   Expect(notified[0] == voltageNode && notified[1] == voltageNode, "Notifications should identify the updated sensor node");
+   Expect(versionAfterCreate > 0, "Creating nodes should advance the structure version");
+   Expect(model.GetStructureVersion() == versionAfterCreate, "Updating an existing sensor should not advance the structure version");
+
+   model.Clear();
+   Expect(notified.size() == 3 && notified.back() == nullptr, "Clearing the tree should notify with a null sensor");
+   Expect(model.GetStructureVersion() > versionAfterCreate, "Clearing the tree should advance the structure version");
+}
+
+void TestStoreChangesPublishAcrossThreads()
+{
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(400));
+
+   SensorDataStore store;
+   store.AddDataSample({"rack", "psu", "voltage"}, DataValue(12.0), {}, SensorAlarmState::Ok, baseTime);
+   store.AddDataSample({"rack", "psu", "voltage"}, DataValue(12.1), {}, SensorAlarmState::Ok, baseTime + std::chrono::seconds(1));
+   store.AddDataSample({"rack", "fan"}, DataValue(900.0), {}, SensorAlarmState::Ok, baseTime);
+
+   SensorChangeSet changes;
+   store.TakeChanges(changes);
+   const Node *rackNode    = store.FindNodeByPath({"rack"});
+   const Node *voltageNode = store.FindNodeByPath({"rack", "psu", "voltage"});
+   const Node *fanNode     = store.FindNodeByPath({"rack", "fan"});
+   Expect(changes.createdNodes.size() == 4 && changes.createdNodes.front() == rackNode, "Created nodes should be listed parents first");
+   Expect(changes.updatedNodes.size() == 2 && changes.updatedNodes[0] == voltageNode && changes.updatedNodes[1] == fanNode,
+       "A sensor updated twice should be listed once");
+   Expect(changes.structureVersion == store.GetStructureVersion(), "Change sets should carry the structure version they end at");
+
+   store.TakeChanges(changes);
+   Expect(changes.Empty(), "Taking changes should start a new set");
+
+   SensorTreeModel model;
+   size_t notifications = 0;
+   model.SetOnSensorUpdated([&notifications](const Node *) { ++notifications; });
+
+   constexpr int SENSOR_COUNT = 8;
+   constexpr int BATCH_COUNT  = 200;
+   std::atomic<bool> producing(true);
+   std::thread producer([&model, &producing, baseTime] {
+      std::vector<SensorSample> batch;
+      for (int round = 0; round < BATCH_COUNT; ++round) {
+         batch.clear();
+         for (int sensor = 0; sensor < SENSOR_COUNT; ++sensor) {
+            batch.push_back({{"bay" + std::to_string(sensor % 2), "sensor" + std::to_string(sensor)}, DataValue(double(round)), {},
+                SensorAlarmState::Ok, baseTime + std::chrono::milliseconds(round)});
+         }
+         model.GetStore().AddDataSamples(batch);
+      }
+      producing = false;
+   });
+
+   size_t publishes = 0;
+   while (producing.load()) {
+      if (model.PublishChanges())
+         ++publishes;
+   }
+   producer.join();
+   if (model.PublishChanges())
+      ++publishes;
+
+   wxDataViewItemArray roots;
+   Expect(model.GetChildren(wxDataViewItem(nullptr), roots) == 2, "Both bays should be shown once publishing catches up");
+   for (int sensor = 0; sensor < SENSOR_COUNT; ++sensor) {
+      const Node *node = model.FindNodeByPath({"bay" + std::to_string(sensor % 2), "sensor" + std::to_string(sensor)});
+      Expect(node && model.IsNodeVisible(node) && node->GetUpdateCount() == BATCH_COUNT, "Every sample applied on the producer thread should be kept");
+   }
+   Expect(notifications >= SENSOR_COUNT && notifications <= SENSOR_COUNT * publishes,
+       "Update callbacks should fire at most once per sensor per publish");
+   Expect(!model.PublishChanges(), "Nothing should be left to publish once the producer is done");
+}
+
+void TestShardedStoreMatchesSingleShard()
+{
+   const auto baseTime = std::chrono::steady_clock::time_point(std::chrono::seconds(500));
+
+   const auto feed = [&](SensorDataStore &store) {
+      std::string error;
+      Expect(store.AddDerivedSensor({"Total", "Sum"}, "{rack0/temp} + {rack1/temp}", {}, error), "Derived sensors should be accepted by any store");
+
+      std::vector<SensorSample> batch;
+      for (int round = 0; round < 100; ++round) {
+         for (int rack = 0; rack < 16; ++rack) {
+            const SensorAlarmState state = round == 99 ? SensorAlarmState::Failed : SensorAlarmState::Ok;
+            batch.push_back({{"rack" + std::to_string(rack), "temp"}, DataValue(double(round)), {}, state, baseTime + std::chrono::milliseconds(round)});
+         }
+         if (batch.size() >= 400)
+            store.SubmitSamples(batch);
+      }
+      store.SubmitSamples(batch);
+      Expect(batch.empty(), "Submitted samples should be consumed");
+   };
+
+   AlarmPolicy policy;
+   policy.enabled = false;
+
+   SensorDataStore single;
+   single.SetAlarmPolicy(policy);
+   feed(single);
+
+   SensorDataStore sharded(4);
+   sharded.SetAlarmPolicy(policy);
+   sharded.StartWorkers();
+   feed(sharded);
+   sharded.StopWorkers();
+
+   const SensorStoreTotals singleTotals  = single.GetTotals();
+   const SensorStoreTotals shardedTotals = sharded.GetTotals();
+   Expect(sharded.GetShardCount() == 4, "The store should keep the requested shard count");
+   Expect(shardedTotals.sensorCount == 17 && singleTotals.sensorCount == 17, "Every sensor and the derived sensor should exist");
+   Expect(singleTotals.sampleCount == 1600 + 199, "Derived samples should be produced once per input sample after both inputs reported");
+   // Shards race to their first samples, so fewer inputs may find both reported.
+   Expect(shardedTotals.sampleCount > 1600 && shardedTotals.sampleCount <= singleTotals.sampleCount,
+       "Sharded stores should produce derived samples from inputs on other shards");
+   Expect(shardedTotals.failedCount == 16 && singleTotals.failedCount == 16, "Totals should merge alarm counts across shards");
+
+   const Node *sum = sharded.FindNodeByPath({"Total", "Sum"});
+   Expect(sum && sum->GetValue().GetNumeric() == 198.0, "Derived outputs should reach their shard from other shards' workers");
+   for (int rack = 0; rack < 16; ++rack) {
+      const Node *node = sharded.FindNodeByPath({"rack" + std::to_string(rack), "temp"});
+      Expect(node && node->GetUpdateCount() == 100 && node->GetValue().GetNumeric() == 99.0, "Each sensor should receive its samples in order");
+   }
+
+   SensorChangeSet changes;
+   sharded.TakeChanges(changes);
+   Expect(changes.createdNodes.size() == 34 && changes.updatedNodes.size() == 17, "Change sets should gather every shard's changes");
+   for (const Node *created : changes.createdNodes) {
+      const auto position = std::find(changes.createdNodes.begin(), changes.createdNodes.end(), created);
+      Expect(!created->GetParent() || std::find(changes.createdNodes.begin(), position, created->GetParent()) != position,
+          "Parents should still come before their children");
+   }
+
+   const auto lock = sharded.Lock();
+   Expect(sharded.GetRootNodes().size() == 17, "Root nodes from every shard should be listed");
+}
+
 } // namespace
 
+void TestSyntheticLoadShapesAndPacesSamples()
+{
+   SyntheticLoadConfig config;
+   config.sensorCount      = 60;
+   config.depth            = 2;
+   config.fanOut           = 3;
+   config.doubleShare      = 2.0;
+   config.booleanShare     = 0.0;
+   config.samplesPerSecond = 1000.0;
+   config.burstFactor      = 4.0;
+   config.alarmRate        = 0.25;
+
+   SyntheticLoadGenerator generator(config);
+   const auto &sensors = generator.GetSensors();
+   const size_t doubles  = std::count_if(sensors.begin(), sensors.end(), [](const auto &sensor) { return sensor.type == DataValue::DOUBLE; });
+   const size_t booleans = std::count_if(sensors.begin(), sensors.end(), [](const auto &sensor) { return sensor.type == DataValue::BOOLEAN; });
+   Expect(sensors.size() == 60 && doubles == 30 && booleans == 0, "Sensor types should follow their shares");
+   Expect(sensors[0].path == std::vector<std::string>{"Category1", "Group1", "Sensor1_Double"} &&
+              sensors[4].path == std::vector<std::string>{"Category2", "Group2", "Sensor5_Double"} &&
+              sensors[9].path[0] == "Category1" && sensors[9].path[1] == "Group1",
+       "Sensors should be spread over fanOut^depth groups");
+
+   const auto dueAt = [&](std::uint64_t index) { return generator.GetDueOffset(index).count(); };
+   Expect(std::fabs(dueAt(999) - 0.24975) < 1e-9 && std::fabs(dueAt(1000) - 1.0) < 1e-9 && std::fabs(dueAt(1500) - 1.125) < 1e-9,
+       "Bursts should send a period's share at the peak rate, then idle until the next period");
+
+   std::vector<std::uint32_t> ids(sensors.size());
+   for (size_t index = 0; index < ids.size(); ++index)
+      ids[index] = static_cast<std::uint32_t>(index);
+
+   const auto timestamp = std::chrono::steady_clock::time_point(std::chrono::seconds(10));
+   PackedSampleBatch first;
+   PackedSampleBatch second;
+   SyntheticLoadGenerator::Stream(generator, ids, 0, 42).Fill(first, 6000, timestamp);
+   SyntheticLoadGenerator::Stream(generator, ids, 0, 42).Fill(second, 6000, timestamp);
+   Expect(first.Size() == 6000 && second.Size() == 6000 && first.GetText() == second.GetText() &&
+              std::memcmp(first.GetRecords(), second.GetRecords(), 6000 * sizeof(PackedSampleRecord)) == 0,
+       "A stream should depend only on its seed");
+
+   size_t alarms = 0;
+   for (size_t index = 0; index < first.Size(); ++index) {
+      const PackedSampleRecord &record = first.GetRecords()[index];
+      const auto &sensor               = sensors[record.sensorId];
+      Expect(record.sensorId == index % sensors.size() && record.GetType() == sensor.type, "A single stream should cycle through every sensor");
+      if (record.GetType() == DataValue::DOUBLE)
+         Expect(record.GetAlarmState() == ClassifyNumericAlarm(record.GetDouble(), sensor.thresholds), "Numeric alarm states should match the thresholds");
+      if (record.GetAlarmState() != SensorAlarmState::Ok)
+         ++alarms;
+   }
+   Expect(alarms > 1200 && alarms < 1800, "About alarmRate of the samples should be in alarm");
+
+   config.samplesPerSecond = 0.0;
+   config.threadCount      = 2;
+   config.batchSize        = 500;
+   SyntheticLoadGenerator unthrottled(config);
+   AlarmPolicy policy;
+   policy.enabled = false;
+   SensorDataStore store(2);
+   store.SetAlarmPolicy(policy);
+   std::atomic<std::uint64_t> observed{0};
+   std::atomic<bool> resolvedEveryRecord{true};
+   unthrottled.SetBatchObserver([&](const SyntheticLoadGenerator &generator, const PackedSampleBatch &batch) {
+      observed += batch.Size();
+      for (size_t idx = 0; idx < batch.Size(); ++idx) {
+         const auto *sensor = generator.FindSensor(batch.GetRecords()[idx].sensorId);
+         if (!sensor || sensor->type != batch.GetRecords()[idx].GetType() || !DecodePackedValue(batch.GetRecords()[idx], batch.GetText()))
+            resolvedEveryRecord = false;
+      }
+   });
+   unthrottled.Start(store);
+   const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+   while (unthrottled.GetGeneratedCount() < 20000 && std::chrono::steady_clock::now() < deadline)
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+   unthrottled.Stop();
+
+   const SensorStoreTotals totals = store.GetTotals();
+   Expect(!unthrottled.IsRunning() && unthrottled.GetThreadCount() == 2, "Stop should join every worker");
+   Expect(totals.sensorCount == 60 && totals.sampleCount == unthrottled.GetGeneratedCount() && totals.sampleCount >= 20000,
+       "Every generated sample should reach the store");
+   Expect(observed.load() == unthrottled.GetGeneratedCount() && resolvedEveryRecord.load(),
+       "The batch observer should see every applied sample and resolve its sensor");
+}
+
+void TestSyntheticWorkloadProfilesReplay()
+{
+   const auto timestamp = std::chrono::steady_clock::time_point(std::chrono::seconds(20));
+   const auto fill      = [&](const SyntheticLoadConfig &config, std::uint64_t seed, size_t count) {
+      SyntheticLoadGenerator generator(config);
+      std::vector<std::uint32_t> ids(generator.GetSensors().size());
+      for (size_t index = 0; index < ids.size(); ++index)
+         ids[index] = static_cast<std::uint32_t>(index);
+
+      PackedSampleBatch batch;
+      SyntheticLoadGenerator::Stream(generator, ids, 0, seed).Fill(batch, count, timestamp);
+      return batch;
+   };
+   const auto sameRecords = [](const PackedSampleBatch &first, const PackedSampleBatch &second) {
+      return first.Size() == second.Size() && first.GetText() == second.GetText() &&
+             std::memcmp(first.GetRecords(), second.GetRecords(), first.Size() * sizeof(PackedSampleRecord)) == 0;
+   };
+
+   for (WorkloadProfile profile : {WorkloadProfile::Uniform, WorkloadProfile::HotSensors, WorkloadProfile::AlarmStorm,
+            WorkloadProfile::TreeGrowth, WorkloadProfile::Categorical}) {
+      WorkloadProfile parsed = WorkloadProfile::Uniform;
+      Expect(TryParseWorkloadProfile(ToString(profile), parsed) && parsed == profile, "Profile names should round-trip");
+
+      SyntheticLoadConfig config = MakeWorkloadConfig(profile);
+      config.sensorCount         = 160;
+      Expect(sameRecords(fill(config, 9, 4000), fill(config, 9, 4000)) && !sameRecords(fill(config, 9, 4000), fill(config, 10, 4000)),
+          std::string("Profile ") + ToString(profile) + " should replay exactly from its seed");
+   }
+
+   SyntheticLoadConfig config = MakeWorkloadConfig(WorkloadProfile::HotSensors);
+   config.sensorCount         = 100;
+
+   std::vector<size_t> hits(config.sensorCount, 0);
+   const PackedSampleBatch hot = fill(config, 3, 20000);
+   for (size_t index = 0; index < hot.Size(); ++index)
+      ++hits[hot.GetRecords()[index].sensorId];
+   Expect(hits[0] > 10 * hits[99] && hits[0] > hits[1] && hits[1] > hits[9], "Hot sensors should follow a Zipf skew");
+
+   config             = MakeWorkloadConfig(WorkloadProfile::AlarmStorm);
+   config.sensorCount = 100;
+
+   const PackedSampleBatch storm = fill(config, 3, 1000);
+   size_t calmAlarms             = 0;
+   size_t stormAlarms            = 0;
+   for (size_t index = 0; index < storm.Size(); ++index) {
+      const bool alarm = storm.GetRecords()[index].GetAlarmState() != SensorAlarmState::Ok;
+      (index >= 800 ? stormAlarms : calmAlarms) += alarm ? 1 : 0;
+   }
+   Expect(calmAlarms < 40 && stormAlarms > 120, "The last two of every ten rounds should be storms");
+
+   config             = MakeWorkloadConfig(WorkloadProfile::TreeGrowth);
+   config.sensorCount = 160;
+
+   const PackedSampleBatch growth = fill(config, 3, 200);
+   std::uint32_t newest           = 0;
+   for (size_t index = 0; index < growth.Size(); ++index) {
+      if (index < 40)
+         Expect(growth.GetRecords()[index].sensorId < 10, "Only the first sixteenth of the sensors should report at first");
+      newest = std::max(newest, growth.GetRecords()[index].sensorId);
+   }
+   Expect(newest >= 10 && newest < 30, "Sensors should join in bursts");
+
+   config             = MakeWorkloadConfig(WorkloadProfile::Categorical);
+   config.sensorCount = 100;
+
+   const PackedSampleBatch categorical = fill(config, 3, 5000);
+   std::set<std::string_view> labels;
+   size_t strings                      = 0;
+   for (size_t index = 0; index < categorical.Size(); ++index) {
+      const PackedSampleRecord &record = categorical.GetRecords()[index];
+      if (record.GetType() == DataValue::STRING) {
+         ++strings;
+         labels.insert(record.GetString(categorical.GetText()));
+      }
+   }
+   Expect(strings > 3500 && labels.size() > 60, "Categorical workloads should be string-heavy with many labels");
+
+   const std::filesystem::path path = std::filesystem::temp_directory_path() / "sensor_tree_workloads.json";
+   {
+      std::ofstream output(path);
+      output << R"({"storm": {"profile": "alarm-storm", "seed": 7, "sensors": 500, "threads": 2},)"
+             << R"( "baseline": {"samples_per_second": 0, "burst_period_ms": 250}})";
+   }
+   std::vector<SyntheticWorkload> workloads;
+   std::string error;
+   Expect(LoadSyntheticWorkloads(path.string(), workloads, error), "A valid workload file should load: " + error);
+   Expect(workloads.size() == 2 && workloads[0].name == "baseline" && workloads[1].name == "storm", "Workloads should be sorted by name");
+   Expect(workloads[0].config.profile == WorkloadProfile::Uniform && workloads[0].config.samplesPerSecond == 0.0 &&
+              workloads[0].config.burstPeriod == std::chrono::milliseconds(250) && workloads[0].config.sensorCount == 1000,
+       "Settings left out should keep their defaults");
+   Expect(workloads[1].config.profile == WorkloadProfile::AlarmStorm && workloads[1].config.seed == 7 &&
+              workloads[1].config.sensorCount == 500 && workloads[1].config.threadCount == 2 && workloads[1].config.alarmRate == 0.01,
+       "A workload should start from its profile's defaults");
+
+   {
+      std::ofstream output(path);
+      output << R"({"typo": {"sensor": 10}})";
+   }
+   Expect(!LoadSyntheticWorkloads(path.string(), workloads, error) && error.find("sensor") != std::string::npos && workloads.empty(),
+       "Unknown settings should be rejected");
+   std::filesystem::remove(path);
+}
+
 int main()
 {
    try {
       TestPathRoundTrip();
       TestAlarmStateStringMapping();
       TestUnsignedRangeCheck();
+      TestSampleHistoryWindowExtents();
+      TestHistoryViewsStayConsistentUnderWriter();
+      TestM4DecimationKeepsColumnExtremes();
+      TestCategoryDictionaryKeepsStableLanes();
+      TestPlotDataServiceSharesSnapshots();
+      TestDenseEnvelopeSummarisesSeries();
+      TestSensorStatisticsTrackRunningValues();
+      TestAlarmEvaluatorDebouncesFlapping();
+      TestAlarmJournalIndexesQueries();
+      TestSubtreeAggregatesUpdateIncrementally();
+      TestDerivedSensorsEvaluateIncrementally();
+      TestSensorWireProtocolRoundTrip();
+      TestSourceQueuesMergeFairly();
+      TestPackedSamplesWriteIntoHistory();
       TestWriterUsesCanonicalAlarmSchemaAndPreservesWarnState();
       TestWriterOmitsStatusForOkState();
       TestReaderDefaultsMissingStatusToOk();
@@ -374,7 +1452,15 @@ int main()
       TestModelVisibilityAndAlarmSummary();
       TestModelPreservesExplicitSampleTimestamps();
       TestLoadedRecordingsFreezeElapsedColumn();
+      TestStalenessWheelFiresAtDeadlines();
+      TestModelSurfacesStaleSensors();
+      TestStoreCommitsPendingAlarmOfQuietSensor();
       TestModelKeepsFilteredVisibilityStableAcrossRepeatedUpdates();
+      TestModelNotifiesSensorUpdates();
+      TestStoreChangesPublishAcrossThreads();
+      TestShardedStoreMatchesSingleShard();
+      TestSyntheticLoadShapesAndPacesSamples();
+      TestSyntheticWorkloadProfilesReplay();
    } catch (const std::exception &error) {
       std::cerr << error.what() << std::endl;
       return 1;